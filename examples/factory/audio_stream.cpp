@@ -0,0 +1,600 @@
+/**
+ * @file      audio_stream.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-22
+ *
+ */
+#include "audio_stream.h"
+
+#if defined(ARDUINO) || defined(AUDIO_STREAM_HOST)
+
+#include <string.h>
+#include <stdlib.h>
+#include <mp3dec.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#define stream_ring_alloc(size)     ps_malloc(size)
+static uint32_t stream_now_us()
+{
+    return (uint32_t)esp_timer_get_time();
+}
+#else
+#include <stdio.h>
+#include <chrono>
+#define stream_ring_alloc(size)     malloc(size)
+#define log_d(...)
+#define log_e(format, ...)          fprintf(stderr, format "\n", ##__VA_ARGS__)
+static uint32_t stream_now_us()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+#define STREAM_RING_MASK            (CONFIG_AUDIO_STREAM_RING_SIZE - 1)
+
+// Holds two of the largest MP3 frames, the decoder needs one complete frame
+#define STREAM_DECODE_SIZE          (MAINBUF_SIZE * 2)
+
+// PCM bytes written to the sink per WAV block
+#define STREAM_WAV_BLOCK            2048
+
+#define STREAM_PCM_SAMPLES          (MAX_NCHAN * MAX_NGRAN * MAX_NSAMP)
+
+static uint32_t stream_le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t stream_le16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+bool AudioStreamPlayer::parseHeader(audio_stream_format_t format)
+{
+    uint8_t head[512];
+    if (_source.lock) {
+        _source.lock(_source.ctx);
+    }
+    size_t len = _source.read(_source.ctx, head, sizeof(head));
+    if (_source.unlock) {
+        _source.unlock(_source.ctx);
+    }
+
+    _dataStart = 0;
+    _dataSize = 0;
+    _blockAlign = 1;
+    _byteRate = 0;
+
+    if (format == AUDIO_STREAM_MP3) {
+        // Skip an ID3v2 tag, it can be large when it holds the cover art
+        if (len >= 10 && memcmp(head, "ID3", 3) == 0) {
+            _dataStart = 10 + ((head[6] & 0x7F) << 21 | (head[7] & 0x7F) << 14 | (head[8] & 0x7F) << 7 | (head[9] & 0x7F));
+            if (head[5] & 0x10) {
+                _dataStart += 10;
+            }
+        }
+        return true;
+    }
+
+    if (len < 12 || memcmp(head, "RIFF", 4) || memcmp(head + 8, "WAVE", 4)) {
+        log_e("Not a RIFF/WAVE file");
+        return false;
+    }
+    bool fmt = false;
+    size_t pos = 12;
+    while (pos + 8 <= len) {
+        uint32_t size = stream_le32(head + pos + 4);
+        if (memcmp(head + pos, "fmt ", 4) == 0 && pos + 8 + 16 <= len) {
+            const uint8_t *p = head + pos + 8;
+            if (stream_le16(p) != 1) {
+                log_e("Only PCM WAV is supported");
+                return false;
+            }
+            _channels = stream_le16(p + 2);
+            _rate = stream_le32(p + 4);
+            _byteRate = stream_le32(p + 8);
+            _blockAlign = stream_le16(p + 12);
+            _bits = stream_le16(p + 14);
+            fmt = true;
+        } else if (memcmp(head + pos, "data", 4) == 0) {
+            _dataStart = pos + 8;
+            _dataSize = size;
+            return fmt && _blockAlign;
+        }
+        // Chunks are padded to an even size
+        pos += 8 + size + (size & 1);
+    }
+    log_e("WAV data chunk not found in the first %u bytes", (unsigned)sizeof(head));
+    return false;
+}
+
+bool AudioStreamPlayer::play(const audio_stream_source_t &source, const audio_stream_sink_t &sink,
+                             audio_stream_format_t format, audio_stream_control_cb_t control, void *control_ctx)
+{
+    if (_playing || !source.read || !source.seek || !sink.open || !sink.write) {
+        return false;
+    }
+    _source = source;
+    _sink = sink;
+    memset(&_stats, 0, sizeof(_stats));
+    _head = _tail = 0;
+    _inLen = 0;
+    _eof = false;
+    _stop = false;
+    _seekReq = NO_SEEK;
+    _seekEpoch = _decodeEpoch = 0;
+    _playedSamples = 0;
+    _baseMs = 0;
+    _sinkOpen = false;
+
+    _ring = (uint8_t *)stream_ring_alloc(CONFIG_AUDIO_STREAM_RING_SIZE);
+    _in = (uint8_t *)malloc(STREAM_DECODE_SIZE);
+    if (format == AUDIO_STREAM_MP3) {
+        _pcm = (int16_t *)malloc(STREAM_PCM_SAMPLES * sizeof(int16_t));
+        _decoder = MP3InitDecoder();
+    }
+    if (!_ring || !_in || (format == AUDIO_STREAM_MP3 && (!_pcm || !_decoder))) {
+        log_e("Could not allocate the stream buffers");
+        release();
+        return false;
+    }
+    if (!parseHeader(format) || !_source.seek(_source.ctx, _dataStart)) {
+        release();
+        return false;
+    }
+    _readPos = _dataStart;
+    _dataEnd = _dataSize ? _dataStart + _dataSize : 0xFFFFFFFF;
+    _playing = true;
+
+#ifdef ARDUINO
+    _decoderTask = xTaskGetCurrentTaskHandle();
+    _readerRunning = true;
+    if (xTaskCreate(readerTask, "app/read", 4 * 1024, this, uxTaskPriorityGet(NULL), (TaskHandle_t *)&_readerTask) != pdPASS) {
+        log_e("Could not create the reader task");
+        _readerRunning = false;
+        _playing = false;
+        release();
+        return false;
+    }
+#endif
+
+    uint32_t need = format == AUDIO_STREAM_MP3 ? MAINBUF_SIZE : STREAM_WAV_BLOCK;
+    bool starving = false;
+    bool ok = true;
+    while (ok) {
+        if (control && !control(control_ctx)) {
+            break;
+        }
+        size_t avail = refill();
+        // '_eof' is set after the last byte is queued, check it before the ring
+        bool end = __atomic_load_n(&_eof, __ATOMIC_ACQUIRE) &&
+                   __atomic_load_n(&_head, __ATOMIC_ACQUIRE) == _tail;
+        if (avail < need && !end) {
+            // Count each stall once, not each wait inside it
+            if (!starving && _sinkOpen) {
+                _stats.underruns++;
+            }
+            starving = true;
+            waitData();
+            continue;
+        }
+        starving = false;
+        if (avail == 0) {
+            break;
+        }
+        int ret = format == AUDIO_STREAM_MP3 ? decodeMP3(end) : decodeWAV();
+        ok = ret >= 0;
+    }
+
+    stopReader();
+    if (_sinkOpen && _sink.close) {
+        _sink.close(_sink.ctx);
+    }
+    _sinkOpen = false;
+    _playing = false;
+    release();
+    log_d("Stream done, underruns:%lu slices:%lu lock max:%luus frames:%lu errors:%lu",
+          (unsigned long)_stats.underruns, (unsigned long)_stats.slices, (unsigned long)_stats.lock_max_us,
+          (unsigned long)_stats.frames, (unsigned long)_stats.decode_errors);
+    return ok;
+}
+
+void AudioStreamPlayer::release()
+{
+    if (_decoder) {
+        MP3FreeDecoder((HMP3Decoder)_decoder);
+        _decoder = NULL;
+    }
+    free(_pcm);
+    free(_in);
+    free(_ring);
+    _pcm = NULL;
+    _in = NULL;
+    _ring = NULL;
+}
+
+void AudioStreamPlayer::seek(uint32_t ms)
+{
+    if (!_playing || !_byteRate) {
+        return;
+    }
+    uint64_t offset = (uint64_t)ms * _byteRate / 1000;
+    offset -= offset % _blockAlign;
+    if (_dataSize && offset > _dataSize) {
+        offset = _dataSize;
+    }
+    _seekMs = ms;
+    __atomic_store_n(&_seekReq, (uint32_t)(_dataStart + offset), __ATOMIC_RELEASE);
+    notifyReader();
+}
+
+uint32_t AudioStreamPlayer::position()
+{
+    if (!_playing || !_rate) {
+        return 0;
+    }
+    return _baseMs + (uint32_t)(_playedSamples * 1000 / _rate);
+}
+
+void AudioStreamPlayer::getStats(audio_stream_stats_t *stats)
+{
+    *stats = _stats;
+}
+
+// Reader side, the only writer of '_head'
+int AudioStreamPlayer::fill()
+{
+    uint32_t req = __atomic_exchange_n(&_seekReq, NO_SEEK, __ATOMIC_ACQ_REL);
+    if (req != NO_SEEK) {
+        if (_source.lock) {
+            _source.lock(_source.ctx);
+        }
+        bool ok = _source.seek(_source.ctx, req);
+        if (_source.unlock) {
+            _source.unlock(_source.ctx);
+        }
+        if (ok) {
+            _readPos = req;
+            __atomic_store_n(&_eof, false, __ATOMIC_RELEASE);
+        }
+        // Everything queued so far belongs to the old position
+        __atomic_store_n(&_discardTo, _head, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&_seekEpoch, 1, __ATOMIC_RELEASE);
+        _stats.seeks++;
+    }
+    if (_eof) {
+        return -1;
+    }
+
+    uint32_t head = _head;
+    uint32_t space = CONFIG_AUDIO_STREAM_RING_SIZE - (head - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE));
+    uint32_t len = CONFIG_AUDIO_STREAM_RING_SIZE - (head & STREAM_RING_MASK);
+    if (len > CONFIG_AUDIO_STREAM_READ_SLICE) {
+        len = CONFIG_AUDIO_STREAM_READ_SLICE;
+    }
+    // Wait for room for a whole slice, small reads cost as much bus time as large ones
+    if (space < len) {
+        return 0;
+    }
+    if (len > _dataEnd - _readPos) {
+        len = _dataEnd - _readPos;
+    }
+
+    size_t n = 0;
+    if (len) {
+        if (_source.lock) {
+            _source.lock(_source.ctx);
+        }
+        uint32_t start = stream_now_us();
+        n = _source.read(_source.ctx, _ring + (head & STREAM_RING_MASK), len);
+        uint32_t held = stream_now_us() - start;
+        if (_source.unlock) {
+            _source.unlock(_source.ctx);
+        }
+        _stats.slices++;
+        if (held > _stats.lock_max_us) {
+            _stats.lock_max_us = held;
+        }
+    }
+    if (n == 0) {
+        __atomic_store_n(&_eof, true, __ATOMIC_RELEASE);
+        return -1;
+    }
+    _readPos += n;
+    __atomic_store_n(&_head, head + (uint32_t)n, __ATOMIC_RELEASE);
+    return (int)n;
+}
+
+// Decoder side, the only writer of '_tail'
+size_t AudioStreamPlayer::refill()
+{
+    uint32_t epoch = __atomic_load_n(&_seekEpoch, __ATOMIC_ACQUIRE);
+    if (epoch != _decodeEpoch) {
+        _decodeEpoch = epoch;
+        uint32_t discard = __atomic_load_n(&_discardTo, __ATOMIC_RELAXED);
+        if ((int32_t)(discard - _tail) > 0) {
+            __atomic_store_n(&_tail, discard, __ATOMIC_RELEASE);
+            _inLen = 0;
+        } else if (_tail - discard < _inLen) {
+            // The seek landed between the epoch and the head load of the last call, only
+            // the last '_tail - discard' bytes of the input are from the new position
+            consume(_inLen - (_tail - discard));
+        }
+        _baseMs = _seekMs;
+        _playedSamples = 0;
+        if (_decoder) {
+            // Drop the bit reservoir of the old position
+            MP3FreeDecoder((HMP3Decoder)_decoder);
+            _decoder = MP3InitDecoder();
+        }
+    }
+
+#ifndef ARDUINO
+    // No reader task on the host, read ahead until the ring is full. Doing it between
+    // the epoch and the head load is the worst interleaving the reader task can cause
+    while (fill() > 0) {
+    }
+#endif
+    uint32_t tail = _tail;
+    uint32_t avail = __atomic_load_n(&_head, __ATOMIC_ACQUIRE) - tail;
+    uint32_t n = STREAM_DECODE_SIZE - _inLen;
+    if (n > avail) {
+        n = avail;
+    }
+    if (n) {
+        uint32_t offset = tail & STREAM_RING_MASK;
+        uint32_t first = CONFIG_AUDIO_STREAM_RING_SIZE - offset;
+        if (first > n) {
+            first = n;
+        }
+        memcpy(_in + _inLen, _ring + offset, first);
+        memcpy(_in + _inLen + first, _ring, n - first);
+        _inLen += n;
+        __atomic_store_n(&_tail, tail + n, __ATOMIC_RELEASE);
+        notifyReader();
+    }
+    return _inLen;
+}
+
+void AudioStreamPlayer::consume(size_t bytes)
+{
+    if (bytes >= _inLen) {
+        _inLen = 0;
+        return;
+    }
+    memmove(_in, _in + bytes, _inLen - bytes);
+    _inLen -= bytes;
+}
+
+void AudioStreamPlayer::notifyReader()
+{
+#ifdef ARDUINO
+    if (_readerTask) {
+        xTaskNotifyGive((TaskHandle_t)_readerTask);
+    }
+#endif
+}
+
+void AudioStreamPlayer::waitData()
+{
+#ifdef ARDUINO
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(20));
+#endif
+}
+
+void AudioStreamPlayer::readerTask(void *p)
+{
+#ifdef ARDUINO
+    AudioStreamPlayer *player = (AudioStreamPlayer *)p;
+    while (!player->_stop) {
+        int n = player->fill();
+        if (n != 0) {
+            xTaskNotifyGive((TaskHandle_t)player->_decoderTask);
+        }
+        if (n > 0) {
+            continue;
+        }
+        // Ring full or end of file, wait for the decoder to take data or for a seek
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+    }
+    player->_readerTask = NULL;
+    player->_readerRunning = false;
+    vTaskDelete(NULL);
+#else
+    (void)p;
+#endif
+}
+
+void AudioStreamPlayer::stopReader()
+{
+#ifdef ARDUINO
+    _stop = true;
+    while (_readerRunning) {
+        notifyReader();
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+#endif
+}
+
+bool AudioStreamPlayer::writeBlock(const uint8_t *pcm, size_t bytes, uint32_t rate, uint8_t bits, uint8_t channels)
+{
+    if (!_sinkOpen || rate != _rate || bits != _bits || channels != _channels) {
+        if (_sinkOpen && _sink.close) {
+            _sink.close(_sink.ctx);
+        }
+        _rate = rate;
+        _bits = bits;
+        _channels = channels;
+        _sinkOpen = _sink.open(_sink.ctx, rate, bits, channels);
+        if (!_sinkOpen) {
+            log_e("Sink open failed, rate:%u bits:%u ch:%u", (unsigned)rate, bits, channels);
+            return false;
+        }
+    }
+    if (!_sink.write(_sink.ctx, pcm, bytes)) {
+        return false;
+    }
+    _playedSamples += bytes / ((bits / 8) * channels);
+    _stats.frames++;
+    return true;
+}
+
+int AudioStreamPlayer::decodeMP3(bool end)
+{
+    int offset = MP3FindSyncWord(_in, _inLen);
+    if (offset < 0) {
+        // Keep the last byte, it may be the start of a sync word
+        size_t skip = end || _inLen < 2 ? _inLen : _inLen - 1;
+        _stats.decode_errors += skip;
+        consume(skip);
+        return 0;
+    }
+    consume(offset);
+
+    uint8_t *ptr = _in;
+    int left = (int)_inLen;
+    int err = MP3Decode((HMP3Decoder)_decoder, &ptr, &left, _pcm, 0);
+    consume(_inLen - left);
+    if (err == ERR_MP3_MAINDATA_UNDERFLOW) {
+        // The bit reservoir is not filled yet after the start or a seek
+        return 0;
+    }
+    if (err == ERR_MP3_INDATA_UNDERFLOW && !end && _inLen < MAINBUF_SIZE) {
+        return 0;
+    }
+    if (err) {
+        // Skip the false sync word or the damaged frame
+        _stats.decode_errors++;
+        consume(1);
+        return 0;
+    }
+    MP3FrameInfo info;
+    MP3GetLastFrameInfo((HMP3Decoder)_decoder, &info);
+    _byteRate = info.bitrate / 8;
+    size_t bytes = (info.bitsPerSample / 8) * info.outputSamps;
+    return writeBlock((const uint8_t *)_pcm, bytes, info.samprate, info.bitsPerSample, info.nChans) ? 1 : -1;
+}
+
+int AudioStreamPlayer::decodeWAV()
+{
+    size_t bytes = _inLen < STREAM_WAV_BLOCK ? _inLen : STREAM_WAV_BLOCK;
+    bytes -= bytes % _blockAlign;
+    if (bytes == 0) {
+        // Less than one sample frame left at the end
+        consume(_inLen);
+        return 0;
+    }
+    // memmove() in consume() keeps the data aligned for 16 bit samples
+    bool ok = writeBlock(_in, bytes, _rate, _bits, _channels);
+    consume(bytes);
+    return ok ? 1 : -1;
+}
+
+#ifdef AUDIO_STREAM_HOST
+
+struct stream_wav_writer {
+    FILE *fp;
+    uint32_t bytes;
+    uint32_t rate;
+    uint8_t bits;
+    uint8_t channels;
+};
+
+static size_t stream_host_read(void *ctx, uint8_t *dst, size_t len)
+{
+    return fread(dst, 1, len, (FILE *)ctx);
+}
+
+static bool stream_host_seek(void *ctx, uint32_t pos)
+{
+    return fseek((FILE *)ctx, pos, SEEK_SET) == 0;
+}
+
+static void stream_wav_header(stream_wav_writer *w)
+{
+    uint8_t h[44];
+    uint16_t align = w->channels * (w->bits / 8);
+    memcpy(h, "RIFF", 4);
+    uint32_t v = 36 + w->bytes;
+    memcpy(h + 4, &v, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    v = 16;
+    memcpy(h + 16, &v, 4);
+    uint16_t s = 1;
+    memcpy(h + 20, &s, 2);
+    s = w->channels;
+    memcpy(h + 22, &s, 2);
+    memcpy(h + 24, &w->rate, 4);
+    v = w->rate * align;
+    memcpy(h + 28, &v, 4);
+    memcpy(h + 32, &align, 2);
+    s = w->bits;
+    memcpy(h + 34, &s, 2);
+    memcpy(h + 36, "data", 4);
+    memcpy(h + 40, &w->bytes, 4);
+    fseek(w->fp, 0, SEEK_SET);
+    fwrite(h, 1, sizeof(h), w->fp);
+    fseek(w->fp, 0, SEEK_END);
+}
+
+static bool stream_wav_open(void *ctx, uint32_t rate, uint8_t bits, uint8_t channels)
+{
+    stream_wav_writer *w = (stream_wav_writer *)ctx;
+    // A WAV file has one format, the first one is kept
+    if (w->rate == 0) {
+        w->rate = rate;
+        w->bits = bits;
+        w->channels = channels;
+        stream_wav_header(w);
+    }
+    return true;
+}
+
+static bool stream_wav_write(void *ctx, const uint8_t *pcm, size_t bytes)
+{
+    stream_wav_writer *w = (stream_wav_writer *)ctx;
+    w->bytes += bytes;
+    return fwrite(pcm, 1, bytes, w->fp) == bytes;
+}
+
+bool audio_stream_decode_file(const char *in_path, const char *wav_path, audio_stream_stats_t *stats)
+{
+    size_t len = strlen(in_path);
+    audio_stream_format_t format = len > 4 && strcmp(in_path + len - 4, ".wav") == 0 ? AUDIO_STREAM_WAV : AUDIO_STREAM_MP3;
+    FILE *in = fopen(in_path, "rb");
+    if (!in) {
+        return false;
+    }
+    stream_wav_writer w = {};
+    w.fp = fopen(wav_path, "wb");
+    if (!w.fp) {
+        fclose(in);
+        return false;
+    }
+    audio_stream_source_t source = {stream_host_read, stream_host_seek, NULL, NULL, in};
+    audio_stream_sink_t sink = {stream_wav_open, stream_wav_write, NULL, &w};
+    AudioStreamPlayer player;
+    bool ok = player.play(source, sink, format);
+    if (w.rate) {
+        // Sizes are known now
+        stream_wav_header(&w);
+    }
+    if (stats) {
+        player.getStats(stats);
+    }
+    fclose(w.fp);
+    fclose(in);
+    return ok;
+}
+
+#endif /*AUDIO_STREAM_HOST*/
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ * @file      audio_stream.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-22
+ * @note      Streaming MP3/WAV player. A reader task keeps a small ring buffer filled
+ *            from the file in bounded slices, so the shared SPI bus is only held for one
+ *            slice at a time, and the calling task decodes from the ring into a sink.
+ *            Define AUDIO_STREAM_HOST and add libhelix-mp3 to build it on a PC, then
+ *            audio_stream_decode_file() runs the same pipeline from a file to a WAV file.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(ARDUINO) || defined(AUDIO_STREAM_HOST)
+
+// Compressed data buffered ahead of the decoder, must be a power of two
+#ifndef CONFIG_AUDIO_STREAM_RING_SIZE
+#define CONFIG_AUDIO_STREAM_RING_SIZE   (32 * 1024)
+#endif
+
+// Largest read done while holding the source lock
+#ifndef CONFIG_AUDIO_STREAM_READ_SLICE
+#define CONFIG_AUDIO_STREAM_READ_SLICE  (4 * 1024)
+#endif
+
+typedef enum {
+    AUDIO_STREAM_MP3,
+    AUDIO_STREAM_WAV,
+} audio_stream_format_t;
+
+typedef struct {
+    uint32_t underruns;         // Decoder found the ring empty before the end of the file
+    uint32_t slices;            // Reads from the source
+    uint32_t lock_max_us;       // Longest single hold of the source lock
+    uint32_t frames;            // Blocks written to the sink
+    uint32_t decode_errors;     // Bytes skipped to resynchronize
+    uint32_t seeks;
+} audio_stream_stats_t;
+
+typedef struct {
+    size_t (*read)(void *ctx, uint8_t *dst, size_t len);    // Returns 0 at the end
+    bool (*seek)(void *ctx, uint32_t pos);
+    void (*lock)(void *ctx);                                // Can be NULL, e.g. for FFat
+    void (*unlock)(void *ctx);
+    void *ctx;
+} audio_stream_source_t;
+
+typedef struct {
+    // Called before the first block and again when the format changes
+    bool (*open)(void *ctx, uint32_t sample_rate, uint8_t bits, uint8_t channels);
+    // Must block until the block is queued, this is what paces the pipeline
+    bool (*write)(void *ctx, const uint8_t *pcm, size_t bytes);
+    void (*close)(void *ctx);
+    void *ctx;
+} audio_stream_sink_t;
+
+// Called between blocks, may block while paused, returns false to stop
+typedef bool (*audio_stream_control_cb_t)(void *ctx);
+
+class AudioStreamPlayer
+{
+public:
+    /**
+     * @brief Play until the end of the source or until 'control' returns false.
+     *        Runs in the calling task, the source is read by a separate task.
+     */
+    bool play(const audio_stream_source_t &source, const audio_stream_sink_t &sink,
+              audio_stream_format_t format, audio_stream_control_cb_t control = NULL, void *control_ctx = NULL);
+
+    /**
+     * @brief Move the playback position, safe to call from another task while playing.
+     *        MP3 positions are estimated from the bitrate of the last frame.
+     */
+    void seek(uint32_t ms);
+
+    /**
+     * @brief Current playback position, 0 when not playing.
+     */
+    uint32_t position();
+
+    void getStats(audio_stream_stats_t *stats);
+
+private:
+    bool parseHeader(audio_stream_format_t format);
+    int fill();
+    size_t refill();
+    void consume(size_t bytes);
+    void waitData();
+    void notifyReader();
+    bool writeBlock(const uint8_t *pcm, size_t bytes, uint32_t rate, uint8_t bits, uint8_t channels);
+    int decodeMP3(bool end);
+    int decodeWAV();
+    void release();
+    void stopReader();
+    static void readerTask(void *p);
+
+    audio_stream_source_t _source;
+    audio_stream_sink_t _sink;
+
+    // Single producer (fill) single consumer (refill) ring
+    uint8_t *_ring = NULL;
+    uint32_t _head = 0;
+    uint32_t _tail = 0;
+    volatile bool _eof = false;
+
+    // seek() posts a file position, the reader moves the file and marks the queued
+    // bytes up to '_discardTo' as stale by bumping '_seekEpoch'
+    static const uint32_t NO_SEEK = 0xFFFFFFFF;
+    uint32_t _seekReq = NO_SEEK;
+    uint32_t _discardTo = 0;
+    uint32_t _seekEpoch = 0;
+    uint32_t _decodeEpoch = 0;
+    uint32_t _seekMs = 0;
+
+    // Input of the decoder
+    uint8_t *_in = NULL;
+    size_t _inLen = 0;
+    int16_t *_pcm = NULL;
+    void *_decoder = NULL;
+
+    // Stream format
+    uint32_t _dataStart = 0;
+    uint32_t _dataSize = 0;     // 0 if unknown
+    uint32_t _dataEnd = 0;      // File position the reader stops at
+    uint32_t _readPos = 0;
+    uint32_t _rate = 0;
+    uint8_t _bits = 0;
+    uint8_t _channels = 0;
+    uint32_t _byteRate = 0;     // Compressed bytes per second, estimated for MP3
+    uint16_t _blockAlign = 1;
+    uint64_t _playedSamples = 0;
+    uint32_t _baseMs = 0;       // Position of the last seek
+    bool _sinkOpen = false;
+
+    volatile bool _playing = false;
+    volatile bool _stop = false;
+    volatile bool _readerRunning = false;
+    void *_readerTask = NULL;
+    void *_decoderTask = NULL;
+
+    audio_stream_stats_t _stats = {};
+};
+
+#ifdef AUDIO_STREAM_HOST
+/**
+ * @brief Decode 'in_path' into a 16 bit WAV file with the same pipeline as the device.
+ */
+bool audio_stream_decode_file(const char *in_path, const char *wav_path, audio_stream_stats_t *stats);
+#endif
+
+#endif
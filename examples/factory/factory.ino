@@ -107,7 +107,10 @@ void loop()
     instanceLockTake();
     instance.loop();
 #if defined(USING_ST25R3916)
+    // The reader shares the bus with the display and the SD card
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_NFC);
     loopNFCReader();
+    instance.unlockSPI();
 #endif
     lv_timer_handler();
     instanceLockGive();
@@ -39,13 +39,22 @@ typedef struct _device_const_var {
 #include "audio/keyboard_audio.h"
 #include "driver/rtc_io.h"
 #include "app_nfc.h"
+#include "audio_stream.h"
+#include <bsp_codec/esp_audio_mixer.h>
+#ifdef USING_AUDIO_CODEC
+#include <bsp_codec/esp_audio_engine.h>
+#endif
 #include <FFat.h>
 
 static Preferences           prefs;
+static AudioStreamPlayer     streamPlayer;
 static TaskHandle_t          recTaskHandle;
 static TaskHandle_t          playerTaskHandler = NULL;
 static QueueHandle_t         playerQueue  = NULL;
 static EventGroupHandle_t    playerEvent = NULL;
+static EspAudioMixer         mixer;
+static TaskHandle_t          mixerTaskHandler = NULL;
+static SemaphoreHandle_t     mixerLock = NULL;
 static bool                  pps_trigger = false;
 
 #define PLAYER_PLAY                 _BV(0)
@@ -176,161 +185,297 @@ size_t getArduinoLoopTaskStackSize(void)
 
 #include <mp3dec.h>
 
-static bool playMP3(uint8_t *src, size_t src_len)
+// Output format of the mixer, music and UI sounds are converted to it
+#define MIX_SAMPLE_RATE             44100
+#define MIX_PERIOD_FRAMES           256
+// About one second of silence before the output is powered down
+#define MIX_IDLE_PERIODS            170
+// Decoded samples below this level are trimmed from the end of a clip
+#define CLIP_SILENCE_LEVEL          64
+#define KEY_CLICK_GAIN              1.0f
+
+static EspAudioClip_t        keyClip;
+static volatile bool         keyClipReady = false;
+static int                   keyVoice = -1;
+static int                   musicVoice = -1;
+static uint8_t               musicChannels = 0;
+static bool                  mixOutputOpen = false;
+static bool                  mixerOnEngine = false;
+
+// Decodes a short MP3 once, the clip then plays from memory on every key press
+static bool decode_clip(const uint8_t *src, size_t src_len, EspAudioClip_t *clip)
 {
     int16_t outBuf[MAX_NCHAN * MAX_NGRAN * MAX_NSAMP];
-    uint8_t *readPtr = NULL;
-    int bytesAvailable = 0, err = 0, offset = 0;
+    uint8_t *readPtr = (uint8_t *)src;
+    int bytesAvailable = src_len;
     MP3FrameInfo frameInfo;
-    HMP3Decoder decoder = NULL;
-    bool codec_begin = false;
-
-    bytesAvailable = src_len;
-    readPtr = src;
+    int16_t *pcm = NULL;
+    size_t samples = 0;
+    uint32_t sample_rate = 0;
+    uint8_t channels = 0;
 
-    decoder = MP3InitDecoder();
+    HMP3Decoder decoder = MP3InitDecoder();
     if (decoder == NULL) {
         log_e("Could not allocate decoder");
         return false;
     }
-    xEventGroupSetBits(playerEvent, PLAYER_RUNNING);
-    do {
-        offset = MP3FindSyncWord(readPtr, bytesAvailable);
+    while (true) {
+        int offset = MP3FindSyncWord(readPtr, bytesAvailable);
         if (offset < 0) {
             break;
         }
         readPtr += offset;
         bytesAvailable -= offset;
-        err = MP3Decode(decoder, &readPtr, &bytesAvailable, outBuf, 0);
+        int err = MP3Decode(decoder, &readPtr, &bytesAvailable, outBuf, 0);
         if (err) {
             log_e("Decode ERROR: %d", err);
-            MP3FreeDecoder(decoder);
-            xEventGroupClearBits(playerEvent, PLAYER_RUNNING);
-            return false;
-        } else {
-            MP3GetLastFrameInfo(decoder, &frameInfo);
-#if  defined(USING_PCM_AMPLIFIER)
+            break;
+        }
+        MP3GetLastFrameInfo(decoder, &frameInfo);
+        if (frameInfo.bitsPerSample != 16 || (channels && frameInfo.nChans != channels)) {
+            break;
+        }
+        sample_rate = frameInfo.samprate;
+        channels = frameInfo.nChans;
+        int16_t *grown = (int16_t *)ps_realloc(pcm, (samples + frameInfo.outputSamps) * sizeof(int16_t));
+        if (!grown) {
+            log_e("Could not allocate the clip");
+            break;
+        }
+        pcm = grown;
+        memcpy(pcm + samples, outBuf, frameInfo.outputSamps * sizeof(int16_t));
+        samples += frameInfo.outputSamps;
+    }
+    MP3FreeDecoder(decoder);
 
-            if (!codec_begin) {
-                codec_begin = true;
-                instance.powerControl(POWER_SPEAK, true);
-                log_d("Start PCM Play...");
+    // The quiet tail is not heard, it would only keep a voice busy
+    while (samples && abs(pcm[samples - 1]) < CLIP_SILENCE_LEVEL) {
+        samples--;
+    }
+    if (channels) {
+        samples -= samples % channels;
+    }
+    if (!samples) {
+        free(pcm);
+        return false;
+    }
+    clip->pcm = pcm;
+    clip->frames = samples / channels;
+    clip->sample_rate = sample_rate;
+    clip->channels = channels;
+    return true;
+}
+
+static bool mixer_output_open()
+{
+#if  defined(USING_PCM_AMPLIFIER)
+    instance.powerControl(POWER_SPEAK, true);
 #if  ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5,0,0)
-                printf("sample rate:%d bitPs:%d ch:%d\n", frameInfo.samprate, frameInfo.bitsPerSample, (i2s_channel_t)frameInfo.nChans);
-                instance.player.configureTX(frameInfo.samprate, frameInfo.bitsPerSample, (i2s_channel_t)frameInfo.nChans);
+    instance.player.configureTX(MIX_SAMPLE_RATE, 16, (i2s_channel_t)mixer.getChannels());
 #else
-                instance.player.configureTX(frameInfo.samprate, (i2s_data_bit_width_t)frameInfo.bitsPerSample, (i2s_slot_mode_t)frameInfo.nChans);
+    instance.player.configureTX(MIX_SAMPLE_RATE, (i2s_data_bit_width_t)16, (i2s_slot_mode_t)mixer.getChannels());
 #endif
-            }
+    return true;
+#elif defined(USING_AUDIO_CODEC)
+    int ret = instance.codec.open(16, mixer.getChannels(), MIX_SAMPLE_RATE);
+    if (ret != 0) {
+        Serial.printf("esp_codec_dev_open:0x%X\n", ret);
+    }
+    return ret == 0;
+#else
+    return false;
+#endif
+}
 
-            instance.player.write((uint8_t *)outBuf, (size_t)((frameInfo.bitsPerSample / 8) * frameInfo.outputSamps));
+static void mixer_output_write(int16_t *pcm, size_t bytes)
+{
+#if  defined(USING_PCM_AMPLIFIER)
+    instance.player.write((uint8_t *)pcm, bytes);
+#elif defined(USING_AUDIO_CODEC)
+    int ret = instance.codec.write((uint8_t *)pcm, bytes);
+    if (ret != 0) {
+        Serial.printf("esp_codec_dev_write:0x%X\n", ret);
+    }
+#endif
+}
 
+static void mixer_output_close()
+{
+#if  defined(USING_PCM_AMPLIFIER)
+    instance.powerControl(POWER_SPEAK, false);
 #elif defined(USING_AUDIO_CODEC)
-            if (!codec_begin) {
-                codec_begin = true;
-                // Serial.printf("Set sample rate:%d bitsPerSample:%d\n", frameInfo.samprate, frameInfo.bitsPerSample);
-                int ret = instance.codec.open(frameInfo.bitsPerSample, frameInfo.nChans, frameInfo.samprate);
-                // Serial.printf("esp_codec_dev_open:0x%X\n", ret);
+    instance.codec.close();
+#endif
+}
+
+// The only writer of the speaker, music and UI sounds are voices of the mixer
+static void mixerTask(void *args)
+{
+    static int16_t buffer[MIX_PERIOD_FRAMES * 2];
+    uint32_t idle = 0;
+
+    if (decode_clip(keyboard_audio, keyboard_audio_mp3_len, &keyClip)) {
+        keyClipReady = true;
+    } else {
+        log_e("Key click decode failed");
+    }
+
+    while (1) {
+        if (!mixOutputOpen) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        xSemaphoreTake(mixerLock, portMAX_DELAY);
+        // While the microphone runs the audio engine pulls the mixer, see hw_set_mic_start()
+        if (!mixerOnEngine) {
+            size_t n = mixer.mix(buffer, MIX_PERIOD_FRAMES);
+            if (n) {
+                idle = 0;
+                if (!mixOutputOpen) {
+                    mixOutputOpen = mixer_output_open();
+                }
+            } else if (mixOutputOpen && ++idle > MIX_IDLE_PERIODS) {
+                mixer_output_close();
+                mixOutputOpen = false;
             }
-            int ret = instance.codec.write((uint8_t *)outBuf, (size_t)((frameInfo.bitsPerSample / 8) * frameInfo.outputSamps));
-            if (ret != 0) {
-                Serial.printf("esp_codec_dev_write:0x%X\n", ret);
+            if (mixOutputOpen) {
+                size_t bytes = MIX_PERIOD_FRAMES * mixer.getChannels() * sizeof(int16_t);
+                if (!n) {
+                    memset(buffer, 0, bytes);
+                }
+                // Blocks for about one period, this paces the mixer
+                mixer_output_write(buffer, bytes);
             }
-#endif
         }
+        xSemaphoreGive(mixerLock);
+    }
+}
 
-WAIT:
-        EventBits_t eventBits =  xEventGroupWaitBits(playerEvent, PLAYER_PLAY | PLAYER_END
-                                 , pdFALSE, pdFALSE, portMAX_DELAY);
+static void play_key_click()
+{
+    if (!keyClipReady) {
+        return;
+    }
+    // A new press restarts the click, music keeps playing
+    mixer.stop(keyVoice);
+    keyVoice = mixer.play(&keyClip, KEY_CLICK_GAIN);
+    xTaskNotifyGive(mixerTaskHandler);
+}
 
-        if (eventBits & PLAYER_END) {
-            // printf("TASK END\n");
-            break;
-        }
+static size_t stream_file_read(void *ctx, uint8_t *dst, size_t len)
+{
+    return ((File *)ctx)->read(dst, len);
+}
 
-    } while (true);
+static bool stream_file_seek(void *ctx, uint32_t pos)
+{
+    return ((File *)ctx)->seek(pos);
+}
 
-    MP3FreeDecoder(decoder);
-    xEventGroupClearBits(playerEvent, PLAYER_RUNNING | PLAYER_PLAY | PLAYER_END);
+// T-Watch-S3-Ultra or T-LoRa-Pager is SPI bus-shared, the bus is held for one read slice at a time
+static void stream_spi_lock(void *ctx)
+{
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_SD);
+}
 
-#if  defined(USING_PCM_AMPLIFIER)
-    instance.powerControl(POWER_SPEAK, false);
-#elif defined(USING_AUDIO_CODEC)
-    instance.codec.close();
-#endif
-    return true;
+static void stream_spi_unlock(void *ctx)
+{
+    instance.unlockSPI();
+}
+
+static bool stream_sink_open(void *ctx, uint32_t sample_rate, uint8_t bits, uint8_t channels)
+{
+    printf("sample rate:%lu bitPs:%u ch:%u\n", (unsigned long)sample_rate, bits, channels);
+    if (bits != 16) {
+        return false;
+    }
+    musicVoice = mixer.openStream(sample_rate, channels);
+    musicChannels = channels;
+    xTaskNotifyGive(mixerTaskHandler);
+    return musicVoice >= 0;
+}
+
+static bool stream_sink_write(void *ctx, const uint8_t *pcm, size_t bytes)
+{
+    size_t frames = bytes / (musicChannels * sizeof(int16_t));
+    // Waits while the stream buffer of the voice is full
+    return mixer.writeStream(musicVoice, (const int16_t *)pcm, frames, 1000) == frames;
+}
+
+static void stream_sink_close(void *ctx)
+{
+    // What is queued still plays, the voice then ends by itself
+    mixer.closeStream(musicVoice);
+    musicVoice = -1;
+}
+
+// Pause and stop are handled between blocks
+static bool stream_control(void *ctx)
+{
+    EventBits_t eventBits =  xEventGroupWaitBits(playerEvent, PLAYER_PLAY | PLAYER_END
+                             , pdFALSE, pdFALSE, portMAX_DELAY);
+    return (eventBits & PLAYER_END) == 0;
 }
 
 static void hw_sd_play(audio_source_type_t source, const char *filename)
 {
-    bool isMP3 = String(filename).endsWith(".mp3");
-    bool lock = false;
+    String name = String(filename);
+    name.toLowerCase();
+    audio_stream_format_t format;
+    if (name.endsWith(".mp3")) {
+        format = AUDIO_STREAM_MP3;
+    } else if (name.endsWith(".wav")) {
+        format = AUDIO_STREAM_WAV;
+    } else {
+        Serial.printf("Unsupported file %s\n", filename);
+        return;
+    }
 
+    bool lock = source == AUDIO_SOURCE_SDCARD;
     String str = "/" + String(filename);
     File f;
 
-    // Serial.printf("Playing file: %s source:%d\n", str.c_str(), source);
-    if (source == AUDIO_SOURCE_SDCARD) {
+    if (lock) {
         Serial.printf("Open from SD: %s\n", str.c_str());
-        // T-Watch-S3-Ultra or T-LoRa-Pager is SPI bus-shared, lock the SPI bus before use
-        instance.lockSPI();
+        instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_SD);
         f = SD.open(str);
-        if (f) {
-            lock = true;
-        } else {
-            Serial.printf("SD Open %s failed!\n", filename);
-            // T-Watch-S3-Ultra or T-LoRa-Pager is SPI bus-shared and releases the bus after use.
-            instance.unlockSPI();
-            return;
-        }
+        instance.unlockSPI();
     } else {
         Serial.printf("Open from FFat: %s\n", str.c_str());
         f = FFat.open(str);
-        if (!f) {
-            Serial.printf("FFat Open %s failed!\n", filename);
-            return;
-        }
     }
-
-    size_t file_size = f.size();
-    if (file_size == 0) {
-        Serial.printf("File %s size is 0!\n", filename);
-        f.close();
-        if (lock) {
-            // T-Watch-S3-Ultra or T-LoRa-Pager is SPI bus-shared and releases the bus after use.
-            instance.unlockSPI();
-        }
-        return ;
-    }
-    uint8_t *buf  = (uint8_t *)ps_malloc(file_size);
-    if (!buf) {
-        Serial.println("ps malloc failed!");
-        f.close();
-        if (lock) {
-            // T-Watch-S3-Ultra or T-LoRa-Pager is SPI bus-shared and releases the bus after use.
-            instance.unlockSPI();
-        }
-        return ;
+    if (!f) {
+        Serial.printf("Open %s failed!\n", filename);
+        return;
     }
+    if (f.size() == 0) {
+        Serial.printf("File %s size is 0!\n", filename);
+    } else {
+        audio_stream_source_t src = {
+            stream_file_read, stream_file_seek,
+            lock ? stream_spi_lock : NULL, lock ? stream_spi_unlock : NULL, &f
+        };
+        audio_stream_sink_t sink = {stream_sink_open, stream_sink_write, stream_sink_close, NULL};
 
-    size_t read_size =  f.readBytes((char *)buf, file_size);
-    f.close();
+        Serial.print("Playing ");
+        Serial.println(filename);
+        xEventGroupSetBits(playerEvent, PLAYER_RUNNING);
+        streamPlayer.play(src, sink, format, stream_control, NULL);
+        xEventGroupClearBits(playerEvent, PLAYER_RUNNING | PLAYER_PLAY | PLAYER_END);
+
+        audio_stream_stats_t stats;
+        streamPlayer.getStats(&stats);
+        Serial.printf("Play done, underruns:%lu reads:%lu lock max:%luus errors:%lu\n",
+                      (unsigned long)stats.underruns, (unsigned long)stats.slices,
+                      (unsigned long)stats.lock_max_us, (unsigned long)stats.decode_errors);
+    }
 
-    // SPI bus-shared and releases the bus after use.
     if (lock) {
-        instance.unlockSPI();  //Release lock
+        instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_SD);
     }
-
-    if (read_size == file_size) {
-        Serial.print("Playing ");
-        Serial.println(filename);
-        if (isMP3) {
-            playMP3(buf, read_size);
-        } else {
-        }
-        Serial.println("Play done..");
+    f.close();
+    if (lock) {
+        instance.unlockSPI();
     }
-    free(buf);
 }
 
 static void playerTask(void *args)
@@ -346,8 +491,7 @@ static void playerTask(void *args)
             hw_sd_play(params.source_type, params.filename);
             break;
         case APP_EVENT_PLAY_KEY:
-            // Serial.println("APP_EVENT_PLAY_KEY");
-            playMP3((uint8_t * )keyboard_audio, keyboard_audio_mp3_len);
+            play_key_click();
             break;
         case APP_EVENT_RECOVER:
             break;
@@ -370,6 +514,38 @@ static int16_t left_channel[FFT_SIZE];
 static int16_t right_channel[FFT_SIZE];
 static int read_count = 0;
 
+#ifdef USING_AUDIO_CODEC
+// Capture and playback run in one audio task, the spectrum is one of its subscribers
+#define MIC_PERIOD_FRAMES   256
+
+static EspAudioEngine audioEngine;
+static int16_t fft_window[FFT_SIZE * 2];
+static int16_t fft_capture[FFT_SIZE * 2];
+static size_t fft_fill = 0;
+static volatile bool fft_ready = false;
+static portMUX_TYPE fft_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void fft_capture_cb(const int16_t *frames, size_t count, void *user_data)
+{
+    size_t samples = count * instance.getCodecInputChannels();
+    while (samples) {
+        size_t n = min(samples, (size_t)(FFT_SIZE * 2) - fft_fill);
+        memcpy(fft_capture + fft_fill, frames, n * sizeof(int16_t));
+        fft_fill += n;
+        frames += n;
+        samples -= n;
+        if (fft_fill == FFT_SIZE * 2) {
+            // Publish the window, one the UI has not taken yet is replaced
+            portENTER_CRITICAL(&fft_lock);
+            memcpy(fft_window, fft_capture, sizeof(fft_window));
+            fft_ready = true;
+            portEXIT_CRITICAL(&fft_lock);
+            fft_fill = 0;
+        }
+    }
+}
+#endif /*USING_AUDIO_CODEC*/
+
 static void process_channel_fft(int16_t *channel_data, float *bands, float freq_per_bin)
 {
     for (int i = 0; i < FFT_SIZE; i++) {
@@ -421,7 +597,7 @@ static void process_channel_fft(int16_t *channel_data, float *bands, float freq_
 #endif /*ARDUINO*/
 
 
-void hw_audio_get_fft_data(FFTData *fft_data)
+bool hw_audio_get_fft_data(FFTData *fft_data)
 {
 #ifdef ARDUINO
     float freq_per_bin = (float)SAMPLE_RATE / FFT_SIZE;
@@ -430,7 +606,18 @@ void hw_audio_get_fft_data(FFTData *fft_data)
     int32_t pdm_sample;
     instance.mic.readBytes((char *)i2s_buffer, FFT_SIZE * 2 * sizeof(int16_t));
 #elif defined(USING_AUDIO_CODEC)
-    instance.codec.read((uint8_t *)i2s_buffer, FFT_SIZE * 2 * sizeof(int16_t));
+    // The audio task fills the window, only a new one is processed
+    bool ready;
+    portENTER_CRITICAL(&fft_lock);
+    ready = fft_ready;
+    if (ready) {
+        memcpy(i2s_buffer, fft_window, sizeof(i2s_buffer));
+        fft_ready = false;
+    }
+    portEXIT_CRITICAL(&fft_lock);
+    if (!ready) {
+        return false;
+    }
 #endif
 
     read_count++;
@@ -445,6 +632,9 @@ void hw_audio_get_fft_data(FFTData *fft_data)
 
     process_channel_fft(left_channel, fft_data->left_bands, freq_per_bin);
     process_channel_fft(right_channel, fft_data->right_bands, freq_per_bin);
+    return true;
+#else
+    return false;
 #endif /*ARDUINO*/
 }
 
@@ -454,9 +644,36 @@ bool hw_set_mic_start()
     int ret ;
 
 #ifdef USING_AUDIO_CODEC
-    ret = instance.codec.open(16, instance.getCodecInputChannels(), 16000);
-    if (ret < 0) {
-        log_e("Audio codec open failed:0x%X", ret);
+    EspAudioEngineConfig_t config = {
+        .sample_rate = 16000,
+        .channels = instance.getCodecInputChannels(),
+        .period_frames = MIC_PERIOD_FRAMES,
+        .priority = 15
+    };
+    fft_fill = 0;
+    fft_ready = false;
+    audioEngine.subscribe(fft_capture_cb, NULL);
+
+    // The codec runs full duplex at the microphone rate, the engine takes over the mixer output
+    xSemaphoreTake(mixerLock, portMAX_DELAY);
+    if (mixOutputOpen) {
+        mixer_output_close();
+        mixOutputOpen = false;
+    }
+    mixerOnEngine = true;
+    mixer.setFormat(config.sample_rate, config.channels);
+    audioEngine.setPlaybackSource(EspAudioMixer::source, &mixer);
+    bool started = audioEngine.begin(instance.codec, config);
+    if (!started) {
+        audioEngine.setPlaybackSource(NULL, NULL);
+        mixer.setFormat(MIX_SAMPLE_RATE, 2);
+        mixerOnEngine = false;
+    }
+    xSemaphoreGive(mixerLock);
+    if (!started) {
+        log_e("Audio engine start failed");
+        audioEngine.unsubscribe(fft_capture_cb, NULL);
+        xTaskNotifyGive(mixerTaskHandler);
         return false;
     }
 #endif /*USING_AUDIO_CODEC*/
@@ -478,7 +695,15 @@ void hw_set_mic_stop()
 {
 #ifdef ARDUINO
 #ifdef USING_AUDIO_CODEC
-    instance.codec.close();
+    xSemaphoreTake(mixerLock, portMAX_DELAY);
+    audioEngine.end();
+    audioEngine.setPlaybackSource(NULL, NULL);
+    mixer.setFormat(MIX_SAMPLE_RATE, 2);
+    mixerOnEngine = false;
+    xSemaphoreGive(mixerLock);
+    audioEngine.unsubscribe(fft_capture_cb, NULL);
+    // Playing voices continue on the mixer output
+    xTaskNotifyGive(mixerTaskHandler);
 #endif
     dsps_fft2r_deinit_fc32();
 #endif /*ARDUINO*/
@@ -585,6 +810,8 @@ void hw_init()
 #ifdef ARDUINO
     playerQueue =  xQueueCreate(2, sizeof(audio_params_t));
     playerEvent =  xEventGroupCreate();
+    mixerLock = xSemaphoreCreateMutex();
+    mixer.begin(MIX_SAMPLE_RATE, 2);
 
     hw_radio_begin();
 
@@ -609,19 +836,8 @@ void hw_init()
 
             instance.vibrator();
 
-            audio_params_t params = {
-                .event = APP_EVENT_PLAY_KEY,
-                .filename = NULL
-            };
-            xEventGroupClearBits(playerEvent, PLAYER_PLAY | PLAYER_END);
-            if (hw_player_running()) {
-                xEventGroupSetBits(playerEvent, PLAYER_END);
-                while (hw_player_running()) {
-                    delay(2);
-                }
-            }
-            xEventGroupSetBits(playerEvent, PLAYER_PLAY);
-            xQueueSend(playerQueue, &params, portMAX_DELAY);
+            // Mixed over the music instead of going through the player queue
+            play_key_click();
 
         } else {
 
@@ -633,6 +849,7 @@ void hw_init()
 
 
     xTaskCreate(playerTask, "app/play", 8 * 1024, NULL, 12, &playerTaskHandler);
+    xTaskCreate(mixerTask, "app/mix", 8 * 1024, NULL, 13, &mixerTaskHandler);
 
     prefs.begin(NVS_NAME);
     if (prefs.getBytes(NVS_NAME, &user_setting, sizeof(user_setting_params_t)) != sizeof(user_setting_params_t)) {  // simple check that data fits
@@ -1157,7 +1374,7 @@ void hw_fat_list(vector < AudioParams_t > &list, const char *dirname, uint8_t le
 bool hw_sd_list(vector < AudioParams_t > &list, const char *dirname, uint8_t levels)
 {
 #if defined(ARDUINO) && defined(HAS_SD_CARD_SOCKET)
-    instance.lockSPI();
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_SD);
     if (instance.installSD()) {
         Serial.println("SD Card mount success.");
     } else {
@@ -1252,6 +1469,22 @@ void hw_set_sd_music_resume()
 #endif
 }
 
+void hw_set_sd_music_seek(uint32_t ms)
+{
+#ifdef ARDUINO
+    streamPlayer.seek(ms);
+#endif
+}
+
+uint32_t hw_get_sd_music_position()
+{
+#ifdef ARDUINO
+    return streamPlayer.position();
+#else
+    return 0;
+#endif
+}
+
 bool hw_player_running()
 {
 #ifdef ARDUINO
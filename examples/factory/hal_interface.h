@@ -578,6 +578,20 @@ void hw_set_sd_music_pause();
  */
 void hw_set_sd_music_resume();
 
+/**
+ * @brief Move the music playback to a position, MP3 positions are estimated from the bitrate.
+ *
+ * @param ms Position from the start of the file in milliseconds.
+ */
+void hw_set_sd_music_seek(uint32_t ms);
+
+/**
+ * @brief Get the music playback position.
+ *
+ * @return Position in milliseconds, 0 when nothing is playing.
+ */
+uint32_t hw_get_sd_music_position();
+
 /**
  * @brief Check if the music player is running.
  *
@@ -887,8 +901,9 @@ void hw_set_mic_stop();
  * This function retrieves the FFT data and stores it in the provided FFTData structure.
  *
  * @param fft_data A pointer to an FFTData structure where the FFT data will be stored.
+ * @return True if a new window was processed, false if fft_data was not touched.
  */
-void hw_audio_get_fft_data(FFTData *fft_data);
+bool hw_audio_get_fft_data(FFTData *fft_data);
 
 /**
  * @brief Disable all input devices.
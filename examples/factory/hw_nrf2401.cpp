@@ -72,7 +72,7 @@ int16_t hw_set_nrf24_params(radio_params_t &params)
     static uint8_t addr[] = {0x01, 0x23, 0x45, 0x67, 0x89};
     int state = RADIOLIB_ERR_NONE;
 
-    instance.lockSPI();
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_RADIO);
 
     state = nrf24.setFrequency(params.freq);
     if (state == RADIOLIB_ERR_INVALID_FREQUENCY) {
@@ -164,7 +164,7 @@ bool hw_set_nrf24_tx(radio_tx_params_t &params, bool continuous)
     Serial.print("[TX LEN:]");
     Serial.println(params.length);
 
-    instance.lockSPI();
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_RADIO);
     params.state = nrf24.startTransmit((const uint8_t*)params.data, params.length, 0);
     instance.unlockSPI();
 
@@ -194,7 +194,7 @@ void hw_get_nrf24_rx(radio_rx_params_t &params)
         return;
     }
 
-    instance.lockSPI();
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_RADIO);
     size_t  length = nrf24.getPacketLength();
     params.length = length > params.length ? params.length : length;
     params.state = nrf24.readData(params.data, params.length);
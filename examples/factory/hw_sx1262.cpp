@@ -71,7 +71,7 @@ int16_t hw_set_radio_params(radio_params_t &params)
 
 #ifdef ARDUINO
     int16_t state = 0;
-    instance.lockSPI();
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_RADIO);
     state = radio.setFrequency(params.freq);
     if (state == RADIOLIB_ERR_INVALID_FREQUENCY) {
         Serial.println(F("Selected frequency is invalid for this module!"));
@@ -158,7 +158,7 @@ void hw_set_radio_default()
 void hw_set_radio_listening()
 {
 #ifdef ARDUINO
-    instance.lockSPI();
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_RADIO);
     // Start next packet recv
     radio.startReceive();
     instance.unlockSPI();
@@ -191,7 +191,7 @@ void hw_set_radio_tx(radio_tx_params_t &params, bool continuous)
     Serial.print("[TX LEN:]");
     Serial.println(params.length);
 
-    instance.lockSPI();
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_RADIO);
     params.state = radio.startTransmit(params.data, params.length);
     instance.unlockSPI();
 
@@ -220,7 +220,7 @@ void hw_get_radio_rx(radio_rx_params_t &params)
         return;
     }
 
-    instance.lockSPI();
+    instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_RADIO);
     params.length = radio.getPacketLength();
     params.state = radio.readData(params.data, params.length);
     params.rssi = radio.getRSSI();
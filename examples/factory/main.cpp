@@ -20,6 +20,19 @@
 #include "examples/lv_examples.h"
 
 #include "hal_interface.h"
+#include "LV_FrameStats.h"
+#include "LV_InputLatency.h"
+
+// Print the frame statistics in the same format as the device every N ms, 0 disables
+#ifndef SIM_FRAME_STATS_DUMP_MS
+#define SIM_FRAME_STATS_DUMP_MS     0
+#endif
+
+// Press LV_KEY_NEXT from a synthetic keypad every N ms and print the input latency
+// with the frame statistics, 0 disables
+#ifndef SIM_SYNTHETIC_INPUT_MS
+#define SIM_SYNTHETIC_INPUT_MS      0
+#endif
 
 extern void setupGui();
 extern void hw_init();
@@ -29,6 +42,37 @@ static lv_indev_t *lvMouse;
 static lv_indev_t *lvMouseWheel;
 static lv_indev_t *lvKeyboard;
 
+#if SIM_SYNTHETIC_INPUT_MS
+static lv_indev_t *lvSynthetic;
+static uint32_t syntheticNextUs;
+
+// The key "interrupt" happens on a fixed schedule, the indev poll finds it later
+// like it finds a real key, so the polling delay is part of the latency
+static void synthetic_keypad_read(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    static bool pressed = false;
+    uint32_t now = lv_input_latency_now_us();
+    // The default group is created by the UI after the input devices
+    if (!lv_indev_get_group(indev)) {
+        lv_indev_set_group(indev, lv_group_get_default());
+    }
+    data->key = LV_KEY_NEXT;
+    if (pressed) {
+        pressed = false;
+        data->state = LV_INDEV_STATE_RELEASED;
+        return;
+    }
+    if ((int32_t)(now - syntheticNextUs) >= 0) {
+        lv_input_latency_mark(LV_INPUT_LATENCY_KEYPAD, syntheticNextUs);
+        syntheticNextUs += SIM_SYNTHETIC_INPUT_MS * 1000;
+        pressed = true;
+        data->state = LV_INDEV_STATE_PRESSED;
+        return;
+    }
+    data->state = LV_INDEV_STATE_RELEASED;
+}
+#endif
+
 
 #if LV_USE_LOG != 0
 static void lv_log_print_g_cb(lv_log_level_t level, const char * buf)
@@ -59,11 +103,23 @@ void hal_setup(void)
     lvMouse = lv_sdl_mouse_create();
     lvMouseWheel = lv_sdl_mousewheel_create();
     lvKeyboard = lv_sdl_keyboard_create();
+
+    lv_frame_stats_attach(lvDisplay);
+
+#if SIM_SYNTHETIC_INPUT_MS
+    // The SDL flush returns after the window is updated
+    lv_input_latency_attach(lvDisplay, false);
+    lvSynthetic = lv_indev_create();
+    lv_indev_set_type(lvSynthetic, LV_INDEV_TYPE_KEYPAD);
+    lv_indev_set_read_cb(lvSynthetic, synthetic_keypad_read);
+    syntheticNextUs = lv_input_latency_now_us() + SIM_SYNTHETIC_INPUT_MS * 1000;
+#endif
 }
 
 void hal_loop(void)
 {
     Uint32 lastTick = SDL_GetTicks();
+    Uint32 lastDump = lastTick;
     while (1) {
         fflush(stdout);
         SDL_Delay(5);
@@ -71,6 +127,13 @@ void hal_loop(void)
         lv_tick_inc(current - lastTick); // Update the tick timer. Tick is new for LVGL 9
         lastTick = current;
         lv_timer_handler(); // Update the UI-
+        if (SIM_FRAME_STATS_DUMP_MS && current - lastDump >= SIM_FRAME_STATS_DUMP_MS) {
+            lastDump = current;
+            lv_frame_stats_dump(NULL);
+#if SIM_SYNTHETIC_INPUT_MS
+            lv_input_latency_dump(NULL);
+#endif
+        }
     }
 }
 
@@ -64,7 +64,9 @@ static void update_fft_display(lv_timer_t *timer)
 {
     FFTData  fft_data;
 
-    hw_audio_get_fft_data(&fft_data);
+    if (!hw_audio_get_fft_data(&fft_data)) {
+        return;
+    }
 
     static bool first_update = true;
     if (first_update) {
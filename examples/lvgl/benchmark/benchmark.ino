@@ -4,19 +4,102 @@
  * @license   MIT
  * @copyright Copyright (c) 2023  Shenzhen Xinyuan Electronic Technology Co., Ltd
  * @date      2023-04-30
- *
+ * @note      Comparing one and two draw units needs two builds, the OS layer and the
+ *            draw unit count are fixed at compile time:
+ *            1. Build and flash with LV_HELPER_MULTI_CORE 0 in lv_conf.h (the default)
+ *               and note the "draw units: 1 ..." line printed at the end of the run.
+ *            2. Set LV_HELPER_MULTI_CORE 1 in lv_conf.h, or pass
+ *               -DLV_HELPER_MULTI_CORE=1 in the PlatformIO build_flags, rebuild and
+ *               flash, and note the "draw units: 2 ..." line.
+ *            Keep BENCHMARK_BUFFER_SWEEP 0, the board, the draw buffer configuration
+ *            and the CPU frequency the same for both runs and compare avg fps,
+ *            render and flush time.
  */
 #include <LilyGoLib.h>
 #include <LV_Helper.h>
 #include "lv_demo_benchmark.h"
 
+// Set to 1 to run the benchmark once for every draw buffer configuration below.
+// The board restarts between runs and prints one line of the result table per run.
+#define BENCHMARK_BUFFER_SWEEP      0
+
+#if BENCHMARK_BUFFER_SWEEP
+
+static const struct {
+    const char *name;
+    lv_helper_config_t config;
+} sweep_configs[] = {
+    {"default",             LV_HELPER_CONFIG_DEFAULT()},
+    {"1 x 24 lines dma",    {1, 24, LV_HELPER_BUF_INTERNAL_DMA, 0, LV_DISPLAY_RENDER_MODE_PARTIAL}},
+    {"2 x 24 lines dma",    {2, 24, LV_HELPER_BUF_INTERNAL_DMA, 0, LV_DISPLAY_RENDER_MODE_PARTIAL}},
+    {"2 x 60 lines dma",    {2, 60, LV_HELPER_BUF_INTERNAL_DMA, 0, LV_DISPLAY_RENDER_MODE_PARTIAL}},
+    {"2 x full psram",      {2, 0, LV_HELPER_BUF_PSRAM, 0, LV_DISPLAY_RENDER_MODE_FULL}},
+    {"2 x full bounce",     {2, 0, LV_HELPER_BUF_PSRAM_BOUNCE, 16, LV_DISPLAY_RENDER_MODE_FULL}},
+    {"3 x full bounce",     {3, 0, LV_HELPER_BUF_PSRAM_BOUNCE, 16, LV_DISPLAY_RENDER_MODE_FULL}},
+};
+
+#define SWEEP_MAGIC     0x4C564246
+
+RTC_NOINIT_ATTR static uint32_t sweep_magic;
+RTC_NOINIT_ATTR static uint32_t sweep_index;
+
+static void benchmark_end_cb(const lv_demo_benchmark_summary_t *summary)
+{
+    lv_helper_mem_info_t info;
+    lv_get_helper_mem_info(&info);
+    int32_t cnt = summary->valid_scene_cnt ? summary->valid_scene_cnt : 1;
+
+    Serial.printf("| %-18s | %3ld | %3ld%% | %8u | %8u | %8u |\n",
+                  sweep_configs[sweep_index].name,
+                  summary->total_avg_fps / cnt,
+                  summary->total_avg_cpu / cnt,
+                  info.internal_bytes, info.psram_bytes, info.internal_free);
+    Serial.flush();
+
+    sweep_index++;
+    if (sweep_index < sizeof(sweep_configs) / sizeof(sweep_configs[0])) {
+        esp_restart();
+    }
+    Serial.println("Sweep done");
+    sweep_magic = 0;
+}
+
+#else
+
+// Print one line to compare builds with LV_HELPER_MULTI_CORE 0 and 1 in lv_conf.h,
+// the draw unit count can only be changed at compile time
+static void benchmark_end_cb(const lv_demo_benchmark_summary_t *summary)
+{
+    lv_demo_benchmark_summary_display(summary);
+    int32_t cnt = summary->valid_scene_cnt ? summary->valid_scene_cnt : 1;
+    Serial.printf("draw units: %d, avg fps: %ld, avg cpu: %ld%%, render: %ld ms, flush: %ld ms\n",
+                  LV_DRAW_SW_DRAW_UNIT_CNT,
+                  summary->total_avg_fps / cnt,
+                  summary->total_avg_cpu / cnt,
+                  summary->total_avg_render_time / cnt,
+                  summary->total_avg_flush_time / cnt);
+}
+#endif
+
 void setup()
 {
     Serial.begin(115200);
 
     instance.begin();
 
+#if BENCHMARK_BUFFER_SWEEP
+    if (sweep_magic != SWEEP_MAGIC || sweep_index >= sizeof(sweep_configs) / sizeof(sweep_configs[0])) {
+        sweep_magic = SWEEP_MAGIC;
+        sweep_index = 0;
+        Serial.println("| config             | FPS | CPU  | internal | psram    | int free |");
+        Serial.println("|--------------------|-----|------|----------|----------|----------|");
+    }
+    beginLvglHelper(instance, sweep_configs[sweep_index].config);
+    lv_demo_benchmark_set_end_cb(benchmark_end_cb);
+#else
     beginLvglHelper(instance);
+    lv_demo_benchmark_set_end_cb(benchmark_end_cb);
+#endif
 
     lv_demo_benchmark();
 
@@ -17,69 +17,8 @@
 
 
 #if defined(USING_AUDIO_CODEC)
-class EspAudioOutput : public AudioOutput
-{
-public:
-    EspAudioOutput(EspCodec & codec)
-    {
-        _codec = &codec;
-    }
-    bool begin()
-    {
-        Serial.printf("bps:%d channels:%u hertz:%u\n", bps, channels, hertz);
-        if (hertz != 16000 || hertz != 32000 || hertz != 24000 || hertz != 41000 || hertz == 0) {
-            hertz = 16000;
-        }
-        channels = 2;
-        alreadyBeing = _codec->open(bps, channels, hertz ) != -1;
-        return alreadyBeing;
-    };
-
-    bool SetBitsPerSample(int bits)
-    {
-        Serial.printf("Set bps : %u\n", bps);
-        bps = bits;
-        return true;
-    }
-    bool SetChannels(int chan)
-    {
-        Serial.printf("Set channels : %u\n", channels);
-        channels = chan;
-        return true;
-    }
-    bool SetRate(int hz)
-    {
-        hertz = hz;
-        Serial.printf("Set Rate : %u\n", hertz);
-        if (alreadyBeing) {
-            _codec->close();
-        }
-        alreadyBeing = _codec->open(bps, channels, hertz ) != -1;
-        return true;
-    }
-
-    bool ConsumeSample(int16_t sample[2])
-    {
-        return _codec->write((uint8_t*)sample, 4) != -1;
-    }
-
-    uint16_t ConsumeSamples(int16_t *samples, uint16_t count)
-    {
-        Serial.println("ConsumeSamples....");
-        _codec->write((uint8_t*)samples, count);
-        return count;
-    }
-    bool stop()
-    {
-        Serial.println("Closed\n\n\n");
-        alreadyBeing = false;
-        _codec->close();
-        return true;
-    }
-private:
-    bool alreadyBeing = false;
-    EspCodec *_codec;
-};
+// Writes whole DMA sized blocks to the codec instead of one write per sample
+#include <bsp_codec/esp_audio_output.h>
 
 EspAudioOutput          *out = NULL;
 
@@ -231,6 +170,14 @@ void setup(void)
                 wav->stop();
             }
         }
+
+#if defined(USING_AUDIO_CODEC)
+        EspCodecOutputStats_t stats;
+        out->getStats(&stats);
+        Serial.printf("Frames:%lu writes:%lu failed:%lu busy per second of audio:%lu us\n",
+                      (unsigned long)stats.frames, (unsigned long)stats.writes,
+                      (unsigned long)stats.write_errors, (unsigned long)stats.busy_us_per_s);
+#endif
     }
 
     Serial.println("Done.....");
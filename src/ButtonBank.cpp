@@ -0,0 +1,270 @@
+/**
+ * @file      ButtonBank.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-18
+ *
+ */
+#include "ButtonBank.h"
+
+bool ButtonBank::begin(const uint8_t *pins, uint8_t count, EventGroupHandle_t group, EventBits_t bit, bool active_low)
+{
+    if (_running) {
+        return true;
+    }
+    if (!pins || count == 0 || count > CONFIG_BUTTON_BANK_MAX || !group) {
+        return false;
+    }
+    memcpy(_pins, pins, count);
+    _count = count;
+    _active_low = active_low;
+    _group = group;
+    _bit = bit;
+    return restart();
+}
+
+bool ButtonBank::restart()
+{
+    if (_running) {
+        return true;
+    }
+    if (!_count) {
+        return false;
+    }
+    if (!_timer) {
+        _timer = xTimerCreate("btn", pdMS_TO_TICKS(CONFIG_BUTTON_TICK_MS), pdTRUE, this, timerCallback);
+        if (!_timer) {
+            log_e("Failed to create button timer");
+            return false;
+        }
+    }
+    reset(_count);
+    _edgeHead = _edgeTail = 0;
+    _timerActive = false;
+    for (uint8_t i = 0; i < _count; i++) {
+        ::pinMode(_pins[i], _active_low ? INPUT_PULLUP : INPUT);
+        bool pressed = (::digitalRead(_pins[i]) == LOW) == _active_low;
+        // A button held at start only reports its release
+        _state[i].raw = _state[i].stable = pressed;
+        _state[i].long_sent = pressed;
+        _args[i].bank = this;
+        _args[i].index = i;
+        attachInterruptArg(_pins[i], isr, &_args[i], CHANGE);
+    }
+    _running = true;
+    return true;
+}
+
+void ButtonBank::end()
+{
+    if (!_running) {
+        return;
+    }
+    for (uint8_t i = 0; i < _count; i++) {
+        detachInterrupt(_pins[i]);
+    }
+    xTimerStop(_timer, portMAX_DELAY);
+    _timerActive = false;
+    _running = false;
+}
+
+bool ButtonBank::isRunning()
+{
+    return _running;
+}
+
+void ButtonBank::setTiming(uint16_t debounce_ms, uint16_t long_ms, uint16_t multi_ms)
+{
+    _debounce_ms = debounce_ms;
+    _long_ms = long_ms;
+    _multi_ms = multi_ms;
+}
+
+uint32_t ButtonBank::getDroppedEvents()
+{
+    return _dropped;
+}
+
+void ButtonBank::reset(uint8_t count)
+{
+    _count = count < CONFIG_BUTTON_BANK_MAX ? count : CONFIG_BUTTON_BANK_MAX;
+    for (uint8_t i = 0; i < _count; i++) {
+        memset(&_state[i], 0, sizeof(State));
+        // The first edge is never inside the debounce time
+        _state[i].change_ms = 0 - (uint32_t)_debounce_ms;
+    }
+}
+
+void ButtonBank::dispatch(LilyGoEventManage *events)
+{
+    ButtonEventParam_t event;
+    while (popEvent(&event)) {
+        events->sendEvent(BUTTON_EVENT, &event);
+    }
+}
+
+bool ButtonBank::popEvent(ButtonEventParam_t *event)
+{
+    uint32_t tail = _eventTail;
+    if (tail == __atomic_load_n(&_eventHead, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    *event = _events[tail & (CONFIG_BUTTON_EVENT_QUEUE_SIZE - 1)];
+    __atomic_store_n(&_eventTail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void ButtonBank::emit(uint8_t index, ButtonEvent_t type)
+{
+    uint32_t head = _eventHead;
+    if (head - __atomic_load_n(&_eventTail, __ATOMIC_ACQUIRE) >= CONFIG_BUTTON_EVENT_QUEUE_SIZE) {
+        _dropped++;
+        return;
+    }
+    ButtonEventParam_t &event = _events[head & (CONFIG_BUTTON_EVENT_QUEUE_SIZE - 1)];
+    event.id = index;
+    event.event = type;
+    __atomic_store_n(&_eventHead, head + 1, __ATOMIC_RELEASE);
+}
+
+static ButtonEvent_t click_event(uint8_t clicks)
+{
+    switch (clicks) {
+    case 1:
+        return BUTTON_EVENT_CLICK;
+    case 2:
+        return BUTTON_EVENT_DOUBLE_CLICK;
+    default:
+        return BUTTON_EVENT_TRIPLE_CLICK;
+    }
+}
+
+void ButtonBank::accept(uint8_t index, bool pressed, uint32_t time_ms)
+{
+    State &s = _state[index];
+    s.stable = pressed;
+    s.change_ms = time_ms;
+    if (pressed) {
+        // The timer ran late, the previous sequence had already ended
+        if (s.clicks && time_ms - s.release_ms >= _multi_ms) {
+            emit(index, click_event(s.clicks));
+            s.clicks = 0;
+        }
+        s.down_ms = time_ms;
+        s.long_sent = false;
+        emit(index, BUTTON_EVENT_PRESSED);
+        return;
+    }
+    emit(index, BUTTON_EVENT_RELEASED);
+    if (s.long_sent) {
+        return;
+    }
+    s.clicks++;
+    s.release_ms = time_ms;
+    // Nothing longer is detected, no need to wait for another press
+    if (s.clicks == 3) {
+        emit(index, BUTTON_EVENT_TRIPLE_CLICK);
+        s.clicks = 0;
+    }
+}
+
+void ButtonBank::feed(uint8_t index, bool pressed, uint32_t time_ms)
+{
+    if (index >= CONFIG_BUTTON_BANK_MAX) {
+        return;
+    }
+    State &s = _state[index];
+    s.raw = pressed;
+    s.raw_ms = time_ms;
+    // The first edge of a change is taken with its own timestamp, the bounce after it is ignored
+    if (pressed != s.stable && time_ms - s.change_ms >= _debounce_ms) {
+        accept(index, pressed, time_ms);
+    }
+}
+
+bool ButtonBank::tick(uint32_t now_ms)
+{
+    bool active = false;
+    for (uint8_t i = 0; i < _count; i++) {
+        State &s = _state[i];
+        // The level settled differently from the last accepted change, e.g. a short bounce
+        if (s.raw != s.stable && now_ms - s.change_ms >= _debounce_ms) {
+            accept(i, s.raw, s.raw_ms);
+        }
+        if (s.stable && !s.long_sent && now_ms - s.down_ms >= _long_ms) {
+            s.long_sent = true;
+            s.clicks = 0;
+            emit(i, BUTTON_EVENT_LONG_PRESSED);
+        }
+        if (!s.stable && s.clicks && now_ms - s.release_ms >= _multi_ms) {
+            emit(i, click_event(s.clicks));
+            s.clicks = 0;
+        }
+        active |= (s.raw != s.stable) || (s.stable && !s.long_sent) || s.clicks;
+    }
+    return active;
+}
+
+bool ButtonBank::pushEdge(const ButtonEdge_t &edge)
+{
+    uint32_t head = _edgeHead;
+    if (head - __atomic_load_n(&_edgeTail, __ATOMIC_ACQUIRE) >= CONFIG_BUTTON_EDGE_QUEUE_SIZE) {
+        _dropped++;
+        return false;
+    }
+    _edges[head & (CONFIG_BUTTON_EDGE_QUEUE_SIZE - 1)] = edge;
+    __atomic_store_n(&_edgeHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool ButtonBank::popEdge(ButtonEdge_t *edge)
+{
+    uint32_t tail = _edgeTail;
+    if (tail == __atomic_load_n(&_edgeHead, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    *edge = _edges[tail & (CONFIG_BUTTON_EDGE_QUEUE_SIZE - 1)];
+    __atomic_store_n(&_edgeTail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void ARDUINO_ISR_ATTR ButtonBank::isr(void *arg)
+{
+    PinArg *pin = (PinArg *)arg;
+    ButtonBank *bank = pin->bank;
+    ButtonEdge_t edge;
+    edge.time_ms = millis();
+    edge.index = pin->index;
+    edge.pressed = (::digitalRead(bank->_pins[pin->index]) == LOW) == bank->_active_low;
+    bank->pushEdge(edge);
+    if (!bank->_timerActive) {
+        BaseType_t woken = pdFALSE;
+        bank->_timerActive = true;
+        xTimerStartFromISR(bank->_timer, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void ButtonBank::timerCallback(TimerHandle_t timer)
+{
+    ButtonBank *bank = (ButtonBank *)pvTimerGetTimerID(timer);
+    uint32_t head = bank->_eventHead;
+    ButtonEdge_t edge;
+    while (bank->popEdge(&edge)) {
+        bank->feed(edge.index, edge.pressed, edge.time_ms);
+    }
+    bool active = bank->tick(millis());
+    if (bank->_eventHead != head) {
+        xEventGroupSetBits(bank->_group, bank->_bit);
+    }
+    if (!active) {
+        bank->_timerActive = false;
+        xTimerStop(timer, 0);
+        // An edge queued after the drain may have started the timer before this stop
+        if (__atomic_load_n(&bank->_edgeHead, __ATOMIC_ACQUIRE) != bank->_edgeTail) {
+            bank->_timerActive = true;
+            xTimerStart(timer, 0);
+        }
+    }
+}
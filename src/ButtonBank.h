@@ -0,0 +1,173 @@
+/**
+ * @file      ButtonBank.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-18
+ * @note      Detects click, long press, double and triple click on several buttons.
+ *            The pin interrupts only timestamp the edges, one software timer runs the
+ *            state machines of all buttons and the results are sent as BUTTON_EVENT.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/timers.h"
+#include "LilyGoEventManage.h"
+
+// Maximum number of buttons in one bank
+#ifndef CONFIG_BUTTON_BANK_MAX
+#define CONFIG_BUTTON_BANK_MAX          4
+#endif
+
+// Edges buffered between the interrupts and the timer, must be a power of two
+#ifndef CONFIG_BUTTON_EDGE_QUEUE_SIZE
+#define CONFIG_BUTTON_EDGE_QUEUE_SIZE   32
+#endif
+
+// Events buffered until they are dispatched, must be a power of two
+#ifndef CONFIG_BUTTON_EVENT_QUEUE_SIZE
+#define CONFIG_BUTTON_EVENT_QUEUE_SIZE  16
+#endif
+
+// Timer period while a button is active, the timer is stopped when all are idle
+#ifndef CONFIG_BUTTON_TICK_MS
+#define CONFIG_BUTTON_TICK_MS           10
+#endif
+
+typedef struct {
+    uint32_t time_ms;
+    uint8_t index;          // Position of the button in the bank
+    bool pressed;
+} ButtonEdge_t;
+
+class ButtonBank
+{
+public:
+    /**
+     * @brief Attach the edge interrupts and start detecting.
+     *
+     * When events are ready 'bit' is set in 'group', the owner then calls dispatch(),
+     * from loop() or from the IRQ service task.
+     *
+     * @param pins Button pins, the id of the events is the position in this array
+     * @param count Number of pins, at most CONFIG_BUTTON_BANK_MAX
+     * @param group Event group notified when events are ready
+     * @param bit Bit set in 'group'
+     * @param active_low true if the pins read LOW while pressed
+     * @return true on success
+     */
+    bool begin(const uint8_t *pins, uint8_t count, EventGroupHandle_t group, EventBits_t bit, bool active_low = true);
+
+    /**
+     * @brief Start again with the parameters of the last begin().
+     */
+    bool restart();
+
+    /**
+     * @brief Detach the interrupts and stop the timer, pending events are kept.
+     */
+    void end();
+
+    bool isRunning();
+
+    /**
+     * @brief Set the detection times, the defaults are the same as Button2.
+     * @param debounce_ms Edges closer than this to the last accepted change are bounce
+     * @param long_ms Hold time of a long press
+     * @param multi_ms Maximum time from one release to the next press of a double or triple click
+     */
+    void setTiming(uint16_t debounce_ms, uint16_t long_ms, uint16_t multi_ms);
+
+    /**
+     * @brief Send every pending event as BUTTON_EVENT with a ButtonEventParam_t.
+     */
+    void dispatch(LilyGoEventManage *events);
+
+    /**
+     * @brief Take one pending event.
+     * @return false if there is none
+     */
+    bool popEvent(ButtonEventParam_t *event);
+
+    /**
+     * @brief Run one edge through the state machine of a button.
+     * @note  feed() and tick() do not touch the hardware, a recorded or synthetic
+     *        edge trace can be replayed on a host and the results read with popEvent().
+     * @param index Position of the button
+     * @param pressed Level after the edge
+     * @param time_ms Time of the edge
+     */
+    void feed(uint8_t index, bool pressed, uint32_t time_ms);
+
+    /**
+     * @brief Handle the timeouts of all buttons.
+     * @param now_ms Current time
+     * @return true while a button still needs the timer
+     */
+    bool tick(uint32_t now_ms);
+
+    /**
+     * @brief Clear the state of 'count' buttons, a host replay calls it instead of begin().
+     */
+    void reset(uint8_t count);
+
+    /**
+     * @brief Gets the number of edges or events lost because a queue was full.
+     */
+    uint32_t getDroppedEvents();
+
+private:
+    struct State {
+        bool raw;               // Level of the last edge
+        uint32_t raw_ms;
+        bool stable;            // Debounced level
+        uint32_t change_ms;     // Time of the last accepted change
+        uint32_t down_ms;
+        uint32_t release_ms;
+        uint8_t clicks;
+        bool long_sent;
+    };
+
+    void accept(uint8_t index, bool pressed, uint32_t time_ms);
+    void emit(uint8_t index, ButtonEvent_t event);
+    bool pushEdge(const ButtonEdge_t &edge);
+    bool popEdge(ButtonEdge_t *edge);
+
+    static void ARDUINO_ISR_ATTR isr(void *arg);
+    static void timerCallback(TimerHandle_t timer);
+
+    uint8_t _pins[CONFIG_BUTTON_BANK_MAX];
+    uint8_t _count = 0;
+    bool _active_low = true;
+    EventGroupHandle_t _group = NULL;
+    EventBits_t _bit = 0;
+    TimerHandle_t _timer = NULL;
+    volatile bool _timerActive = false;
+    bool _running = false;
+
+    uint16_t _debounce_ms = 50;
+    uint16_t _long_ms = 250;
+    uint16_t _multi_ms = 400;
+
+    State _state[CONFIG_BUTTON_BANK_MAX];
+
+    // The pin interrupts are the only producer, the timer the only consumer
+    ButtonEdge_t _edges[CONFIG_BUTTON_EDGE_QUEUE_SIZE];
+    uint32_t _edgeHead = 0;
+    uint32_t _edgeTail = 0;
+
+    // The timer is the only producer, dispatch the only consumer
+    ButtonEventParam_t _events[CONFIG_BUTTON_EVENT_QUEUE_SIZE];
+    uint32_t _eventHead = 0;
+    uint32_t _eventTail = 0;
+
+    uint32_t _dropped = 0;
+
+    // Argument of each pin interrupt
+    struct PinArg {
+        ButtonBank *bank;
+        uint8_t index;
+    } _args[CONFIG_BUTTON_BANK_MAX];
+};
@@ -0,0 +1,55 @@
+/**
+ * @file      LV_FlushMerge.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ *
+ */
+#include "LV_FlushMerge.h"
+
+#if LVGL_VERSION_MAJOR == 9
+
+uint32_t lv_flush_merge_area(lv_area_t *area, const lv_area_t *queued, uint32_t count,
+                             uint32_t cost_px, uint32_t max_px, lv_flush_merge_stats_t *stats)
+{
+    uint32_t merged_count = 0;
+    if (stats) {
+        stats->areas++;
+    }
+    // Growing may bring further areas within reach, repeat until nothing merges
+    bool merged;
+    do {
+        merged = false;
+        for (uint32_t i = 0; i < count; i++) {
+            const lv_area_t *inv = &queued[i];
+            // Already covered, lvgl drops it when joining
+            if (lv_area_is_in(inv, area, 0)) {
+                continue;
+            }
+            lv_area_t join;
+            lv_area_join(&join, area, inv);
+            uint32_t join_size = lv_area_get_size(&join);
+            uint32_t sum_size = lv_area_get_size(area) + lv_area_get_size(inv);
+            if (join_size > sum_size + cost_px) {
+                continue;
+            }
+            // Do not turn areas that fit the draw buffer into one that needs several flushes
+            if (max_px && join_size > max_px && sum_size <= max_px) {
+                continue;
+            }
+            if (stats) {
+                if (join_size > sum_size) {
+                    stats->extra_px += join_size - sum_size;
+                }
+                stats->merged++;
+            }
+            *area = join;
+            merged_count++;
+            merged = true;
+        }
+    } while (merged);
+    return merged_count;
+}
+
+#endif
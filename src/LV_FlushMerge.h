@@ -0,0 +1,35 @@
+/**
+ * @file      LV_FlushMerge.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      Cost model deciding which invalidated areas are rendered and flushed
+ *            together. Only uses the lvgl area helpers, the host tests build it as is.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <lvgl.h>
+
+typedef struct {
+    uint32_t areas;         // Areas invalidated
+    uint32_t merged;        // Areas merged into another one, each saves one flush
+    uint32_t extra_px;      // Pixels rendered and sent only because of merging
+} lv_flush_merge_stats_t;
+
+/**
+ * @brief  Grow a newly invalidated area over the queued areas that cost less to render
+ *         with it than to flush on their own: the bounding box may add at most cost_px
+ *         pixels, and areas fitting the draw buffer never grow past it. The queued
+ *         areas are only read, lvgl joins the ones the grown area covers itself.
+ * @param  area    New area, grown in place
+ * @param  queued  Areas already invalidated in this refresh
+ * @param  count   Number of queued areas
+ * @param  cost_px Address window setup cost of one flush in pixels
+ * @param  max_px  Draw buffer size in pixels, 0 for no limit
+ * @param  stats   Counters to update, may be NULL
+ * @retval Number of queued areas merged
+ */
+uint32_t lv_flush_merge_area(lv_area_t *area, const lv_area_t *queued, uint32_t count,
+                             uint32_t cost_px, uint32_t max_px, lv_flush_merge_stats_t *stats);
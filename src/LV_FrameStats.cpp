@@ -0,0 +1,255 @@
+/**
+ * @file      LV_FrameStats.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-10
+ *
+ */
+#include "LV_FrameStats.h"
+#include <stdio.h>
+#include <string.h>
+
+#if LVGL_VERSION_MAJOR == 9
+
+#ifdef ARDUINO
+#include "esp_timer.h"
+static inline uint32_t frame_stats_now_us()
+{
+    return (uint32_t)esp_timer_get_time();
+}
+#else
+#include <chrono>
+static inline uint32_t frame_stats_now_us()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+#define FRAME_STATS_OVERLAY_PERIOD_MS   500
+#define FRAME_STATS_DUMP_CHUNK          8
+
+static lv_frame_stats_t history[CONFIG_LV_FRAME_STATS_HISTORY];
+static uint32_t history_count = 0;
+static uint32_t frame_seq = 0;
+static lv_frame_stats_hist_t histogram;
+
+// Frame being recorded
+static lv_frame_stats_t cur;
+static uint32_t frame_start_us, flush_start_us, wait_start_us;
+static uint32_t te_wait_start_us, bus_wait_start_us;
+
+static lv_frame_stats_wait_cb_t wait_cb = NULL;
+static void *wait_cb_user_data = NULL;
+
+static lv_obj_t *overlay_label = NULL;
+static lv_timer_t *overlay_timer = NULL;
+static uint32_t overlay_last_frame = 0;
+
+static uint8_t frame_stats_bucket(uint32_t us)
+{
+    uint8_t n = 0;
+    while (us > 1 && n < LV_FRAME_STATS_BUCKETS - 1) {
+        us >>= 1;
+        n++;
+    }
+    return n;
+}
+
+static void frame_stats_record()
+{
+    cur.frame = frame_seq++;
+    history[history_count % CONFIG_LV_FRAME_STATS_HISTORY] = cur;
+    history_count++;
+    histogram.frame_us[frame_stats_bucket(cur.render_us + cur.flush_us + cur.flush_wait_us)]++;
+    histogram.render_us[frame_stats_bucket(cur.render_us)]++;
+    histogram.flush_us[frame_stats_bucket(cur.flush_us)]++;
+}
+
+static void frame_stats_event_cb(lv_event_t *e)
+{
+    uint32_t now = frame_stats_now_us();
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+        memset(&cur, 0, sizeof(cur));
+        frame_start_us = now;
+        if (wait_cb) {
+            wait_cb(&te_wait_start_us, &bus_wait_start_us, wait_cb_user_data);
+        }
+        break;
+    case LV_EVENT_FLUSH_START: {
+        const lv_area_t *area = (const lv_area_t *)lv_event_get_param(e);
+        cur.areas++;
+        if (area) {
+            cur.bytes += lv_area_get_size(area) * sizeof(uint16_t);
+        }
+        flush_start_us = now;
+        break;
+    }
+    case LV_EVENT_FLUSH_FINISH:
+        cur.flush_us += now - flush_start_us;
+        break;
+    case LV_EVENT_FLUSH_WAIT_START:
+        wait_start_us = now;
+        break;
+    case LV_EVENT_FLUSH_WAIT_FINISH:
+        cur.flush_wait_us += now - wait_start_us;
+        break;
+    case LV_EVENT_REFR_READY: {
+        // Refresh cycles without anything to redraw are not frames
+        if (cur.areas == 0) {
+            break;
+        }
+        uint32_t total = now - frame_start_us;
+        uint32_t busy = cur.flush_us + cur.flush_wait_us;
+        cur.render_us = total > busy ? total - busy : 0;
+        if (wait_cb) {
+            uint32_t te_us, bus_us;
+            wait_cb(&te_us, &bus_us, wait_cb_user_data);
+            cur.te_wait_us = te_us - te_wait_start_us;
+            cur.bus_wait_us = bus_us - bus_wait_start_us;
+        }
+        frame_stats_record();
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void lv_frame_stats_attach(lv_display_t *disp)
+{
+    lv_display_add_event_cb(disp, frame_stats_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, frame_stats_event_cb, LV_EVENT_FLUSH_START, NULL);
+    lv_display_add_event_cb(disp, frame_stats_event_cb, LV_EVENT_FLUSH_FINISH, NULL);
+    lv_display_add_event_cb(disp, frame_stats_event_cb, LV_EVENT_FLUSH_WAIT_START, NULL);
+    lv_display_add_event_cb(disp, frame_stats_event_cb, LV_EVENT_FLUSH_WAIT_FINISH, NULL);
+    lv_display_add_event_cb(disp, frame_stats_event_cb, LV_EVENT_REFR_READY, NULL);
+}
+
+void lv_frame_stats_set_wait_cb(lv_frame_stats_wait_cb_t cb, void *user_data)
+{
+    wait_cb = cb;
+    wait_cb_user_data = user_data;
+}
+
+uint32_t lv_frame_stats_get_history(lv_frame_stats_t *out, uint32_t max)
+{
+    uint32_t count = history_count < CONFIG_LV_FRAME_STATS_HISTORY ? history_count : CONFIG_LV_FRAME_STATS_HISTORY;
+    if (count > max) {
+        count = max;
+    }
+    uint32_t first = history_count - count;
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = history[(first + i) % CONFIG_LV_FRAME_STATS_HISTORY];
+    }
+    return count;
+}
+
+void lv_frame_stats_get_histogram(lv_frame_stats_hist_t *hist)
+{
+    if (hist) {
+        *hist = histogram;
+    }
+}
+
+void lv_frame_stats_reset()
+{
+    history_count = 0;
+    overlay_last_frame = 0;
+    memset(&histogram, 0, sizeof(histogram));
+}
+
+static void frame_stats_print_default(const char *line)
+{
+    printf("%s\n", line);
+}
+
+static void frame_stats_print_hist(lv_frame_stats_print_cb_t print, const char *name, const uint32_t *buckets)
+{
+    char line[256];
+    int n = snprintf(line, sizeof(line), "hist,%s", name);
+    for (uint32_t i = 0; i < LV_FRAME_STATS_BUCKETS && n < (int)sizeof(line); i++) {
+        n += snprintf(line + n, sizeof(line) - n, ",%lu", (unsigned long)buckets[i]);
+    }
+    print(line);
+}
+
+void lv_frame_stats_dump(lv_frame_stats_print_cb_t print)
+{
+    if (!print) {
+        print = frame_stats_print_default;
+    }
+    char line[160];
+    print("frame,seq,render_us,flush_us,flush_wait_us,te_wait_us,bus_wait_us,bytes,areas");
+    // Copied out a few frames at a time, the whole history does not fit the stack of every task
+    lv_frame_stats_t frames[FRAME_STATS_DUMP_CHUNK];
+    uint32_t end = history_count;
+    uint32_t n = end < CONFIG_LV_FRAME_STATS_HISTORY ? 0 : end - CONFIG_LV_FRAME_STATS_HISTORY;
+    while (n < end) {
+        uint32_t count = end - n < FRAME_STATS_DUMP_CHUNK ? end - n : FRAME_STATS_DUMP_CHUNK;
+        for (uint32_t i = 0; i < count; i++) {
+            frames[i] = history[(n + i) % CONFIG_LV_FRAME_STATS_HISTORY];
+        }
+        n += count;
+        for (uint32_t i = 0; i < count; i++) {
+            const lv_frame_stats_t &f = frames[i];
+            snprintf(line, sizeof(line), "frame,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%u",
+                     (unsigned long)f.frame, (unsigned long)f.render_us, (unsigned long)f.flush_us,
+                     (unsigned long)f.flush_wait_us, (unsigned long)f.te_wait_us,
+                     (unsigned long)f.bus_wait_us, (unsigned long)f.bytes, f.areas);
+            print(line);
+        }
+    }
+    frame_stats_print_hist(print, "frame_us", histogram.frame_us);
+    frame_stats_print_hist(print, "render_us", histogram.render_us);
+    frame_stats_print_hist(print, "flush_us", histogram.flush_us);
+}
+
+// Averages the frames recorded since the last update, the label redraw itself
+// shows up as a small frame every period
+static void frame_stats_overlay_cb(lv_timer_t *t)
+{
+    uint32_t frames = history_count - overlay_last_frame;
+    if (frames == 0) {
+        return;
+    }
+    if (frames > CONFIG_LV_FRAME_STATS_HISTORY) {
+        frames = CONFIG_LV_FRAME_STATS_HISTORY;
+    }
+    uint64_t render = 0, flush = 0, wait = 0, bytes = 0;
+    for (uint32_t i = 0; i < frames; i++) {
+        const lv_frame_stats_t &f = history[(history_count - 1 - i) % CONFIG_LV_FRAME_STATS_HISTORY];
+        render += f.render_us;
+        flush += f.flush_us;
+        wait += f.flush_wait_us;
+        bytes += f.bytes;
+    }
+    overlay_last_frame = history_count;
+    lv_label_set_text_fmt(overlay_label, "%lu fps R %lu F %lu W %lu us %lu KB",
+                          (unsigned long)(frames * 1000 / FRAME_STATS_OVERLAY_PERIOD_MS),
+                          (unsigned long)(render / frames), (unsigned long)(flush / frames),
+                          (unsigned long)(wait / frames), (unsigned long)(bytes / frames / 1024));
+}
+
+void lv_frame_stats_show_overlay(bool enable)
+{
+    if (enable && !overlay_label) {
+        overlay_label = lv_label_create(lv_layer_top());
+        lv_obj_set_style_bg_opa(overlay_label, LV_OPA_50, 0);
+        lv_obj_set_style_bg_color(overlay_label, lv_color_black(), 0);
+        lv_obj_set_style_text_color(overlay_label, lv_color_white(), 0);
+        lv_obj_align(overlay_label, LV_ALIGN_BOTTOM_MID, 0, 0);
+        lv_label_set_text(overlay_label, "");
+        overlay_last_frame = history_count;
+        overlay_timer = lv_timer_create(frame_stats_overlay_cb, FRAME_STATS_OVERLAY_PERIOD_MS, NULL);
+    } else if (!enable && overlay_label) {
+        lv_timer_delete(overlay_timer);
+        lv_obj_delete(overlay_label);
+        overlay_timer = NULL;
+        overlay_label = NULL;
+    }
+}
+
+#endif
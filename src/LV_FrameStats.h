@@ -0,0 +1,74 @@
+/**
+ * @file      LV_FrameStats.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-10
+ * @note      Per frame render/flush statistics built on the lvgl 9 display events.
+ *            Does not depend on Arduino, add LV_FrameStats.cpp to the simulator
+ *            sources to get the same report on a PC.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <lvgl.h>
+
+// Number of frames kept in the history ring
+#ifndef CONFIG_LV_FRAME_STATS_HISTORY
+#define CONFIG_LV_FRAME_STATS_HISTORY   64
+#endif
+
+// Histogram buckets, bucket n counts frames taking [2^n, 2^(n+1)) microseconds
+#define LV_FRAME_STATS_BUCKETS          20
+
+typedef struct {
+    uint32_t frame;             // Frame sequence number
+    uint32_t render_us;         // Time spent rendering
+    uint32_t flush_us;          // Time spent in the flush callback
+    uint32_t flush_wait_us;     // Time spent waiting for the previous flush to finish
+    uint32_t te_wait_us;        // Time the display driver waited for tearing effect
+    uint32_t bus_wait_us;       // Time the display driver waited for the bus lock
+    uint32_t bytes;             // Pixel bytes flushed
+    uint16_t areas;             // Areas flushed
+} lv_frame_stats_t;
+
+typedef struct {
+    uint32_t frame_us[LV_FRAME_STATS_BUCKETS];  // Whole frame, render + flush + wait
+    uint32_t render_us[LV_FRAME_STATS_BUCKETS];
+    uint32_t flush_us[LV_FRAME_STATS_BUCKETS];
+} lv_frame_stats_hist_t;
+
+// Returns the total time the display driver has waited for tearing effect and
+// for the bus since start, the difference across a frame is recorded
+typedef void (*lv_frame_stats_wait_cb_t)(uint32_t *te_wait_us, uint32_t *bus_wait_us, void *user_data);
+
+// Receives one line of the serial dump without line ending
+typedef void (*lv_frame_stats_print_cb_t)(const char *line);
+
+/**
+ * @brief  Start collecting statistics of a display.
+ */
+void lv_frame_stats_attach(lv_display_t *disp);
+void lv_frame_stats_set_wait_cb(lv_frame_stats_wait_cb_t cb, void *user_data);
+
+/**
+ * @brief  Copy the most recent frames, oldest first.
+ * @param  out Destination array
+ * @param  max Size of the destination array
+ * @retval Number of frames copied
+ */
+uint32_t lv_frame_stats_get_history(lv_frame_stats_t *out, uint32_t max);
+void lv_frame_stats_get_histogram(lv_frame_stats_hist_t *hist);
+void lv_frame_stats_reset();
+
+/**
+ * @brief  Print the history and histograms as CSV lines.
+ *         "frame,..." lines hold one frame each, "hist,<metric>,..." lines one histogram each.
+ * @param  print Line output, NULL uses printf
+ */
+void lv_frame_stats_dump(lv_frame_stats_print_cb_t print);
+
+/**
+ * @brief  Show the average of the last frames in a label on the top layer.
+ */
+void lv_frame_stats_show_overlay(bool enable);
@@ -60,24 +60,13 @@ void touchpad_read( lv_indev_drv_t *indev_driver, lv_indev_data_t *data )
 #ifdef USING_INPUT_DEV_ROTARY
 static void lv_encoder_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data)
 {
-    static uint8_t last_dir = 0;
-    RotaryMsg_t msg = static_cast<LilyGo_Display *>(indev_drv->user_data)->getRotary();
-    switch (msg.dir) {
-    case ROTARY_DIR_UP:
-        data->enc_diff = 1;
-        break;
-    case ROTARY_DIR_DOWN:
-        data->enc_diff = -1;
-        break;
-    default:
-        data->state = LV_INDEV_STATE_RELEASED;
-        break;
-    }
-    if (msg.centerBtnPressed) {
-        data->state = LV_INDEV_STATE_PRESSED;
-    }
-    if (last_dir != msg.dir || msg.centerBtnPressed) {
-        plane->feedback((void*)drv);
+    auto *plane = static_cast<LilyGo_Display *>(indev_drv->user_data);
+    // Returns immediately with all steps since the last poll
+    RotaryMsg_t msg = plane->getRotary();
+    data->enc_diff = msg.diff;
+    data->state = msg.centerBtnPressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+    if (msg.diff != 0 || msg.centerBtnPressed) {
+        plane->feedback((void *)indev_drv);
     }
 }
 #endif //USING_INPUT_DEV_ROTARY
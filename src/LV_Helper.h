@@ -12,15 +12,117 @@
 #include "LilyGoDispInterface.h"
 #include <Arduino.h>
 #include <lvgl.h>
+#if LVGL_VERSION_MAJOR == 9
+#include "LV_FrameStats.h"
+#include "LV_InputLatency.h"
+#include "LV_FlushMerge.h"
+#endif
 
 #if LV_USE_FS_POSIX != 1 || LV_FS_POSIX_LETTER != 'A'
 #warning "Lvgl fs mismatch, may not be able to use fs function"
 #endif
 
+// Collect per frame statistics, see LV_FrameStats.h. Adds a display event
+// callback and a timestamp to every refresh and flush
+#ifndef CONFIG_LV_FRAME_STATS
+#define CONFIG_LV_FRAME_STATS           0
+#endif
+
+// Measure the time from the input interrupt to the flush showing its result,
+// see LV_InputLatency.h. Adds a little work to every invalidation and flush
+#ifndef CONFIG_LV_INPUT_LATENCY
+#define CONFIG_LV_INPUT_LATENCY         0
+#endif
+
+// Address window setup cost of one flush expressed in pixels. Two invalidated areas
+// are rendered and flushed as one when their bounding box is at most this many
+// pixels larger than the two areas together, 0 disables merging.
+#ifndef CONFIG_LV_FLUSH_MERGE_COST_PX
+#define CONFIG_LV_FLUSH_MERGE_COST_PX   256
+#endif
+
+// By default every queued key goes through LVGL, all of them in one read of the keypad
+// with continue_reading, so group focus, LV_EVENT_KEY and activity work as usual.
+// Opt in with a value > 0 to insert printable keys queued for a text area without
+// event handlers with one lv_textarea_add_text call of up to this many characters
+#ifndef CONFIG_LV_KEYPAD_TEXT_BATCH
+#define CONFIG_LV_KEYPAD_TEXT_BATCH     0
+#endif
+
+typedef enum {
+    LV_HELPER_BUF_AUTO,             // Internal DMA memory on DMA boards, PSRAM otherwise
+    LV_HELPER_BUF_INTERNAL_DMA,     // DMA capable internal SRAM
+    LV_HELPER_BUF_PSRAM,            // PSRAM, flushed directly
+    LV_HELPER_BUF_PSRAM_BOUNCE,     // PSRAM, copied through two small SRAM bounce buffers when flushed
+} lv_helper_buf_caps_t;
+
+typedef struct {
+    uint8_t buffer_count;           // 1, 2 or 3, the third buffer is only used in full refresh mode
+    uint16_t buffer_lines;          // Lines per draw buffer in partial mode, 0 uses the board default
+    lv_helper_buf_caps_t caps;      // Where the draw buffers are allocated
+    uint16_t bounce_lines;          // Lines per bounce buffer with LV_HELPER_BUF_PSRAM_BOUNCE, rounded up to even, at least 2
+    int render_mode;                // lv_display_render_mode_t, -1 uses the board default
+} lv_helper_config_t;
+
+#define LV_HELPER_CONFIG_DEFAULT()  {2, 0, LV_HELPER_BUF_AUTO, 16, -1}
+
+typedef struct {
+    uint8_t buffer_count;           // Draw buffers allocated
+    uint16_t buffer_lines;          // Lines per draw buffer
+    size_t buffer_size;             // Bytes per draw buffer
+    lv_helper_buf_caps_t caps;      // Memory the buffers were allocated from
+    size_t bounce_size;             // Bytes per bounce buffer, 0 without bounce buffers
+    size_t internal_bytes;          // Internal SRAM used by draw and bounce buffers
+    size_t psram_bytes;             // PSRAM used by draw buffers
+    size_t internal_free;           // Internal SRAM still free after allocation
+    int render_mode;                // lv_display_render_mode_t in use
+} lv_helper_mem_info_t;
+
 void beginLvglHelper(LilyGo_Display &display, bool debug = false);
+/**
+ * @brief  Start LVGL with a custom draw buffer configuration. When the requested
+ *         internal memory is not available the buffer is shrunk, then PSRAM is used,
+ *         see lv_get_helper_mem_info() for what was actually obtained.
+ */
+void beginLvglHelper(LilyGo_Display &display, const lv_helper_config_t &config, bool debug = false);
+void lv_get_helper_mem_info(lv_helper_mem_info_t *info);
 void updateLvglHelper();
 
 void lv_set_default_group(lv_group_t *group);
 lv_indev_t *lv_get_touch_indev();
 lv_indev_t *lv_get_keyboard_indev();
-lv_indev_t *lv_get_encoder_indev(); 
+lv_indev_t *lv_get_encoder_indev();
+
+/**
+ * With LV_HELPER_MULTI_CORE set in lv_conf.h lvgl runs with the FreeRTOS OS layer and
+ * two software draw units. The cores are used as follows:
+ *  - Core 0: WiFi/BT stacks and the library interrupt handling tasks.
+ *  - Core 1: the task calling lv_timer_handler, the Arduino loop or the task started
+ *    by lv_helper_start_task. Input read and flush callbacks run here.
+ *  - Draw unit threads are created by lvgl without affinity, the scheduler runs them
+ *    on whichever core is free so one of them mostly renders on core 0.
+ *
+ * lvgl must only be called from another task between lv_helper_lock() and
+ * lv_helper_unlock(). The input read callbacks take this lock around every touch,
+ * encoder and keyboard driver read, also when lv_indev_read() is called outside
+ * lv_timer_handler, so applications reading those devices directly from another
+ * task must hold it too. The lock is recursive. Without LV_HELPER_MULTI_CORE the
+ * lock does nothing.
+ */
+void lv_helper_lock();
+void lv_helper_unlock();
+
+/**
+ * @brief  Run lv_timer_handler, it holds the lvgl lock while it runs.
+ * @retval Time until the next timer has to run in ms.
+ */
+uint32_t lv_helper_timer_handler();
+
+/**
+ * @brief  Run lv_helper_timer_handler in its own task instead of loop().
+ * @param  core Core to pin the task to, see the core usage above
+ */
+bool lv_helper_start_task(BaseType_t core = 1, UBaseType_t priority = 2, uint32_t stack_size = 8 * 1024); 
+
+void lv_get_flush_merge_stats(lv_flush_merge_stats_t *stats);
+void lv_reset_flush_merge_stats();
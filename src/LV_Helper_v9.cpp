@@ -19,6 +19,17 @@ static lv_indev_t   *indev_keyboard;
 
 static lv_color16_t *buf  = NULL;
 static lv_color16_t *buf1  = NULL;
+static lv_color16_t *buf2  = NULL;
+
+// With LV_HELPER_BUF_PSRAM_BOUNCE the areas are copied to these in bands and pushed from SRAM
+static uint16_t *bounce_buf[2] = {NULL, NULL};
+static uint32_t bounce_size = 0;
+static uint8_t bounce_index = 0;
+
+static lv_helper_mem_info_t mem_info;
+
+// Partial buffers are not shrunk below this when internal memory runs out
+#define LV_HELPER_MIN_BUFFER_LINES  10
 
 #if defined(ARDUINO_T_WATCH_S3_ULTRA)
 static lv_color16_t *buf_sw  = NULL;
@@ -33,6 +44,44 @@ static lv_color16_t *buf_sw  = NULL;
 #define _SWAP_COLORS
 #endif
 
+// Set when the display driver cannot swap the bytes during the transfer
+static bool swap_in_flush = false;
+
+static void disp_push(LilyGo_Display *plane, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint16_t *color)
+{
+#if defined(ARDUINO_T_LORA_PAGER) || defined(ARDUINO_T_WATCH_S3_ULTRA)
+    // log_d("x1:%d y1:%d w:%d h:%d", x, y, w, h);
+    plane->pushColors(x, y, w, h, color);
+#else
+    // log_d("x1:%d y1:%d x2:%d y2:%d", x, y, x + w, y + h);
+    plane->pushColors(x, y, x + w, y + h, color);
+#endif
+}
+
+// Copy the area from PSRAM into the bounce buffers in bands of whole lines. The two
+// buffers alternate, pushColors waits for the previous band so the buffer being
+// filled is never the one still being sent.
+static void disp_flush_bounce(LilyGo_Display *plane, const lv_area_t *area, uint16_t *color)
+{
+    uint32_t w = lv_area_get_width(area);
+    uint32_t h = lv_area_get_height(area);
+    // The buffers hold an even number of lines, at least two, of the widest possible
+    // area, so a band is never less than two lines and stays on even lines for the
+    // panels that need aligned areas
+    uint32_t lines = (bounce_size / (w * sizeof(uint16_t))) & ~1UL;
+    for (uint32_t row = 0; row < h; row += lines) {
+        uint32_t n = (h - row) < lines ? (h - row) : lines;
+        uint16_t *dst = bounce_buf[bounce_index];
+        bounce_index ^= 1;
+        memcpy(dst, color, w * n * sizeof(uint16_t));
+        if (swap_in_flush) {
+            lv_draw_sw_rgb565_swap(dst, w * n);
+        }
+        disp_push(plane, area->x1, area->y1 + row, w, n, dst);
+        color += w * n;
+    }
+}
+
 static void disp_flush( lv_display_t *disp_drv, const lv_area_t *area, uint8_t *color_p)
 {
     size_t len = lv_area_get_size(area);
@@ -40,19 +89,32 @@ static void disp_flush( lv_display_t *disp_drv, const lv_area_t *area, uint8_t *
     uint32_t h = lv_area_get_height(area);
     auto *plane = (LilyGo_Display *)lv_display_get_user_data(disp_drv);
 
-#ifdef _SWAP_COLORS
-    lv_draw_sw_rgb565_swap(color_p, len);
-#endif
+    if (bounce_buf[0]) {
+        disp_flush_bounce(plane, area, (uint16_t *)color_p);
+        // The draw buffer has been copied, LVGL can reuse it even if the last band is still being sent
+        lv_display_flush_ready( disp_drv );
+        return;
+    }
 
-#if defined(ARDUINO_T_LORA_PAGER) || defined(ARDUINO_T_WATCH_S3_ULTRA)
-    // log_d("x1:%d y1:%d w:%d h:%d", area->x1, area->y1, w, h);
-    plane->pushColors(area->x1, area->y1, w, h, (uint16_t *)color_p);
-#else
-    // log_d("x1:%d y1:%d x2:%d y2:%d", area->x1, area->y1, area->x2 + 1, area->y2 + 1);
-    plane->pushColors(area->x1, area->y1, area->x2 + 1, area->y2 + 1, (uint16_t *)color_p);
-#endif
+    if (swap_in_flush) {
+        lv_draw_sw_rgb565_swap(color_p, len);
+    }
 
-    lv_display_flush_ready( disp_drv );
+    disp_push(plane, area->x1, area->y1, w, h, (uint16_t *)color_p);
+
+    // In asynchronous mode the display's flush task calls disp_flush_done once the last chunk is sent
+    if (!plane->useAsyncFlush()) {
+        lv_display_flush_ready( disp_drv );
+    }
+}
+
+static void disp_flush_done(void *user_data, uint32_t done_us)
+{
+#if CONFIG_LV_INPUT_LATENCY
+    // Stamped when the last chunk finished, not when this task got to run
+    lv_input_latency_flush_ready(done_us);
+#endif
+    lv_display_flush_ready((lv_display_t *)user_data);
 }
 
 #ifdef USING_INPUT_DEV_TOUCHPAD
@@ -60,11 +122,18 @@ static void touchpad_read( lv_indev_t *drv, lv_indev_data_t *data )
 {
     static int16_t x, y;
     auto *plane = (LilyGo_Display *)lv_indev_get_user_data(drv);
+    // The lvgl lock is recursive, this only blocks when lv_indev_read runs outside
+    // lv_timer_handler while another task reads the driver under lv_helper_lock()
+    lv_helper_lock();
     uint8_t touched = plane->getPoint(&x, &y, 1);
+    lv_helper_unlock();
     if ( touched ) {
         data->point.x = x;
         data->point.y = y;
         data->state = LV_INDEV_STATE_PR;
+#if CONFIG_LV_INPUT_LATENCY
+        lv_input_latency_mark(LV_INPUT_LATENCY_POINTER, plane->getPointTime());
+#endif
         return;
     }
     data->state = LV_INDEV_STATE_REL;
@@ -74,47 +143,104 @@ static void touchpad_read( lv_indev_t *drv, lv_indev_data_t *data )
 #ifdef USING_INPUT_DEV_ROTARY
 static void lv_encoder_read(lv_indev_t *drv, lv_indev_data_t *data)
 {
-    static uint8_t last_dir = 0;
     auto *plane = (LilyGo_Display *)lv_indev_get_user_data(drv);
+    // Returns immediately with all steps since the last poll
+    lv_helper_lock();
     RotaryMsg_t msg =  plane->getRotary();
-    switch (msg.dir) {
-    case ROTARY_DIR_UP:
-        data->enc_diff = 1;
-        break;
-    case ROTARY_DIR_DOWN:
-        data->enc_diff = -1;
-        break;
-    default:
-        data->state = LV_INDEV_STATE_RELEASED;
-        break;
-    }
-    if (msg.centerBtnPressed) {
-        data->state = LV_INDEV_STATE_PRESSED;
-    }
+    lv_helper_unlock();
+    data->enc_diff = msg.diff;
+    data->state = msg.centerBtnPressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
 
-    if (last_dir != msg.dir || msg.centerBtnPressed) {
+    if (msg.diff != 0 || msg.centerBtnPressed) {
+#if CONFIG_LV_INPUT_LATENCY
+        lv_input_latency_mark(LV_INPUT_LATENCY_ENCODER, msg.time_us);
+#endif
         plane->feedback((void *)drv);
     }
 }
 #endif //USING_INPUT_DEV_ROTARY
 
 #ifdef USING_INPUT_DEV_KEYBOARD
+#if CONFIG_LV_KEYPAD_TEXT_BATCH > 0
+// Text area that receives the keys, NULL when something else is focused. A text area
+// with event handlers gets every key through lvgl so LV_EVENT_KEY still reaches them
+static lv_obj_t *keypad_text_target(lv_indev_t *drv)
+{
+    lv_group_t *group = lv_indev_get_group(drv);
+    lv_obj_t *obj = group ? lv_group_get_focused(group) : NULL;
+    if (obj && lv_obj_check_type(obj, &lv_textarea_class) && lv_obj_get_event_count(obj) == 0) {
+        return obj;
+    }
+    return NULL;
+}
+#endif
+
+// The key queue has a single consumer, other tasks taking keys must hold lv_helper_lock()
+static int keypad_get_key(LilyGo_Display *plane, char *c)
+{
+    lv_helper_lock();
+    int state = plane->getKeyChar(c);
+    lv_helper_unlock();
+    return state;
+}
+
 static void keypad_read(lv_indev_t *drv, lv_indev_data_t *data)
 {
     static uint32_t last_key = 0;
     uint32_t act_key ;
     char c = '\0';
     auto *plane = (LilyGo_Display *)lv_indev_get_user_data(drv);
-    int state = plane->getKeyChar(&c);
+#if CONFIG_LV_KEYPAD_TEXT_BATCH > 0
+    // Insert a run of characters at once, the text is laid out and invalidated
+    // once instead of once per key
+    char text[CONFIG_LV_KEYPAD_TEXT_BATCH + 1];
+    uint32_t len = 0;
+    lv_obj_t *ta = keypad_text_target(drv);
+    int state;
+    while ((state = keypad_get_key(plane, &c)) != -1) {
+        if (state != KEYBOARD_PRESSED) {
+            continue;
+        }
+        if (ta && c >= ' ' && c < 0x7F) {
+            text[len++] = c;
+            if (len == CONFIG_LV_KEYPAD_TEXT_BATCH) {
+                text[len] = '\0';
+                lv_textarea_add_text(ta, text);
+                lv_display_trigger_activity(NULL);
+                len = 0;
+            }
+            continue;
+        }
+        break;
+    }
+    if (len) {
+        text[len] = '\0';
+        lv_textarea_add_text(ta, text);
+        // lvgl did not see these presses, keep the inactivity timer from blanking the screen
+        lv_display_trigger_activity(NULL);
+#if CONFIG_LV_INPUT_LATENCY
+        lv_input_latency_mark(LV_INPUT_LATENCY_KEYPAD, plane->getKeyTime());
+#endif
+        plane->feedback((void *)drv);
+    }
+#else
+    int state = keypad_get_key(plane, &c);
+#endif
     if (state == KEYBOARD_PRESSED) {
         act_key = c;
         data->key = act_key;
         data->state = LV_INDEV_STATE_PR;
+#if CONFIG_LV_INPUT_LATENCY
+        lv_input_latency_mark(LV_INPUT_LATENCY_KEYPAD, plane->getKeyTime());
+#endif
         plane->feedback((void *)drv);
+        // Read the following queued events in the same handler run
+        data->continue_reading = true;
         return;
     }
     data->state = LV_INDEV_STATE_REL;
     data->key = last_key;
+    data->continue_reading = (state == KEYBOARD_RELEASED);
 }
 #endif //USING_INPUT_DEV_KEYBOARD
 
@@ -147,23 +273,112 @@ static void lv_rounder_cb(lv_event_t *e)
         area->y2++;
 }
 
+static lv_flush_merge_stats_t merge_stats;
+
+// Grow the new area over already invalidated areas when the pixels added by the
+// bounding box cost less than the address window setup of a separate flush. lvgl
+// skips or joins the covered areas in its own join pass before rendering
+static void lv_merge_area_cb(lv_event_t *e)
+{
+    lv_area_t *area = (lv_area_t *)lv_event_get_param(e);
+    lv_display_t *disp = (lv_display_t *)lv_event_get_current_target(e);
+    uint32_t max_px = disp->buf_1 ? disp->buf_1->data_size / sizeof(lv_color16_t) : 0;
+    lv_flush_merge_area(area, disp->inv_areas, disp->inv_p, CONFIG_LV_FLUSH_MERGE_COST_PX,
+                        max_px, &merge_stats);
+}
+
+void lv_get_flush_merge_stats(lv_flush_merge_stats_t *stats)
+{
+    if (stats) {
+        *stats = merge_stats;
+    }
+}
+
+void lv_reset_flush_merge_stats()
+{
+    memset(&merge_stats, 0, sizeof(merge_stats));
+}
+
 static void lv_res_changed_cb(lv_event_t *e)
 {
     auto *plane = (LilyGo_Display *)lv_event_get_user_data(e);
     plane->setRotation(lv_display_get_rotation(NULL));
 }
 
+#if CONFIG_LV_FRAME_STATS
+static void lv_frame_stats_wait_cb(uint32_t *te_wait_us, uint32_t *bus_wait_us, void *user_data)
+{
+    auto *plane = (LilyGo_Display *)user_data;
+    plane->getFlushWaitTime(te_wait_us, bus_wait_us);
+}
+#endif
+
 static void lv_display_flush_wait_callback(lv_display_t *disp)
 {
-    log_d("flush disp finish");
+    auto *plane = (LilyGo_Display *)lv_display_get_user_data(disp);
+    // Block until the display has completed the flush instead of spinning on the flushing flag
+    plane->waitFlushDone();
+}
+
+
+static void *lv_helper_alloc(size_t size, lv_helper_buf_caps_t caps)
+{
+    if (caps == LV_HELPER_BUF_INTERNAL_DMA) {
+        return heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    }
+    return ps_malloc(size);
 }
 
+static void lv_helper_free_buffers()
+{
+    free(buf);
+    free(buf1);
+    free(buf2);
+    buf = buf1 = buf2 = NULL;
+}
+
+// Allocate the draw buffers, shrinking partial buffers and falling back to PSRAM
+// when the internal memory is not available
+static bool lv_helper_alloc_buffers(uint8_t count, uint32_t width, uint32_t &lines, lv_helper_buf_caps_t &caps, bool partial)
+{
+    for (;;) {
+        size_t size = width * lines * sizeof(lv_color16_t);
+        buf = (lv_color16_t *)lv_helper_alloc(size, caps);
+        buf1 = count > 1 ? (lv_color16_t *)lv_helper_alloc(size, caps) : NULL;
+        buf2 = count > 2 ? (lv_color16_t *)lv_helper_alloc(size, caps) : NULL;
+        if (buf && (count < 2 || buf1) && (count < 3 || buf2)) {
+            return true;
+        }
+        lv_helper_free_buffers();
+        if (caps != LV_HELPER_BUF_INTERNAL_DMA) {
+            return false;
+        }
+        if (partial && lines / 2 >= LV_HELPER_MIN_BUFFER_LINES) {
+            lines /= 2;
+            log_d("Not enough DMA memory, shrink draw buffers to %u lines", lines);
+            continue;
+        }
+        log_e("Not enough DMA memory, allocate draw buffers from PSRAM");
+        caps = LV_HELPER_BUF_PSRAM;
+    }
+}
 
 void beginLvglHelper(LilyGo_Display &board, bool debug)
+{
+    lv_helper_config_t config = LV_HELPER_CONFIG_DEFAULT();
+    beginLvglHelper(board, config, debug);
+}
+
+void beginLvglHelper(LilyGo_Display &board, const lv_helper_config_t &config, bool debug)
 {
 
 #ifdef _SWAP_COLORS
-    log_d("Using color swap function");
+    if (board.setSwapBytes(true)) {
+        log_d("Using display driver color swap");
+    } else {
+        log_d("Using color swap function");
+        swap_in_flush = true;
+    }
 #endif
 
     lv_init();
@@ -178,42 +393,110 @@ void beginLvglHelper(LilyGo_Display &board, bool debug)
 
     bool useDMA = board.useDMA();
 
-    size_t lv_buffer_size = board.width() * board.height() * sizeof(lv_color16_t);
+    lv_display_render_mode_t render_mode = board.needFullRefresh() ? LV_DISPLAY_RENDER_MODE_FULL : LV_DISPLAY_RENDER_MODE_PARTIAL;
+    if (config.render_mode == LV_DISPLAY_RENDER_MODE_PARTIAL || config.render_mode == LV_DISPLAY_RENDER_MODE_FULL) {
+        render_mode = (lv_display_render_mode_t)config.render_mode;
+    } else if (config.render_mode >= 0) {
+        log_e("Render mode %d is not supported, using the board default", config.render_mode);
+    }
+    bool partial = render_mode == LV_DISPLAY_RENDER_MODE_PARTIAL;
 
-    if (useDMA) {
+    uint8_t buffer_count = config.buffer_count;
+    if (buffer_count < 1 || buffer_count > 3) {
+        buffer_count = 2;
+    }
+    if (buffer_count == 3 && partial) {
+        log_d("The third draw buffer is only used in full refresh mode");
+        buffer_count = 2;
+    }
 
-        log_d("Using DMA pushColors..");
+    lv_helper_buf_caps_t caps = config.caps;
+    if (caps == LV_HELPER_BUF_AUTO) {
+        caps = useDMA ? LV_HELPER_BUF_INTERNAL_DMA : LV_HELPER_BUF_PSRAM;
+    }
 
-        lv_buffer_size = (board.width() * board.height() / 6) * sizeof(lv_color16_t);
+    uint32_t lines = board.height();
+    if (partial) {
+        if (config.buffer_lines) {
+            lines = config.buffer_lines < board.height() ? config.buffer_lines : board.height();
+        } else if (useDMA) {
+            lines = board.height() / 6;
+        }
+    }
 
-        // lv_buffer_size = (board.width() * board.height() / 10) * sizeof(lv_color16_t);
+    log_d("Using %s pushColors..", useDMA ? "DMA" : "Not DMA");
 
-        buf = (lv_color16_t *)heap_caps_malloc(lv_buffer_size, MALLOC_CAP_DMA);
-        assert(buf);
-        buf1 = (lv_color16_t *)heap_caps_malloc(lv_buffer_size, MALLOC_CAP_DMA);
-        assert(buf1);
+    bool bounce = caps == LV_HELPER_BUF_PSRAM_BOUNCE;
+    lv_helper_buf_caps_t buf_caps = bounce ? LV_HELPER_BUF_PSRAM : caps;
+    if (!lv_helper_alloc_buffers(buffer_count, board.width(), lines, buf_caps, partial)) {
+        log_e("Draw buffers malloc failed!");
+        assert(0);
+    }
+    size_t lv_buffer_size = board.width() * lines * sizeof(lv_color16_t);
 
-        if (!esp_ptr_dma_capable(buf) || !esp_ptr_dma_capable(buf1)) {
+    if (buf_caps == LV_HELPER_BUF_INTERNAL_DMA) {
+        if (!esp_ptr_dma_capable(buf) || (buf1 && !esp_ptr_dma_capable(buf1))) {
             log_e("Error: Buffers are not DMA-capable!");
         }
+    }
+
+    memset(&mem_info, 0, sizeof(mem_info));
+    if (bounce) {
+        uint32_t bounce_lines = config.bounce_lines ? config.bounce_lines : 16;
+        // At least two lines and rounded up to even, see disp_flush_bounce
+        if (bounce_lines < 2) {
+            bounce_lines = 2;
+        }
+        bounce_lines = (bounce_lines + 1) & ~1U;
+        // Sized for the longer side, the area can be that wide after a rotation
+        uint32_t bounce_width = board.width() > board.height() ? board.width() : board.height();
+        bounce_size = bounce_width * bounce_lines * sizeof(uint16_t);
+        bounce_buf[0] = (uint16_t *)heap_caps_malloc(bounce_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        bounce_buf[1] = (uint16_t *)heap_caps_malloc(bounce_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!bounce_buf[0] || !bounce_buf[1]) {
+            log_e("Bounce buffers malloc failed, flushing directly from PSRAM");
+            heap_caps_free(bounce_buf[0]);
+            heap_caps_free(bounce_buf[1]);
+            bounce_buf[0] = bounce_buf[1] = NULL;
+            bounce_size = 0;
+        } else {
+            buf_caps = LV_HELPER_BUF_PSRAM_BOUNCE;
+        }
+        mem_info.bounce_size = bounce_size;
+        mem_info.internal_bytes += bounce_size * 2;
+    }
 
+    mem_info.buffer_count = buffer_count;
+    mem_info.buffer_lines = lines;
+    mem_info.buffer_size = lv_buffer_size;
+    mem_info.caps = buf_caps;
+    mem_info.render_mode = render_mode;
+    if (buf_caps == LV_HELPER_BUF_INTERNAL_DMA) {
+        mem_info.internal_bytes += lv_buffer_size * buffer_count;
     } else {
-        log_d("Using Not DMA pushColors..");
-        buf = (lv_color16_t *)ps_malloc(lv_buffer_size);
-        assert(buf);
-        buf1 = (lv_color16_t *)ps_malloc(lv_buffer_size);
-        assert(buf1);
+        mem_info.psram_bytes += lv_buffer_size * buffer_count;
     }
+    mem_info.internal_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    log_d("lv draw buffers: %u x %u bytes, %u lines, internal %u bytes, psram %u bytes",
+          buffer_count, lv_buffer_size, lines, mem_info.internal_bytes, mem_info.psram_bytes);
 
     disp_drv = lv_display_create(board.width(), board.height());
 
-    if (board.needFullRefresh()) {
-        log_d("lv set double buffer and full refresh");
-        lv_display_set_buffers(disp_drv, buf, buf1, lv_buffer_size, LV_DISPLAY_RENDER_MODE_FULL);
-    } else {
-        log_d("lv set double buffer and partial refresh");
-        lv_display_set_buffers(disp_drv, buf, buf1, lv_buffer_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_set_buffers(disp_drv, buf, buf1, lv_buffer_size, render_mode);
+    if (partial) {
+        log_d("lv set partial refresh");
         lv_display_add_event_cb(disp_drv, lv_rounder_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+#if CONFIG_LV_FLUSH_MERGE_COST_PX > 0
+        // Must run after the rounder so the merged areas stay aligned
+        lv_display_add_event_cb(disp_drv, lv_merge_area_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+#endif
+    } else {
+        log_d("lv set full refresh");
+        if (buf2) {
+            lv_draw_buf_init(&draw_buf, board.width(), board.height(), LV_COLOR_FORMAT_RGB565,
+                             LV_STRIDE_AUTO, buf2, lv_buffer_size);
+            lv_display_set_3rd_draw_buffer(disp_drv, &draw_buf);
+        }
     }
     lv_display_set_color_format(disp_drv, LV_COLOR_FORMAT_RGB565);
     lv_display_set_flush_cb(disp_drv, disp_flush);
@@ -234,6 +517,23 @@ void beginLvglHelper(LilyGo_Display &board, bool debug)
     */
     lv_display_set_flush_wait_cb(disp_drv, lv_display_flush_wait_callback);
 
+    // With bounce buffers disp_flush is ready once the last band is copied, the
+    // driver would otherwise signal once per band
+    bool async_flush = board.useAsyncFlush() && !bounce_buf[0];
+    if (async_flush) {
+        log_d("Using asynchronous flush");
+        board.setFlushDoneCallback(disp_flush_done, disp_drv);
+    }
+
+#if CONFIG_LV_FRAME_STATS
+    lv_frame_stats_attach(disp_drv);
+    lv_frame_stats_set_wait_cb(lv_frame_stats_wait_cb, &board);
+#endif
+
+#if CONFIG_LV_INPUT_LATENCY
+    lv_input_latency_attach(disp_drv, async_flush);
+#endif
+
 
 #ifdef USING_INPUT_DEV_TOUCHPAD
     if (board.hasTouch()) {
@@ -370,5 +670,48 @@ lv_indev_t *lv_get_encoder_indev()
     return indev_encoder;
 }
 
+void lv_helper_lock()
+{
+#if LV_USE_OS
+    lv_lock();
+#endif
+}
+
+void lv_helper_unlock()
+{
+#if LV_USE_OS
+    lv_unlock();
+#endif
+}
+
+uint32_t lv_helper_timer_handler()
+{
+    // lv_timer_handler takes the lvgl lock itself
+    return lv_timer_handler();
+}
+
+static void lv_helper_task(void *args)
+{
+    for (;;) {
+        uint32_t next = lv_helper_timer_handler();
+        if (next == LV_NO_TIMER_READY || next > 10) {
+            next = 10;
+        }
+        vTaskDelay(pdMS_TO_TICKS(next ? next : 1));
+    }
+}
+
+bool lv_helper_start_task(BaseType_t core, UBaseType_t priority, uint32_t stack_size)
+{
+    return xTaskCreatePinnedToCore(lv_helper_task, "lvgl", stack_size, NULL, priority, NULL, core) == pdPASS;
+}
+
+void lv_get_helper_mem_info(lv_helper_mem_info_t *info)
+{
+    if (info) {
+        *info = mem_info;
+    }
+}
+
 #endif
 
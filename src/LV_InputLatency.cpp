@@ -0,0 +1,250 @@
+/**
+ * @file      LV_InputLatency.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-20
+ *
+ */
+#include "LV_InputLatency.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if LVGL_VERSION_MAJOR == 9
+
+#ifdef ARDUINO
+#include "esp_timer.h"
+uint32_t lv_input_latency_now_us()
+{
+    return (uint32_t)esp_timer_get_time();
+}
+#else
+#include <chrono>
+uint32_t lv_input_latency_now_us()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+typedef struct {
+    bool active;
+    bool tagged;                // 'area' holds what the input invalidated
+    uint8_t age;                // Refresh cycles waited without an invalidated area
+    uint32_t input_us;
+    volatile uint32_t done_us;  // Completion of the last flush covering 'area'
+    lv_area_t area;
+} input_latency_track_t;
+
+typedef struct {
+    uint32_t history[CONFIG_LV_INPUT_LATENCY_HISTORY];
+    uint32_t count;
+    uint32_t no_redraw;
+    uint32_t max_us;
+} input_latency_record_t;
+
+static const char *const type_names[LV_INPUT_LATENCY_TYPES] = {"keypad", "encoder", "pointer"};
+
+// Waiting for the next frame, and in the frame being rendered and flushed
+static input_latency_track_t pending[LV_INPUT_LATENCY_TYPES];
+static input_latency_track_t rendering[LV_INPUT_LATENCY_TYPES];
+static input_latency_record_t records[LV_INPUT_LATENCY_TYPES];
+
+static lv_area_t flush_area;
+static volatile bool flushing = false;
+
+static void input_latency_record(lv_input_latency_type_t type, uint32_t latency_us)
+{
+    input_latency_record_t &r = records[type];
+    r.history[r.count % CONFIG_LV_INPUT_LATENCY_HISTORY] = latency_us;
+    r.count++;
+    if (latency_us > r.max_us) {
+        r.max_us = latency_us;
+    }
+}
+
+// Plain comparison, also called from the flush done interrupt
+static inline bool input_latency_overlap(const lv_area_t *a, const lv_area_t *b)
+{
+    return a->x1 <= b->x2 && b->x1 <= a->x2 && a->y1 <= b->y2 && b->y1 <= a->y2;
+}
+
+static void input_latency_refr_start()
+{
+    // The last flush of the previous frame is still on the bus, look again next cycle
+    if (flushing) {
+        return;
+    }
+    for (int t = 0; t < LV_INPUT_LATENCY_TYPES; t++) {
+        input_latency_track_t &r = rendering[t];
+        if (r.active) {
+            if (r.done_us) {
+                input_latency_record((lv_input_latency_type_t)t, r.done_us - r.input_us);
+            } else {
+                // Invalidated but hidden, e.g. behind another object
+                records[t].no_redraw++;
+            }
+            r.active = false;
+        }
+        input_latency_track_t &p = pending[t];
+        if (!p.active) {
+            continue;
+        }
+        if (p.tagged) {
+            r = p;
+            r.done_us = 0;
+            p.active = false;
+        } else if (++p.age > CONFIG_LV_INPUT_LATENCY_MAX_AGE) {
+            records[t].no_redraw++;
+            p.active = false;
+        }
+    }
+}
+
+static void input_latency_invalidate(lv_display_t *disp, const lv_area_t *area)
+{
+    lv_area_t full;
+    if (!area) {
+        lv_area_set(&full, 0, 0, lv_display_get_horizontal_resolution(disp) - 1,
+                    lv_display_get_vertical_resolution(disp) - 1);
+        area = &full;
+    }
+    for (int t = 0; t < LV_INPUT_LATENCY_TYPES; t++) {
+        input_latency_track_t &p = pending[t];
+        if (!p.active) {
+            continue;
+        }
+        if (p.tagged) {
+            lv_area_join(&p.area, &p.area, area);
+        } else {
+            p.area = *area;
+            p.tagged = true;
+        }
+    }
+}
+
+void lv_input_latency_flush_ready(uint32_t done_us)
+{
+    uint32_t now = done_us ? done_us : lv_input_latency_now_us();
+    for (int t = 0; t < LV_INPUT_LATENCY_TYPES; t++) {
+        input_latency_track_t &r = rendering[t];
+        if (r.active && input_latency_overlap(&r.area, &flush_area)) {
+            r.done_us = now;
+        }
+    }
+    flushing = false;
+}
+
+static void input_latency_event_cb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e)) {
+    case LV_EVENT_REFR_START:
+        input_latency_refr_start();
+        break;
+    case LV_EVENT_INVALIDATE_AREA:
+        input_latency_invalidate((lv_display_t *)lv_event_get_current_target(e),
+                                 (const lv_area_t *)lv_event_get_param(e));
+        break;
+    case LV_EVENT_FLUSH_START: {
+        const lv_area_t *area = (const lv_area_t *)lv_event_get_param(e);
+        if (area) {
+            flush_area = *area;
+            flushing = true;
+        }
+        break;
+    }
+    case LV_EVENT_FLUSH_FINISH:
+        // Registered only when the flush callback returns after the transfer
+        lv_input_latency_flush_ready();
+        break;
+    default:
+        break;
+    }
+}
+
+void lv_input_latency_attach(lv_display_t *disp, bool async_flush)
+{
+    lv_display_add_event_cb(disp, input_latency_event_cb, LV_EVENT_REFR_START, NULL);
+    // Added last so the area is seen after rounding and merging
+    lv_display_add_event_cb(disp, input_latency_event_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_display_add_event_cb(disp, input_latency_event_cb, LV_EVENT_FLUSH_START, NULL);
+    if (!async_flush) {
+        lv_display_add_event_cb(disp, input_latency_event_cb, LV_EVENT_FLUSH_FINISH, NULL);
+    }
+}
+
+void lv_input_latency_mark(lv_input_latency_type_t type, uint32_t input_us)
+{
+    // 0 is an input without timestamp
+    if (type >= LV_INPUT_LATENCY_TYPES || input_us == 0) {
+        return;
+    }
+    input_latency_track_t &p = pending[type];
+    if (p.active) {
+        return;
+    }
+    memset(&p, 0, sizeof(p));
+    p.active = true;
+    p.input_us = input_us;
+}
+
+static int input_latency_compare(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+void lv_input_latency_get_summary(lv_input_latency_type_t type, lv_input_latency_summary_t *summary)
+{
+    memset(summary, 0, sizeof(*summary));
+    if (type >= LV_INPUT_LATENCY_TYPES) {
+        return;
+    }
+    const input_latency_record_t &r = records[type];
+    summary->count = r.count;
+    summary->no_redraw = r.no_redraw;
+    summary->max_us = r.max_us;
+    uint32_t n = r.count < CONFIG_LV_INPUT_LATENCY_HISTORY ? r.count : CONFIG_LV_INPUT_LATENCY_HISTORY;
+    if (n == 0) {
+        return;
+    }
+    uint32_t sorted[CONFIG_LV_INPUT_LATENCY_HISTORY];
+    memcpy(sorted, r.history, n * sizeof(uint32_t));
+    qsort(sorted, n, sizeof(uint32_t), input_latency_compare);
+    summary->p50_us = sorted[(n - 1) * 50 / 100];
+    summary->p90_us = sorted[(n - 1) * 90 / 100];
+    summary->p99_us = sorted[(n - 1) * 99 / 100];
+}
+
+void lv_input_latency_reset()
+{
+    memset(pending, 0, sizeof(pending));
+    memset(rendering, 0, sizeof(rendering));
+    memset(records, 0, sizeof(records));
+}
+
+static void input_latency_print_default(const char *line)
+{
+    printf("%s\n", line);
+}
+
+void lv_input_latency_dump(lv_frame_stats_print_cb_t print)
+{
+    if (!print) {
+        print = input_latency_print_default;
+    }
+    char line[128];
+    print("latency,type,count,no_redraw,p50_us,p90_us,p99_us,max_us");
+    for (int t = 0; t < LV_INPUT_LATENCY_TYPES; t++) {
+        lv_input_latency_summary_t s;
+        lv_input_latency_get_summary((lv_input_latency_type_t)t, &s);
+        snprintf(line, sizeof(line), "latency,%s,%lu,%lu,%lu,%lu,%lu,%lu", type_names[t],
+                 (unsigned long)s.count, (unsigned long)s.no_redraw, (unsigned long)s.p50_us,
+                 (unsigned long)s.p90_us, (unsigned long)s.p99_us, (unsigned long)s.max_us);
+        print(line);
+    }
+}
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * @file      LV_InputLatency.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-20
+ * @note      Input to photon latency built on the lvgl 9 display events.
+ *            An input stamped in its interrupt is followed through the areas it
+ *            invalidates until the flush covering them completes on the panel.
+ *            Does not depend on Arduino, add LV_InputLatency.cpp to the simulator
+ *            sources and call lv_input_latency_mark() from the simulated input devices.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <lvgl.h>
+#include "LV_FrameStats.h"
+
+// Latencies kept per input type for the percentiles
+#ifndef CONFIG_LV_INPUT_LATENCY_HISTORY
+#define CONFIG_LV_INPUT_LATENCY_HISTORY     128
+#endif
+
+// Refresh cycles an input may wait for an invalidated area before it counts as no redraw
+#ifndef CONFIG_LV_INPUT_LATENCY_MAX_AGE
+#define CONFIG_LV_INPUT_LATENCY_MAX_AGE     3
+#endif
+
+typedef enum {
+    LV_INPUT_LATENCY_KEYPAD,
+    LV_INPUT_LATENCY_ENCODER,
+    LV_INPUT_LATENCY_POINTER,
+    LV_INPUT_LATENCY_TYPES,
+} lv_input_latency_type_t;
+
+typedef struct {
+    uint32_t count;             // Inputs that reached the panel
+    uint32_t no_redraw;         // Inputs that did not change any pixel
+    uint32_t p50_us;            // Percentiles of the last CONFIG_LV_INPUT_LATENCY_HISTORY inputs
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;            // Since start or reset
+} lv_input_latency_summary_t;
+
+/**
+ * @brief  Start measuring on a display.
+ * @param  disp The display
+ * @param  async_flush true if the flush callback returns before the pixels are sent,
+ *         the driver then calls lv_input_latency_flush_ready() when they are,
+ *         passing the time the last pixel was sent
+ */
+void lv_input_latency_attach(lv_display_t *disp, bool async_flush);
+
+/**
+ * @brief  Report an input read by an input device.
+ *         Only the oldest input of each type not yet on the panel is followed,
+ *         later ones until then would only measure the same frame.
+ * @param  type Input type
+ * @param  input_us Time the input happened, on the clock of lv_input_latency_now_us()
+ */
+void lv_input_latency_mark(lv_input_latency_type_t type, uint32_t input_us);
+
+/**
+ * @brief  The pixels of the last flush reached the panel. Call it from a task, not from an
+ *         interrupt, and before lv_display_flush_ready() lets LVGL start the next flush.
+ * @param  done_us Time the last pixel was sent on the clock of lv_input_latency_now_us(),
+ *         0 uses the current time
+ */
+void lv_input_latency_flush_ready(uint32_t done_us = 0);
+
+uint32_t lv_input_latency_now_us();
+
+void lv_input_latency_get_summary(lv_input_latency_type_t type, lv_input_latency_summary_t *summary);
+void lv_input_latency_reset();
+
+/**
+ * @brief  Print one CSV line per input type,
+ *         "latency,<type>,count,no_redraw,p50_us,p90_us,p99_us,max_us".
+ * @param  print Line output, NULL uses printf
+ */
+void lv_input_latency_dump(lv_frame_stats_print_cb_t print);
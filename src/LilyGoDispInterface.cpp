@@ -7,10 +7,12 @@
  *
  */
 #include "LilyGoDispInterface.h"
+#include "LilyGoDispSwap.h"
 #include <Arduino.h>
-#include <vector>
+#include "esp_timer.h"
 #include <bsp_lcd/esp_lcd_st7796.h>
 
+#define DISP_CMD_NOP          (0x00) // No operation
 #define DISP_CMD_MADCTL       (0x36) // Memory data access control
 #define DISP_CMD_CASET        (0x2A) // Set column address
 #define DISP_CMD_RASET        (0x2B) // Set row address
@@ -29,6 +31,9 @@
 
 #define SEND_BUF_SIZE        (16384)
 
+// TE pulses further apart than this are not used to measure the refresh period
+#define DISP_TE_MAX_PERIOD_US   (100000)
+
 
 #ifdef ARDUINO_T_LORA_PAGER
 #define SPI_DEV_HOST_ID     SPI2_HOST
@@ -38,6 +43,8 @@
 
 void LilyGoDispQSPI::end()
 {
+    waitFlushDone();
+    stopFlushTask();
     spi_bus_remove_device(_spi_dev);
     spi_bus_free(SPI_DEV_HOST_ID);
 }
@@ -48,13 +55,104 @@ void LilyGoDispQSPI::setGapOffset(uint16_t gap_x, uint16_t gap_y)
     _offset_y = gap_y;
 }
 
-static volatile bool disp_tearing_effect = false;
-static volatile uint8_t frame_count = 0;
+static SemaphoreHandle_t disp_te_sem = NULL;
+static volatile uint32_t disp_te_count = 0;
+static volatile uint32_t disp_te_last_us = 0;
+static volatile uint32_t disp_te_period_us = 0;
 
 static  void ICACHE_RAM_ATTR disp_te_isr()
 {
-    disp_tearing_effect = true;
-    frame_count++;
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    uint32_t period = now - disp_te_last_us;
+    // Ignore the first pulse and long gaps such as display sleep
+    if (disp_te_last_us != 0 && period < DISP_TE_MAX_PERIOD_US) {
+        disp_te_period_us = disp_te_period_us ? (disp_te_period_us * 7 + period) / 8 : period;
+    }
+    disp_te_last_us = now;
+    disp_te_count++;
+
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(disp_te_sem, &xHigherPriorityTaskWoken);
+    if (xHigherPriorityTaskWoken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// Estimate from the time since the last TE pulse whether the area can be written
+// now without the panel scanning over lines that are only partially updated.
+bool LilyGoDispQSPI::canWriteMidFrame(uint16_t y, uint16_t w, uint16_t h)
+{
+    uint32_t period = disp_te_period_us;
+    if (period == 0 || _freq_mhz == 0 || height == 0) {
+        return false;
+    }
+    uint32_t elapsed = (uint32_t)esp_timer_get_time() - disp_te_last_us;
+    if (elapsed >= period) {
+        // TE is late, the beam position is unknown
+        return false;
+    }
+
+    float line_us = (float)period / height;
+    float beam = elapsed / line_us;
+    // Panel rows covered by the area, the scan always runs from panel row 0 downwards
+    float top = _mirror_y ? (float)(height - y - h) : (float)y;
+    float bottom = top + h;
+    // QSPI sends one RGB565 pixel every 4 clocks
+    float pixel_us = 4.0f / _freq_mhz;
+    float write_us = pixel_us * w * h;
+
+    if (beam >= bottom) {
+        // Behind the beam: the write must finish before the next scan comes back to the top of the area
+        return write_us < (period - elapsed) + top * line_us;
+    }
+    if (beam < top) {
+        // Ahead of the beam: every line must be written before the beam reaches it.
+        // When mirrored the rows are written bottom-up, so the whole area must be done first.
+        if (_mirror_y) {
+            return write_us < (top - beam) * line_us;
+        }
+        return pixel_us * w < (top - beam) * line_us && write_us < (bottom - beam) * line_us;
+    }
+    return false;
+}
+
+void LilyGoDispQSPI::waitTearingEffect(uint16_t y, uint16_t w, uint16_t h)
+{
+    if (!_use_tearing_effect || !disp_te_sem) {
+        return;
+    }
+    if (canWriteMidFrame(y, w, h)) {
+        _te_stats.mid_frame_starts++;
+        return;
+    }
+    // Drop a pulse that is already pending, the write has to start at the top of a new frame
+    xSemaphoreTake(disp_te_sem, 0);
+
+    uint32_t start = (uint32_t)esp_timer_get_time();
+    if (xSemaphoreTake(disp_te_sem, pdMS_TO_TICKS(CONFIG_DISP_TE_TIMEOUT_MS)) != pdTRUE) {
+        _te_stats.missed_vsync++;
+    }
+    uint32_t wait_us = (uint32_t)esp_timer_get_time() - start;
+    _te_stats.te_waits++;
+    _te_stats.te_wait_us += wait_us;
+    if (wait_us > _te_stats.te_wait_max_us) {
+        _te_stats.te_wait_max_us = wait_us;
+    }
+}
+
+void LilyGoDispQSPI::getTearingEffectStats(DispTearingEffectStats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    *stats = _te_stats;
+    stats->te_count = disp_te_count;
+    stats->frame_period_us = disp_te_period_us;
+}
+
+void LilyGoDispQSPI::resetTearingEffectStats()
+{
+    memset(&_te_stats, 0, sizeof(_te_stats));
 }
 
 bool LilyGoDispQSPI:: init(int rst, int cs, int te, int sck, int d0, int d1, int d2, int d3,  uint32_t freq_Mhz)
@@ -65,8 +163,13 @@ bool LilyGoDispQSPI:: init(int rst, int cs, int te, int sck, int d0, int d1, int
 
     pinMode(cs, OUTPUT);
 
+    _freq_mhz = freq_Mhz;
+
     if (_use_tearing_effect) {
         if (te != -1) {
+            if (!disp_te_sem) {
+                disp_te_sem = xSemaphoreCreateBinary();
+            }
             attachInterrupt(te, disp_te_isr, RISING);
         }
     }
@@ -104,9 +207,9 @@ bool LilyGoDispQSPI:: init(int rst, int cs, int te, int sck, int d0, int d1, int
         .clock_speed_hz = static_cast<int>(freq_Mhz * 1000U * 1000U),
         .spics_io_num = -1,
         .flags = SPI_DEVICE_HALFDUPLEX,
-        .queue_size = 17,
+        .queue_size = CONFIG_QSPI_TRANS_QUEUE_SIZE,
         .pre_cb = NULL,
-        .post_cb = NULL,
+        .post_cb = post_transfer_cb,
     };
     esp_err_t ret = spi_bus_initialize(SPI_DEV_HOST_ID, &spi_config, SPI_DMA_CH_AUTO);
     if (ret != ESP_OK) {
@@ -131,8 +234,7 @@ bool LilyGoDispQSPI:: init(int rst, int cs, int te, int sck, int d0, int d1, int
 
     setRotation(0);
 
-    std::vector<uint16_t> draw_buf(width * height * 2, 0x0);
-    pushColors(0, 0, width, height, draw_buf.data());
+    fillRect(0, 0, width, height, 0x0000);
 
     return true;
 }
@@ -182,6 +284,8 @@ void LilyGoDispQSPI::setRotation(uint8_t rotation)
         break;
     }
 
+    _mirror_y = (gbr & DISP_CMD_MAD_MY) != 0;
+
     // _cfg.rotation = r;
     // log_d("disp_set_rotation Gap x-> %02d  y-> %02d\n", _offset_x, _offset_y);
     // log_d("disp_set_rotation 0X36 -> %02X\n", gbr);
@@ -228,7 +332,6 @@ void LilyGoDispQSPI::setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16
 void LilyGoDispQSPI::pushColorsNoDMA(uint16_t *data, uint32_t len)
 {
     bool first_send = true;
-    bool frame_top = 1;
     uint16_t *p = data;
     assert(p);
     assert(_spi_dev);
@@ -238,7 +341,6 @@ void LilyGoDispQSPI::pushColorsNoDMA(uint16_t *data, uint32_t len)
         spi_transaction_ext_t t = {0};
         memset(&t, 0, sizeof(t));
         if (first_send) {
-            frame_top = 1;
             t.base.flags = SPI_TRANS_MODE_QIO;
             t.base.cmd = 0x32 ;
             t.base.addr = 0x002C00;
@@ -252,19 +354,12 @@ void LilyGoDispQSPI::pushColorsNoDMA(uint16_t *data, uint32_t len)
         if (chunk_size > SEND_BUF_SIZE) {
             chunk_size = SEND_BUF_SIZE;
         }
+        if (_swap_bytes) {
+            disp_swap_rgb565(p, chunk_size);
+        }
         t.base.tx_buffer = p;
         t.base.length = chunk_size * 16;
 
-        if (_use_tearing_effect) {
-            if (frame_top == 1) {
-                if (disp_tearing_effect == true) {
-                    disp_tearing_effect = false;
-                }
-                while (disp_tearing_effect == false) ;
-                frame_top = 0;
-            }
-        }
-
         esp_err_t  err = spi_device_polling_transmit(_spi_dev, (spi_transaction_t *)&t);
         if (err != ESP_OK) {
             log_e("failed , err :%d", err);
@@ -278,13 +373,16 @@ void LilyGoDispQSPI::pushColorsNoDMA(uint16_t *data, uint32_t len)
 void LilyGoDispQSPI::pushColorsDMA(uint16_t *data, uint32_t len)
 {
     bool first_send = true;
-    bool frame_top = 1;
     uint16_t *p = data;
     assert(p);
     assert(_spi_dev);
 
     digitalWrite(_cs, LOW);
 
+    if (_swap_bytes) {
+        disp_swap_rgb565(data, len < SEND_BUF_SIZE ? len : SEND_BUF_SIZE);
+    }
+
     while (len > 0) {
         size_t chunk_size = len;
         if (chunk_size > SEND_BUF_SIZE) {
@@ -295,7 +393,6 @@ void LilyGoDispQSPI::pushColorsDMA(uint16_t *data, uint32_t len)
         memset(&t, 0, sizeof(t));
 
         if (first_send) {
-            frame_top = 1;
             t.base.flags = SPI_TRANS_MODE_QIO;
             t.base.cmd = 0x32;
             t.base.addr = 0x002C00;
@@ -309,20 +406,15 @@ void LilyGoDispQSPI::pushColorsDMA(uint16_t *data, uint32_t len)
         t.base.tx_buffer = data;
         t.base.length = chunk_size * 16;
 
-        if (_use_tearing_effect) {
-            if (frame_top == 1) {
-                if (disp_tearing_effect == true) {
-                    disp_tearing_effect = false;
-                }
-                while (disp_tearing_effect == false) ;
-                frame_top = 0;
-            }
-        }
-
         esp_err_t ret = spi_device_queue_trans(_spi_dev, &t.base, portMAX_DELAY);
         if (ret != ESP_OK) {
             log_e("DMA transfer failed!");
         }
+        // Convert the next chunk while this one is being sent
+        if (_swap_bytes && len > chunk_size) {
+            size_t next = len - chunk_size;
+            disp_swap_rgb565(data + chunk_size, next < SEND_BUF_SIZE ? next : SEND_BUF_SIZE);
+        }
         spi_transaction_t *trans_result;
         ret = spi_device_get_trans_result(_spi_dev, &trans_result, portMAX_DELAY);
         if (ret != ESP_OK) {
@@ -334,24 +426,267 @@ void LilyGoDispQSPI::pushColorsDMA(uint16_t *data, uint32_t len)
     digitalWrite(_cs, HIGH);
 }
 
+// Called by the spi driver when a transaction is done, in the interrupt context for queued transactions
+void ICACHE_RAM_ATTR LilyGoDispQSPI::post_transfer_cb(spi_transaction_t *t)
+{
+    trans_slot_t *slot = (trans_slot_t *)t->user;
+    if (!slot || !slot->last) {
+        return;
+    }
+    LilyGoDispQSPI *owner = slot->owner;
+    gpio_set_level((gpio_num_t)owner->_cs, 1);
+    // The flush task completes the flush, nothing here may call into LVGL
+    owner->_flush_done_us = (uint32_t)esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(owner->_flush_task, &woken);
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void LilyGoDispQSPI::setFlushDoneCallback(disp_flush_done_cb_t cb, void *user_data)
+{
+    _flush_done_cb = cb;
+    _flush_done_user_data = user_data;
+}
+
+// Collect the result of the oldest queued transaction so that its slot can be reused
+void LilyGoDispQSPI::reapTransaction()
+{
+    spi_transaction_t *trans_result;
+    esp_err_t ret = spi_device_get_trans_result(_spi_dev, &trans_result, portMAX_DELAY);
+    if (ret != ESP_OK) {
+        log_e("DMA SPI transfer failed!");
+    }
+    _trans_inflight--;
+}
+
+void LilyGoDispQSPI::waitFlushDone()
+{
+    // An asynchronous flush holds _flush_idle until the flush task has completed it
+    if (_flush_idle) {
+        xSemaphoreTake(_flush_idle, portMAX_DELAY);
+        xSemaphoreGive(_flush_idle);
+    }
+}
+
+// Completes the asynchronous flushes, woken by post_transfer_cb once the last chunk is sent
+void LilyGoDispQSPI::flushTask(void *p)
+{
+    LilyGoDispQSPI *self = (LilyGoDispQSPI *)p;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (self->_flush_task_stop) {
+            break;
+        }
+        while (self->_trans_inflight > 0) {
+            self->reapTransaction();
+        }
+        spi_device_release_bus(self->_spi_dev);
+        if (self->_flush_done_cb) {
+            self->_flush_done_cb(self->_flush_done_user_data, self->_flush_done_us);
+        }
+        xSemaphoreGive(self->_flush_idle);
+    }
+    self->_flush_task_running = false;
+    vTaskDelete(NULL);
+}
+
+bool LilyGoDispQSPI::startFlushTask()
+{
+    if (_flush_task) {
+        return true;
+    }
+    if (!_flush_idle) {
+        _flush_idle = xSemaphoreCreateBinary();
+        if (!_flush_idle) {
+            return false;
+        }
+        xSemaphoreGive(_flush_idle);
+    }
+    _flush_task_stop = false;
+    _flush_task_running = true;
+    if (xTaskCreate(flushTask, "disp_flush", 3 * 1024, this, 10, &_flush_task) != pdPASS) {
+        log_e("Failed to create flush task, flushing synchronously");
+        _flush_task_running = false;
+        _flush_task = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Only called while no flush is in flight
+void LilyGoDispQSPI::stopFlushTask()
+{
+    if (!_flush_task) {
+        return;
+    }
+    _flush_task_stop = true;
+    xTaskNotifyGive(_flush_task);
+    while (_flush_task_running) {
+        delay(1);
+    }
+    _flush_task = NULL;
+}
+
+// Queue all chunks without waiting, up to CONFIG_QSPI_TRANS_QUEUE_SIZE transactions are kept in flight.
+// CS is released by post_transfer_cb after the last chunk, the flush task then completes the flush.
+void LilyGoDispQSPI::pushColorsAsync(uint16_t *data, uint32_t len)
+{
+    bool first_send = true;
+    assert(data);
+    assert(_spi_dev);
+
+    digitalWrite(_cs, LOW);
+
+    if (_swap_bytes) {
+        disp_swap_rgb565(data, len < SEND_BUF_SIZE ? len : SEND_BUF_SIZE);
+    }
+
+    while (len > 0) {
+        size_t chunk_size = len;
+        if (chunk_size > SEND_BUF_SIZE) {
+            chunk_size = SEND_BUF_SIZE;
+        }
+
+        if (_trans_inflight == CONFIG_QSPI_TRANS_QUEUE_SIZE) {
+            reapTransaction();
+        }
+
+        trans_slot_t *slot = &_trans_slot[_trans_head];
+        spi_transaction_ext_t &t = slot->trans;
+        memset(&t, 0, sizeof(t));
+
+        if (first_send) {
+            t.base.flags = SPI_TRANS_MODE_QIO;
+            t.base.cmd = 0x32;
+            t.base.addr = 0x002C00;
+            first_send = 0;
+        } else {
+            t.base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+            t.command_bits = 0;
+            t.address_bits = 0;
+            t.dummy_bits = 0;
+        }
+        t.base.tx_buffer = data;
+        t.base.length = chunk_size * 16;
+        t.base.user = slot;
+        slot->owner = this;
+        slot->last = (chunk_size == len);
+
+        // Counted before queueing, the flush task may reap the last chunk before this returns
+        _trans_inflight++;
+        esp_err_t ret = spi_device_queue_trans(_spi_dev, &t.base, portMAX_DELAY);
+        if (ret != ESP_OK) {
+            log_e("DMA transfer failed!");
+            _trans_inflight--;
+            if (slot->last) {
+                // The post callback will never come, wake the flush task from here
+                digitalWrite(_cs, HIGH);
+                _flush_done_us = (uint32_t)esp_timer_get_time();
+                xTaskNotifyGive(_flush_task);
+            }
+        } else {
+            _trans_head = (_trans_head + 1) % CONFIG_QSPI_TRANS_QUEUE_SIZE;
+        }
+        // Convert the next chunk while the queued ones are being sent
+        if (_swap_bytes && len > chunk_size) {
+            size_t next = len - chunk_size;
+            disp_swap_rgb565(data + chunk_size, next < SEND_BUF_SIZE ? next : SEND_BUF_SIZE);
+        }
+        data += chunk_size;
+        len -= chunk_size;
+    }
+}
+
 void LilyGoDispQSPI::pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *color)
 {
+    // The address window cannot be changed while the previous frame is still being sent
+    waitFlushDone();
+
+    waitTearingEffect(y1, x2, y2);
+
     //acquire the bus to send polling transactions faster
     esp_err_t  err ;
     do {
         err = spi_device_acquire_bus(_spi_dev, portMAX_DELAY);
     } while (err != ESP_OK);
     setAddrWindow(x1, y1, x1 + x2 - 1, y1 + y2 - 1);
+    if (_use_dma_transaction && _use_async_flush && startFlushTask()) {
+        // The bus is released and the flush completed by the flush task after the last chunk
+        xSemaphoreTake(_flush_idle, portMAX_DELAY);
+        pushColorsAsync(color, x2 * y2);
+        return;
+    }
     if (_use_dma_transaction) {
         pushColorsDMA(color, x2 * y2);
     } else {
         pushColorsNoDMA(color, x2 * y2);
     }
     spi_device_release_bus(_spi_dev);
+    // Without the flush task an asynchronous flush completes here, still in the caller's task
+    if (_use_dma_transaction && _use_async_flush && _flush_done_cb) {
+        _flush_done_cb(_flush_done_user_data, (uint32_t)esp_timer_get_time());
+    }
+}
+
+void LilyGoDispQSPI::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    uint32_t len = (uint32_t)w * h;
+    if (len == 0) {
+        return;
+    }
+    uint32_t buf_len = len < CONFIG_DISP_FILL_BUF_PIXELS ? len : CONFIG_DISP_FILL_BUF_PIXELS;
+    uint16_t *buf = (uint16_t *)heap_caps_malloc(buf_len * sizeof(uint16_t), MALLOC_CAP_DMA);
+    if (!buf) {
+        log_e("fill buffer malloc failed!");
+        return;
+    }
+    // The panel takes the high byte first
+    uint16_t swapped = (color >> 8) | (color << 8);
+    for (uint32_t i = 0; i < buf_len; i++) {
+        buf[i] = swapped;
+    }
+
+    waitFlushDone();
+    esp_err_t  err ;
+    do {
+        err = spi_device_acquire_bus(_spi_dev, portMAX_DELAY);
+    } while (err != ESP_OK);
+    setAddrWindow(x, y, x + w - 1, y + h - 1);
+
+    // Send the same line buffer until the whole area is covered
+    bool first_send = true;
+    digitalWrite(_cs, LOW);
+    while (len > 0) {
+        uint32_t chunk_size = len < buf_len ? len : buf_len;
+        spi_transaction_ext_t t;
+        memset(&t, 0, sizeof(t));
+        if (first_send) {
+            t.base.flags = SPI_TRANS_MODE_QIO;
+            t.base.cmd = 0x32;
+            t.base.addr = 0x002C00;
+            first_send = false;
+        } else {
+            t.base.flags = SPI_TRANS_MODE_QIO | SPI_TRANS_VARIABLE_CMD | SPI_TRANS_VARIABLE_ADDR | SPI_TRANS_VARIABLE_DUMMY;
+        }
+        t.base.tx_buffer = buf;
+        t.base.length = chunk_size * 16;
+        err = spi_device_polling_transmit(_spi_dev, (spi_transaction_t *)&t);
+        if (err != ESP_OK) {
+            log_e("failed , err :%d", err);
+        }
+        len -= chunk_size;
+    }
+    digitalWrite(_cs, HIGH);
+    spi_device_release_bus(_spi_dev);
+    heap_caps_free(buf);
 }
 
 void LilyGoDispQSPI::writeCommand(uint32_t cmd, uint8_t *pdat, uint32_t length)
 {
+    // Polling transactions cannot be mixed with queued ones
+    waitFlushDone();
     digitalWrite(_cs, LOW);
     spi_transaction_t t;
     memset(&t, 0, sizeof(t));
@@ -552,8 +887,7 @@ bool LilyGoDispSPI::init(int sck, int miso, int mosi, int cs, int rst, int dc, i
 #endif
     }
 
-    std::vector<uint16_t> draw_buf(_width * _height * 2, 0x000);
-    esp_lcd_panel_draw_bitmap(panel_handle, 0, 0, _width, _height, draw_buf.data());
+    fillRect(0, 0, _width, _height, 0x0000);
 
     return true;
 }
@@ -597,6 +931,41 @@ void LilyGoDispSPI::pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y
     esp_lcd_panel_draw_bitmap(panel_handle, x1, y1, x2, y2, color);
 }
 
+void LilyGoDispSPI::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    assert(panel_handle);
+    if (w == 0 || h == 0) {
+        return;
+    }
+    // Fill whole lines so every band is one draw call
+    uint16_t lines = CONFIG_DISP_FILL_BUF_PIXELS / w;
+    if (lines == 0) {
+        lines = 1;
+    }
+    if (lines > h) {
+        lines = h;
+    }
+    uint32_t buf_len = (uint32_t)w * lines;
+    uint16_t *buf = (uint16_t *)heap_caps_malloc(buf_len * sizeof(uint16_t), MALLOC_CAP_DMA);
+    if (!buf) {
+        log_e("fill buffer malloc failed!");
+        return;
+    }
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
+    color = (color >> 8) | (color << 8);
+#endif
+    for (uint32_t i = 0; i < buf_len; i++) {
+        buf[i] = color;
+    }
+    for (uint16_t row = 0; row < h; row += lines) {
+        uint16_t n = (h - row) < lines ? (h - row) : lines;
+        esp_lcd_panel_draw_bitmap(panel_handle, x, y + row, x + w, y + row + n, buf);
+    }
+    // draw_bitmap only queues the transfers, a parameter write waits for all of them to finish
+    esp_lcd_panel_io_tx_param(io_handle, DISP_CMD_NOP, NULL, 0);
+    heap_caps_free(buf);
+}
+
 void LilyGoDispSPI::sleep()
 {
     assert(io_handle);
@@ -632,16 +1001,52 @@ void LilyGoDispSPI::setBrightness(uint8_t level)
 //**  @brief  Arduino SPI
 #define TFT_MAD_COLOR_ORDER     DISP_CMD_RGB
 
-bool LilyGoDispArduinoSPI::lock(TickType_t xTicksToWait)
+bool LilyGoDispArduinoSPI::lock(TickType_t xTicksToWait, SpiBusOwner_t owner)
 {
-    return xSemaphoreTake(_lock, xTicksToWait) == pdTRUE;
+    uint32_t start = (uint32_t)esp_timer_get_time();
+    if (xSemaphoreTake(_lock, xTicksToWait) != pdTRUE) {
+        return false;
+    }
+    if (owner >= SPI_BUS_OWNER_MAX) {
+        owner = SPI_BUS_OWNER_OTHER;
+    }
+    _lock_owner = owner;
+    _lock_start_us = (uint32_t)esp_timer_get_time();
+    _bus_stats[owner].locks++;
+    _bus_stats[owner].wait_us += _lock_start_us - start;
+    return true;
 }
 
 void LilyGoDispArduinoSPI::unlock()
 {
+    uint32_t hold = (uint32_t)esp_timer_get_time() - _lock_start_us;
+    SpiBusHoldStats_t *stats = &_bus_stats[_lock_owner];
+    stats->hold_us += hold;
+    if (hold > stats->hold_max_us) {
+        stats->hold_max_us = hold;
+    }
     xSemaphoreGive(_lock);
 }
 
+void LilyGoDispArduinoSPI::setPushChunkSize(size_t bytes)
+{
+    // Keep whole pixels in every chunk
+    _push_chunk_size = bytes & ~1UL;
+}
+
+void LilyGoDispArduinoSPI::getBusHoldStats(SpiBusOwner_t owner, SpiBusHoldStats_t *stats)
+{
+    if (!stats || owner >= SPI_BUS_OWNER_MAX) {
+        return;
+    }
+    *stats = _bus_stats[owner];
+}
+
+void LilyGoDispArduinoSPI::resetBusHoldStats()
+{
+    memset(_bus_stats, 0, sizeof(_bus_stats));
+}
+
 void LilyGoDispArduinoSPI::setBrightness(uint8_t level)
 {
 
@@ -686,21 +1091,14 @@ bool LilyGoDispArduinoSPI::init(int sck,
     _spi->begin(sck, miso, mosi);
 
 
-    const CommandTable_t *t = _init_list;
-    for (uint32_t i = 0; i < _init_list_length; i++) {
-        writeParams(t[i].cmd, (uint8_t *)t[i].data, t[i].len & 0x1F);
-        if (t[i].len & 0x80) {
-            delay(120);
-        }
-    }
+    writeCommandTable(_init_list, _init_list_length);
 
     setRotation(0);
 
     _spi_freq = freq_Mhz * 1000U * 1000U;
 
     log_v("_init_width:%u _init_height:%u", _init_width, _init_height);
-    std::vector<uint16_t> draw_buf(_width * _height * 2, 0x0000);
-    pushColors( 0, 0, _width, _height, draw_buf.data());
+    fillRect(0, 0, _width, _height, 0x0000);
     xSemaphoreGive(_lock);
     return true;
 }
@@ -718,8 +1116,8 @@ uint8_t LilyGoDispArduinoSPI::getRotation()
 void LilyGoDispArduinoSPI::setRotation(uint8_t rotation)
 {
     _rotation = rotation % 4; // Limit the range of values to 0-3
-    writeCommand(DISP_CMD_MADCTL);
-    writeData(_rotation_configs[_rotation].madCmd);
+    uint8_t mad = _rotation_configs[_rotation].madCmd;
+    writeParams(DISP_CMD_MADCTL, &mad, 1);
     _width  = _rotation_configs[_rotation].width;
     _height = _rotation_configs[_rotation].height;
     _offset_x = _rotation_configs[_rotation].offset_x;
@@ -730,20 +1128,88 @@ void LilyGoDispArduinoSPI::setRotation(uint8_t rotation)
 
 void LilyGoDispArduinoSPI::pushColors(uint16_t *data, uint32_t len)
 {
-    xSemaphoreTake(_lock, portMAX_DELAY);
-    digitalWrite(_cs, LOW);
-    _spi->beginTransaction(SPISettings(_spi_freq, MSBFIRST, SPI_MODE0));
-    digitalWrite(_dc, HIGH);
-    _spi->writeBytes((const uint8_t *)data, len * sizeof(uint16_t));
-    _spi->endTransaction();
-    digitalWrite(_cs, HIGH);
-    xSemaphoreGive(_lock);
+    writePixels((const uint8_t *)data, len * sizeof(uint16_t), false);
 }
 
 void LilyGoDispArduinoSPI::pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *color)
 {
-    setAddrWindow(x1, y1, x1 + x2 - 1, y1 + y2 - 1);
-    pushColors(color, x2 * y2);
+    // The address window goes out with the first chunk of pixels
+    lock(portMAX_DELAY, SPI_BUS_OWNER_DISPLAY);
+    beginWrite();
+    writeAddrWindow(x1, y1, x1 + x2 - 1, y1 + y2 - 1);
+    writePixels((const uint8_t *)color, x2 * y2 * sizeof(uint16_t), true);
+}
+
+// Send pixel data in chunks and give the shared bus to other devices between them.
+// Each chunk is a blocking write, the chunk size only bounds how long the lock is held.
+// The panel keeps the memory write position while CS is high, so the next chunk
+// continues where the previous one stopped. If locked is set the caller already
+// holds the bus inside beginWrite, it is released here.
+void LilyGoDispArduinoSPI::writePixels(const uint8_t *data, size_t len, bool locked)
+{
+    size_t chunk = _push_chunk_size ? _push_chunk_size : len;
+    do {
+        if (!locked) {
+            lock(portMAX_DELAY, SPI_BUS_OWNER_DISPLAY);
+            beginWrite();
+        }
+        size_t n = len < chunk ? len : chunk;
+        if (n && _swap_bytes) {
+            // Swaps each pixel while loading the SPI FIFO, no extra pass over the buffer
+            _spi->writePixels(data, n);
+        } else if (n) {
+            _spi->writeBytes(data, n);
+        }
+        endWrite();
+        unlock();
+        locked = false;
+        data += n;
+        len -= n;
+    } while (len);
+}
+
+void LilyGoDispArduinoSPI::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    size_t len = (size_t)w * h * sizeof(uint16_t);
+    if (len == 0) {
+        return;
+    }
+    size_t buf_len = CONFIG_DISP_FILL_BUF_PIXELS * sizeof(uint16_t);
+    if (buf_len > len) {
+        buf_len = len;
+    }
+    uint16_t *buf = (uint16_t *)malloc(buf_len);
+    if (!buf) {
+        log_e("fill buffer malloc failed!");
+        return;
+    }
+    // The panel takes the high byte first
+    uint16_t swapped = (color >> 8) | (color << 8);
+    for (size_t i = 0; i < buf_len / sizeof(uint16_t); i++) {
+        buf[i] = swapped;
+    }
+
+    lock(portMAX_DELAY, SPI_BUS_OWNER_DISPLAY);
+    beginWrite();
+    writeAddrWindow(x, y, x + w - 1, y + h - 1);
+    size_t sent = 0;
+    while (len > 0) {
+        size_t n = len < buf_len ? len : buf_len;
+        // Give the shared bus to other devices between chunks like writePixels
+        if (_push_chunk_size && sent >= _push_chunk_size) {
+            endWrite();
+            unlock();
+            lock(portMAX_DELAY, SPI_BUS_OWNER_DISPLAY);
+            beginWrite();
+            sent = 0;
+        }
+        _spi->writeBytes((const uint8_t *)buf, n);
+        sent += n;
+        len -= n;
+    }
+    endWrite();
+    unlock();
+    free(buf);
 }
 
 void LilyGoDispArduinoSPI::sleep()
@@ -759,49 +1225,91 @@ void LilyGoDispArduinoSPI::wakeup()
 
 void LilyGoDispArduinoSPI::setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
 {
-    xs += _offset_x;
-    ys += _offset_y;
-    xe += _offset_x;
-    ye += _offset_y;
-    CommandTable_t t[3] = {
-        {0x2a, {uint8_t(xs >> 8), (uint8_t)xs, (uint8_t)(xe >> 8), (uint8_t) xe}, 0x04},
-        {0x2b, {uint8_t(ys >> 8), (uint8_t)ys, (uint8_t)(ye >> 8), (uint8_t) ye}, 0x04},
-        {0x2c, {0x00}, 0x00},
-    };
-    for (uint32_t i = 0; i < 3; i++) {
-        writeParams(t[i].cmd, t[i].data, t[i].len);
-    }
+    lock(portMAX_DELAY, SPI_BUS_OWNER_DISPLAY);
+    beginWrite();
+    writeAddrWindow(xs, ys, xe, ye);
+    endWrite();
+    unlock();
 }
 
 void LilyGoDispArduinoSPI::writeCommand(uint8_t cmd)
 {
-    xSemaphoreTake(_lock, portMAX_DELAY);
-    digitalWrite(_cs, LOW);
-    _spi->beginTransaction(SPISettings(_spi_freq, MSBFIRST, SPI_MODE0));
-    digitalWrite(_dc, LOW);
-    _spi->write(cmd);
-    digitalWrite(_dc, HIGH);
-    _spi->endTransaction();
-    digitalWrite(_cs, HIGH);
-    xSemaphoreGive(_lock);
+    writeParams(cmd);
 }
 
 void LilyGoDispArduinoSPI::writeData(uint8_t data)
 {
-    xSemaphoreTake(_lock, portMAX_DELAY);
+    lock(portMAX_DELAY, SPI_BUS_OWNER_DISPLAY);
+    beginWrite();
+    _spi->write(data);
+    endWrite();
+    unlock();
+}
+
+void LilyGoDispArduinoSPI::writeParams(uint8_t cmd, uint8_t *data, size_t length)
+{
+    lock(portMAX_DELAY, SPI_BUS_OWNER_DISPLAY);
+    beginWrite();
+    sendCommand(cmd, data, length);
+    endWrite();
+    unlock();
+}
+
+void LilyGoDispArduinoSPI::writeCommandTable(const CommandTable_t *table, size_t length)
+{
+    size_t i = 0;
+    while (i < length) {
+        // Send the commands up to the next one that needs a delay in one transaction
+        lock(portMAX_DELAY, SPI_BUS_OWNER_DISPLAY);
+        beginWrite();
+        bool need_delay = false;
+        while (i < length && !need_delay) {
+            sendCommand(table[i].cmd, table[i].data, table[i].len & 0x1F);
+            need_delay = table[i].len & 0x80;
+            i++;
+        }
+        endWrite();
+        unlock();
+        if (need_delay) {
+            delay(120);
+        }
+    }
+}
+
+// The following functions must be called with the lock held between beginWrite and endWrite
+
+void LilyGoDispArduinoSPI::beginWrite()
+{
     digitalWrite(_cs, LOW);
     _spi->beginTransaction(SPISettings(_spi_freq, MSBFIRST, SPI_MODE0));
     digitalWrite(_dc, HIGH);
-    _spi->write(data);
+}
+
+void LilyGoDispArduinoSPI::endWrite()
+{
     _spi->endTransaction();
     digitalWrite(_cs, HIGH);
-    xSemaphoreGive(_lock);
 }
 
-void LilyGoDispArduinoSPI::writeParams(uint8_t cmd, uint8_t *data, size_t length)
+void LilyGoDispArduinoSPI::sendCommand(uint8_t cmd, const uint8_t *data, size_t length)
 {
-    writeCommand(cmd);
-    for (int i = 0; i < length; i++) {
-        writeData(data[i]);
+    digitalWrite(_dc, LOW);
+    _spi->write(cmd);
+    digitalWrite(_dc, HIGH);
+    if (length) {
+        _spi->writeBytes(data, length);
     }
 }
+
+void LilyGoDispArduinoSPI::writeAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
+{
+    xs += _offset_x;
+    ys += _offset_y;
+    xe += _offset_x;
+    ye += _offset_y;
+    uint8_t caset[4] = {uint8_t(xs >> 8), (uint8_t)xs, (uint8_t)(xe >> 8), (uint8_t) xe};
+    uint8_t raset[4] = {uint8_t(ys >> 8), (uint8_t)ys, (uint8_t)(ye >> 8), (uint8_t) ye};
+    sendCommand(0x2a, caset, sizeof(caset));
+    sendCommand(0x2b, raset, sizeof(raset));
+    sendCommand(0x2c, NULL, 0);
+}
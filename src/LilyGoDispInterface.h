@@ -40,6 +40,31 @@
 #define CONFIG_ARDUINO_SPI_MAX_FREQ         80  //MHZ
 #endif
 
+// Longest wait for a tearing effect pulse before the flush goes ahead anyway
+#ifndef CONFIG_DISP_TE_TIMEOUT_MS
+#define CONFIG_DISP_TE_TIMEOUT_MS           50
+#endif
+
+// Pixels in the line buffer fillRect repeats to cover the area
+#ifndef CONFIG_DISP_FILL_BUF_PIXELS
+#define CONFIG_DISP_FILL_BUF_PIXELS         4096
+#endif
+
+// Number of QSPI transactions that can be queued at the same time,
+// must match the queue_size of the spi device
+#ifndef CONFIG_QSPI_TRANS_QUEUE_SIZE
+#define CONFIG_QSPI_TRANS_QUEUE_SIZE        17
+#endif
+
+// Pixel bytes sent per lock of the shared Arduino SPI bus, other devices
+// can use the bus between two chunks. 0 sends the whole area at once.
+// This only sets the lock granularity: every chunk is still a blocking
+// SPIClass transfer done by the CPU, there is no queued or DMA transfer
+// on this bus and pushColors returns once the last chunk has been sent.
+#ifndef CONFIG_ARDUINO_SPI_PUSH_CHUNK_SIZE
+#define CONFIG_ARDUINO_SPI_PUSH_CHUNK_SIZE  8192
+#endif
+
 enum DriverBusType {
     SPI_DRIVER,
     QSPI_DRIVER,
@@ -73,8 +98,40 @@ typedef enum KeyboardState {
 typedef struct RotaryMsg {
     RotaryDir_t dir;
     bool centerBtnPressed;
+    int16_t diff;           // Steps since the last read, positive is ROTARY_DIR_UP
+    uint32_t time_us;       // Interrupt time of the first step or button change, 0 if none
 } RotaryMsg_t;
 
+typedef struct {
+    uint32_t te_count;          // TE pulses received
+    uint32_t frame_period_us;   // Measured panel refresh period, 0 until two pulses were seen
+    uint32_t te_waits;          // Flushes that waited for a TE pulse
+    uint32_t te_wait_us;        // Total time spent waiting for TE
+    uint32_t te_wait_max_us;    // Longest single wait for TE
+    uint32_t mid_frame_starts;  // Flushes started mid-frame without waiting
+    uint32_t missed_vsync;      // Waits that timed out without a TE pulse
+} DispTearingEffectStats_t;
+
+typedef enum {
+    SPI_BUS_OWNER_DISPLAY,
+    SPI_BUS_OWNER_RADIO,
+    SPI_BUS_OWNER_NFC,
+    SPI_BUS_OWNER_SD,
+    SPI_BUS_OWNER_OTHER,
+    SPI_BUS_OWNER_MAX,
+} SpiBusOwner_t;
+
+typedef struct {
+    uint32_t locks;             // Times the bus was taken
+    uint32_t wait_us;           // Total time spent waiting for the bus
+    uint32_t hold_us;           // Total time the bus was held
+    uint32_t hold_max_us;       // Longest single hold
+} SpiBusHoldStats_t;
+
+// Called in task context once an asynchronous pushColors has been completely sent,
+// 'done_us' is the esp_timer time in microseconds when the last chunk finished
+using disp_flush_done_cb_t = void (*)(void *user_data, uint32_t done_us);
+
 class LilyGo_Display
 {
 public:
@@ -84,18 +141,30 @@ public:
     virtual void setRotation(uint8_t rotation) = 0;
     virtual uint8_t getRotation() = 0;
     virtual void pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *color) = 0;
+    virtual void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color){}
     virtual uint16_t width() = 0;
     virtual uint16_t height() = 0;
 
-    virtual RotaryMsg_t getRotary(){RotaryMsg_t msg;return msg;}
+    virtual RotaryMsg_t getRotary(){RotaryMsg_t msg = {ROTARY_DIR_NONE, false, 0};return msg;}
     virtual uint8_t getPoint(int16_t *x, int16_t *y, uint8_t get_point){return 0;};
     virtual int getKeyChar(char *c){return -1;}
+    // Interrupt time in microseconds of the last key returned by getKeyChar, 0 if unknown
+    virtual uint32_t getKeyTime(){return 0;}
+    // Time in microseconds of the points last returned by getPoint, 0 if unknown
+    virtual uint32_t getPointTime(){return 0;}
     virtual bool hasTouch() {return false;}
     virtual bool hasEncoder() { return false; }
     virtual bool hasKeyboard() { return false; }
     virtual void feedback(void* args = NULL) {}
     bool needFullRefresh(){return _full_refresh;}
     virtual bool useDMA(){return false;}
+    virtual bool useAsyncFlush(){return false;}
+    virtual void setFlushDoneCallback(disp_flush_done_cb_t cb, void *user_data){}
+    virtual void waitFlushDone(){}
+    // Let the driver convert RGB565 to big endian during the transfer, returns false if not supported
+    virtual bool setSwapBytes(bool enable){return false;}
+    // Total time the driver has waited for tearing effect and for the bus lock
+    virtual void getFlushWaitTime(uint32_t *te_wait_us, uint32_t *bus_wait_us){*te_wait_us = 0; *bus_wait_us = 0;}
     // *INDENT-ON*
 protected:
     uint16_t _offset_x ;
@@ -111,7 +180,12 @@ class LilyGoDispQSPI
 public:
     LilyGoDispQSPI(const  disp_cmd_t *init_list, uint16_t init_len, uint16_t width, uint16_t height) :
         _spi_dev(NULL), _cs(-1), _disp_init_cmd(init_list), _disp_init_cmd_len(init_len), width(width), height(height),
-        _offset_x(0), _offset_y(0), _init_width(width), _init_height(height)
+        _offset_x(0), _offset_y(0), _init_width(width), _init_height(height),
+        _use_dma_transaction(false), _use_tearing_effect(false), _use_async_flush(false),
+        _trans_head(0), _trans_inflight(0), _flush_task(NULL), _flush_idle(NULL),
+        _flush_task_stop(false), _flush_task_running(false), _flush_done_us(0),
+        _flush_done_cb(NULL), _flush_done_user_data(NULL),
+        _freq_mhz(0), _mirror_y(false), _swap_bytes(false), _te_stats()
     {
     };
 
@@ -125,6 +199,35 @@ public:
     {
         _use_tearing_effect = enable;
     }
+    /**
+     * @brief  Let pushColors return as soon as all chunks are queued,
+     *         only takes effect when DMA is enabled.
+     * @note   The color buffer must stay valid until waitFlushDone() returns.
+     *         A small task releases the bus and calls the flush done callback
+     *         as soon as the last chunk has been sent.
+     */
+    void enableAsyncFlush(bool enable)
+    {
+        _use_async_flush = enable;
+    }
+    /**
+     * @brief  Byte swap little endian RGB565 pixels chunk by chunk while pushing,
+     *         the next chunk is converted while the current one is sent.
+     * @note   The color buffer is modified in place.
+     */
+    void enableSwapBytes(bool enable)
+    {
+        _swap_bytes = enable;
+    }
+    void setFlushDoneCallback(disp_flush_done_cb_t cb, void *user_data);
+    void waitFlushDone();
+
+    /**
+     * @brief  Get the tearing effect synchronisation counters.
+     * @param  stats Filled with the current counters.
+     */
+    void getTearingEffectStats(DispTearingEffectStats_t *stats);
+    void resetTearingEffectStats();
 
     bool init(int rst, int cs, int te, int sck, int d0, int d1, int d2, int d3,  uint32_t freq_Mhz = CONFIG_QSPI_MAX_FREQ);
     void end();
@@ -135,6 +238,11 @@ public:
 
     void pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *color);
 
+    /**
+     * @brief  Fill an area with one RGB565 color without a full size buffer.
+     */
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+
     void sleep();
     void wakeup();
     void setBrightness(uint8_t level);
@@ -146,6 +254,20 @@ private:
     void setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye);
     void pushColorsNoDMA(uint16_t *data, uint32_t len);
     void pushColorsDMA(uint16_t *data, uint32_t len);
+    void pushColorsAsync(uint16_t *data, uint32_t len);
+    void reapTransaction();
+    bool startFlushTask();
+    void stopFlushTask();
+    static void flushTask(void *p);
+    bool canWriteMidFrame(uint16_t y, uint16_t w, uint16_t h);
+    void waitTearingEffect(uint16_t y, uint16_t w, uint16_t h);
+    static void post_transfer_cb(spi_transaction_t *t);
+
+    typedef struct {
+        spi_transaction_ext_t trans;
+        LilyGoDispQSPI *owner;
+        bool last;
+    } trans_slot_t;
 
     spi_device_handle_t _spi_dev;
     int _cs ;
@@ -156,6 +278,21 @@ private:
     uint16_t _init_width, _init_height;
     bool _use_dma_transaction;
     bool _use_tearing_effect;
+    bool _use_async_flush;
+    trans_slot_t _trans_slot[CONFIG_QSPI_TRANS_QUEUE_SIZE];
+    uint8_t _trans_head;
+    volatile uint8_t _trans_inflight;
+    TaskHandle_t _flush_task;
+    SemaphoreHandle_t _flush_idle;      // Taken while an asynchronous flush is in flight
+    volatile bool _flush_task_stop;
+    volatile bool _flush_task_running;
+    volatile uint32_t _flush_done_us;
+    disp_flush_done_cb_t _flush_done_cb;
+    void *_flush_done_user_data;
+    uint32_t _freq_mhz;
+    bool _mirror_y;
+    bool _swap_bytes;
+    DispTearingEffectStats_t _te_stats;
 };
 
 class LilyGoDispSPI
@@ -175,6 +312,7 @@ public:
     void setRotation(uint8_t rotation);
     uint8_t getRotation();
     void pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *color);
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
     void sleep();
     void wakeup();
     void setBrightness(uint8_t level);
@@ -203,12 +341,18 @@ private:
     size_t _init_list_length;
     xSemaphoreHandle _lock;
     const  DispRotationConfig_t *_rotation_configs;
+    size_t _push_chunk_size;
+    bool _swap_bytes;
+    SpiBusOwner_t _lock_owner;
+    uint32_t _lock_start_us;
+    SpiBusHoldStats_t _bus_stats[SPI_BUS_OWNER_MAX];
 
 public:
     uint16_t _width, _height;
     uint8_t _brightness;
     LilyGoDispArduinoSPI( uint16_t width, uint16_t height, const CommandTable_t *init_list, size_t init_list_length, const DispRotationConfig_t *rotation_config) :
-        _init_width(width), _init_height(height), _init_list(init_list), _init_list_length(init_list_length), _lock(NULL),_rotation_configs(rotation_config)
+        _init_width(width), _init_height(height), _init_list(init_list), _init_list_length(init_list_length), _lock(NULL),_rotation_configs(rotation_config),
+        _push_chunk_size(CONFIG_ARDUINO_SPI_PUSH_CHUNK_SIZE), _swap_bytes(false), _lock_owner(SPI_BUS_OWNER_OTHER), _lock_start_us(0), _bus_stats()
     {
     };
     ~LilyGoDispArduinoSPI() {};
@@ -218,6 +362,7 @@ public:
     uint8_t getRotation();
     void pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *color);
     void pushColors(uint16_t *data, uint32_t len);
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
     void sleep();
     void wakeup();
     void setBrightness(uint8_t level);
@@ -225,9 +370,47 @@ public:
     void writeData(uint8_t data);
     void writeCommand(uint8_t cmd);
     void setAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye);
-    bool lock(TickType_t xTicksToWait = portMAX_DELAY);
+    bool lock(TickType_t xTicksToWait = portMAX_DELAY, SpiBusOwner_t owner = SPI_BUS_OWNER_OTHER);
     void unlock();
 
+    /**
+     * @brief  Set how many pixel bytes are sent per lock of the shared bus.
+     * @note   Lock granularity only, the chunks are sent one after another by
+     *         blocking SPIClass writes, nothing is queued or sent by DMA.
+     * @param  bytes Chunk size, 0 holds the bus for the whole area
+     */
+    void setPushChunkSize(size_t bytes);
+
+    /**
+     * @brief  Send little endian RGB565 pixels high byte first, the swap is done
+     *         while filling the SPI FIFO so the color buffer is not modified.
+     */
+    void enableSwapBytes(bool enable)
+    {
+        _swap_bytes = enable;
+    }
+
+    /**
+     * @brief  Get the bus lock statistics of one bus user.
+     * @param  owner Bus user passed to lock()
+     * @param  stats Filled with the current counters
+     */
+    void getBusHoldStats(SpiBusOwner_t owner, SpiBusHoldStats_t *stats);
+    void resetBusHoldStats();
+
+    /**
+     * @brief  Send a command table, commands between two delays share one lock and one transaction.
+     * @param  table Command list, bit 7 of len requests a 120ms delay after the command
+     * @param  length Number of commands in the table
+     */
+    void writeCommandTable(const CommandTable_t *table, size_t length);
+
+private:
+    void writePixels(const uint8_t *data, size_t len, bool locked);
+    void beginWrite();
+    void endWrite();
+    void sendCommand(uint8_t cmd, const uint8_t *data, size_t length);
+    void writeAddrWindow(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye);
 };
 
 
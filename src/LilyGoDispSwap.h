@@ -0,0 +1,29 @@
+/**
+ * @file      LilyGoDispSwap.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      RGB565 byte swap used by the display drivers before a transfer.
+ */
+#pragma once
+
+#include <stdint.h>
+
+// Convert RGB565 pixels to the big endian order the panels expect, two pixels per word
+static inline void disp_swap_rgb565(uint16_t *p, uint32_t len)
+{
+    if (((uintptr_t)p & 2) && len) {
+        *p = (*p >> 8) | (*p << 8);
+        p++;
+        len--;
+    }
+    uint32_t *w = (uint32_t *)p;
+    for (uint32_t i = 0; i < len / 2; i++) {
+        uint32_t v = w[i];
+        w[i] = ((v & 0xFF00FF00) >> 8) | ((v & 0x00FF00FF) << 8);
+    }
+    if (len & 1) {
+        p[len - 1] = (p[len - 1] >> 8) | (p[len - 1] << 8);
+    }
+}
@@ -6,8 +6,13 @@
  * @date      2025-03-18
  *
  */
+#pragma once
 #include <Arduino.h>
-#include <vector>
+
+// Callbacks that can be registered per event type, plus the same number for ALL_EVENT_MAX
+#ifndef CONFIG_EVENT_CALLBACKS_PER_TYPE
+#define CONFIG_EVENT_CALLBACKS_PER_TYPE     8
+#endif
 
 typedef enum ButtonEvent {
     BUTTON_EVENT_NONE,
@@ -16,6 +21,7 @@ typedef enum ButtonEvent {
     BUTTON_EVENT_CLICK,
     BUTTON_EVENT_LONG_PRESSED,
     BUTTON_EVENT_DOUBLE_CLICK,
+    BUTTON_EVENT_TRIPLE_CLICK,
 } ButtonEvent_t;
 
 typedef struct ButtonEventParam {
@@ -58,6 +64,14 @@ typedef enum PMUEventType {
     PMU_EVENT_BAT_FET_OVER_CURRENT,
 } PMUEventType_t;
 
+// Parameter of POWER_EVENT, every event found in one read of the PMU interrupt status
+typedef struct PMUEventRecord {
+    PMUEventType_t type;        // Last event of the batch, first so getPMUEventType() keeps working
+    uint32_t mask;              // _BV(PMUEventType_t) of every event in the batch
+    uint32_t irq_status;        // Raw interrupt status, the three status registers low byte first
+    uint32_t timestamp;         // millis() when the status was read
+} PMUEventRecord_t;
+
 typedef enum SensorEventType {
     SENSOR_EVENT_NONE,
     SENSOR_EVENT_INTERRUPT,
@@ -89,13 +103,68 @@ typedef struct DeviceEventCbList {
     DeviceEventCb_t cb;
     DeviceEvent_t event;
     void *user_data;
-    DeviceEventCbList() :  cb(NULL), event(NONE_EVENT), user_data(NULL) {}
+    uint32_t id;                // Unique per registration, 0 once removed
+    DeviceEventCbList() :  cb(NULL), event(NONE_EVENT), user_data(NULL), id(0) {}
 } DeviceEventCbList_t;
 
 class LilyGoEventManage
 {
 private:
-    std::vector < DeviceEventCbList_t > cbEventList;
+    // One bucket per event type, the last one holds the ALL_EVENT_MAX callbacks.
+    // Fixed size so registering never allocates and sending only visits the relevant callbacks.
+    DeviceEventCbList_t cbEventList[ALL_EVENT_MAX + 1][CONFIG_EVENT_CALLBACKS_PER_TYPE];
+    uint8_t cbEventCount[ALL_EVENT_MAX + 1] = {0};
+    uint32_t lastId = 0;
+    // Events being sent on any task, removed slots are only compacted when none is.
+    // Until then a slot keeps its position so a sender can check its id without locking
+    uint8_t dispatchDepth = 0;
+    bool pendingCompact = false;
+    // Guards the buckets, events are sent from the irq service task and loop() while
+    // the application registers callbacks from its own tasks
+    portMUX_TYPE cbEventLock = portMUX_INITIALIZER_UNLOCKED;
+
+    // Caller holds cbEventLock
+    uint32_t indexOf(DeviceEventCb_t cbEvent, uint32_t bucket)
+    {
+        for (uint32_t i = 0; i < cbEventCount[bucket]; i++) {
+            if (cbEventList[bucket][i].cb == cbEvent) {
+                return i;
+            }
+        }
+        return CONFIG_EVENT_CALLBACKS_PER_TYPE;
+    }
+
+    // Caller holds cbEventLock
+    void compactEvents()
+    {
+        for (uint32_t b = 0; b <= ALL_EVENT_MAX; b++) {
+            uint8_t n = 0;
+            for (uint8_t i = 0; i < cbEventCount[b]; i++) {
+                if (cbEventList[b][i].cb) {
+                    cbEventList[b][n++] = cbEventList[b][i];
+                }
+            }
+            for (uint8_t i = n; i < cbEventCount[b]; i++) {
+                cbEventList[b][i] = DeviceEventCbList_t();
+            }
+            cbEventCount[b] = n;
+        }
+        pendingCompact = false;
+    }
+
+    void dispatch(uint32_t bucket, const DeviceEventCbList_t *list, uint8_t count,
+                  DeviceEvent_t event, void *params)
+    {
+        for (uint8_t i = 0; i < count; i++) {
+            // The slot changes its id when the callback is removed, even if it is added again,
+            // a slot removed before the copy waits for compaction with id 0
+            if (!list[i].id || __atomic_load_n(&cbEventList[bucket][i].id, __ATOMIC_ACQUIRE) != list[i].id) {
+                continue;
+            }
+            list[i].cb(event, params, list[i].user_data);
+        }
+    }
+
 public:
     LilyGoEventManage()
     {
@@ -104,19 +173,18 @@ public:
     {
     }
 
+    /**
+     * @brief  Find a registered callback.
+     * @retval Position in the bucket of 'event', CONFIG_EVENT_CALLBACKS_PER_TYPE if not registered
+     */
     uint32_t findEvent(DeviceEventCb_t cbEvent, DeviceEvent_t event)
     {
-        uint32_t i;
-
-        if (!cbEvent) {
-            return cbEventList.size();
-        }
-        for (i = 0; i < cbEventList.size(); i++) {
-            DeviceEventCbList_t entry = cbEventList[i];
-            if (entry.cb == cbEvent && entry.event == event) {
-                break;
-            }
+        if (!cbEvent || event > ALL_EVENT_MAX) {
+            return CONFIG_EVENT_CALLBACKS_PER_TYPE;
         }
+        portENTER_CRITICAL(&cbEventLock);
+        uint32_t i = indexOf(cbEvent, event);
+        portEXIT_CRITICAL(&cbEventLock);
         return i;
     }
 
@@ -127,41 +195,83 @@ public:
 
     void onEvent(DeviceEventCb_t cbEvent, DeviceEvent_t event, void*user_data)
     {
-        if (!cbEvent) {
+        if (!cbEvent || event > ALL_EVENT_MAX) {
             return;
         }
-        if (findEvent(cbEvent, event) < cbEventList.size()) {
+        bool duplicate = false, full = false;
+        portENTER_CRITICAL(&cbEventLock);
+        if (indexOf(cbEvent, event) < CONFIG_EVENT_CALLBACKS_PER_TYPE) {
+            duplicate = true;
+        } else {
+            if (cbEventCount[event] >= CONFIG_EVENT_CALLBACKS_PER_TYPE && pendingCompact && dispatchDepth == 0) {
+                compactEvents();
+            }
+            if (cbEventCount[event] >= CONFIG_EVENT_CALLBACKS_PER_TYPE) {
+                full = true;
+            } else {
+                DeviceEventCbList_t &newEventHandler = cbEventList[event][cbEventCount[event]];
+                newEventHandler.cb = cbEvent;
+                newEventHandler.user_data = user_data;
+                newEventHandler.event = event;
+                if (++lastId == 0) {
+                    lastId = 1;
+                }
+                __atomic_store_n(&newEventHandler.id, lastId, __ATOMIC_RELEASE);
+                cbEventCount[event]++;
+            }
+        }
+        portEXIT_CRITICAL(&cbEventLock);
+        if (duplicate) {
             log_e("Attempt to add duplicate event handler!");
-            return;
+        } else if (full) {
+            log_e("Too many event handlers, increase CONFIG_EVENT_CALLBACKS_PER_TYPE");
         }
-        DeviceEventCbList_t newEventHandler;
-        newEventHandler.cb = cbEvent;
-        newEventHandler.user_data = user_data;
-        newEventHandler.event = event;
-        cbEventList.push_back(newEventHandler);
     }
 
     void removeEvent(DeviceEventCb_t cbEvent, DeviceEvent_t event)
     {
-        uint32_t i;
-        if (!cbEvent) {
+        if (!cbEvent || event > ALL_EVENT_MAX) {
             return;
         }
-        i = findEvent(cbEvent, event);
-        if (i >= cbEventList.size()) {
-            return;
+        // Safe to call from a callback or another task, the slot is only cleared while sending
+        portENTER_CRITICAL(&cbEventLock);
+        uint32_t i = indexOf(cbEvent, event);
+        if (i < CONFIG_EVENT_CALLBACKS_PER_TYPE) {
+            __atomic_store_n(&cbEventList[event][i].id, 0, __ATOMIC_RELEASE);
+            cbEventList[event][i].cb = NULL;
+            if (dispatchDepth) {
+                pendingCompact = true;
+            } else {
+                compactEvents();
+            }
         }
-        cbEventList.erase(cbEventList.begin() + i);
+        portEXIT_CRITICAL(&cbEventLock);
     }
 
     void sendEvent(DeviceEvent_t event, void * params = NULL)
     {
-        for (uint32_t i = 0; i < cbEventList.size(); i++) {
-            DeviceEventCbList_t entry = cbEventList[i];
-            if (entry.cb && entry.event == event || entry.event == ALL_EVENT_MAX) {
-                entry.cb(event, params, entry.user_data);
-            }
+        if (event >= ALL_EVENT_MAX) {
+            return;
+        }
+        // The callbacks run on a copy taken in one critical section, without the lock held,
+        // callbacks added meanwhile are not called until the next event
+        DeviceEventCbList_t list[2][CONFIG_EVENT_CALLBACKS_PER_TYPE];
+        portENTER_CRITICAL(&cbEventLock);
+        dispatchDepth++;
+        uint8_t count = cbEventCount[event];
+        uint8_t count_all = cbEventCount[ALL_EVENT_MAX];
+        memcpy(list[0], cbEventList[event], count * sizeof(DeviceEventCbList_t));
+        memcpy(list[1], cbEventList[ALL_EVENT_MAX], count_all * sizeof(DeviceEventCbList_t));
+        portEXIT_CRITICAL(&cbEventLock);
+
+        dispatch(event, list[0], count, event, params);
+        dispatch(ALL_EVENT_MAX, list[1], count_all, event, params);
+
+        portENTER_CRITICAL(&cbEventLock);
+        if (--dispatchDepth == 0 && pendingCompact) {
+            compactEvents();
         }
+        portEXIT_CRITICAL(&cbEventLock);
     }
 
     PMUEventType_t getPMUEventType(void *params)
@@ -172,6 +282,19 @@ public:
         return *(static_cast < PMUEventType_t* > (params));
     }
 
+    uint32_t getPMUEventMask(void *params)
+    {
+        if (!params) {
+            return 0;
+        }
+        return static_cast < PMUEventRecord_t * > (params)->mask;
+    }
+
+    bool hasPMUEvent(void *params, PMUEventType_t type)
+    {
+        return getPMUEventMask(params) & _BV(type);
+    }
+
     SensorEventType_t getSensorEventType(void *params)
     {
         if (!params) {
@@ -44,9 +44,32 @@ void esp_enable_slow_crystal()
     }
 }
 
+// Time of the first interrupt of each event bit not yet taken by takeGroupBitsTime, 0 if none
+static volatile uint32_t group_bits_time[configUSE_16_BIT_TICKS ? 8 : 24];
+
+uint32_t takeGroupBitsTime(const EventBits_t uxBit)
+{
+    if (uxBit == 0) {
+        return 0;
+    }
+    uint32_t index = __builtin_ctz(uxBit);
+    if (index >= sizeof(group_bits_time) / sizeof(group_bits_time[0])) {
+        return 0;
+    }
+    uint32_t time_us = group_bits_time[index];
+    group_bits_time[index] = 0;
+    return time_us;
+}
+
 void setGroupBitsFromISR(EventGroupHandle_t xEventGroup,
                          const EventBits_t uxBitsToSet)
 {
+    uint32_t now = micros() | 1;
+    for (uint32_t i = 0; i < sizeof(group_bits_time) / sizeof(group_bits_time[0]); i++) {
+        if ((uxBitsToSet & _BV(i)) && group_bits_time[i] == 0) {
+            group_bits_time[i] = now;
+        }
+    }
     BaseType_t xHigherPriorityTaskWoken, xResult;
     xHigherPriorityTaskWoken = pdFALSE;
     xResult = xEventGroupSetBitsFromISR(xEventGroup, uxBitsToSet, &xHigherPriorityTaskWoken);
@@ -0,0 +1,133 @@
+/**
+ * @file      LilyGoIrqService.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-14
+ *
+ */
+#include "LilyGoIrqService.h"
+
+extern uint32_t takeGroupBitsTime(const EventBits_t uxBit);
+
+bool LilyGoIrqService::begin(EventGroupHandle_t group, const EventBits_t *sources, uint8_t count,
+                             IrqSourceHandler_t handler, void *user_data,
+                             BaseType_t core, UBaseType_t priority)
+{
+    if (_running) {
+        return true;
+    }
+    if (!group || !sources || !handler || count > CONFIG_IRQ_SERVICE_MAX_SOURCES) {
+        return false;
+    }
+    _group = group;
+    _sources = sources;
+    _count = count;
+    _handler = handler;
+    _user_data = user_data;
+    _core = core;
+    _priority = priority;
+    _mask = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        _mask |= sources[i];
+    }
+    return restart();
+}
+
+bool LilyGoIrqService::restart()
+{
+    if (_running) {
+        // Called by a handler that stopped the service earlier in the same pass, cancel the stop
+        if (xTaskGetCurrentTaskHandle() == _task) {
+            xEventGroupClearBits(_group, HW_IRQ_SERVICE_EXIT);
+        }
+        return true;
+    }
+    if (!_handler) {
+        return false;
+    }
+    xEventGroupClearBits(_group, HW_IRQ_SERVICE_EXIT);
+    _running = true;
+    if (xTaskCreatePinnedToCore(serviceTask, "irq", 4 * 1024, this, _priority, &_task, _core) != pdPASS) {
+        log_e("Failed to create irq service task");
+        _running = false;
+        _task = NULL;
+        return false;
+    }
+    return true;
+}
+
+void LilyGoIrqService::end()
+{
+    if (!_running) {
+        return;
+    }
+    xEventGroupSetBits(_group, HW_IRQ_SERVICE_EXIT);
+    // Called by a handler, e.g. through sleep(), the task cannot wait for itself
+    // and exits once the current pass returns
+    if (xTaskGetCurrentTaskHandle() == _task) {
+        return;
+    }
+    while (_running) {
+        delay(1);
+    }
+}
+
+bool LilyGoIrqService::isRunning()
+{
+    return _running;
+}
+
+void LilyGoIrqService::getStats(EventBits_t bit, IrqSourceStats_t *stats)
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_sources[i] == bit) {
+            *stats = _stats[i];
+            return;
+        }
+    }
+    memset(stats, 0, sizeof(*stats));
+}
+
+void LilyGoIrqService::resetStats()
+{
+    memset(_stats, 0, sizeof(_stats));
+}
+
+void LilyGoIrqService::service(EventBits_t bits)
+{
+    for (uint8_t i = 0; i < _count; i++) {
+        if (!(bits & _sources[i])) {
+            continue;
+        }
+        uint32_t irq_time = takeGroupBitsTime(_sources[i]);
+        _handler(_sources[i], _user_data);
+        IrqSourceStats_t &stats = _stats[i];
+        stats.count++;
+        // Bits set by software have no interrupt time
+        if (irq_time) {
+            stats.latency_us = micros() - irq_time;
+            stats.latency_total_us += stats.latency_us;
+            if (stats.latency_us > stats.latency_max_us) {
+                stats.latency_max_us = stats.latency_us;
+            }
+        }
+    }
+}
+
+void LilyGoIrqService::serviceTask(void *p)
+{
+    LilyGoIrqService *self = (LilyGoIrqService *)p;
+    while (1) {
+        // Clearing on exit takes every pending source in one pass
+        EventBits_t bits = xEventGroupWaitBits(self->_group, self->_mask | HW_IRQ_SERVICE_EXIT,
+                                               pdTRUE, pdFALSE, portMAX_DELAY);
+        self->service(bits & self->_mask);
+        if (bits & HW_IRQ_SERVICE_EXIT) {
+            break;
+        }
+    }
+    self->_task = NULL;
+    self->_running = false;
+    vTaskDelete(NULL);
+}
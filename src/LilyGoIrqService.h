@@ -0,0 +1,90 @@
+/**
+ * @file      LilyGoIrqService.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-14
+ * @note      Optional task that services the board interrupt bits as soon as they are
+ *            set, instead of waiting for the application to call loop().
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "LilyGoTypedef.h"
+
+// Maximum number of interrupt sources serviced by the task
+#ifndef CONFIG_IRQ_SERVICE_MAX_SOURCES
+#define CONFIG_IRQ_SERVICE_MAX_SOURCES  8
+#endif
+
+typedef struct {
+    uint32_t count;             // Times the source was handled
+    uint32_t latency_us;        // Interrupt to handler return, last time
+    uint32_t latency_max_us;
+    uint64_t latency_total_us;  // Divide by count for the average
+} IrqSourceStats_t;
+
+// Handles one source, 'bit' has already been cleared
+typedef void (*IrqSourceHandler_t)(EventBits_t bit, void *user_data);
+
+class LilyGoIrqService
+{
+public:
+    /**
+     * @brief Start the service task.
+     *
+     * All sources set since the last wake up are handled in one pass, in the order given,
+     * so several interrupts of one source result in a single handler call.
+     *
+     * @param group Board event group set by the interrupts
+     * @param sources Event bits in priority order, the array must stay valid
+     * @param count Number of sources
+     * @param handler Called for each pending source
+     * @param user_data Passed to handler
+     * @param core Core the task is pinned to
+     * @param priority Task priority
+     * @return true if the task is running
+     */
+    bool begin(EventGroupHandle_t group, const EventBits_t *sources, uint8_t count,
+               IrqSourceHandler_t handler, void *user_data,
+               BaseType_t core = 0, UBaseType_t priority = 5);
+
+    /**
+     * @brief Start again with the parameters of the last begin().
+     */
+    bool restart();
+
+    /**
+     * @brief Stop the task after the current pass, pending bits are left set.
+     *
+     * Called from a handler, it returns at once and the task exits when the pass is over.
+     */
+    void end();
+
+    bool isRunning();
+
+    /**
+     * @brief Get the statistics of one source.
+     * @param bit Event bit of the source
+     */
+    void getStats(EventBits_t bit, IrqSourceStats_t *stats);
+    void resetStats();
+
+private:
+    void service(EventBits_t bits);
+    static void serviceTask(void *p);
+
+    EventGroupHandle_t _group = NULL;
+    const EventBits_t *_sources = NULL;
+    uint8_t _count = 0;
+    EventBits_t _mask = 0;
+    IrqSourceHandler_t _handler = NULL;
+    void *_user_data = NULL;
+    BaseType_t _core = 0;
+    UBaseType_t _priority = 5;
+    TaskHandle_t _task = NULL;
+    volatile bool _running = false;
+    IrqSourceStats_t _stats[CONFIG_IRQ_SERVICE_MAX_SOURCES] = {};
+};
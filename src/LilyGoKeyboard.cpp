@@ -23,11 +23,17 @@
 #endif
 
 
-static bool keyboard_interrupted = false;
+static TaskHandle_t keyboard_task = NULL;
+static volatile uint32_t keyboard_irq_time = 0;
 
-static void keyboard_isr()
+static void IRAM_ATTR keyboard_isr()
 {
-    keyboard_interrupted = true;
+    BaseType_t woken = pdFALSE;
+    keyboard_irq_time = micros();
+    if (keyboard_task) {
+        vTaskNotifyGiveFromISR(keyboard_task, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
 }
 
 LilyGoKeyboard::LilyGoKeyboard()
@@ -97,6 +103,8 @@ bool LilyGoKeyboard::begin(const LilyGoKeyboardConfigure_t &config, TwoWire &w,
     lastState = false;
     lastKeyVal = '\0';
     lastPressedTime = 0;
+    _eventHead = _eventTail = 0;
+    _droppedEvents = 0;
 
     log_d("Initializing Keyboard succeeded");
 
@@ -110,9 +118,25 @@ bool LilyGoKeyboard::begin(const LilyGoKeyboardConfigure_t &config, TwoWire &w,
     if (irq > 0) {
         _irq = irq;
         ::pinMode(_irq, INPUT_PULLUP);
-        attachInterrupt(_irq, keyboard_isr, CHANGE);
+        // The events are read over I2C, which cannot be done in the interrupt
+        _taskStop = false;
+        _taskRunning = true;
+        if (xTaskCreate(keyboardTask, "kb", 3 * 1024, this, 10, &_task) != pdPASS) {
+            _taskRunning = false;
+            _task = NULL;
+        }
+        keyboard_task = _task;
+        if (!_repeatTimer) {
+            _repeatTimer = xTimerCreate("kb_rep", pdMS_TO_TICKS(_repeatDelay), pdTRUE, this, repeatTimerCallback);
+        }
+        // INT is held low until the flags are cleared, only the falling edge starts a read
+        attachInterrupt(_irq, keyboard_isr, FALLING);
         log_d("Set keyboard input pull. pin %d", _irq);
         this->enableInterrupts();
+        // Events queued before the interrupt was attached
+        if (::digitalRead(_irq) == LOW) {
+            xTaskNotifyGive(_task);
+        }
     }
     return true;
 }
@@ -126,6 +150,17 @@ void LilyGoKeyboard::end()
         detachInterrupt(_irq);
         ::pinMode(_irq, OPEN_DRAIN);
     }
+    stopRepeat();
+    if (_task) {
+        keyboard_task = NULL;
+        _taskStop = true;
+        xTaskNotifyGive(_task);
+        // The task finishes the transfer it is in, the Wire lock is released
+        while (_taskRunning) {
+            vTaskDelay(pdMS_TO_TICKS(2));
+        }
+        _task = NULL;
+    }
     if (_backlight != -1) {
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5,0,0)
         ledcDetach(_backlight);
@@ -162,28 +197,197 @@ void LilyGoKeyboard::setRawCallback(KeyboardRawCallback cb)
 void LilyGoKeyboard::setRepeat(bool enable)
 {
     repeat_function = enable;
+    if (!enable) {
+        stopRepeat();
+    }
+}
+
+void LilyGoKeyboard::setRepeatTiming(uint16_t delay_ms, uint16_t rate_ms)
+{
+    _repeatDelay = delay_ms ? delay_ms : 1;
+    _repeatRate = rate_ms ? rate_ms : 1;
+}
+
+void LilyGoKeyboard::startRepeat()
+{
+    if (!_repeatTimer) {
+        return;
+    }
+    _repeatDelayPhase = true;
+    // Changing the period also (re)starts the timer from now
+    xTimerChangePeriod(_repeatTimer, pdMS_TO_TICKS(_repeatDelay), 0);
+}
+
+void LilyGoKeyboard::stopRepeat()
+{
+    if (_repeatTimer && xTimerIsTimerActive(_repeatTimer)) {
+        xTimerStop(_repeatTimer, 0);
+    }
+}
+
+void LilyGoKeyboard::repeatTimerCallback(TimerHandle_t timer)
+{
+    LilyGoKeyboard *kb = (LilyGoKeyboard *)pvTimerGetTimerID(timer);
+    if (kb->_repeatDelayPhase) {
+        kb->_repeatDelayPhase = false;
+        xTimerChangePeriod(timer, pdMS_TO_TICKS(kb->_repeatRate), 0);
+    }
+    if (kb->_task) {
+        kb->_repeatPending = true;
+        xTaskNotifyGive(kb->_task);
+    }
+}
+
+uint32_t LilyGoKeyboard::getLastKeyTime()
+{
+    return _lastKeyTime;
+}
+
+uint32_t LilyGoKeyboard::getDroppedEvents()
+{
+    return _droppedEvents;
+}
+
+bool LilyGoKeyboard::pushEvent(const KeyboardEvent_t &event)
+{
+    uint32_t head = _eventHead;
+    if (head - __atomic_load_n(&_eventTail, __ATOMIC_ACQUIRE) >= CONFIG_KEYBOARD_EVENT_QUEUE_SIZE) {
+        _droppedEvents++;
+        return false;
+    }
+    _events[head & (CONFIG_KEYBOARD_EVENT_QUEUE_SIZE - 1)] = event;
+    __atomic_store_n(&_eventHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool LilyGoKeyboard::popEvent(KeyboardEvent_t *event)
+{
+    uint32_t tail = _eventTail;
+    if (tail == __atomic_load_n(&_eventHead, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+    *event = _events[tail & (CONFIG_KEYBOARD_EVENT_QUEUE_SIZE - 1)];
+    __atomic_store_n(&_eventTail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void LilyGoKeyboard::drainFifo(uint32_t time_us)
+{
+    uint8_t intStat = this->readRegister(TCA8418_REG_INT_STAT);
+    if (intStat & 0x02) {
+        //  reading the registers is mandatory to clear IRQ flag
+        //  can also be used to find the GPIO changed
+        //  as these registers are a bitmap of the gpio pins.
+        this->readRegister(TCA8418_REG_GPIO_INT_STAT_1);
+        this->readRegister(TCA8418_REG_GPIO_INT_STAT_2);
+        this->readRegister(TCA8418_REG_GPIO_INT_STAT_3);
+    }
+
+    // Take every queued event, not just one per interrupt
+    uint8_t count = this->available();
+    while (count--) {
+        KeyboardEvent_t event;
+        event.raw = this->getEvent();
+        if (event.raw == 0) {
+            break;
+        }
+        event.time_us = time_us;
+        pushEvent(event);
+    }
+
+    // Clear all raised flags in one write, the controller raises them again
+    // for events that arrived after the count was read
+    this->writeRegister(TCA8418_REG_INT_STAT, intStat | 0x01);
+}
+
+void LilyGoKeyboard::keyboardTask(void *p)
+{
+    LilyGoKeyboard *kb = (LilyGoKeyboard *)p;
+    TickType_t wait = portMAX_DELAY;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, wait);
+        if (kb->_taskStop) {
+            break;
+        }
+        // INT stays low while events remain, there is no new falling edge for them
+        for (int pass = 0; pass < CONFIG_KEYBOARD_DRAIN_PASSES && ::digitalRead(kb->_irq) == LOW; pass++) {
+            if (pass) {
+                vTaskDelay(1);
+            }
+            kb->drainFifo(keyboard_irq_time);
+        }
+        // Still low after the passes, retry later instead of spinning
+        wait = ::digitalRead(kb->_irq) == LOW ? pdMS_TO_TICKS(20) : portMAX_DELAY;
+        // Queued after the controller events, a release read above cancels it in getKey
+        if (kb->_repeatPending) {
+            kb->_repeatPending = false;
+            KeyboardEvent_t event;
+            event.raw = KB_RAW_REPEAT;
+            event.time_us = micros();
+            kb->pushEvent(event);
+        }
+    }
+    kb->_taskRunning = false;
+    vTaskDelete(NULL);
 }
 
 int LilyGoKeyboard::getKey(char *c)
 {
-    const uint32_t REPEAT_INTERVAL = 300;
     static char output;
     static uint32_t interval = 0;
-    int val = -1;
+    KeyboardEvent_t event;
 
-    if (millis() - interval > 100) {
-        // Polling detects whether there is an ignored state in the interrupt status that has not been processed.
+    if (!_task && millis() - interval > 100) {
+        // Without an interrupt pin the FIFO is polled.
         // The polling speed affects the response speed of the keyboard.
         interval = millis();
-        this->readRegister(TCA8418_REG_INT_STAT);
-        if (this->available() != 0 && !keyboard_interrupted) {
-            keyboard_interrupted = true;
+        if (this->available() != 0) {
+            drainFifo(micros());
+        }
+    }
+
+    // Translate queued events in order, modifier, gpio and raw events produce no key
+    while (popEvent(&event)) {
+        int ret;
+        if (event.raw == KB_RAW_REPEAT) {
+            // The key was released before the repeat was read
+            if (!repeat_function || !lastState) {
+                continue;
+            }
+            // The space key conflicts with the symbol function,
+            // so the space key is not processed as a continuous key.
+            if (lastKeyVal == 0 || lastKeyVal == ' ') {
+                lastState = false;
+                stopRepeat();
+                continue;
+            }
+            ret = KB_PRESSED;
+        } else {
+            ret = update(event.raw, &output);
+            if (ret == KB_PRESSED && repeat_function) {
+                startRepeat();
+            } else if (!lastState) {
+                stopRepeat();
+            }
+            if (ret < 0) {
+                continue;
+            }
         }
+        _lastKeyTime = event.time_us;
+        if (cb) {
+            cb(ret, output);
+        }
+        if (c) {
+            *c = output;
+        }
+        // Serial.printf("Update \"%c\" sate:%s\n", output, ret > 0 ? "Pressed" : "Released");
+        return ret;
     }
 
-    if (repeat_function) {
+    // Without the task the repeat is polled
+    if (repeat_function && !_repeatTimer) {
         if (lastState) {
-            if (millis() - lastPressedTime > REPEAT_INTERVAL) {
+            if (millis() - lastPressedTime > _repeatRate) {
                 // The space key conflicts with the symbol function,
                 // so the space key is not processed as a continuous key.
                 if (lastKeyVal == 0 || lastKeyVal == ' ') {
@@ -202,40 +406,7 @@ int LilyGoKeyboard::getKey(char *c)
             }
         }
     }
-
-    if (!keyboard_interrupted) {
-        return val;
-    }
-
-    int intStat = this->readRegister(TCA8418_REG_INT_STAT);
-    if (intStat & 0x02) {
-        //  reading the registers is mandatory to clear IRQ flag
-        //  can also be used to find the GPIO changed
-        //  as these registers are a bitmap of the gpio pins.
-        this->readRegister(TCA8418_REG_GPIO_INT_STAT_1);
-        this->readRegister(TCA8418_REG_GPIO_INT_STAT_2);
-        this->readRegister(TCA8418_REG_GPIO_INT_STAT_3);
-        //  clear GPIO IRQ flag
-        this->writeRegister(TCA8418_REG_INT_STAT, 2);
-    }
-
-
-    // Clear IRQ flag
-    this->writeRegister(TCA8418_REG_INT_STAT, 1);
-    uint8_t intstat = this->readRegister(TCA8418_REG_INT_STAT);
-    if ((intstat & 0x01) == 0) {
-        keyboard_interrupted = false;
-    }
-
-    int ret = update(&output);
-    if (cb) {
-        cb(ret, output);
-    }
-    if (c) {
-        *c = output;
-    }
-    // Serial.printf("Update \"%c\" sate:%s\n", output, ret > 0 ? "Pressed" : "Released");
-    return ret;
+    return -1;
 }
 
 
@@ -370,10 +541,9 @@ void LilyGoKeyboard::printDebugInfo(bool pressed, uint8_t k, char keyVal)
     Serial.printf("Char:'%c' (0x%X)\n", keyVal, keyVal);
 }
 
-int LilyGoKeyboard::update(char *c)
+int LilyGoKeyboard::update(uint8_t k, char *c)
 {
     char keyVal = '\0';
-    uint8_t k = this->getEvent();
     if (k == 0) {
         return -1; // No event
     }
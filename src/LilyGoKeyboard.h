@@ -17,6 +17,38 @@
 #define KB_PRESSED  1
 #define KB_RELEASED 0
 
+// Raw controller events buffered between the interrupt task and getKey, must be a power of two.
+// The TCA8418 FIFO itself only holds 10 events.
+#ifndef CONFIG_KEYBOARD_EVENT_QUEUE_SIZE
+#define CONFIG_KEYBOARD_EVENT_QUEUE_SIZE    64
+#endif
+
+static_assert((CONFIG_KEYBOARD_EVENT_QUEUE_SIZE & (CONFIG_KEYBOARD_EVENT_QUEUE_SIZE - 1)) == 0,
+              "CONFIG_KEYBOARD_EVENT_QUEUE_SIZE must be a power of two");
+
+// FIFO drains per interrupt, a failed read or a stuck INT line must not keep the task busy
+#ifndef CONFIG_KEYBOARD_DRAIN_PASSES
+#define CONFIG_KEYBOARD_DRAIN_PASSES        8
+#endif
+
+// Time a key is held before it starts repeating
+#ifndef CONFIG_KEYBOARD_REPEAT_DELAY_MS
+#define CONFIG_KEYBOARD_REPEAT_DELAY_MS     300
+#endif
+
+// Interval between repeats once repeating
+#ifndef CONFIG_KEYBOARD_REPEAT_RATE_MS
+#define CONFIG_KEYBOARD_REPEAT_RATE_MS      300
+#endif
+
+// Raw value of the events queued by the repeat timer, not a valid TCA8418 event
+#define KB_RAW_REPEAT   0xFF
+
+typedef struct {
+    uint8_t raw;        // TCA8418 key event, bit 7 is set when pressed
+    uint32_t time_us;   // Time of the interrupt that reported it
+} KeyboardEvent_t;
+
 typedef struct LilyGoKeyboardConfigure {
     uint8_t kb_rows;
     uint8_t kb_cols;
@@ -152,14 +184,56 @@ public:
      */
     void setRepeat(bool enable);
 
+    /**
+     * @brief Sets the key repeat timing.
+     * @note  With an interrupt pin the repeats are generated by a timer and queued
+     *          with the key events, so they do not depend on how often getKey is called.
+     *
+     * @param delay_ms Time the key is held before the first repeat.
+     * @param rate_ms Interval between the following repeats.
+     */
+    void setRepeatTiming(uint16_t delay_ms, uint16_t rate_ms);
+
+    /**
+     * @brief Gets the interrupt time of the key last returned by getKey.
+     *
+     * @return Timestamp in microseconds.
+     */
+    uint32_t getLastKeyTime();
+
+    /**
+     * @brief Gets the number of events lost because the event queue was full.
+     */
+    uint32_t getDroppedEvents();
+
 private:
     /**
-     * @brief Updates the keyboard state and retrieves the currently pressed key.
+     * @brief Translates one controller event and updates the keyboard state.
      *
+     * @param raw The TCA8418 key event.
      * @param c A pointer to a character where the key value will be stored.
      * @return An integer representing the state of the key press.
      */
-    int update(char *c);
+    int update(uint8_t raw, char *c);
+
+    /**
+     * @brief Reads every event queued in the controller FIFO into the event queue
+     *        and clears the interrupt flags.
+     *
+     * @param time_us Timestamp given to the events.
+     */
+    void drainFifo(uint32_t time_us);
+
+    // Single producer (drainFifo) single consumer (getKey) event queue
+    bool pushEvent(const KeyboardEvent_t &event);
+    bool popEvent(KeyboardEvent_t *event);
+
+    static void keyboardTask(void *p);
+    static void repeatTimerCallback(TimerHandle_t timer);
+
+    // Start counting the repeat delay from now, or stop repeating
+    void startRepeat();
+    void stopRepeat();
 
     /**
      * @brief Prints debug information about the key press event.
@@ -237,6 +311,22 @@ private:
     uint32_t lastPressedTime = 0;
     // Pointer to the storage keyboard config
     const LilyGoKeyboardConfigure_t *_config;
+    // Task draining the controller FIFO, NULL when no interrupt pin is used
+    TaskHandle_t _task = NULL;
+    // Asks the task to return, end() waits for it instead of deleting it inside an I2C transfer
+    volatile bool _taskStop = false;
+    volatile bool _taskRunning = false;
+    KeyboardEvent_t _events[CONFIG_KEYBOARD_EVENT_QUEUE_SIZE];
+    uint32_t _eventHead = 0;
+    uint32_t _eventTail = 0;
+    uint32_t _droppedEvents = 0;
+    uint32_t _lastKeyTime = 0;
+    // Repeat timer, it only asks the task to queue a repeat so the queue keeps a single producer
+    TimerHandle_t _repeatTimer = NULL;
+    uint16_t _repeatDelay = CONFIG_KEYBOARD_REPEAT_DELAY_MS;
+    uint16_t _repeatRate = CONFIG_KEYBOARD_REPEAT_RATE_MS;
+    volatile bool _repeatDelayPhase = false;
+    volatile bool _repeatPending = false;
 
 };
 #endif
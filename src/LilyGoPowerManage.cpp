@@ -82,4 +82,67 @@ void LilyGoPowerManage::enablePowerMeasure()
     power->enableTemperatureMeasure();
 }
 
+// Ordered as the events were previously checked, the last one found is reported as the record type
+static const struct {
+    uint32_t irq;
+    PMUEventType_t event;
+} irq_event_table[] = {
+    {XPOWERS_AXP2101_WARNING_LEVEL2_IRQ,    PMU_EVENT_LOW_VOLTAGE_LEVEL2},
+    {XPOWERS_AXP2101_WARNING_LEVEL1_IRQ,    PMU_EVENT_LOW_VOLTAGE_LEVEL1},
+    {XPOWERS_AXP2101_BAT_CHG_OVER_TEMP_IRQ, PMU_EVENT_CHARGE_HIGH_TEMP},
+    {XPOWERS_AXP2101_VBUS_INSERT_IRQ,       PMU_EVENT_USBC_INSERT},
+    {XPOWERS_AXP2101_VBUS_REMOVE_IRQ,       PMU_EVENT_USBC_REMOVE},
+    {XPOWERS_AXP2101_BAT_INSERT_IRQ,        PMU_EVENT_BATTERY_INSERT},
+    {XPOWERS_AXP2101_BAT_REMOVE_IRQ,        PMU_EVENT_BATTERY_REMOVE},
+    {XPOWERS_AXP2101_PKEY_SHORT_IRQ,        PMU_EVENT_KEY_CLICKED},
+    {XPOWERS_AXP2101_PKEY_LONG_IRQ,         PMU_EVENT_KEY_LONG_PRESSED},
+    {XPOWERS_AXP2101_BATFET_OVER_CURR_IRQ,  PMU_EVENT_BAT_FET_OVER_CURRENT},
+    {XPOWERS_AXP2101_BAT_CHG_DONE_IRQ,      PMU_EVENT_CHARGE_FINISH},
+    {XPOWERS_AXP2101_BAT_CHG_START_IRQ,     PMU_EVENT_CHARGE_STARTED},
+    {XPOWERS_AXP2101_CHAGER_TIMER_IRQ,      PMU_EVENT_CHARGE_TIMEOUT},
+    {XPOWERS_AXP2101_BAT_OVER_VOL_IRQ,      PMU_EVENT_BATTERY_OVER_VOLTAGE},
+};
+
+uint32_t LilyGoPowerManage::decodeIrqStatus(uint32_t irq_status, bool battery_connected, PMUEventType_t *last)
+{
+    uint32_t mask = 0;
+    PMUEventType_t event = PMU_EVENT_NONE;
+    if (!battery_connected) {
+        irq_status &= ~(XPOWERS_AXP2101_BAT_CHG_DONE_IRQ | XPOWERS_AXP2101_BAT_CHG_START_IRQ);
+    }
+    for (uint32_t i = 0; i < sizeof(irq_event_table) / sizeof(irq_event_table[0]); i++) {
+        if (irq_status & irq_event_table[i].irq) {
+            event = irq_event_table[i].event;
+            mask |= _BV(event);
+        }
+    }
+    if (last) {
+        *last = event;
+    }
+    return mask;
+}
+
+bool LilyGoPowerManage::readPowerEvent(PMUEventRecord_t *record)
+{
+    // INTEN1..3 at 0x40, INTSTS1..3 at 0x48, read in one transfer
+    uint8_t regs[XPOWERS_AXP2101_INTSTS1 - XPOWERS_AXP2101_INTEN1 + 3] = {0};
+    const uint8_t *enable = regs;
+    uint8_t *status = regs + (XPOWERS_AXP2101_INTSTS1 - XPOWERS_AXP2101_INTEN1);
+    bool battery_connected = power->isBatteryConnect();
+    if (power->readRegister(XPOWERS_AXP2101_INTEN1, regs, sizeof(regs)) < 0) {
+        log_e("Failed to read PMU interrupt status");
+        return false;
+    }
+    // Write 1 to clear, only the bits that were read so nothing raised meanwhile is lost
+    power->writeRegister(XPOWERS_AXP2101_INTSTS1, status, 3);
+
+    // Status bits latch whether or not the interrupt is enabled, only enabled ones are events
+    uint32_t enabled = enable[0] | (enable[1] << 8) | ((uint32_t)enable[2] << 16);
+    record->irq_status = (status[0] | (status[1] << 8) | ((uint32_t)status[2] << 16)) & enabled;
+    record->timestamp = millis();
+    record->mask = decodeIrqStatus(record->irq_status, battery_connected, &record->type);
+    log_d("PMU irq status:0x%06lx events:0x%lx", (unsigned long)record->irq_status, (unsigned long)record->mask);
+    return record->mask != 0;
+}
+
 #endif /*#ifdef USING_PMU_MANAGE*/
\ No newline at end of file
@@ -12,6 +12,7 @@
 #ifdef USING_PMU_MANAGE
 
 #include <XPowersLib.h>
+#include "LilyGoEventManage.h"
 
 class LilyGoPowerManage
 {
@@ -73,6 +74,27 @@ public:
     */
     void enablePowerMeasure();
 
+    /**
+     * @brief Read and clear the PMU interrupt status.
+     *
+     * The three status registers are read in one I2C transfer and cleared in one write.
+     * Every asserted interrupt that maps to a PMUEventType_t is set in the record mask.
+     *
+     * @param record Receives the events.
+     * @return bool True if at least one event was found.
+     */
+    bool readPowerEvent(PMUEventRecord_t *record);
+
+    /**
+     * @brief Translate a raw interrupt status into PMUEventType_t bits.
+     *
+     * @param irq_status The three status registers, low byte first.
+     * @param battery_connected Charge start and done are ignored without a battery.
+     * @param last Receives the last event found, can be NULL.
+     * @return uint32_t _BV(PMUEventType_t) of every event found.
+     */
+    static uint32_t decodeIrqStatus(uint32_t irq_status, bool battery_connected, PMUEventType_t *last);
+
 private:
     XPowersAXP2101 *power;
 };
@@ -0,0 +1,176 @@
+/**
+ * @file      LilyGoTouchService.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-12
+ *
+ */
+#include "LilyGoTouchService.h"
+#include <math.h>
+
+extern uint32_t takeGroupBitsTime(const EventBits_t uxBit);
+
+// Cutoff of the speed estimate used by the one euro filter
+#define TOUCH_SPEED_CUTOFF_HZ   1.0f
+
+static inline float touch_alpha(float cutoff, float dt)
+{
+    float tau = 1.0f / (2.0f * (float)M_PI * cutoff);
+    return 1.0f / (1.0f + tau / dt);
+}
+
+bool LilyGoTouchService::begin(TouchReadCallback_t read_cb, void *user_data, EventGroupHandle_t group, EventBits_t bit)
+{
+    if (_task) {
+        return true;
+    }
+    _read_cb = read_cb;
+    _user_data = user_data;
+    _group = group;
+    _bit = bit;
+    _history_count = 0;
+    _last_count = 0;
+    memset(&_latest, 0, sizeof(_latest));
+    _running = true;
+    if (xTaskCreate(serviceTask, "touch", 3 * 1024, this, 10, &_task) != pdPASS) {
+        _running = false;
+        _task = NULL;
+        return false;
+    }
+    return true;
+}
+
+void LilyGoTouchService::end()
+{
+    if (_task) {
+        // Let the task finish its bus access and exit by itself
+        _stop = true;
+        xEventGroupSetBits(_group, _bit);
+        while (_running) {
+            delay(1);
+        }
+        _task = NULL;
+        _stop = false;
+        xEventGroupClearBits(_group, _bit);
+    }
+    portENTER_CRITICAL(&_mux);
+    _latest.count = 0;
+    portEXIT_CRITICAL(&_mux);
+}
+
+uint8_t LilyGoTouchService::getPoints(int16_t *x_array, int16_t *y_array, uint8_t max, uint32_t *time_us)
+{
+    portENTER_CRITICAL(&_mux);
+    uint8_t count = _latest.count < max ? _latest.count : max;
+    for (uint8_t i = 0; i < count; i++) {
+        x_array[i] = _latest.x[i];
+        y_array[i] = _latest.y[i];
+    }
+    if (time_us) {
+        *time_us = _latest.time_us;
+    }
+    uint8_t touched = _latest.count;
+    portEXIT_CRITICAL(&_mux);
+    return touched;
+}
+
+uint8_t LilyGoTouchService::getHistory(TouchSample_t *out, uint8_t max)
+{
+    portENTER_CRITICAL(&_mux);
+    uint32_t count = _history_count < CONFIG_TOUCH_HISTORY ? _history_count : CONFIG_TOUCH_HISTORY;
+    if (count > max) {
+        count = max;
+    }
+    uint32_t first = _history_count - count;
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = _history[(first + i) % CONFIG_TOUCH_HISTORY];
+    }
+    portEXIT_CRITICAL(&_mux);
+    return count;
+}
+
+void LilyGoTouchService::setFilter(bool enable, float min_cutoff, float beta)
+{
+    _min_cutoff = min_cutoff;
+    _beta = beta;
+    _filter_enable = enable;
+}
+
+void LilyGoTouchService::setPrediction(uint16_t horizon_ms)
+{
+    _horizon_ms = horizon_ms;
+}
+
+float LilyGoTouchService::filterAxis(AxisFilter &f, float x, float dt)
+{
+    float speed = (x - f.value) / dt;
+    f.speed += touch_alpha(TOUCH_SPEED_CUTOFF_HZ, dt) * (speed - f.speed);
+    if (_filter_enable) {
+        float cutoff = _min_cutoff + _beta * fabsf(f.speed);
+        f.value += touch_alpha(cutoff, dt) * (x - f.value);
+    } else {
+        f.value = x;
+    }
+    return f.value + f.speed * _horizon_ms / 1000.0f;
+}
+
+void LilyGoTouchService::process(const TouchSample_t &raw)
+{
+    TouchSample_t out = raw;
+    if (_filter_enable || _horizon_ms) {
+        // Points are renumbered when a finger is added or lifted, start over
+        bool restart = raw.count != _last_count;
+        float dt = (raw.time_us - _last_time_us) / 1000000.0f;
+        for (uint8_t i = 0; i < raw.count; i++) {
+            if (restart || dt <= 0) {
+                _fx[i] = {(float)raw.x[i], 0};
+                _fy[i] = {(float)raw.y[i], 0};
+                continue;
+            }
+            out.x[i] = (int16_t)lroundf(filterAxis(_fx[i], raw.x[i], dt));
+            out.y[i] = (int16_t)lroundf(filterAxis(_fy[i], raw.y[i], dt));
+        }
+    }
+    _last_count = raw.count;
+    _last_time_us = raw.time_us;
+
+    portENTER_CRITICAL(&_mux);
+    _history[_history_count % CONFIG_TOUCH_HISTORY] = raw;
+    _history_count++;
+    _latest = out;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void LilyGoTouchService::serviceTask(void *p)
+{
+    LilyGoTouchService *self = (LilyGoTouchService *)p;
+    TouchSample_t sample;
+    while (1) {
+        // Leave the bit set while touched, getTouched() reports it
+        xEventGroupWaitBits(self->_group, self->_bit, pdFALSE, pdFALSE, portMAX_DELAY);
+        TickType_t last_wake = xTaskGetTickCount();
+        // The first sample of a touch is stamped with the interrupt, the following ones with the read
+        uint32_t irq_time = takeGroupBitsTime(self->_bit);
+        while (!self->_stop) {
+            memset(&sample, 0, sizeof(sample));
+            sample.count = self->_read_cb(sample.x, sample.y, CONFIG_TOUCH_MAX_POINTS, self->_user_data);
+            sample.time_us = irq_time ? irq_time : micros();
+            irq_time = 0;
+            if (sample.count > CONFIG_TOUCH_MAX_POINTS) {
+                sample.count = CONFIG_TOUCH_MAX_POINTS;
+            }
+            self->process(sample);
+            if (sample.count == 0) {
+                xEventGroupClearBits(self->_group, self->_bit);
+                break;
+            }
+            vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CONFIG_TOUCH_SAMPLE_PERIOD_MS));
+        }
+        if (self->_stop) {
+            break;
+        }
+    }
+    self->_running = false;
+    vTaskDelete(NULL);
+}
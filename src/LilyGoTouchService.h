@@ -0,0 +1,129 @@
+/**
+ * @file      LilyGoTouchService.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-12
+ * @note      Reads the touch controller from its own task when the touch interrupt
+ *            fires, so the LVGL read callback only copies the latest state.
+ */
+#pragma once
+
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+// Maximum number of simultaneous touch points kept per sample
+#ifndef CONFIG_TOUCH_MAX_POINTS
+#define CONFIG_TOUCH_MAX_POINTS         2
+#endif
+
+// Number of samples kept in the history ring
+#ifndef CONFIG_TOUCH_HISTORY
+#define CONFIG_TOUCH_HISTORY            8
+#endif
+
+// Read period while a finger is down, the controllers do not
+// raise an interrupt for every report while touched
+#ifndef CONFIG_TOUCH_SAMPLE_PERIOD_MS
+#define CONFIG_TOUCH_SAMPLE_PERIOD_MS   10
+#endif
+
+typedef struct {
+    int16_t x[CONFIG_TOUCH_MAX_POINTS];
+    int16_t y[CONFIG_TOUCH_MAX_POINTS];
+    uint8_t count;          // Points touched, 0 when released
+    uint32_t time_us;       // Time of the read, of the interrupt for the first sample of a touch
+} TouchSample_t;
+
+// Reads up to 'max' points from the controller, returns the number of points touched
+typedef uint8_t (*TouchReadCallback_t)(int16_t *x, int16_t *y, uint8_t max, void *user_data);
+
+class LilyGoTouchService
+{
+public:
+    /**
+     * @brief Start the service task.
+     *
+     * The task sleeps until 'bit' is set in 'group' by the touch interrupt, then reads the
+     * controller every CONFIG_TOUCH_SAMPLE_PERIOD_MS until the touch is released and clears 'bit'.
+     *
+     * @param read_cb Controller read function
+     * @param user_data Passed to read_cb
+     * @param group Board event group the touch interrupt sets
+     * @param bit Touch interrupt bit in the group
+     * @return true if the task was created
+     */
+    bool begin(TouchReadCallback_t read_cb, void *user_data, EventGroupHandle_t group, EventBits_t bit);
+
+    /**
+     * @brief Stop the service task, call before putting the controller to sleep.
+     */
+    void end();
+
+    /**
+     * @brief Copy the latest points, filtered and predicted when enabled. No bus access.
+     * @param x_array Destination of the x coordinates
+     * @param y_array Destination of the y coordinates
+     * @param max Size of the destination arrays
+     * @param time_us Receives the time of the sample, can be NULL
+     * @retval Number of points touched
+     */
+    uint8_t getPoints(int16_t *x_array, int16_t *y_array, uint8_t max, uint32_t *time_us = NULL);
+
+    /**
+     * @brief Copy the most recent raw samples, oldest first.
+     * @param out Destination array
+     * @param max Size of the destination array
+     * @retval Number of samples copied
+     */
+    uint8_t getHistory(TouchSample_t *out, uint8_t max);
+
+    /**
+     * @brief Smooth the points with a one euro filter.
+     *        Jitter is removed at low speed while fast movement follows with little lag.
+     * @param enable Enable or disable the filter
+     * @param min_cutoff Cutoff frequency in Hz at rest, lower is smoother
+     * @param beta Cutoff increase per pixel/s of speed, higher reduces lag
+     */
+    void setFilter(bool enable, float min_cutoff = 1.0f, float beta = 0.01f);
+
+    /**
+     * @brief Extrapolate the points along the filtered velocity.
+     * @param horizon_ms How far ahead to predict, 0 disables it
+     */
+    void setPrediction(uint16_t horizon_ms);
+
+private:
+    struct AxisFilter {
+        float value;
+        float speed;
+    };
+
+    void process(const TouchSample_t &raw);
+    float filterAxis(AxisFilter &f, float x, float dt);
+
+    static void serviceTask(void *p);
+
+    TouchReadCallback_t _read_cb = NULL;
+    void *_user_data = NULL;
+    EventGroupHandle_t _group = NULL;
+    EventBits_t _bit = 0;
+    TaskHandle_t _task = NULL;
+    volatile bool _running = false;
+    volatile bool _stop = false;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+
+    TouchSample_t _history[CONFIG_TOUCH_HISTORY];
+    uint32_t _history_count = 0;
+    TouchSample_t _latest = {};
+
+    bool _filter_enable = false;
+    float _min_cutoff = 1.0f;
+    float _beta = 0.01f;
+    uint16_t _horizon_ms = 0;
+    AxisFilter _fx[CONFIG_TOUCH_MAX_POINTS];
+    AxisFilter _fy[CONFIG_TOUCH_MAX_POINTS];
+    uint8_t _last_count = 0;
+    uint32_t _last_time_us = 0;
+};
@@ -58,6 +58,10 @@
 #define HW_IRQ_POWER                (_BV(2))
 #define HW_IRQ_SENSOR               (_BV(3))
 #define HW_IRQ_EXPAND               (_BV(4))
+// Set by ButtonBank when button events are ready
+#define HW_IRQ_BUTTON               (_BV(5))
+// Not an interrupt, tells the IRQ service task to exit
+#define HW_IRQ_SERVICE_EXIT         (_BV(23))
 
 
 typedef enum PowerCtrlChannel {
@@ -18,6 +18,7 @@
 #include "LilyGoLib.h"
 #include "driver/rtc_io.h"
 
+extern uint32_t takeGroupBitsTime(const EventBits_t uxBit);
 extern void setGroupBitsFromISR(EventGroupHandle_t xEventGroup,
                                 const EventBits_t uxBitsToSet);
 extern void setupMSC(lock_callback_t lock_cb, lock_callback_t ulock_cb);
@@ -41,7 +42,7 @@ LilyGoWatch2022 *LilyGoWatch2022::_instance = nullptr;
 
 static bool _lock_callback(void)
 {
-    return instance.lockSPI();
+    return instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_SD);
 }
 
 static bool _unlock_callback(void)
@@ -239,6 +240,11 @@ bool LilyGoWatch2022::initGPS()
     return res;
 }
 
+static uint8_t touchRead(int16_t *x, int16_t *y, uint8_t max, void *user_data)
+{
+    return ((TouchDrvFT6X36 *)user_data)->getPoint(x, y, max);
+}
+
 bool LilyGoWatch2022::initTouch()
 {
     log_d("Init Touch");
@@ -256,6 +262,8 @@ bool LilyGoWatch2022::initTouch()
         attachInterrupt(TP_INT, []() {
             setGroupBitsFromISR(_event, HW_IRQ_TOUCHPAD);
         }, FALLING);
+
+        touchService.begin(touchRead, &touch, _event, HW_IRQ_TOUCHPAD);
     }
     return res;
 }
@@ -534,102 +542,10 @@ bool LilyGoWatch2022::initPMU()
 
 void LilyGoWatch2022::checkPowerStatus()
 {
-    static PMUEventType_t event;
-
-    event = PMU_EVENT_NONE;
-
-    bool batteryInsert = pmu.isBatteryConnect();
-    // Get PMU Interrupt Status Register
-    pmu.getIrqStatus();
-
-    if (pmu.isDropWarningLevel2Irq()) {
-        log_d("isDropWarningLevel2");
-        event = PMU_EVENT_LOW_VOLTAGE_LEVEL2;
-    }
-    if (pmu.isDropWarningLevel1Irq()) {
-        log_d("isDropWarningLevel1");
-        event = PMU_EVENT_LOW_VOLTAGE_LEVEL1;
-    }
-    if (pmu.isGaugeWdtTimeoutIrq()) {
-        log_d("isWdtTimeout");
-    }
-    if (pmu.isBatChargerOverTemperatureIrq()) {
-        log_d("isBatChargeOverTemperature");
-        event = PMU_EVENT_CHARGE_HIGH_TEMP;
-    }
-    if (pmu.isBatWorkOverTemperatureIrq()) {
-        log_d("isBatWorkOverTemperature");
-    }
-    if (pmu.isBatWorkUnderTemperatureIrq()) {
-        log_d("isBatWorkUnderTemperature");
-    }
-    if (pmu.isVbusInsertIrq()) {
-        log_d("isVbusInsert");
-        event = PMU_EVENT_USBC_INSERT;
-    }
-    if (pmu.isVbusRemoveIrq()) {
-        log_d("isVbusRemove");
-        event = PMU_EVENT_USBC_REMOVE;
-    }
-    if (pmu.isBatInsertIrq()) {
-        log_d("isBatInsert");
-        event = PMU_EVENT_BATTERY_INSERT;
-    }
-    if (pmu.isBatRemoveIrq()) {
-        log_d("isBatRemove");
-        event = PMU_EVENT_BATTERY_REMOVE;
-    }
-    if (pmu.isPekeyShortPressIrq()) {
-        log_d("isPekeyShortPress");
-        event = PMU_EVENT_KEY_CLICKED;
-    }
-    if (pmu.isPekeyLongPressIrq()) {
-        log_d("isPekeyLongPress");
-        event = PMU_EVENT_KEY_LONG_PRESSED;
-    }
-    if (pmu.isPekeyNegativeIrq()) {
-        log_d("isPekeyNegative");
-    }
-    if (pmu.isPekeyPositiveIrq()) {
-        log_d("isPekeyPositive");
-    }
-    if (pmu.isWdtExpireIrq()) {
-        log_d("isWdtExpire");
-    }
-    if (pmu.isLdoOverCurrentIrq()) {
-        log_d("isLdoOverCurrentIrq");
-    }
-    if (pmu.isBatfetOverCurrentIrq()) {
-        log_d("isBatfetOverCurrentIrq");
-    }
-
-    if (batteryInsert) {
-        if (pmu.isBatChargeDoneIrq()) {
-            log_d("isBatChargeDone");
-            event = PMU_EVENT_CHARGE_FINISH;
-        }
-        if (pmu.isBatChargeStartIrq()) {
-            log_d("isBatChargeStart");
-            event = PMU_EVENT_CHARGE_STARTED;
-        }
-    }
-
-    if (pmu.isBatDieOverTemperatureIrq()) {
-        log_d("isBatDieOverTemperature");
-    }
-    if (pmu.isChargeOverTimeoutIrq()) {
-        log_d("isChargeOverTimeout");
-        event = PMU_EVENT_CHARGE_TIMEOUT;
-    }
-    if (pmu.isBatOverVoltageIrq()) {
-        log_d("isBatOverVoltage");
-        event = PMU_EVENT_BATTERY_OVER_VOLTAGE;
-    }
-    // Clear PMU Interrupt Status Register
-    pmu.clearIrqStatus();
-
-    if (event != PMU_EVENT_NONE) {
-        sendEvent(POWER_EVENT, &event);
+    PMUEventRecord_t record;
+    // All events of one interrupt are delivered together, sendEvent is synchronous
+    if (readPowerEvent(&record)) {
+        sendEvent(POWER_EVENT, &record);
     }
 }
 
@@ -765,6 +681,9 @@ void LilyGoWatch2022::sleep(WakeupSource_t wakeup_src, bool off_rtc_backup_domai
         }
     }
 
+    touchService.end();
+    irqService.end();
+
     pmu.disableIRQ(XPOWERS_AXP2101_ALL_IRQ);
 
     if (wakeup_src & WAKEUP_SRC_POWER_KEY) {
@@ -931,16 +850,15 @@ uint16_t LilyGoWatch2022::height()
 
 uint8_t LilyGoWatch2022::getPoint(int16_t *x_array, int16_t *y_array, uint8_t get_point )
 {
-    EventBits_t bits = xEventGroupGetBits(_event);
-    if (bits & HW_IRQ_TOUCHPAD) {
-        uint8_t tp = touch.getPoint(x_array, y_array, get_point);
-        if (tp == 0) {
-            xEventGroupClearBits(_event, HW_IRQ_TOUCHPAD);
-        }
-        log_d("TP:%d X:%d Y:%d", tp, x_array[0], y_array[0]);
-        return tp;
-    }
-    return 0;
+    // The touch service task reads the controller, this does not touch the bus
+    return touchService.getPoints(x_array, y_array, get_point);
+}
+
+uint32_t LilyGoWatch2022::getPointTime()
+{
+    uint32_t time_us = 0;
+    touchService.getPoints(NULL, NULL, 0, &time_us);
+    return time_us;
 }
 
 void LilyGoWatch2022::setRotation(uint8_t rotation)
@@ -958,6 +876,11 @@ void LilyGoWatch2022::pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t
     LilyGoDispSPI::pushColors( x1,  y1,  x2,  y2, color);
 }
 
+void LilyGoWatch2022::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    LilyGoDispSPI::fillRect(x, y, w, h, color);
+}
+
 
 void LilyGoWatch2022::setHapticEffects(uint8_t effects)
 {
@@ -979,26 +902,63 @@ void LilyGoWatch2022::vibrator()
     }
 }
 
-void LilyGoWatch2022::loop()
+static const EventBits_t irq_sources[] = {HW_IRQ_POWER, HW_IRQ_RTC, HW_IRQ_SENSOR};
+
+void LilyGoWatch2022::handleIrq(EventBits_t bit)
 {
-    EventBits_t bits = xEventGroupGetBits(_event);
-    if (bits & HW_IRQ_POWER) {
-        clearEventBits(HW_IRQ_POWER);
+    switch (bit) {
+    case HW_IRQ_POWER:
         checkPowerStatus();
-    }
-
-    if (bits & HW_IRQ_RTC) {
-        clearEventBits(HW_IRQ_RTC);
+        break;
+    case HW_IRQ_RTC:
         sendEvent(RTC_EVENT_INTERRUPT);
+        break;
+    case HW_IRQ_SENSOR:
+        checkSensorStatus();
+        break;
+    default:
+        break;
     }
+}
 
-    if (bits & HW_IRQ_SENSOR) {
-        clearEventBits(HW_IRQ_SENSOR);
-        checkSensorStatus();
+void LilyGoWatch2022::irqServiceHandler(EventBits_t bit, void *user_data)
+{
+    static_cast<LilyGoWatch2022 *>(user_data)->handleIrq(bit);
+}
+
+bool LilyGoWatch2022::startIrqService(BaseType_t core, UBaseType_t priority)
+{
+    return irqService.begin(_event, irq_sources, sizeof(irq_sources) / sizeof(irq_sources[0]),
+                            irqServiceHandler, this, core, priority);
+}
+
+void LilyGoWatch2022::stopIrqService()
+{
+    irqService.end();
+}
+
+void LilyGoWatch2022::getIrqStats(EventBits_t source, IrqSourceStats_t *stats)
+{
+    irqService.getStats(source, stats);
+}
+
+void LilyGoWatch2022::loop()
+{
+    // The service task handles the interrupts while it runs
+    if (irqService.isRunning()) {
+        return;
+    }
+    EventBits_t bits = xEventGroupGetBits(_event);
+    for (uint32_t i = 0; i < sizeof(irq_sources) / sizeof(irq_sources[0]); i++) {
+        if (bits & irq_sources[i]) {
+            clearEventBits(irq_sources[i]);
+            takeGroupBitsTime(irq_sources[i]);
+            handleIrq(irq_sources[i]);
+        }
     }
 }
 
-bool LilyGoWatch2022::lockSPI(TickType_t xTicksToWait)
+bool LilyGoWatch2022::lockSPI(TickType_t xTicksToWait, SpiBusOwner_t owner)
 {
     return true;
 }
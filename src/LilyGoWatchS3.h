@@ -27,7 +27,9 @@
 #include <ESP_I2S.h>
 #endif
 #include "LilyGoTypedef.h"
+#include "LilyGoIrqService.h"
 #include "LilyGoPowerManage.h"
+#include "LilyGoTouchService.h"
 #include "BrightnessController.h"
 
 #define newModule()   new Module(LORA_CS,LORA_IRQ,LORA_RST,LORA_BUSY,SPI)
@@ -46,6 +48,8 @@ private:
 public:
     GPS gps;
     TouchDrvFT6X36 touch;
+    // Reads 'touch' on interrupt, getPoint() returns its latest state
+    LilyGoTouchService touchService;
     SensorBMA423 sensor;
     SensorPCF8563 rtc;
     SensorDRV2605 drv;
@@ -105,6 +109,32 @@ public:
      */
     void loop();
 
+    /**
+     * @brief Service the board interrupts from a library task.
+     *
+     * The task wakes up as soon as an interrupt bit is set and handles the pending sources in priority
+     * order (power, RTC, sensor), so the event callbacks do not wait for the application to call loop().
+     * Once started, loop() does nothing and the event callbacks run in the service task.
+     *
+     * @param core Core the task is pinned to (default: 0).
+     * @param priority Task priority (default: 5).
+     * @return bool True if the task is running.
+     */
+    bool startIrqService(BaseType_t core = 0, UBaseType_t priority = 5);
+
+    /**
+     * @brief Stop the interrupt service task, loop() handles the interrupts again.
+     */
+    void stopIrqService();
+
+    /**
+     * @brief Get the interrupt to callback latency of one source while the service task runs.
+     *
+     * @param source The interrupt bit, e.g. HW_IRQ_POWER.
+     * @param stats Receives the statistics.
+     */
+    void getIrqStats(EventBits_t source, IrqSourceStats_t *stats);
+
     /**
      * @brief Initialize the driver.
      * @note  Already called in begin, it is only necessary to call when begin specifies not to initialize this device.
@@ -158,9 +188,10 @@ public:
      * @brief Lock the SPI bus.
      *
      * @param xTicksToWait Time to wait for the lock (default: portMAX_DELAY).
+     * @param owner Bus user, kept for the same calls as on T-LoRa-Pager, no hold statistics are kept here.
      * @return bool True if the lock is successful, false otherwise.
      */
-    bool lockSPI(TickType_t xTicksToWait = portMAX_DELAY);
+    bool lockSPI(TickType_t xTicksToWait = portMAX_DELAY, SpiBusOwner_t owner = SPI_BUS_OWNER_OTHER);
 
     /**
      * @brief Unlock the SPI bus.
@@ -206,6 +237,17 @@ public:
      */
     void pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *color);
 
+    /**
+     * @brief Fill a rectangular area of the display with one color.
+     *
+     * @param x Starting x-coordinate.
+     * @param y Starting y-coordinate.
+     * @param w Width of the area.
+     * @param h Height of the area.
+     * @param color RGB565 color.
+     */
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
+
     /**
      * @brief Check if the touch screen is available.
      *
@@ -237,6 +279,13 @@ public:
      */
     uint8_t getPoint(int16_t *x_array, int16_t *y_array, uint8_t get_point);
 
+    /**
+     * @brief Get the time the touch points last returned by getPoint were read.
+     *
+     * @return uint32_t Timestamp in microseconds, the interrupt time for the first point of a touch.
+     */
+    uint32_t getPointTime();
+
     /**
      * @brief Check if the touch screen is touched.
      *
@@ -406,6 +455,9 @@ private:
     uint8_t _effects;
     uint32_t devices_probe;
     uint8_t *_boot_images_addr;
+    LilyGoIrqService irqService;
+    void handleIrq(EventBits_t bit);
+    static void irqServiceHandler(EventBits_t bit, void *user_data);
 };
 
 extern LilyGoWatch2022 &instance;
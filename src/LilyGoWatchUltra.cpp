@@ -22,6 +22,7 @@
 
 extern void setupMSC(lock_callback_t lock_cb, lock_callback_t ulock_cb);
 extern void esp_enable_slow_crystal();
+extern uint32_t takeGroupBitsTime(const EventBits_t uxBit);
 extern void setGroupBitsFromISR(EventGroupHandle_t xEventGroup,
                                 const EventBits_t uxBitsToSet);
 
@@ -74,7 +75,7 @@ LilyGoUltra *LilyGoUltra::_instance = nullptr;
 
 static bool _lock_callback(void)
 {
-    return instance.lockSPI();
+    return instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_SD);
 }
 
 static bool _unlock_callback(void)
@@ -88,7 +89,8 @@ LilyGoUltra::LilyGoUltra() : LilyGo_Display(QSPI_DRIVER, false),
     LilyGoPowerManage(&pmu),
     _effects(80), devices_probe(0), _boot_images_addr(NULL), _lock(NULL),
     _enableDMA(false),
-    _enableTearingEffect(false)
+    _enableTearingEffect(false),
+    _enableAsyncFlush(false)
 {
     // LilyGoDispQSPI::setGapOffset(22, 0);
     LilyGoDispQSPI::setRotation(0);
@@ -105,10 +107,41 @@ bool LilyGoUltra::useDMA()
     return _enableDMA;
 }
 
-void LilyGoUltra::setDisplayParams(bool enableDMA, bool enableTearingEffect)
+bool LilyGoUltra::useAsyncFlush()
+{
+    return _enableDMA && _enableAsyncFlush;
+}
+
+void LilyGoUltra::setFlushDoneCallback(disp_flush_done_cb_t cb, void *user_data)
+{
+    LilyGoDispQSPI::setFlushDoneCallback(cb, user_data);
+}
+
+void LilyGoUltra::waitFlushDone()
+{
+    LilyGoDispQSPI::waitFlushDone();
+}
+
+bool LilyGoUltra::setSwapBytes(bool enable)
+{
+    LilyGoDispQSPI::enableSwapBytes(enable);
+    return true;
+}
+
+void LilyGoUltra::getFlushWaitTime(uint32_t *te_wait_us, uint32_t *bus_wait_us)
+{
+    DispTearingEffectStats_t stats;
+    LilyGoDispQSPI::getTearingEffectStats(&stats);
+    *te_wait_us = stats.te_wait_us;
+    // The QSPI bus is not shared
+    *bus_wait_us = 0;
+}
+
+void LilyGoUltra::setDisplayParams(bool enableDMA, bool enableTearingEffect, bool enableAsyncFlush)
 {
     _enableDMA = enableDMA;
     _enableTearingEffect = enableTearingEffect;
+    _enableAsyncFlush = enableAsyncFlush;
 }
 
 void LilyGoUltra::clearEventBits(const EventBits_t uxBitsToClear)
@@ -217,6 +250,8 @@ uint32_t LilyGoUltra::begin(uint32_t disable_hw_init)
 
     LilyGoDispQSPI::enableTearingEffect(_enableTearingEffect);
 
+    LilyGoDispQSPI::enableAsyncFlush(_enableAsyncFlush);
+
 #if defined(USING_BHI_EXPANDS)
 
     if (!initSensor()) {
@@ -371,15 +406,15 @@ bool LilyGoUltra::getTouched()
 
 uint8_t LilyGoUltra::getPoint(int16_t *x_array, int16_t *y_array, uint8_t get_point )
 {
-    EventBits_t bits = xEventGroupGetBits(_event);
-    if (bits & HW_IRQ_TOUCHPAD) {
-        uint8_t tp = touch.getPoint(x_array, y_array, get_point);
-        if (tp == 0) {
-            clearEventBits(HW_IRQ_TOUCHPAD);
-        }
-        return tp;
-    }
-    return 0;
+    // The touch service task reads the controller, this does not touch the bus
+    return touchService.getPoints(x_array, y_array, get_point);
+}
+
+uint32_t LilyGoUltra::getPointTime()
+{
+    uint32_t time_us = 0;
+    touchService.getPoints(NULL, NULL, 0, &time_us);
+    return time_us;
 }
 
 void LilyGoUltra::setHapticEffects(uint8_t effects)
@@ -527,102 +562,10 @@ bool LilyGoUltra::initPMU(bool batteryCalibration)
 
 void LilyGoUltra::checkPowerStatus()
 {
-    static PMUEventType_t event;
-
-    event = PMU_EVENT_NONE;
-
-    bool batteryInsert = pmu.isBatteryConnect();
-    // Get PMU Interrupt Status Register
-    pmu.getIrqStatus();
-
-    if (pmu.isDropWarningLevel2Irq()) {
-        log_d("isDropWarningLevel2");
-        event = PMU_EVENT_LOW_VOLTAGE_LEVEL2;
-    }
-    if (pmu.isDropWarningLevel1Irq()) {
-        log_d("isDropWarningLevel1");
-        event = PMU_EVENT_LOW_VOLTAGE_LEVEL1;
-    }
-    if (pmu.isGaugeWdtTimeoutIrq()) {
-        log_d("isWdtTimeout");
-    }
-    if (pmu.isBatChargerOverTemperatureIrq()) {
-        log_d("isBatChargeOverTemperature");
-        event = PMU_EVENT_CHARGE_HIGH_TEMP;
-    }
-    if (pmu.isBatWorkOverTemperatureIrq()) {
-        log_d("isBatWorkOverTemperature");
-    }
-    if (pmu.isBatWorkUnderTemperatureIrq()) {
-        log_d("isBatWorkUnderTemperature");
-    }
-    if (pmu.isVbusInsertIrq()) {
-        log_d("isVbusInsert");
-        event = PMU_EVENT_USBC_INSERT;
-    }
-    if (pmu.isVbusRemoveIrq()) {
-        log_d("isVbusRemove");
-        event = PMU_EVENT_USBC_REMOVE;
-    }
-    if (pmu.isBatInsertIrq()) {
-        log_d("isBatInsert");
-        event = PMU_EVENT_BATTERY_INSERT;
-    }
-    if (pmu.isBatRemoveIrq()) {
-        log_d("isBatRemove");
-        event = PMU_EVENT_BATTERY_REMOVE;
-    }
-    if (pmu.isPekeyShortPressIrq()) {
-        log_d("isPekeyShortPress");
-        event = PMU_EVENT_KEY_CLICKED;
-    }
-    if (pmu.isPekeyLongPressIrq()) {
-        log_d("isPekeyLongPress");
-        event = PMU_EVENT_KEY_LONG_PRESSED;
-    }
-    if (pmu.isPekeyNegativeIrq()) {
-        log_d("isPekeyNegative");
-    }
-    if (pmu.isPekeyPositiveIrq()) {
-        log_d("isPekeyPositive");
-    }
-    if (pmu.isWdtExpireIrq()) {
-        log_d("isWdtExpire");
-    }
-    if (pmu.isLdoOverCurrentIrq()) {
-        log_d("isLdoOverCurrentIrq");
-    }
-    if (pmu.isBatfetOverCurrentIrq()) {
-        log_d("isBatfetOverCurrentIrq");
-    }
-
-    if (batteryInsert) {
-        if (pmu.isBatChargeDoneIrq()) {
-            log_d("isBatChargeDone");
-            event = PMU_EVENT_CHARGE_FINISH;
-        }
-        if (pmu.isBatChargeStartIrq()) {
-            log_d("isBatChargeStart");
-            event = PMU_EVENT_CHARGE_STARTED;
-        }
-    }
-
-    if (pmu.isBatDieOverTemperatureIrq()) {
-        log_d("isBatDieOverTemperature");
-    }
-    if (pmu.isChargeOverTimeoutIrq()) {
-        log_d("isChargeOverTimeout");
-        event = PMU_EVENT_CHARGE_TIMEOUT;
-    }
-    if (pmu.isBatOverVoltageIrq()) {
-        log_d("isBatOverVoltage");
-        event = PMU_EVENT_BATTERY_OVER_VOLTAGE;
-    }
-    // Clear PMU Interrupt Status Register
-    pmu.clearIrqStatus();
-
-    if (event != PMU_EVENT_NONE) {
-        sendEvent(POWER_EVENT, &event);
+    PMUEventRecord_t record;
+    // All events of one interrupt are delivered together, sendEvent is synchronous
+    if (readPowerEvent(&record)) {
+        sendEvent(POWER_EVENT, &record);
     }
 }
 
@@ -662,7 +605,7 @@ void LilyGoUltra::uninstallSD()
 bool LilyGoUltra::isCardReady()
 {
     bool rlst = false;
-    if (lockSPI(pdTICKS_TO_MS(100))) {
+    if (lockSPI(pdTICKS_TO_MS(100), SPI_BUS_OWNER_SD)) {
         rlst =  SD.sectorSize() != 0;
         unlockSPI();
     }
@@ -684,6 +627,11 @@ void LilyGoUltra::pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2,
     LilyGoDispQSPI::pushColors( x1,  y1,  x2,  y2, color);
 }
 
+void LilyGoUltra::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    LilyGoDispQSPI::fillRect(x, y, w, h, color);
+}
+
 void LilyGoUltra::powerControl(enum PowerCtrlChannel ch, bool enable)
 {
     switch (ch) {
@@ -755,6 +703,14 @@ void LilyGoUltra::lightSleep(WakeupSource_t wakeup_src)
 
     radio.sleep();
 
+    // Stop reading the touch panel before the bus goes down, wakeupTouch() restarts it
+    touchService.end();
+    bool irq_service = irqService.isRunning();
+    irqService.end();
+    // The wakeup configuration changes the interrupt type of the button pins
+    bool buttons_running = buttons.isRunning();
+    buttons.end();
+
     powerControl(POWER_HAPTIC_DRIVER, false);
     powerControl(POWER_GPS, false);
     powerControl(POWER_SPEAK, false);
@@ -833,6 +789,13 @@ void LilyGoUltra::lightSleep(WakeupSource_t wakeup_src)
     attachInterrupt(PMU_INT, []() {
         setGroupBitsFromISR(_event, HW_IRQ_POWER);
     }, FALLING);
+
+    if (irq_service) {
+        irqService.restart();
+    }
+    if (buttons_running) {
+        buttons.restart();
+    }
 }
 
 
@@ -852,6 +815,10 @@ void LilyGoUltra::sleep(WakeupSource_t wakeup_src, bool off_rtc_backup_domain, u
         }
     }
 
+    touchService.end();
+    irqService.end();
+    buttons.end();
+
     pmu.disableIRQ(XPOWERS_AXP2101_ALL_IRQ);
 
     if (wakeup_src & WAKEUP_SRC_POWER_KEY) {
@@ -1097,6 +1064,11 @@ bool LilyGoUltra::initGPS()
 #define TP_RST -1
 #endif
 
+static uint8_t touchRead(int16_t *x, int16_t *y, uint8_t max, void *user_data)
+{
+    return ((TouchDrvCST92xx *)user_data)->getPoint(x, y, max);
+}
+
 bool LilyGoUltra::initTouch()
 {
     io.digitalWrite(EXPANDS_TOUCH_RST, LOW);
@@ -1126,6 +1098,7 @@ bool LilyGoUltra::initTouch()
             setGroupBitsFromISR(_event, HW_IRQ_TOUCHPAD);
         }, FALLING);
 
+        touchService.begin(touchRead, &touch, _event, HW_IRQ_TOUCHPAD);
     }
     return res;
 }
@@ -1230,31 +1203,76 @@ bool LilyGoUltra::initAmplifier()
 
 
 
-void LilyGoUltra::loop()
+static const EventBits_t irq_sources[] = {HW_IRQ_POWER, HW_IRQ_RTC, HW_IRQ_SENSOR, HW_IRQ_BUTTON};
+
+void LilyGoUltra::handleIrq(EventBits_t bit)
 {
-    EventBits_t bits = xEventGroupGetBits(_event);
-    if (bits & HW_IRQ_POWER) {
-        clearEventBits(HW_IRQ_POWER);
+    switch (bit) {
+    case HW_IRQ_POWER:
         checkPowerStatus();
-    }
-
-    if (bits & HW_IRQ_RTC) {
-        clearEventBits(HW_IRQ_RTC);
+        break;
+    case HW_IRQ_RTC:
         sendEvent(RTC_EVENT_INTERRUPT);
-    }
-
-    if (bits & HW_IRQ_SENSOR) {
-        clearEventBits(HW_IRQ_SENSOR);
+        break;
+    case HW_IRQ_SENSOR:
+        // One update drains everything the sensor hub queued since the last interrupt
         sensor.update();
         sendEvent(SENSOR_EVENT);
+        break;
+    case HW_IRQ_BUTTON:
+        buttons.dispatch(this);
+        break;
+    default:
+        break;
+    }
+}
+
+void LilyGoUltra::irqServiceHandler(EventBits_t bit, void *user_data)
+{
+    static_cast<LilyGoUltra *>(user_data)->handleIrq(bit);
+}
+
+bool LilyGoUltra::startIrqService(BaseType_t core, UBaseType_t priority)
+{
+    return irqService.begin(_event, irq_sources, sizeof(irq_sources) / sizeof(irq_sources[0]),
+                            irqServiceHandler, this, core, priority);
+}
+
+void LilyGoUltra::stopIrqService()
+{
+    irqService.end();
+}
+
+void LilyGoUltra::getIrqStats(EventBits_t source, IrqSourceStats_t *stats)
+{
+    irqService.getStats(source, stats);
+}
+
+bool LilyGoUltra::attachButtons(const uint8_t *pins, uint8_t count, bool active_low)
+{
+    return buttons.begin(pins, count, _event, HW_IRQ_BUTTON, active_low);
+}
+
+void LilyGoUltra::loop()
+{
+    // The service task handles the interrupts while it runs
+    if (irqService.isRunning()) {
+        return;
+    }
+    EventBits_t bits = xEventGroupGetBits(_event);
+    for (uint32_t i = 0; i < sizeof(irq_sources) / sizeof(irq_sources[0]); i++) {
+        if (bits & irq_sources[i]) {
+            clearEventBits(irq_sources[i]);
+            takeGroupBitsTime(irq_sources[i]);
+            handleIrq(irq_sources[i]);
+        }
     }
 
     // if (devices_probe & HW_NFC_ONLINE) {
-    //     lockSPI();
+    //     lockSPI(portMAX_DELAY, SPI_BUS_OWNER_NFC);
     //     NFCReader.rfalNfcWorker();
     //     unlockSPI();
     // }
-
 }
 
 void LilyGoUltra::wakeupTouch()
@@ -1267,9 +1285,12 @@ void LilyGoUltra::wakeupTouch()
     attachInterrupt(TP_INT, []() {
         setGroupBitsFromISR(_event, HW_IRQ_TOUCHPAD);
     }, FALLING);
+    if (devices_probe & HW_TOUCH_ONLINE) {
+        touchService.begin(touchRead, &touch, _event, HW_IRQ_TOUCHPAD);
+    }
 }
 
-bool LilyGoUltra::lockSPI(TickType_t xTicksToWait)
+bool LilyGoUltra::lockSPI(TickType_t xTicksToWait, SpiBusOwner_t owner)
 {
     return xSemaphoreTake(_lock, xTicksToWait) == pdTRUE;
 }
@@ -33,7 +33,10 @@
 #include "LilyGoDispInterface.h"
 #include "LilyGoEventManage.h"
 #include "LilyGoTypedef.h"
+#include "LilyGoIrqService.h"
+#include "ButtonBank.h"
 #include "LilyGoPowerManage.h"
+#include "LilyGoTouchService.h"
 #include "BrightnessController.h"
 
 #define newModule()   new Module(LORA_CS,LORA_IRQ,LORA_RST,LORA_BUSY)
@@ -81,6 +84,8 @@ public:
     SensorBHI260AP sensor;
     SensorPCF85063 rtc;
     TouchDrvCST92xx touch;
+    // Reads 'touch' on interrupt, getPoint() returns its latest state
+    LilyGoTouchService touchService;
     SensorDRV2605 drv;
 
 #ifdef USING_PDM_MICROPHONE
@@ -146,8 +151,11 @@ public:
      * @param enableTearingEffect A boolean value indicating whether to enable the tearing effect.
      *                            If true, the tearing effect is enabled; if false, it is disabled.
      *                            LilyGoUltra default disabled tearing effect
+     * @param enableAsyncFlush A boolean value indicating whether pushColors returns before the transfer is complete.
+     *                         Only effective when DMA is enabled, the completion is reported through the flush done callback.
+     *                         LilyGoUltra default disabled asynchronous flush
      */
-    void setDisplayParams(bool enableDMA, bool enableTearingEffect);
+    void setDisplayParams(bool enableDMA, bool enableTearingEffect, bool enableAsyncFlush = false);
 
     /**
      * @brief Begin the device.
@@ -169,6 +177,46 @@ public:
      */
     void loop();
 
+    /**
+     * @brief Service the board interrupts from a library task.
+     *
+     * The task wakes up as soon as an interrupt bit is set and handles the pending sources in priority
+     * order (power, RTC, sensor, buttons), so the event callbacks do not wait for the application to call loop().
+     * Once started, loop() does nothing and the event callbacks run in the service task.
+     *
+     * @param core Core the task is pinned to (default: 0).
+     * @param priority Task priority (default: 5).
+     * @return bool True if the task is running.
+     */
+    bool startIrqService(BaseType_t core = 0, UBaseType_t priority = 5);
+
+    /**
+     * @brief Stop the interrupt service task, loop() handles the interrupts again.
+     */
+    void stopIrqService();
+
+    /**
+     * @brief Get the interrupt to callback latency of one source while the service task runs.
+     *
+     * @param source The interrupt bit, e.g. HW_IRQ_POWER.
+     * @param stats Receives the statistics.
+     */
+    void getIrqStats(EventBits_t source, IrqSourceStats_t *stats);
+
+    /**
+     * @brief Detect clicks on buttons wired to GPIOs.
+     *
+     * The edges are timestamped in the pin interrupts and a single timer detects click, double click,
+     * triple click and long press for all of them. The results are sent as BUTTON_EVENT, from loop()
+     * or from the interrupt service task, with a ButtonEventParam_t whose id is the position in 'pins'.
+     *
+     * @param pins Button pins, e.g. the BOOT button.
+     * @param count Number of pins, at most CONFIG_BUTTON_BANK_MAX.
+     * @param active_low True if the pins read LOW while pressed (default: true).
+     * @return bool True if the buttons are attached.
+     */
+    bool attachButtons(const uint8_t *pins, uint8_t count, bool active_low = true);
+
     /**
      * @brief Initialize the NFC module.
      * @note  Already called in begin, it is only necessary to call when begin specifies not to initialize this device.
@@ -257,9 +305,10 @@ public:
      * otherwise.
      *
      * @param xTicksToWait Time to wait for the lock (default: portMAX_DELAY).
+     * @param owner Bus user, kept for the same calls as on T-LoRa-Pager, no hold statistics are kept here.
      * @return bool True if the lock is successful, false otherwise.
      */
-    bool lockSPI(TickType_t xTicksToWait = portMAX_DELAY);
+    bool lockSPI(TickType_t xTicksToWait = portMAX_DELAY, SpiBusOwner_t owner = SPI_BUS_OWNER_OTHER);
 
     /**
      * @brief Unlock the SPI bus.
@@ -339,6 +388,17 @@ public:
      */
     void pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *color) override;
 
+    /**
+     * @brief Fill a rectangular area of the display with one color.
+     *
+     * @param x Starting x-coordinate.
+     * @param y Starting y-coordinate.
+     * @param w Width of the area.
+     * @param h Height of the area.
+     * @param color RGB565 color.
+     */
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) override;
+
     /**
      * @brief Check if the touch screen is touched.
      *
@@ -363,6 +423,13 @@ public:
      */
     uint8_t getPoint(int16_t *x_array, int16_t *y_array, uint8_t get_point = 1) override;
 
+    /**
+     * @brief Get the time the touch points last returned by getPoint were read.
+     *
+     * @return uint32_t Timestamp in microseconds, the interrupt time for the first point of a touch.
+     */
+    uint32_t getPointTime() override;
+
     /**
      * @brief Check if the touch screen is available.
      *
@@ -510,6 +577,39 @@ public:
      */
     bool useDMA();
 
+    /**
+     * @brief Get the device display is enable asynchronous flush.
+     * @return true enabled , false not enable
+     */
+    bool useAsyncFlush() override;
+
+    /**
+     * @brief Set the callback called when an asynchronous pushColors is complete.
+     * @note  The callback is called from the interrupt context.
+     * @param cb The callback function.
+     * @param user_data User data passed to the callback.
+     */
+    void setFlushDoneCallback(disp_flush_done_cb_t cb, void *user_data) override;
+
+    /**
+     * @brief Block until the pending asynchronous pushColors is complete.
+     */
+    void waitFlushDone() override;
+
+    /**
+     * @brief Let the display driver swap the RGB565 byte order while sending pixels.
+     * @param enable true to swap the bytes of every pixel passed to pushColors.
+     * @return true, the driver supports the swap.
+     */
+    bool setSwapBytes(bool enable) override;
+
+    /**
+     * @brief Get the total time the display driver has waited while flushing.
+     * @param te_wait_us Time waited for the tearing effect signal.
+     * @param bus_wait_us Time waited for the bus lock.
+     */
+    void getFlushWaitTime(uint32_t *te_wait_us, uint32_t *bus_wait_us) override;
+
     /**
      * @brief Get the number of codec input channels.(Microphone)
      *
@@ -623,7 +723,11 @@ private:
     uint32_t devices_probe;
     uint8_t *_boot_images_addr;
     xSemaphoreHandle _lock;
-    bool _enableDMA, _enableTearingEffect;
+    LilyGoIrqService irqService;
+    void handleIrq(EventBits_t bit);
+    static void irqServiceHandler(EventBits_t bit, void *user_data);
+    ButtonBank buttons;
+    bool _enableDMA, _enableTearingEffect, _enableAsyncFlush;
 };
 
 #ifdef USING_ST25R3916
@@ -20,6 +20,7 @@
 #include "driver/rtc_io.h"
 
 extern void esp_enable_slow_crystal();
+extern uint32_t takeGroupBitsTime(const EventBits_t uxBit);
 extern void setGroupBitsFromISR(EventGroupHandle_t xEventGroup,
                                 const EventBits_t uxBitsToSet);
 
@@ -46,6 +47,8 @@ static QueueHandle_t rotaryMsg;
 static TaskHandle_t  rotaryHandler = NULL;
 static EventGroupHandle_t  rotaryTaskFlag = NULL;
 static void rotaryTask(void *p);
+static TaskHandle_t  hapticHandler = NULL;
+static void hapticTask(void *p);
 extern void setupMSC(lock_callback_t lock_cb, lock_callback_t ulock_cb);
 LilyGoLoRaPager *LilyGoLoRaPager::_instance = nullptr;
 
@@ -114,7 +117,7 @@ static const DispRotationConfig_t rotation_config[4] = {
 
 static bool _lock_callback(void)
 {
-    return instance.lockSPI();
+    return instance.lockSPI(portMAX_DELAY, SPI_BUS_OWNER_SD);
 }
 
 static bool _unlock_callback(void)
@@ -148,6 +151,21 @@ bool LilyGoLoRaPager::hasEncoder()
     return true;
 }
 
+bool LilyGoLoRaPager::setSwapBytes(bool enable)
+{
+    LilyGoDispArduinoSPI::enableSwapBytes(enable);
+    return true;
+}
+
+void LilyGoLoRaPager::getFlushWaitTime(uint32_t *te_wait_us, uint32_t *bus_wait_us)
+{
+    SpiBusHoldStats_t stats;
+    LilyGoDispArduinoSPI::getBusHoldStats(SPI_BUS_OWNER_DISPLAY, &stats);
+    // The panel has no tearing effect output
+    *te_wait_us = 0;
+    *bus_wait_us = stats.wait_us;
+}
+
 bool LilyGoLoRaPager::hasKeyboard()
 {
     return devices_probe & HW_KEYBOARD_ONLINE;
@@ -452,7 +470,7 @@ uint32_t LilyGoLoRaPager::begin(uint32_t disable_hw_init)
 #endif /*USING_AUDIO_CODEC*/
 
     // Create message queue
-    rotaryMsg = xQueueCreate(5, sizeof(RotaryMsg_t));
+    rotaryMsg = xQueueCreate(16, sizeof(RotaryMsg_t));
 
     rotaryTaskFlag = xEventGroupCreate();
 
@@ -462,9 +480,9 @@ uint32_t LilyGoLoRaPager::begin(uint32_t disable_hw_init)
     return devices_probe;
 }
 
-bool LilyGoLoRaPager::lockSPI(TickType_t xTicksToWait)
+bool LilyGoLoRaPager::lockSPI(TickType_t xTicksToWait, SpiBusOwner_t owner)
 {
-    return  LilyGoDispArduinoSPI::lock(xTicksToWait);
+    return  LilyGoDispArduinoSPI::lock(xTicksToWait, owner);
 }
 
 void LilyGoLoRaPager::unlockSPI()
@@ -480,6 +498,11 @@ int LilyGoLoRaPager::getKeyChar(char *c)
     return -1;
 }
 
+uint32_t LilyGoLoRaPager::getKeyTime()
+{
+    return kb.getLastKeyTime();
+}
+
 bool LilyGoLoRaPager::initPMU()
 {
     bool res = ppm.init(Wire, SDA, SCL);
@@ -530,7 +553,7 @@ bool LilyGoLoRaPager::installSD()
 
 void LilyGoLoRaPager::uninstallSD()
 {
-    lockSPI();
+    lockSPI(portMAX_DELAY, SPI_BUS_OWNER_SD);
     SD.end();
     unlockSPI();
 }
@@ -538,7 +561,7 @@ void LilyGoLoRaPager::uninstallSD()
 bool LilyGoLoRaPager::isCardReady()
 {
     bool rlst = false;
-    if (lockSPI(pdTICKS_TO_MS(100))) {
+    if (lockSPI(pdTICKS_TO_MS(100), SPI_BUS_OWNER_SD)) {
         rlst =  SD.sectorSize() != 0;
         unlockSPI();
     }
@@ -560,6 +583,11 @@ void LilyGoLoRaPager::pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t
     LilyGoDispArduinoSPI::pushColors( x1,  y1,  x2,  y2, color);
 }
 
+void LilyGoLoRaPager::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    LilyGoDispArduinoSPI::fillRect(x, y, w, h, color);
+}
+
 
 void LilyGoLoRaPager::powerControl(PowerCtrlChannel_t ch, bool enable)
 {
@@ -659,6 +687,10 @@ void LilyGoLoRaPager::lightSleep(WakeupSource_t wakeup_src)
         kb.end();
     }
 
+    // The wakeup configuration changes the interrupt type of the button pins
+    bool buttons_running = buttons.isRunning();
+    buttons.end();
+
     powerControl(POWER_HAPTIC_DRIVER, false);
     powerControl(POWER_GPS, false);
     powerControl(POWER_SPEAK, false);
@@ -723,6 +755,10 @@ void LilyGoLoRaPager::lightSleep(WakeupSource_t wakeup_src)
 
     initKeyboard();
 
+    if (buttons_running) {
+        buttons.restart();
+    }
+
     Serial1.begin(38400, SERIAL_8N1, GPS_RX, GPS_TX);
 }
 
@@ -742,7 +778,12 @@ void LilyGoLoRaPager::sleep(WakeupSource_t wakeup_src, bool off_rtc_backup_domai
         }
     }
 
+    irqService.end();
+    buttons.end();
+    instance.rotary.end();
+    detachInterrupt(ROTARY_C);
     vTaskDelete(rotaryHandler);
+    rotaryHandler = NULL;
 
     ppm.disableMeasure();
     
@@ -957,6 +998,10 @@ bool LilyGoLoRaPager::initDrv()
         drv.setWaveform(1, 0);   // end waveform
         drv.run();
         devices_probe |= HW_DRV_ONLINE;
+        // Effects are started from a task, the I2C writes no longer block the input callbacks
+        if (!hapticHandler) {
+            xTaskCreate(hapticTask, "haptic", 2 * 1024, NULL, 10, &hapticHandler);
+        }
     }
     return res;
 }
@@ -981,11 +1026,7 @@ void LilyGoLoRaPager::feedback(void *args)
         _custom_feedback(args);
         return;
     }
-    if (devices_probe & HW_DRV_ONLINE) {
-        drv.setWaveform(0, _feedback_effects);  // play effect
-        drv.setWaveform(1, 0);   // end waveform
-        drv.run();
-    }
+    playHaptic(_feedback_effects);
 }
 
 void LilyGoLoRaPager::setHapticEffects(uint8_t effects)
@@ -1001,11 +1042,22 @@ uint8_t LilyGoLoRaPager::getHapticEffects()
 
 void LilyGoLoRaPager::vibrator()
 {
-    if (devices_probe & HW_DRV_ONLINE) {
-        drv.setWaveform(0, _effects);
-        drv.setWaveform(1, 0);
-        drv.run();
+    playHaptic(_effects);
+}
+
+void LilyGoLoRaPager::playHaptic(uint8_t effects)
+{
+    if (!(devices_probe & HW_DRV_ONLINE)) {
+        return;
+    }
+    if (hapticHandler) {
+        // A request still pending is replaced, fast typing does not queue up vibrations
+        xTaskNotify(hapticHandler, effects, eSetValueWithOverwrite);
+        return;
     }
+    drv.setWaveform(0, effects);  // play effect
+    drv.setWaveform(1, 0);   // end waveform
+    drv.run();
 }
 
 bool LilyGoLoRaPager::initGPS()
@@ -1098,25 +1150,68 @@ bool LilyGoLoRaPager::initNRF24()
     return false;
 }
 
-void LilyGoLoRaPager::loop()
-{
-    EventBits_t bits = xEventGroupGetBits(_event);
-    // if (bits & HW_IRQ_POWER) {
-    //     xEventGroupClearBits(_event, HW_IRQ_POWER);
-    // }
+static const EventBits_t irq_sources[] = {HW_IRQ_RTC, HW_IRQ_SENSOR, HW_IRQ_BUTTON};
 
-    if (bits & HW_IRQ_RTC) {
-        xEventGroupClearBits(_event, HW_IRQ_RTC);
+void LilyGoLoRaPager::handleIrq(EventBits_t bit)
+{
+    switch (bit) {
+    case HW_IRQ_RTC:
         sendEvent(RTC_EVENT_INTERRUPT);
+        break;
+    case HW_IRQ_SENSOR:
+        sensor.update();
+        break;
+    case HW_IRQ_BUTTON:
+        buttons.dispatch(this);
+        break;
+    default:
+        break;
     }
+}
 
-    if (bits & HW_IRQ_SENSOR) {
-        xEventGroupClearBits(_event, HW_IRQ_SENSOR);
-        sensor.update();
+void LilyGoLoRaPager::irqServiceHandler(EventBits_t bit, void *user_data)
+{
+    static_cast<LilyGoLoRaPager *>(user_data)->handleIrq(bit);
+}
+
+bool LilyGoLoRaPager::startIrqService(BaseType_t core, UBaseType_t priority)
+{
+    return irqService.begin(_event, irq_sources, sizeof(irq_sources) / sizeof(irq_sources[0]),
+                            irqServiceHandler, this, core, priority);
+}
+
+void LilyGoLoRaPager::stopIrqService()
+{
+    irqService.end();
+}
+
+void LilyGoLoRaPager::getIrqStats(EventBits_t source, IrqSourceStats_t *stats)
+{
+    irqService.getStats(source, stats);
+}
+
+bool LilyGoLoRaPager::attachButtons(const uint8_t *pins, uint8_t count, bool active_low)
+{
+    return buttons.begin(pins, count, _event, HW_IRQ_BUTTON, active_low);
+}
+
+void LilyGoLoRaPager::loop()
+{
+    // The service task handles the interrupts while it runs
+    if (irqService.isRunning()) {
+        return;
+    }
+    EventBits_t bits = xEventGroupGetBits(_event);
+    for (uint32_t i = 0; i < sizeof(irq_sources) / sizeof(irq_sources[0]); i++) {
+        if (bits & irq_sources[i]) {
+            xEventGroupClearBits(_event, irq_sources[i]);
+            takeGroupBitsTime(irq_sources[i]);
+            handleIrq(irq_sources[i]);
+        }
     }
 
     // if (devices_probe & HW_NFC_ONLINE) {
-    //     lockSPI();
+    //     lockSPI(portMAX_DELAY, SPI_BUS_OWNER_NFC);
     //     NFCReader.rfalNfcWorker();
     //     unlockSPI();
     // }
@@ -1124,12 +1219,21 @@ void LilyGoLoRaPager::loop()
 
 RotaryMsg_t LilyGoLoRaPager::getRotary()
 {
-    static RotaryMsg_t msg;
-    if (xQueueReceive(rotaryMsg, &msg, pdMS_TO_TICKS(50)) == pdPASS) {
-        return (msg);
-    } else {
-        msg.centerBtnPressed = false;
-        msg.dir = ROTARY_DIR_NONE;
+    RotaryMsg_t msg = {ROTARY_DIR_NONE, false, 0};
+    RotaryMsg_t event;
+    // Drain everything queued since the last call without blocking the caller
+    while (xQueueReceive(rotaryMsg, &event, 0) == pdPASS) {
+        msg.diff += event.diff;
+        // A press is a single message, keep it even if a release follows in the same batch
+        msg.centerBtnPressed |= event.centerBtnPressed;
+        if (!msg.time_us) {
+            msg.time_us = event.time_us;
+        }
+    }
+    if (msg.diff > 0) {
+        msg.dir = ROTARY_DIR_UP;
+    } else if (msg.diff < 0) {
+        msg.dir = ROTARY_DIR_DOWN;
     }
     return (msg);
 }
@@ -1158,11 +1262,33 @@ void LilyGoLoRaPager::enableRotary()
         if (digitalRead(ROTARY_C) == LOW) {
             xEventGroupSetBits(rotaryTaskFlag, TASK_ROTARY_START_PRESSED_FLAG);
         }
+        // Drop steps decoded while the task was suspended
+        instance.rotary.read(NULL);
         vTaskResume(rotaryHandler);
     }
 }
 
-static bool getButtonState()
+// Called from the rotary and center button interrupts
+static void IRAM_ATTR rotaryEdgeISR(void *user_data)
+{
+    BaseType_t woken = pdFALSE;
+    if (rotaryHandler) {
+        vTaskNotifyGiveFromISR(rotaryHandler, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static volatile uint32_t rotary_button_irq_time = 0;
+
+static void IRAM_ATTR rotaryButtonISR()
+{
+    rotary_button_irq_time = micros();
+    rotaryEdgeISR(NULL);
+}
+
+// 'settling' is set while the button has changed within the debounce time,
+// the caller must check again later since no further edge may arrive
+static bool getButtonState(bool *settling)
 {
     static uint8_t buttonState;
     static uint8_t lastButtonState = HIGH;
@@ -1170,6 +1296,8 @@ static bool getButtonState()
     const uint8_t debounceDelay = 20;
     int reading = digitalRead(ROTARY_C);
 
+    *settling = false;
+
     EventBits_t eventBits = xEventGroupGetBits(rotaryTaskFlag);
     if (eventBits & TASK_ROTARY_START_PRESSED_FLAG) {
         if (reading == HIGH) {
@@ -1190,6 +1318,8 @@ static bool getButtonState()
                 return true;
             }
         }
+    } else {
+        *settling = true;
     }
     lastButtonState = reading;
     return false;
@@ -1197,33 +1327,47 @@ static bool getButtonState()
 
 static void rotaryTask(void *p)
 {
-    RotaryMsg_t msg;
+    RotaryMsg_t msg = {ROTARY_DIR_NONE, false, 0, 0};
+    RotaryDelta_t delta;
     bool last_btn_state = false;
-    instance.rotary.begin();
+    bool settling = false;
     pinMode(ROTARY_C, INPUT);
+    // Sleep until an edge arrives instead of sampling the pins every 2 ms,
+    // only a bouncing center button needs a timeout
+    instance.rotary.beginInterrupt(rotaryEdgeISR, NULL);
+    attachInterrupt(ROTARY_C, rotaryButtonISR, CHANGE);
     while (1) {
-        msg.centerBtnPressed = getButtonState();
-        uint8_t result = instance.rotary.process();
-        if (result || msg.centerBtnPressed != last_btn_state) {
-            switch (result) {
-            case DIR_CW:
+        ulTaskNotifyTake(pdTRUE, settling ? pdMS_TO_TICKS(5) : portMAX_DELAY);
+        msg.centerBtnPressed = getButtonState(&settling);
+        bool moved = instance.rotary.read(&delta);
+        if (moved || msg.centerBtnPressed != last_btn_state) {
+            msg.diff = moved ? delta.accel_steps : 0;
+            msg.time_us = moved ? delta.first_us : rotary_button_irq_time;
+            if (msg.diff > 0) {
                 msg.dir = ROTARY_DIR_UP;
-                break;
-            case DIR_CCW:
+            } else if (msg.diff < 0) {
                 msg.dir = ROTARY_DIR_DOWN;
-                break;
-            default:
+            } else {
                 msg.dir = ROTARY_DIR_NONE;
-                break;
             }
             last_btn_state = msg.centerBtnPressed;
             xQueueSend(rotaryMsg, (void *)&msg, portMAX_DELAY);
         }
-        delay(2);
     }
     vTaskDelete(NULL);
 }
 
+static void hapticTask(void *p)
+{
+    uint32_t effects;
+    while (1) {
+        xTaskNotifyWait(0, UINT32_MAX, &effects, portMAX_DELAY);
+        instance.drv.setWaveform(0, effects);  // play effect
+        instance.drv.setWaveform(1, 0);   // end waveform
+        instance.drv.run();
+    }
+    vTaskDelete(NULL);
+}
 
 namespace
 {
@@ -31,6 +31,8 @@
 #include "nfc_include.h"
 #include "LilyGoEventManage.h"
 #include "LilyGoTypedef.h"
+#include "LilyGoIrqService.h"
+#include "ButtonBank.h"
 
 #ifdef USING_XL9555_EXPANDS
 #include <ExtensionIOXL9555.hpp>
@@ -122,6 +124,46 @@ public:
      */
     void loop();
 
+    /**
+     * @brief Service the board interrupts from a library task.
+     *
+     * The task wakes up as soon as an interrupt bit is set and handles the pending sources in priority
+     * order (RTC, sensor, buttons), so the event callbacks do not wait for the application to call loop().
+     * Once started, loop() does nothing and the event callbacks run in the service task.
+     *
+     * @param core Core the task is pinned to (default: 0).
+     * @param priority Task priority (default: 5).
+     * @return bool True if the task is running.
+     */
+    bool startIrqService(BaseType_t core = 0, UBaseType_t priority = 5);
+
+    /**
+     * @brief Stop the interrupt service task, loop() handles the interrupts again.
+     */
+    void stopIrqService();
+
+    /**
+     * @brief Get the interrupt to callback latency of one source while the service task runs.
+     *
+     * @param source The interrupt bit, e.g. HW_IRQ_POWER.
+     * @param stats Receives the statistics.
+     */
+    void getIrqStats(EventBits_t source, IrqSourceStats_t *stats);
+
+    /**
+     * @brief Detect clicks on buttons wired to GPIOs.
+     *
+     * The edges are timestamped in the pin interrupts and a single timer detects click, double click,
+     * triple click and long press for all of them. The results are sent as BUTTON_EVENT, from loop()
+     * or from the interrupt service task, with a ButtonEventParam_t whose id is the position in 'pins'.
+     *
+     * @param pins Button pins, e.g. the BOOT button.
+     * @param count Number of pins, at most CONFIG_BUTTON_BANK_MAX.
+     * @param active_low True if the pins read LOW while pressed (default: true).
+     * @return bool True if the buttons are attached.
+     */
+    bool attachButtons(const uint8_t *pins, uint8_t count, bool active_low = true);
+
 
     /**
      * @brief Initialize the NFC module.
@@ -204,9 +246,10 @@ public:
      * otherwise.
      *
      * @param xTicksToWait Time to wait for the lock (default: portMAX_DELAY).
+     * @param owner Bus user the hold time is accounted to, see getBusHoldStats().
      * @return bool True if the lock is successful, false otherwise.
      */
-    bool lockSPI(TickType_t xTicksToWait = portMAX_DELAY);
+    bool lockSPI(TickType_t xTicksToWait = portMAX_DELAY, SpiBusOwner_t owner = SPI_BUS_OWNER_OTHER);
 
     /**
      * @brief Unlock the SPI bus.
@@ -266,6 +309,17 @@ public:
      */
     void pushColors(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint16_t *color) override;
 
+    /**
+     * @brief Fill a rectangular area of the display with one color.
+     *
+     * @param x Starting x-coordinate.
+     * @param y Starting y-coordinate.
+     * @param w Width of the area.
+     * @param h Height of the area.
+     * @param color RGB565 color.
+     */
+    void fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) override;
+
     /**
      * @brief Control the power of a specific channel.
      *
@@ -332,11 +386,20 @@ public:
      */
     int getKeyChar(char *c) override;
 
+    /**
+     * @brief Get the interrupt time of the key last returned by getKeyChar.
+     *
+     * @return uint32_t Timestamp in microseconds.
+     */
+    uint32_t getKeyTime() override;
+
     /**
      * @brief Get the rotary message.
      *
      * This function retrieves the message related to the rotary encoder. It returns a value of type RotaryMsg_t
-     * which contains information about the rotary encoder's state.
+     * which contains information about the rotary encoder's state. It does not wait, all steps received since
+     * the last call are summed up in 'diff' and 'dir' gives their direction.
+     * The encoder is decoded on pin edges, use rotary.setAcceleration() to scale 'diff' on fast spins.
      *
      * @return RotaryMsg_t The rotary encoder message.
      */
@@ -388,7 +451,7 @@ public:
      * @brief Trigger the feedback mechanism.
      *
      * This function triggers the feedback mechanism. The 'args' parameter is an optional pointer to additional
-     * arguments (default: NULL).
+     * arguments (default: NULL). The haptic effect is started asynchronously, the call does not wait for the bus.
      *
      * @param args An optional pointer to additional arguments.
      */
@@ -397,7 +460,7 @@ public:
     /**
      * @brief Trigger the vibrator.
      *
-     * This function triggers the vibrator to produce a vibration.
+     * This function triggers the vibrator to produce a vibration. Returns without waiting for the bus.
      */
     void vibrator();
 
@@ -503,6 +566,20 @@ public:
      */
     bool hasKeyboard() override;
 
+    /**
+     * @brief Let the display driver swap the RGB565 byte order while sending pixels.
+     * @param enable true to swap the bytes of every pixel passed to pushColors.
+     * @return true, the driver supports the swap.
+     */
+    bool setSwapBytes(bool enable) override;
+
+    /**
+     * @brief Get the total time the display driver has waited while flushing.
+     * @param te_wait_us Time waited for the tearing effect signal.
+     * @param bus_wait_us Time waited for the bus lock.
+     */
+    void getFlushWaitTime(uint32_t *te_wait_us, uint32_t *bus_wait_us) override;
+
     /**
      * @brief Get the number of codec input channels.(Microphone)
      *
@@ -571,6 +648,11 @@ private:
     uint32_t devices_probe;
     uint8_t _effects;
     static EventGroupHandle_t _event;
+    LilyGoIrqService irqService;
+    void handleIrq(EventBits_t bit);
+    static void irqServiceHandler(EventBits_t bit, void *user_data);
+    ButtonBank buttons;
+    void playHaptic(uint8_t effects);
     bool _feedback_enable = false;
     uint8_t _feedback_effects = 70;
     custom_feedback_t _custom_feedback = nullptr;
@@ -6,6 +6,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include "audio_codec_sw_vol.h"
 
 #define GAIN_0DB_SHIFT (15)
@@ -13,7 +14,7 @@
 typedef struct {
     audio_codec_vol_if_t        base;
     esp_codec_dev_sample_info_t fs;
-    uint16_t                    gain;
+    int                         gain;
     bool                        is_open;
     int                         cur;
     int                         step;
@@ -47,6 +48,83 @@ static int _sw_vol_open(const audio_codec_vol_if_t *h, esp_codec_dev_sample_info
     return ESP_CODEC_DEV_OK;
 }
 
+// Above 0dB the product can exceed 32 bits, e.g. +12dB is a gain of 4 << 15
+static inline int16_t _sw_vol_sat(int64_t v)
+{
+    return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : (int16_t) v);
+}
+
+// Constant gain, element by element so in == out is safe
+static void _sw_vol_apply(const int16_t *in, int16_t *out, int n, int32_t gain)
+{
+    if (gain == (1 << GAIN_0DB_SHIFT)) {
+        if (in != out) {
+            memmove(out, in, n * sizeof(int16_t));
+        }
+        return;
+    }
+    int i = 0;
+    if (gain < (1 << GAIN_0DB_SHIFT)) {
+        // Below 0dB the product can not leave the int16 range
+        for (; i + 4 <= n; i += 4) {
+            int32_t a = in[i], b = in[i + 1], c = in[i + 2], d = in[i + 3];
+            out[i] = (int16_t) ((a * gain) >> GAIN_0DB_SHIFT);
+            out[i + 1] = (int16_t) ((b * gain) >> GAIN_0DB_SHIFT);
+            out[i + 2] = (int16_t) ((c * gain) >> GAIN_0DB_SHIFT);
+            out[i + 3] = (int16_t) ((d * gain) >> GAIN_0DB_SHIFT);
+        }
+        for (; i < n; i++) {
+            out[i] = (int16_t) ((in[i] * gain) >> GAIN_0DB_SHIFT);
+        }
+        return;
+    }
+    for (; i + 4 <= n; i += 4) {
+        int32_t a = in[i], b = in[i + 1], c = in[i + 2], d = in[i + 3];
+        out[i] = _sw_vol_sat(((int64_t) a * gain) >> GAIN_0DB_SHIFT);
+        out[i + 1] = _sw_vol_sat(((int64_t) b * gain) >> GAIN_0DB_SHIFT);
+        out[i + 2] = _sw_vol_sat(((int64_t) c * gain) >> GAIN_0DB_SHIFT);
+        out[i + 3] = _sw_vol_sat(((int64_t) d * gain) >> GAIN_0DB_SHIFT);
+    }
+    for (; i < n; i++) {
+        out[i] = _sw_vol_sat(((int64_t) in[i] * gain) >> GAIN_0DB_SHIFT);
+    }
+}
+
+static inline int16_t _sw_vol_mul(int32_t s, int32_t gain, bool sat)
+{
+    return sat ? _sw_vol_sat(((int64_t) s * gain) >> GAIN_0DB_SHIFT) : (int16_t) ((s * gain) >> GAIN_0DB_SHIFT);
+}
+
+// One gain step per frame. Mono and stereo are spelled out, a loop over a variable
+// channel count gets vectorized with run time checks that cost more than they save
+static inline int32_t _sw_vol_ramp(const int16_t *in, int16_t *out, int frames, int channel,
+                                   int32_t cur, int32_t step, bool sat)
+{
+    if (channel == 1) {
+        for (int i = 0; i < frames; i++) {
+            out[i] = _sw_vol_mul(in[i], cur, sat);
+            cur += step;
+        }
+    } else if (channel == 2) {
+        for (int i = 0; i < frames; i++) {
+            int32_t l = in[2 * i], r = in[2 * i + 1];
+            out[2 * i] = _sw_vol_mul(l, cur, sat);
+            out[2 * i + 1] = _sw_vol_mul(r, cur, sat);
+            cur += step;
+        }
+    } else {
+        for (int i = 0; i < frames; i++) {
+            for (int j = 0; j < channel; j++) {
+                out[j] = _sw_vol_mul(in[j], cur, sat);
+            }
+            in += channel;
+            out += channel;
+            cur += step;
+        }
+    }
+    return cur;
+}
+
 static int _sw_vol_process(const audio_codec_vol_if_t *h, uint8_t *in, int len,
                            uint8_t *out, int out_len)
 {
@@ -58,42 +136,43 @@ static int _sw_vol_process(const audio_codec_vol_if_t *h, uint8_t *in, int len,
         return ESP_CODEC_DEV_WRONG_STATE;
     }
     int sample = len / vol->block_size;
-    if (vol->fs.bits_per_sample == 16) {
-        int16_t *v_in = (int16_t *) in;
-        int16_t *v_out = (int16_t *) out;
-        if (vol->cur == vol->gain) {
-            if (vol->gain == 0) {
-                memset(out, 0, len);
-                return 0;
-            } else {
-                for (int i = 0; i < sample; i++) {
-                    for (int j = 0; j < vol->fs.channel; j++) {
-                        *(v_out++) = ((*v_in++) * vol->cur) >> GAIN_0DB_SHIFT;
-                    }
-                }
-                return 0;
-            }
+    if (vol->fs.bits_per_sample != 16) {
+        return 0;
+    }
+    int channel = vol->fs.channel;
+    int16_t *v_in = (int16_t *) in;
+    int16_t *v_out = (int16_t *) out;
+    if (vol->step) {
+        // Frames left on the ramp, the frame reaching the target is played with the target gain
+        int diff = vol->gain - vol->cur;
+        int ramp = (diff + vol->step + (vol->step > 0 ? -1 : 1)) / vol->step;
+        if (ramp > sample) {
+            ramp = sample;
         }
-        for (int i = 0; i < sample; i++) {
-            for (int j = 0; j < vol->fs.channel; j++) {
-                *(v_out++) = ((*v_in++) * vol->cur) >> GAIN_0DB_SHIFT;
-            }
-            if (vol->step) {
-                vol->cur += vol->step;
-                if (vol->step > 0) {
-                    if (vol->cur > vol->gain) {
-                        vol->cur = vol->gain;
-                        vol->step = 0;
-                    }
-                } else {
-                    if (vol->cur < vol->gain) {
-                        vol->cur = vol->gain;
-                        vol->step = 0;
-                    }
-                }
-            }
+        int32_t cur = vol->cur;
+        if (cur <= (1 << GAIN_0DB_SHIFT) && vol->gain <= (1 << GAIN_0DB_SHIFT)) {
+            // The whole ramp is at or below 0dB, no clamping needed
+            cur = _sw_vol_ramp(v_in, v_out, ramp, channel, cur, vol->step, false);
+        } else {
+            cur = _sw_vol_ramp(v_in, v_out, ramp, channel, cur, vol->step, true);
+        }
+        v_in += ramp * channel;
+        v_out += ramp * channel;
+        if ((vol->step > 0 && cur >= vol->gain) || (vol->step < 0 && cur <= vol->gain)) {
+            cur = vol->gain;
+            vol->step = 0;
         }
+        vol->cur = cur;
+        sample -= ramp;
+    }
+    if (sample == 0) {
+        return 0;
+    }
+    if (vol->cur == 0) {
+        memset(v_out, 0, sample * vol->block_size);
+        return 0;
     }
+    _sw_vol_apply(v_in, v_out, sample * channel, vol->cur);
     return 0;
 }
 
@@ -0,0 +1,340 @@
+/**
+ * @file      esp_audio_engine.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-24
+ *
+ */
+#include "esp_audio_engine.h"
+
+#if defined(ARDUINO) || defined(ESP_AUDIO_ENGINE_HOST)
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef ARDUINO
+#include "esp_timer.h"
+static uint32_t engine_now_us()
+{
+    return (uint32_t)esp_timer_get_time();
+}
+#else
+#include <chrono>
+#define log_e(...)
+static uint32_t engine_now_us()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+EspAudioEngine::EspAudioEngine() :
+    _dev(NULL), _capture(NULL), _playback(NULL), _periodBytes(0),
+    _source(NULL), _sourceData(NULL), _lastStart(0), _lagUs(0), _running(false), _taskRunning(false), _dispatching(false)
+{
+    memset(_subscribers, 0, sizeof(_subscribers));
+    memset(&_config, 0, sizeof(_config));
+    memset(&_stats, 0, sizeof(_stats));
+#ifdef ARDUINO
+    _codec = NULL;
+    _task = NULL;
+    _lock = xSemaphoreCreateMutex();
+#endif
+}
+
+EspAudioEngine::~EspAudioEngine()
+{
+    end();
+#ifdef ARDUINO
+    vSemaphoreDelete(_lock);
+#endif
+}
+
+void EspAudioEngine::lock()
+{
+#ifdef ARDUINO
+    xSemaphoreTake(_lock, portMAX_DELAY);
+#endif
+}
+
+void EspAudioEngine::unlock()
+{
+#ifdef ARDUINO
+    xSemaphoreGive(_lock);
+#endif
+}
+
+// The callbacks run without the lock, a change made from another task waits for the
+// period being dispatched, one made from a callback applies from the next period
+void EspAudioEngine::waitDispatch()
+{
+#ifdef ARDUINO
+    if (xTaskGetCurrentTaskHandle() == _task) {
+        return;
+    }
+    while (__atomic_load_n(&_dispatching, __ATOMIC_ACQUIRE)) {
+        vTaskDelay(1);
+    }
+#endif
+}
+
+#ifdef ARDUINO
+bool EspAudioEngine::begin(EspCodec &codec, const EspAudioEngineConfig_t &config)
+{
+    if (_running) {
+        return false;
+    }
+    // Through EspCodec so the PA callback follows the device
+    if (codec.open(16, config.channels, config.sample_rate) != 0) {
+        log_e("Codec open failed");
+        return false;
+    }
+    _codec = &codec;
+    _dev = codec.getDevice();
+    _config = config;
+    if (!start()) {
+        codec.close();
+        _codec = NULL;
+        return false;
+    }
+    return true;
+}
+#endif
+
+bool EspAudioEngine::begin(esp_codec_dev_handle_t dev, const EspAudioEngineConfig_t &config)
+{
+    if (_running || !dev) {
+        return false;
+    }
+    esp_codec_dev_sample_info_t fs = {
+        .bits_per_sample = 16,
+        .channel = config.channels,
+        .channel_mask = 0,
+        .sample_rate = config.sample_rate
+    };
+    if (esp_codec_dev_open(dev, &fs) != ESP_CODEC_DEV_OK) {
+        log_e("Codec device open failed");
+        return false;
+    }
+    _dev = dev;
+    _config = config;
+    if (!start()) {
+        esp_codec_dev_close(dev);
+        return false;
+    }
+    return true;
+}
+
+bool EspAudioEngine::start()
+{
+    if (!_config.period_frames || !_config.channels || !_config.sample_rate) {
+        return false;
+    }
+    _periodBytes = _config.period_frames * _config.channels * sizeof(int16_t);
+    _capture = (int16_t *)malloc(_periodBytes);
+    _playback = (int16_t *)malloc(_periodBytes);
+    if (!_capture || !_playback) {
+        log_e("Could not allocate the period buffers");
+        free(_capture);
+        free(_playback);
+        _capture = _playback = NULL;
+        return false;
+    }
+
+    memset(&_stats, 0, sizeof(_stats));
+    _stats.period_frames = _config.period_frames;
+    _stats.period_us = (uint32_t)((uint64_t)_config.period_frames * 1000000 / _config.sample_rate);
+    _stats.capture_latency_us = _stats.period_us;
+    _stats.playback_latency_us = _stats.period_us * (1 + CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS);
+    _lastStart = 0;
+    _lagUs = 0;
+
+    // The playback margin, each period afterwards writes one period
+    memset(_playback, 0, _periodBytes);
+    for (int i = 0; i < CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS; i++) {
+        esp_codec_dev_write(_dev, _playback, _periodBytes);
+    }
+
+    _running = true;
+#ifdef ARDUINO
+    _taskRunning = true;
+    if (xTaskCreate(task, "audio", 4 * 1024, this, _config.priority, &_task) != pdPASS) {
+        log_e("Could not create the audio task");
+        _taskRunning = false;
+        _running = false;
+        free(_capture);
+        free(_playback);
+        _capture = _playback = NULL;
+        return false;
+    }
+#endif
+    return true;
+}
+
+void EspAudioEngine::end()
+{
+    if (!_running) {
+        return;
+    }
+    _running = false;
+#ifdef ARDUINO
+    // Returns within one period, the reads and writes block for about that long
+    while (_taskRunning) {
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    if (_codec) {
+        _codec->close();
+        _codec = NULL;
+    } else
+#endif
+    {
+        esp_codec_dev_close(_dev);
+    }
+    free(_capture);
+    free(_playback);
+    _capture = _playback = NULL;
+    _dev = NULL;
+}
+
+bool EspAudioEngine::isRunning()
+{
+    return _running;
+}
+
+bool EspAudioEngine::subscribe(EspAudioCaptureCallback_t cb, void *user_data)
+{
+    if (!cb) {
+        return false;
+    }
+    bool ok = false;
+    lock();
+    for (int i = 0; i < CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS; i++) {
+        if (!_subscribers[i].cb) {
+            _subscribers[i].cb = cb;
+            _subscribers[i].user_data = user_data;
+            ok = true;
+            break;
+        }
+    }
+    unlock();
+    return ok;
+}
+
+void EspAudioEngine::unsubscribe(EspAudioCaptureCallback_t cb, void *user_data)
+{
+    lock();
+    for (int i = 0; i < CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS; i++) {
+        if (_subscribers[i].cb == cb && _subscribers[i].user_data == user_data) {
+            _subscribers[i].cb = NULL;
+            _subscribers[i].user_data = NULL;
+        }
+    }
+    unlock();
+    waitDispatch();
+}
+
+void EspAudioEngine::setPlaybackSource(EspAudioPlaybackCallback_t cb, void *user_data)
+{
+    lock();
+    _source = cb;
+    _sourceData = user_data;
+    unlock();
+    waitDispatch();
+}
+
+bool EspAudioEngine::process()
+{
+    uint32_t start = engine_now_us();
+    if (_lastStart) {
+        // The blocking read paces the loop, a late period eats into the playback margin
+        // and the following reads return at once until the loop has caught up
+        _lagUs += (int32_t)(start - _lastStart) - (int32_t)_stats.period_us;
+        if (_lagUs < 0) {
+            _lagUs = 0;
+        }
+        if ((uint32_t)_lagUs > _stats.late_max_us) {
+            _stats.late_max_us = _lagUs;
+        }
+        if ((uint32_t)_lagUs > _stats.period_us * CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS) {
+            // Playback has most likely run dry and the driver played silence, the margin
+            // starts over
+            _stats.late_periods++;
+            _lagUs = 0;
+        }
+    }
+    _lastStart = start;
+
+    bool ok = true;
+    if (esp_codec_dev_read(_dev, _capture, _periodBytes) != ESP_CODEC_DEV_OK) {
+        _stats.io_errors++;
+        memset(_capture, 0, _periodBytes);
+        ok = false;
+    }
+
+    uint32_t work = engine_now_us();
+    size_t filled = 0;
+    // Called from a copy, so a callback may subscribe, unsubscribe or change the source
+    Subscriber subscribers[CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS];
+    lock();
+    memcpy(subscribers, _subscribers, sizeof(subscribers));
+    EspAudioPlaybackCallback_t source = _source;
+    void *sourceData = _sourceData;
+    __atomic_store_n(&_dispatching, true, __ATOMIC_RELEASE);
+    unlock();
+    for (int i = 0; i < CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS; i++) {
+        if (subscribers[i].cb) {
+            subscribers[i].cb(_capture, _config.period_frames, subscribers[i].user_data);
+        }
+    }
+    if (source) {
+        filled = source(_playback, _config.period_frames, sourceData);
+        if (filled > _config.period_frames) {
+            filled = _config.period_frames;
+        }
+        // Nothing at all is an idle source, only a partly filled period is short
+        if (filled && filled < _config.period_frames) {
+            _stats.short_periods++;
+        }
+    }
+    __atomic_store_n(&_dispatching, false, __ATOMIC_RELEASE);
+    work = engine_now_us() - work;
+    if (work > _stats.work_max_us) {
+        _stats.work_max_us = work;
+    }
+
+    if (filled < _config.period_frames) {
+        size_t offset = filled * _config.channels;
+        memset(_playback + offset, 0, _periodBytes - offset * sizeof(int16_t));
+    }
+    if (esp_codec_dev_write(_dev, _playback, _periodBytes) != ESP_CODEC_DEV_OK) {
+        _stats.io_errors++;
+        ok = false;
+    }
+    _stats.periods++;
+    return ok;
+}
+
+void EspAudioEngine::getStats(EspAudioEngineStats_t *stats)
+{
+    *stats = _stats;
+}
+
+void EspAudioEngine::task(void *args)
+{
+#ifdef ARDUINO
+    EspAudioEngine *engine = (EspAudioEngine *)args;
+    while (engine->_running) {
+        if (!engine->process()) {
+            // Keep the period timing when the device fails
+            vTaskDelay(pdMS_TO_TICKS(engine->_stats.period_us / 1000 + 1));
+        }
+    }
+    engine->_task = NULL;
+    engine->_taskRunning = false;
+    vTaskDelete(NULL);
+#else
+    (void)args;
+#endif
+}
+
+#endif
@@ -0,0 +1,180 @@
+/**
+ * @file      esp_audio_engine.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-24
+ * @note      Full duplex audio on one codec device. One task reads a capture period, hands it
+ *            to the subscribers, pulls a playback period from the source and writes it, so
+ *            capture and playback share one clock and the device is opened only once.
+ *            Define ESP_AUDIO_ENGINE_HOST to build it on a PC, there is no task and the
+ *            caller runs process() over a codec device with a fake audio_codec_data_if_t.
+ */
+#pragma once
+
+#if defined(ARDUINO) || defined(ESP_AUDIO_ENGINE_HOST)
+#include <stdint.h>
+#include <stddef.h>
+#include "include/esp_codec_dev.h"
+#ifdef ARDUINO
+#include "esp_codec.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#endif
+
+/**
+ * @brief Maximum number of capture subscribers.
+ */
+#ifndef CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS
+#define CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS     4
+#endif
+
+/**
+ * @brief Silent playback periods written at start, the playback margin against a late period.
+ */
+#ifndef CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS
+#define CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS   1
+#endif
+
+/**
+ * @typedef EspAudioCaptureCallback_t
+ * @brief Receives each capture period, called from the audio task and must return quickly.
+ * @param frames Interleaved 16 bit samples.
+ * @param count Number of frames.
+ * @param user_data User-provided data pointer.
+ */
+using EspAudioCaptureCallback_t = void(*)(const int16_t *frames, size_t count, void *user_data);
+
+/**
+ * @typedef EspAudioPlaybackCallback_t
+ * @brief Fills one playback period, called from the audio task, e.g. a mixer.
+ * @param frames Interleaved 16 bit samples to fill.
+ * @param count Number of frames requested.
+ * @param user_data User-provided data pointer.
+ * @return Number of frames filled, the rest is played as silence.
+ */
+using EspAudioPlaybackCallback_t = size_t(*)(int16_t *frames, size_t count, void *user_data);
+
+/**
+ * @struct EspAudioEngineConfig_t
+ * @brief Stream format and task settings.
+ */
+typedef struct {
+    uint32_t sample_rate;       /**< Sampling rate in Hz, capture and playback */
+    uint8_t channels;           /**< Channels, capture and playback */
+    uint16_t period_frames;     /**< Frames per period, the unit of capture and playback */
+    uint8_t priority;           /**< Priority of the audio task */
+} EspAudioEngineConfig_t;
+
+/**
+ * @struct EspAudioEngineStats_t
+ * @brief Timing of the period loop since begin().
+ */
+typedef struct {
+    uint16_t period_frames;     /**< Frames per period */
+    uint32_t period_us;         /**< Duration of a period */
+    uint32_t capture_latency_us;    /**< From the microphone to the subscribers */
+    uint32_t playback_latency_us;   /**< From the playback source to the speaker */
+    uint32_t periods;           /**< Periods processed */
+    uint32_t late_periods;      /**< Times the loop fell behind by more than the playback margin, from the loop timing */
+    uint32_t short_periods;     /**< Periods the playback source filled only partly */
+    uint32_t io_errors;         /**< Failed reads or writes */
+    uint32_t work_max_us;       /**< Longest time in the callbacks of one period */
+    uint32_t late_max_us;       /**< Longest time the loop was behind the device clock */
+} EspAudioEngineStats_t;
+
+/**
+ * @class EspAudioEngine
+ * @brief Full duplex capture and playback with subscribers and a playback source.
+ */
+class EspAudioEngine
+{
+public:
+    EspAudioEngine();
+    ~EspAudioEngine();
+
+#ifdef ARDUINO
+    /**
+     * @brief Open the codec once for capture and playback and start the audio task.
+     * @param codec Codec, stays open until end().
+     * @param config Stream format and task settings.
+     * @return True on success, false otherwise.
+     */
+    bool begin(EspCodec &codec, const EspAudioEngineConfig_t &config);
+#endif
+
+    /**
+     * @brief Open a codec device for capture and playback and start the audio task.
+     * @param dev Codec device created with ESP_CODEC_DEV_TYPE_IN_OUT.
+     * @param config Stream format and task settings.
+     * @return True on success, false otherwise.
+     */
+    bool begin(esp_codec_dev_handle_t dev, const EspAudioEngineConfig_t &config);
+
+    /**
+     * @brief Stop the audio task and close the device.
+     */
+    void end();
+
+    bool isRunning();
+
+    /**
+     * @brief Add a capture subscriber, e.g. a spectrum, a recorder or a voice detector.
+     * @return True on success, false if all slots are in use.
+     */
+    bool subscribe(EspAudioCaptureCallback_t cb, void *user_data);
+
+    /**
+     * @brief Remove a capture subscriber, it is not called anymore when this returns.
+     * @note  From a callback the subscriber may still get the rest of the current period.
+     */
+    void unsubscribe(EspAudioCaptureCallback_t cb, void *user_data);
+
+    /**
+     * @brief Set the playback source, NULL plays silence.
+     */
+    void setPlaybackSource(EspAudioPlaybackCallback_t cb, void *user_data);
+
+    /**
+     * @brief Run one period: read, dispatch, pull and write.
+     * @note  Called by the audio task, on a host build it is called by the test.
+     * @return False if the device failed.
+     */
+    bool process();
+
+    void getStats(EspAudioEngineStats_t *stats);
+
+private:
+    bool start();
+    void lock();
+    void unlock();
+    void waitDispatch();
+    static void task(void *args);
+
+    struct Subscriber {
+        EspAudioCaptureCallback_t cb;
+        void *user_data;
+    };
+
+    esp_codec_dev_handle_t _dev;
+    EspAudioEngineConfig_t _config;
+    int16_t *_capture;
+    int16_t *_playback;
+    size_t _periodBytes;
+    Subscriber _subscribers[CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS];
+    EspAudioPlaybackCallback_t _source;
+    void *_sourceData;
+    EspAudioEngineStats_t _stats;
+    uint32_t _lastStart;
+    int32_t _lagUs;             /**< Time the loop is behind the device clock */
+    volatile bool _running;
+    volatile bool _taskRunning;
+    bool _dispatching;          /**< Callbacks of a period are running */
+#ifdef ARDUINO
+    EspCodec *_codec;
+    TaskHandle_t _task;
+    SemaphoreHandle_t _lock;
+#endif
+};
+
+#endif
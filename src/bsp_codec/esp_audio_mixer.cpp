@@ -0,0 +1,515 @@
+/**
+ * @file      esp_audio_mixer.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-25
+ *
+ */
+#include "esp_audio_mixer.h"
+
+#if defined(ARDUINO) || defined(ESP_AUDIO_MIXER_HOST)
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "esp_timer.h"
+#define mixer_ring_alloc(size)      ps_malloc(size)
+static uint32_t mixer_now_us()
+{
+    return (uint32_t)esp_timer_get_time();
+}
+#else
+#include <chrono>
+#define mixer_ring_alloc(size)      malloc(size)
+#define log_e(...)
+static uint32_t mixer_now_us()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+#define MIXER_RING_MASK             (CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES - 1)
+#define MIXER_UNITY_STEP            (1 << 16)
+
+// What a voice does when it reaches the last frame it may use
+enum {
+    MIXER_VOICE_MORE,
+    MIXER_VOICE_ENDED,
+    MIXER_VOICE_STARVED,
+};
+
+static int32_t mixer_gain(float gain)
+{
+    if (gain < 0.0f) {
+        gain = 0.0f;
+    } else if (gain > 2.0f) {
+        // Keeps sample * gain inside 32 bits
+        gain = 2.0f;
+    }
+    return (int32_t)(gain * 32768.0f + 0.5f);
+}
+
+EspAudioMixer::EspAudioMixer() : _acc(NULL), _rate(0), _channels(0), _serial(0)
+{
+    memset(_voices, 0, sizeof(_voices));
+    for (int i = 0; i < CONFIG_ESP_AUDIO_MIXER_VOICES; i++) {
+        _voices[i].handle = -1;
+    }
+    memset(&_stats, 0, sizeof(_stats));
+#ifdef ARDUINO
+    _lock = xSemaphoreCreateMutex();
+#endif
+}
+
+EspAudioMixer::~EspAudioMixer()
+{
+    end();
+#ifdef ARDUINO
+    vSemaphoreDelete(_lock);
+#endif
+}
+
+void EspAudioMixer::lock()
+{
+#ifdef ARDUINO
+    xSemaphoreTake(_lock, portMAX_DELAY);
+#endif
+}
+
+void EspAudioMixer::unlock()
+{
+#ifdef ARDUINO
+    xSemaphoreGive(_lock);
+#endif
+}
+
+bool EspAudioMixer::begin(uint32_t sample_rate, uint8_t channels)
+{
+    if (!_acc) {
+        _acc = (int32_t *)malloc(CONFIG_ESP_AUDIO_MIXER_FRAMES * 2 * sizeof(int32_t));
+        if (!_acc) {
+            log_e("Could not allocate the mix buffer");
+            return false;
+        }
+    }
+    memset(&_stats, 0, sizeof(_stats));
+    return setFormat(sample_rate, channels);
+}
+
+void EspAudioMixer::end()
+{
+    lock();
+    for (int i = 0; i < CONFIG_ESP_AUDIO_MIXER_VOICES; i++) {
+        _voices[i].handle = -1;
+        free(_voices[i].ring);
+        _voices[i].ring = NULL;
+    }
+    free(_acc);
+    _acc = NULL;
+    unlock();
+}
+
+bool EspAudioMixer::setFormat(uint32_t sample_rate, uint8_t channels)
+{
+    if (!sample_rate || channels < 1 || channels > 2) {
+        return false;
+    }
+    lock();
+    _rate = sample_rate;
+    _channels = channels;
+    for (int i = 0; i < CONFIG_ESP_AUDIO_MIXER_VOICES; i++) {
+        if (_voices[i].handle >= 0) {
+            updateStep(&_voices[i]);
+        }
+    }
+    unlock();
+    return true;
+}
+
+uint32_t EspAudioMixer::getSampleRate()
+{
+    return _rate;
+}
+
+uint8_t EspAudioMixer::getChannels()
+{
+    return _channels;
+}
+
+void EspAudioMixer::updateStep(Voice *v)
+{
+    v->step = (uint32_t)(((uint64_t)v->rate << 16) / _rate);
+}
+
+EspAudioMixer::Voice *EspAudioMixer::findVoice(int handle)
+{
+    if (handle < 0) {
+        return NULL;
+    }
+    Voice *v = &_voices[handle % CONFIG_ESP_AUDIO_MIXER_VOICES];
+    return v->handle == handle ? v : NULL;
+}
+
+// Called locked, the voice is returned cleared except for its stream buffer
+int EspAudioMixer::startVoice(Voice **voice)
+{
+    for (int i = 0; i < CONFIG_ESP_AUDIO_MIXER_VOICES; i++) {
+        Voice *v = &_voices[i];
+        if (v->handle >= 0) {
+            continue;
+        }
+        int16_t *ring = v->ring;
+        memset(v, 0, sizeof(Voice));
+        v->ring = ring;
+        _serial = (_serial + 1) & 0xFFFFFF;
+        v->handle = (int)(_serial * CONFIG_ESP_AUDIO_MIXER_VOICES + i);
+        *voice = v;
+        return v->handle;
+    }
+    return -1;
+}
+
+int EspAudioMixer::play(const EspAudioClip_t *clip, float gain, bool loop)
+{
+    if (!clip || !clip->pcm || !clip->frames || !clip->sample_rate ||
+            clip->channels < 1 || clip->channels > 2) {
+        return -1;
+    }
+    lock();
+    Voice *v = NULL;
+    int handle = _rate ? startVoice(&v) : -1;
+    if (v) {
+        v->pcm = clip->pcm;
+        v->frames = clip->frames;
+        v->rate = clip->sample_rate;
+        v->channels = clip->channels;
+        v->loop = loop;
+        v->gain = mixer_gain(gain);
+        updateStep(v);
+    }
+    unlock();
+    return handle;
+}
+
+int EspAudioMixer::openStream(uint32_t sample_rate, uint8_t channels, float gain)
+{
+    if (!sample_rate || channels < 1 || channels > 2) {
+        return -1;
+    }
+    lock();
+    Voice *v = NULL;
+    int handle = _rate ? startVoice(&v) : -1;
+    if (v && !v->ring) {
+        // Room for stereo, the buffer is reused by any later stream on this voice
+        v->ring = (int16_t *)mixer_ring_alloc(CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES * 2 * sizeof(int16_t));
+        if (!v->ring) {
+            log_e("Could not allocate the stream buffer");
+            v->handle = -1;
+            v = NULL;
+            handle = -1;
+        }
+    }
+    if (v) {
+        v->rate = sample_rate;
+        v->channels = channels;
+        v->gain = mixer_gain(gain);
+        updateStep(v);
+    }
+    unlock();
+    return handle;
+}
+
+// Writer side, the only writer of 'head'
+size_t EspAudioMixer::writeStream(int voice, const int16_t *frames, size_t count, uint32_t timeout_ms)
+{
+    Voice *v = findVoice(voice);
+    if (!v || !v->ring || v->closing) {
+        return 0;
+    }
+    size_t done = 0;
+#ifdef ARDUINO
+    uint32_t waited = 0;
+#endif
+    while (done < count) {
+        uint32_t head = v->head;
+        uint32_t space = CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES - (head - __atomic_load_n(&v->tail, __ATOMIC_ACQUIRE));
+        if (space == 0) {
+#ifdef ARDUINO
+            if (waited >= timeout_ms || v->handle != voice) {
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(2));
+            waited += 2;
+            continue;
+#else
+            (void)timeout_ms;
+            break;
+#endif
+        }
+        uint32_t offset = head & MIXER_RING_MASK;
+        uint32_t n = CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES - offset;
+        if (n > space) {
+            n = space;
+        }
+        if (n > count - done) {
+            n = count - done;
+        }
+        memcpy(v->ring + offset * v->channels, frames + done * v->channels, n * v->channels * sizeof(int16_t));
+        __atomic_store_n(&v->head, head + n, __ATOMIC_RELEASE);
+        done += n;
+    }
+    return done;
+}
+
+void EspAudioMixer::closeStream(int voice)
+{
+    lock();
+    Voice *v = findVoice(voice);
+    if (v && !v->pcm) {
+        v->closing = true;
+    }
+    unlock();
+}
+
+void EspAudioMixer::stop(int voice)
+{
+    lock();
+    Voice *v = findVoice(voice);
+    if (v) {
+        v->handle = -1;
+    }
+    unlock();
+}
+
+void EspAudioMixer::stopAll()
+{
+    lock();
+    for (int i = 0; i < CONFIG_ESP_AUDIO_MIXER_VOICES; i++) {
+        _voices[i].handle = -1;
+    }
+    unlock();
+}
+
+void EspAudioMixer::setGain(int voice, float gain)
+{
+    lock();
+    Voice *v = findVoice(voice);
+    if (v) {
+        v->gain = mixer_gain(gain);
+    }
+    unlock();
+}
+
+bool EspAudioMixer::isPlaying(int voice)
+{
+    lock();
+    bool playing = findVoice(voice) != NULL;
+    unlock();
+    return playing;
+}
+
+bool EspAudioMixer::isActive()
+{
+    bool active = false;
+    lock();
+    for (int i = 0; i < CONFIG_ESP_AUDIO_MIXER_VOICES; i++) {
+        if (_voices[i].handle >= 0) {
+            active = true;
+            break;
+        }
+    }
+    unlock();
+    return active;
+}
+
+// Adds 'count' output frames of one voice to 'acc', returns false when the voice has ended
+bool EspAudioMixer::mixVoice(Voice *v, int32_t *acc, size_t count)
+{
+    const bool stream = v->pcm == NULL;
+    const int16_t *base = stream ? v->ring : v->pcm;
+    const uint32_t ch = v->channels;
+    const int32_t gain = v->gain;
+    uint32_t avail = stream ? __atomic_load_n(&v->head, __ATOMIC_ACQUIRE) - v->tail : v->frames;
+    // An open stream keeps its last frame until the next one arrives to interpolate with
+    uint32_t limit = stream && !v->closing && avail ? avail - 1 : avail;
+    bool direct = v->step == MIXER_UNITY_STEP && v->frac == 0 && ch == _channels;
+    if (direct) {
+        limit = avail;
+    }
+
+    int state = MIXER_VOICE_MORE;
+    size_t done = 0;
+    while (done < count) {
+        if (v->pos >= limit) {
+            if (!stream && v->loop) {
+                v->pos %= v->frames;
+            } else if (!stream || v->closing) {
+                state = MIXER_VOICE_ENDED;
+                break;
+            } else {
+                state = MIXER_VOICE_STARVED;
+                break;
+            }
+        }
+
+        if (direct) {
+            // Same rate and channels, add whole runs
+            uint32_t offset = stream ? (v->tail + v->pos) & MIXER_RING_MASK : v->pos;
+            uint32_t n = limit - v->pos;
+            if (stream && n > CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES - offset) {
+                n = CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES - offset;
+            }
+            if (n > count - done) {
+                n = count - done;
+            }
+            const int16_t *src = base + offset * ch;
+            int32_t *dst = acc + done * ch;
+            uint32_t samples = n * ch;
+            uint32_t i = 0;
+            for (; i + 4 <= samples; i += 4) {
+                dst[i] += (src[i] * gain) >> 15;
+                dst[i + 1] += (src[i + 1] * gain) >> 15;
+                dst[i + 2] += (src[i + 2] * gain) >> 15;
+                dst[i + 3] += (src[i + 3] * gain) >> 15;
+            }
+            for (; i < samples; i++) {
+                dst[i] += (src[i] * gain) >> 15;
+            }
+            v->pos += n;
+            done += n;
+            continue;
+        }
+
+        // Linear interpolation between the frame at 'pos' and the next one
+        uint32_t next = v->pos + 1 < avail ? v->pos + 1 : (v->loop ? 0 : v->pos);
+        const int16_t *f0, *f1;
+        if (stream) {
+            f0 = base + ((v->tail + v->pos) & MIXER_RING_MASK) * ch;
+            f1 = base + ((v->tail + next) & MIXER_RING_MASK) * ch;
+        } else {
+            f0 = base + v->pos * ch;
+            f1 = base + next * ch;
+        }
+        int32_t t = (int32_t)(v->frac >> 1);
+        int32_t l0 = f0[0], l1 = f1[0];
+        int32_t left = l0 + (((l1 - l0) * t) >> 15);
+        int32_t right = left;
+        if (ch == 2) {
+            int32_t r0 = f0[1], r1 = f1[1];
+            right = r0 + (((r1 - r0) * t) >> 15);
+        }
+        if (_channels == 2) {
+            acc[done * 2] += (left * gain) >> 15;
+            acc[done * 2 + 1] += (right * gain) >> 15;
+        } else {
+            acc[done] += (((left + right) >> 1) * gain) >> 15;
+        }
+        v->frac += v->step;
+        v->pos += v->frac >> 16;
+        v->frac &= 0xFFFF;
+        done++;
+    }
+    _stats.voice_frames += done;
+
+    if (stream) {
+        if (state == MIXER_VOICE_STARVED) {
+            if (!v->starved) {
+                _stats.underruns++;
+                v->starved = true;
+            }
+        } else {
+            v->starved = false;
+        }
+        // A step of two or more frames can jump past the last queued frame, never give
+        // back more than was written
+        if (v->pos > avail) {
+            v->pos = avail;
+            v->frac = 0;
+        }
+        // Give the played frames back to the writer, the position restarts at the new tail
+        __atomic_store_n(&v->tail, v->tail + v->pos, __ATOMIC_RELEASE);
+        v->pos = 0;
+    }
+    return state != MIXER_VOICE_ENDED;
+}
+
+size_t EspAudioMixer::mix(int16_t *out, size_t count)
+{
+    uint32_t start = mixer_now_us();
+    size_t done = 0;
+    lock();
+    if (_acc) {
+        while (done < count) {
+            size_t n = count - done;
+            if (n > CONFIG_ESP_AUDIO_MIXER_FRAMES) {
+                n = CONFIG_ESP_AUDIO_MIXER_FRAMES;
+            }
+            size_t samples = n * _channels;
+            memset(_acc, 0, samples * sizeof(int32_t));
+            bool present = false;
+            bool active = false;
+            for (int i = 0; i < CONFIG_ESP_AUDIO_MIXER_VOICES; i++) {
+                Voice *v = &_voices[i];
+                if (v->handle < 0) {
+                    continue;
+                }
+                present = true;
+                if (mixVoice(v, _acc, n)) {
+                    active = true;
+                } else {
+                    v->handle = -1;
+                }
+            }
+            if (!present) {
+                break;
+            }
+            int16_t *dst = out + done * _channels;
+            for (size_t i = 0; i < samples; i++) {
+                int32_t s = _acc[i];
+                if (s > INT16_MAX) {
+                    s = INT16_MAX;
+                    _stats.clipped++;
+                } else if (s < INT16_MIN) {
+                    s = INT16_MIN;
+                    _stats.clipped++;
+                }
+                dst[i] = (int16_t)s;
+            }
+            done += n;
+            if (!active) {
+                // Ended voices were mixed up to their end, the rest of this pass is silence
+                if (done < count) {
+                    memset(out + done * _channels, 0, (count - done) * _channels * sizeof(int16_t));
+                    done = count;
+                }
+                break;
+            }
+        }
+        if (done) {
+            uint32_t spent = mixer_now_us() - start;
+            _stats.mixes++;
+            _stats.frames += done;
+            _stats.mix_us += spent;
+            if (spent > _stats.mix_max_us) {
+                _stats.mix_max_us = spent;
+            }
+        }
+    }
+    unlock();
+    return done;
+}
+
+size_t EspAudioMixer::source(int16_t *frames, size_t count, void *user_data)
+{
+    return ((EspAudioMixer *)user_data)->mix(frames, count);
+}
+
+void EspAudioMixer::getStats(EspAudioMixerStats_t *stats)
+{
+    *stats = _stats;
+}
+
+#endif
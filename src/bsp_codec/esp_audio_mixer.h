@@ -0,0 +1,213 @@
+/**
+ * @file      esp_audio_mixer.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-25
+ * @note      Software mixer for a few voices, e.g. music together with key clicks and
+ *            notifications. Each voice has its own gain, rate and channel count and is
+ *            converted to the output format, the sum is saturated to 16 bit. mix() is the
+ *            stage in front of EspCodec::write() or Player::write(), source() plugs the
+ *            mixer into EspAudioEngine as its playback source.
+ *            Define ESP_AUDIO_MIXER_HOST to build it on a PC.
+ */
+#pragma once
+
+#if defined(ARDUINO) || defined(ESP_AUDIO_MIXER_HOST)
+#include <stdint.h>
+#include <stddef.h>
+#ifdef ARDUINO
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#endif
+
+/**
+ * @brief Number of voices mixed at the same time.
+ */
+#ifndef CONFIG_ESP_AUDIO_MIXER_VOICES
+#define CONFIG_ESP_AUDIO_MIXER_VOICES       4
+#endif
+
+/**
+ * @brief Output frames mixed in one pass, mix() loops for larger requests.
+ */
+#ifndef CONFIG_ESP_AUDIO_MIXER_FRAMES
+#define CONFIG_ESP_AUDIO_MIXER_FRAMES       256
+#endif
+
+/**
+ * @brief Frames buffered per stream voice, must be a power of two.
+ */
+#ifndef CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES
+#define CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES    4096
+#endif
+
+/**
+ * @struct EspAudioClip_t
+ * @brief Decoded 16 bit PCM kept in memory, e.g. a key click, played without decoding again.
+ */
+typedef struct {
+    const int16_t *pcm;         /**< Interleaved samples, must stay valid while the clip plays */
+    uint32_t frames;            /**< Number of frames */
+    uint32_t sample_rate;       /**< Sampling rate in Hz */
+    uint8_t channels;           /**< 1 or 2 */
+} EspAudioClip_t;
+
+/**
+ * @struct EspAudioMixerStats_t
+ * @brief Counters since begin().
+ */
+typedef struct {
+    uint32_t mixes;             /**< Calls of mix() */
+    uint32_t frames;            /**< Output frames mixed */
+    uint32_t voice_frames;      /**< Output frames summed over the voices, the cost driver */
+    uint32_t underruns;         /**< A stream voice ran out of data while it was not closing */
+    uint32_t clipped;           /**< Output samples saturated */
+    uint32_t mix_us;            /**< Time spent in mix() */
+    uint32_t mix_max_us;        /**< Longest mix() */
+} EspAudioMixerStats_t;
+
+/**
+ * @class EspAudioMixer
+ * @brief Mixes clips and streams into one output.
+ * @details Voices are referred to by the handle returned when they start, a handle becomes
+ *          invalid when its voice ends, so a stale handle never controls a newer voice.
+ */
+class EspAudioMixer
+{
+public:
+    EspAudioMixer();
+    ~EspAudioMixer();
+
+    /**
+     * @brief Set the output format and allocate the mix buffer.
+     * @param sample_rate Output sampling rate in Hz.
+     * @param channels Output channels, 1 or 2.
+     * @return True on success, false otherwise.
+     */
+    bool begin(uint32_t sample_rate, uint8_t channels);
+
+    /**
+     * @brief Stop all voices and free the buffers.
+     */
+    void end();
+
+    /**
+     * @brief Change the output format, the voices keep playing and are converted to it.
+     * @return True on success, false if the format is not supported.
+     */
+    bool setFormat(uint32_t sample_rate, uint8_t channels);
+
+    uint32_t getSampleRate();
+
+    uint8_t getChannels();
+
+    /**
+     * @brief Start a clip on a free voice.
+     * @param clip Clip to play, not copied.
+     * @param gain Linear gain, 0.0 to 2.0.
+     * @param loop Restart the clip at its end until stop().
+     * @return Voice handle, -1 if no voice is free.
+     */
+    int play(const EspAudioClip_t *clip, float gain = 1.0f, bool loop = false);
+
+    /**
+     * @brief Start a voice that is fed with writeStream(), e.g. by a decoder.
+     * @param sample_rate Sampling rate of the stream in Hz.
+     * @param channels Channels of the stream, 1 or 2.
+     * @param gain Linear gain, 0.0 to 2.0.
+     * @return Voice handle, -1 if no voice is free or the buffer could not be allocated.
+     */
+    int openStream(uint32_t sample_rate, uint8_t channels, float gain = 1.0f);
+
+    /**
+     * @brief Queue frames on a stream voice, only one task may write to a voice.
+     * @param voice Handle from openStream().
+     * @param frames Interleaved 16 bit samples in the format of the stream.
+     * @param count Number of frames.
+     * @param timeout_ms Time to wait for buffer space, this is what paces the writer.
+     * @return Number of frames queued.
+     */
+    size_t writeStream(int voice, const int16_t *frames, size_t count, uint32_t timeout_ms);
+
+    /**
+     * @brief End a stream voice after the queued frames have played.
+     */
+    void closeStream(int voice);
+
+    /**
+     * @brief Stop a voice at once, a stale handle is ignored.
+     */
+    void stop(int voice);
+
+    void stopAll();
+
+    /**
+     * @brief Change the gain of a voice, a stale handle is ignored.
+     */
+    void setGain(int voice, float gain);
+
+    /**
+     * @brief Check whether a voice is still playing.
+     */
+    bool isPlaying(int voice);
+
+    /**
+     * @brief Check whether any voice is playing, including a stream waiting for data.
+     */
+    bool isActive();
+
+    /**
+     * @brief Mix the voices into the output format.
+     * @param out Interleaved output samples.
+     * @param count Number of output frames.
+     * @return count if any voice is playing, the frames of a starving stream are silent,
+     *         0 without voices, then 'out' is not written.
+     */
+    size_t mix(int16_t *out, size_t count);
+
+    /**
+     * @brief EspAudioPlaybackCallback_t calling mix(), 'user_data' is the mixer.
+     */
+    static size_t source(int16_t *frames, size_t count, void *user_data);
+
+    void getStats(EspAudioMixerStats_t *stats);
+
+private:
+    struct Voice {
+        int handle;             // -1 when free
+        const int16_t *pcm;     // Clip data, NULL for a stream
+        uint32_t frames;        // Clip length
+        int16_t *ring;          // Stream buffer, kept for the next stream on this voice
+        uint32_t head;          // Stream frames written
+        uint32_t tail;          // Stream frames played
+        uint32_t rate;
+        uint8_t channels;
+        bool loop;
+        bool closing;
+        bool starved;
+        int32_t gain;           // Q15
+        uint32_t pos;           // Frame position, in the clip or after 'tail'
+        uint32_t frac;          // Position between two frames, Q16
+        uint32_t step;          // Source frames per output frame, Q16
+    };
+
+    Voice *findVoice(int handle);
+    int startVoice(Voice **voice);
+    void updateStep(Voice *v);
+    bool mixVoice(Voice *v, int32_t *acc, size_t count);
+    void lock();
+    void unlock();
+
+    Voice _voices[CONFIG_ESP_AUDIO_MIXER_VOICES];
+    int32_t *_acc;
+    uint32_t _rate;
+    uint8_t _channels;
+    uint32_t _serial;
+    EspAudioMixerStats_t _stats;
+#ifdef ARDUINO
+    SemaphoreHandle_t _lock;
+#endif
+};
+
+#endif
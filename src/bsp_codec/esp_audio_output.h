@@ -0,0 +1,89 @@
+/**
+ * @file      esp_audio_output.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-23
+ * @note      ESP8266Audio AudioOutput on top of EspCodecOutput. Header only, so the library
+ *            does not depend on ESP8266Audio, include it from a sketch that uses ESP8266Audio.
+ */
+#pragma once
+
+#ifdef ARDUINO
+#include <AudioOutput.h>
+#include "esp_codec_output.h"
+
+/**
+ * @class EspAudioOutput
+ * @brief AudioOutput that writes whole blocks to an EspCodec.
+ */
+class EspAudioOutput : public AudioOutput
+{
+public:
+    /**
+     * @brief Constructor for EspAudioOutput.
+     * @param codec Codec used for playback, e.g. instance.codec.
+     */
+    EspAudioOutput(EspCodec &codec) : _out(codec)
+    {
+        hertz = 16000;
+        bps = 16;
+        channels = 2;
+        SetGain(1.0);
+    }
+
+    bool SetRate(int hz) override
+    {
+        hertz = hz;
+        // Changed without closing the codec when already playing
+        return _out.setRate(hz);
+    }
+
+    bool begin() override
+    {
+        // The codec always runs 16 bit stereo, other formats are converted per sample
+        return _out.begin(hertz);
+    }
+
+    bool ConsumeSample(int16_t sample[2]) override
+    {
+        int16_t ms[2] = {sample[LEFTCHANNEL], sample[RIGHTCHANNEL]};
+        MakeSampleStereo16(ms);
+        ms[LEFTCHANNEL] = Amplify(ms[LEFTCHANNEL]);
+        ms[RIGHTCHANNEL] = Amplify(ms[RIGHTCHANNEL]);
+        return _out.writeFrame(ms);
+    }
+
+    uint16_t ConsumeSamples(int16_t *samples, uint16_t count) override
+    {
+        // 'count' is in stereo frames, copied as one block when no conversion is needed
+        if (channels == 2 && bps == 16 && gainF2P6 == (1 << 6)) {
+            return _out.write(samples, count);
+        }
+        return AudioOutput::ConsumeSamples(samples, count);
+    }
+
+    void flush() override
+    {
+        _out.flush();
+    }
+
+    bool stop() override
+    {
+        _out.end();
+        return true;
+    }
+
+    /**
+     * @brief Get the output counters, see EspCodecOutputStats_t.
+     */
+    void getStats(EspCodecOutputStats_t *stats)
+    {
+        _out.getStats(stats);
+    }
+
+private:
+    EspCodecOutput _out;
+};
+
+#endif
@@ -49,6 +49,7 @@ EspCodec::EspCodec(uint8_t i2s_channel)
     _ws_io_num = -1;
     _data_out_num = -1;
     _data_in_num = -1;
+    codec_dev = NULL;
     paPinCb = nullptr;
     paPinUserData = nullptr;
 }
@@ -266,6 +267,21 @@ int EspCodec::open(uint8_t bits_per_sample, uint8_t channel, uint32_t sample_rat
     return rlst;
 }
 
+int EspCodec::setFormat(uint8_t bits_per_sample, uint8_t channel, uint32_t sample_rate)
+{
+    esp_codec_dev_sample_info_t fs = {
+        .bits_per_sample = bits_per_sample,
+        .channel = channel,
+        .channel_mask = 0,
+        .sample_rate = sample_rate
+    };
+    int rlst = esp_codec_dev_set_fs(codec_dev, &fs);
+    if (rlst == ESP_CODEC_DEV_WRONG_STATE) {
+        return open(bits_per_sample, channel, sample_rate);
+    }
+    return rlst;
+}
+
 void EspCodec::close()
 {
     esp_codec_dev_close(codec_dev);
@@ -279,6 +295,11 @@ int EspCodec::write(uint8_t * buffer, size_t size)
     return esp_codec_dev_write(codec_dev, buffer, size);
 }
 
+esp_codec_dev_handle_t EspCodec::getDevice()
+{
+    return codec_dev;
+}
+
 int EspCodec::read(uint8_t * buffer, size_t size)
 {
     return esp_codec_dev_read(codec_dev, buffer, size);
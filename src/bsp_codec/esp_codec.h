@@ -126,6 +126,17 @@ public:
      */
     int open(uint8_t bits_per_sample, uint8_t channel, uint32_t sample_rate);
 
+    /**
+     * @brief Change the format of the open audio stream without closing it.
+     * @details The codec and the PA stay enabled, so there is no pop and no PA restart delay.
+     *          Opens the stream if it is not open.
+     * @param bits_per_sample Number of bits per audio sample (e.g., 16, 24).
+     * @param channel Number of audio channels (1 for mono, 2 for stereo).
+     * @param sample_rate Sampling rate in Hz (e.g., 44100, 48000).
+     * @return 0 on success, negative error code on failure.
+     */
+    int setFormat(uint8_t bits_per_sample, uint8_t channel, uint32_t sample_rate);
+
     /**
      * @brief Close the current audio stream.
      */
@@ -183,6 +194,12 @@ public:
      */
     float getGain();
 
+    /**
+     * @brief Get the codec device handle, for the esp_codec_dev API.
+     * @return Handle of the codec device, NULL before begin().
+     */
+    esp_codec_dev_handle_t getDevice();
+
     /**
      * @brief Record audio to a WAV file.
      * @note  This is a blocking recording function that will not exit until the recording is complete.
@@ -212,6 +212,40 @@ int esp_codec_dev_open(esp_codec_dev_handle_t handle, esp_codec_dev_sample_info_
     return ESP_CODEC_DEV_OK;
 }
 
+int esp_codec_dev_set_fs(esp_codec_dev_handle_t handle, esp_codec_dev_sample_info_t *fs)
+{
+    codec_dev_t *dev = (codec_dev_t *) handle;
+    if (dev == NULL || fs == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (dev->input_opened == false && dev->output_opened == false) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    const audio_codec_if_t *codec = dev->codec_if;
+    const audio_codec_data_if_t *data_if = dev->data_if;
+    int ret = ESP_CODEC_DEV_OK;
+    if (data_if->set_fmt) {
+        ret = data_if->set_fmt(data_if, dev->dev_caps, fs);
+    }
+    // Setting the format disables the channels internally
+    if (data_if->enable) {
+        data_if->enable(data_if, dev->dev_caps, true);
+    }
+    if (ret != ESP_CODEC_DEV_OK) {
+        return ret;
+    }
+    if (codec && codec->set_fs) {
+        if (codec->set_fs(codec, fs) != 0) {
+            return ESP_CODEC_DEV_NOT_SUPPORT;
+        }
+    }
+    if (dev->output_opened && dev->sw_vol) {
+        // Keeps the current gain, no fade
+        dev->sw_vol->open(dev->sw_vol, fs, VOL_TRANSITION_TIME);
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
 int esp_codec_dev_read(esp_codec_dev_handle_t handle, void *data, int len)
 {
     codec_dev_t *dev = (codec_dev_t *) handle;
@@ -0,0 +1,179 @@
+/**
+ * @file      esp_codec_output.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-23
+ *
+ */
+#include "esp_codec_output.h"
+
+#ifdef ARDUINO
+#include "esp_timer.h"
+
+EspCodecOutput::EspCodecOutput(EspCodec &codec) :
+    _codec(&codec), _buffer(NULL), _fill(0), _rate(0), _running(false), _error(false)
+{
+    resetStats();
+}
+
+EspCodecOutput::~EspCodecOutput()
+{
+    end();
+    free(_buffer);
+}
+
+bool EspCodecOutput::begin(uint32_t sample_rate)
+{
+    if (_running) {
+        return setRate(sample_rate);
+    }
+    if (!_buffer) {
+        // Internal RAM, the codec write runs the software volume over it
+        _buffer = (int16_t *)malloc(CONFIG_ESP_CODEC_OUTPUT_FRAMES * 2 * sizeof(int16_t));
+        if (!_buffer) {
+            log_e("Could not allocate the staging buffer");
+            return false;
+        }
+    }
+    if (_codec->open(16, 2, sample_rate) != 0) {
+        log_e("Codec open failed, rate:%lu", (unsigned long)sample_rate);
+        return false;
+    }
+    _rate = sample_rate;
+    _fill = 0;
+    _error = false;
+    _running = true;
+    resetStats();
+    return true;
+}
+
+bool EspCodecOutput::setRate(uint32_t sample_rate)
+{
+    if (!_running) {
+        _rate = sample_rate;
+        return true;
+    }
+    if (sample_rate == _rate) {
+        return true;
+    }
+    flush();
+    if (_codec->setFormat(16, 2, sample_rate) != 0) {
+        log_e("Codec rate change failed, rate:%lu", (unsigned long)sample_rate);
+        return false;
+    }
+    _rate = sample_rate;
+    return true;
+}
+
+bool EspCodecOutput::writeBlock()
+{
+    int64_t start = esp_timer_get_time();
+    if (_last_us) {
+        _busy_us += start - _last_us;
+    }
+    int ret = _codec->write((uint8_t *)_buffer, _fill * 2 * sizeof(int16_t));
+    _last_us = esp_timer_get_time();
+    _write_us += _last_us - start;
+    _writes++;
+    size_t fill = _fill;
+    _fill = 0;
+    if (ret < 0) {
+        if (!_error) {
+            log_e("Codec write failed:%d", ret);
+        }
+        _error = true;
+        _write_errors++;
+        _dropped += fill;
+        return false;
+    }
+    _error = false;
+    _frames += fill;
+    return true;
+}
+
+bool EspCodecOutput::writeFrame(const int16_t frame[2])
+{
+    if (!_running) {
+        return false;
+    }
+    _buffer[_fill * 2] = frame[0];
+    _buffer[_fill * 2 + 1] = frame[1];
+    if (++_fill == CONFIG_ESP_CODEC_OUTPUT_FRAMES) {
+        writeBlock();
+    }
+    return true;
+}
+
+size_t EspCodecOutput::write(const int16_t *frames, size_t count)
+{
+    if (!_running) {
+        return 0;
+    }
+    size_t done = 0;
+    while (done < count) {
+        size_t n = CONFIG_ESP_CODEC_OUTPUT_FRAMES - _fill;
+        if (n > count - done) {
+            n = count - done;
+        }
+        // Always copied, the codec write changes the buffer in place for the software volume
+        memcpy(_buffer + _fill * 2, frames + done * 2, n * 2 * sizeof(int16_t));
+        _fill += n;
+        done += n;
+        if (_fill == CONFIG_ESP_CODEC_OUTPUT_FRAMES) {
+            // The block may start with frames staged before this call
+            size_t own = _fill < done ? _fill : done;
+            if (!writeBlock()) {
+                done -= own;
+                break;
+            }
+        }
+    }
+    return done;
+}
+
+void EspCodecOutput::flush()
+{
+    if (_running && _fill) {
+        writeBlock();
+    }
+}
+
+void EspCodecOutput::end()
+{
+    if (!_running) {
+        return;
+    }
+    flush();
+    _codec->close();
+    _running = false;
+}
+
+bool EspCodecOutput::isRunning()
+{
+    return _running;
+}
+
+void EspCodecOutput::getStats(EspCodecOutputStats_t *stats)
+{
+    stats->frames = (uint32_t)_frames;
+    stats->writes = _writes;
+    stats->write_errors = _write_errors;
+    stats->dropped = _dropped;
+    stats->busy_us = (uint32_t)_busy_us;
+    stats->write_us = (uint32_t)_write_us;
+    stats->busy_us_per_s = _frames && _rate ? (uint32_t)(_busy_us * _rate / _frames) : 0;
+}
+
+void EspCodecOutput::resetStats()
+{
+    _frames = 0;
+    _writes = 0;
+    _write_errors = 0;
+    _dropped = 0;
+    _busy_us = 0;
+    _write_us = 0;
+    _last_us = 0;
+}
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * @file      esp_codec_output.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-23
+ *
+ */
+#pragma once
+
+#ifdef ARDUINO
+#include "esp_codec.h"
+
+/**
+ * @brief Stereo frames staged before one codec write.
+ * @details 240 is the DMA buffer length of the default I2S channel config, so one write fills one DMA buffer.
+ */
+#ifndef CONFIG_ESP_CODEC_OUTPUT_FRAMES
+#define CONFIG_ESP_CODEC_OUTPUT_FRAMES      240
+#endif
+
+/**
+ * @struct EspCodecOutputStats_t
+ * @brief Counters of an EspCodecOutput since begin() or resetStats().
+ */
+typedef struct {
+    uint32_t frames;        /**< Stereo frames written to the codec */
+    uint32_t writes;        /**< Codec writes, one per staged block */
+    uint32_t write_errors;  /**< Codec writes that failed, the frames of their block were dropped */
+    uint32_t dropped;       /**< Stereo frames dropped by failed writes */
+    uint32_t busy_us;       /**< Time between writes, spent producing the samples */
+    uint32_t write_us;      /**< Time inside the codec writes, mostly waiting for DMA space */
+    uint32_t busy_us_per_s; /**< busy_us per second of audio, 1000000 means the producer is just in time */
+} EspCodecOutputStats_t;
+
+/**
+ * @class EspCodecOutput
+ * @brief Block sink for 16 bit stereo samples on top of EspCodec.
+ * @details Samples are collected in a staging buffer and written to the codec one block at a time,
+ *          instead of one esp_codec_dev_write() per sample. The methods follow the ESP8266Audio
+ *          AudioOutput calls, see esp_audio_output.h for the AudioOutput adapter.
+ */
+class EspCodecOutput
+{
+public:
+    /**
+     * @brief Constructor for EspCodecOutput.
+     * @param codec Codec the blocks are written to.
+     */
+    EspCodecOutput(EspCodec &codec);
+
+    /**
+     * @brief Destructor for EspCodecOutput.
+     */
+    ~EspCodecOutput();
+
+    /**
+     * @brief Open the codec for 16 bit stereo.
+     * @param sample_rate Sampling rate in Hz.
+     * @return True on success, false otherwise.
+     */
+    bool begin(uint32_t sample_rate);
+
+    /**
+     * @brief Change the sampling rate, the staged samples are played at the old rate first.
+     * @details The codec is reconfigured without closing it.
+     * @param sample_rate Sampling rate in Hz.
+     * @return True on success, false otherwise.
+     */
+    bool setRate(uint32_t sample_rate);
+
+    /**
+     * @brief Add one stereo frame.
+     * @details A failed codec write is not reported here, the frame was taken either way
+     *          and giving it again would repeat it. See write_errors in getStats().
+     * @param frame Left and right sample.
+     * @return True once the frame is staged, false if not started.
+     */
+    bool writeFrame(const int16_t frame[2]);
+
+    /**
+     * @brief Add interleaved stereo frames.
+     * @details Stops at the first failed codec write. The frames of this call in that block
+     *          were dropped and are not counted, so the caller may give them again.
+     * @param frames Interleaved left and right samples.
+     * @param count Number of stereo frames, not bytes.
+     * @return Number of frames written or staged.
+     */
+    size_t write(const int16_t *frames, size_t count);
+
+    /**
+     * @brief Write the staged frames now.
+     */
+    void flush();
+
+    /**
+     * @brief Flush and close the codec.
+     */
+    void end();
+
+    /**
+     * @brief Check if the codec is open.
+     * @return True if begin() succeeded and end() was not called.
+     */
+    bool isRunning();
+
+    /**
+     * @brief Get the counters.
+     * @param stats Pointer to receive the counters.
+     */
+    void getStats(EspCodecOutputStats_t *stats);
+
+    /**
+     * @brief Clear the counters.
+     */
+    void resetStats();
+
+private:
+    bool writeBlock();
+
+    EspCodec *_codec;
+    int16_t *_buffer;
+    size_t _fill;
+    uint32_t _rate;
+    bool _running;
+    bool _error;
+
+    uint64_t _frames;
+    uint32_t _writes;
+    uint32_t _write_errors;
+    uint32_t _dropped;
+    uint64_t _busy_us;
+    uint64_t _write_us;
+    int64_t _last_us;       /**< End of the last write, start of the current busy period */
+};
+
+#endif
@@ -54,6 +54,18 @@ esp_codec_dev_handle_t esp_codec_dev_new(esp_codec_dev_cfg_t *codec_dev_cfg);
  */
 int esp_codec_dev_open(esp_codec_dev_handle_t codec, esp_codec_dev_sample_info_t *fs);
 
+/**
+ * @brief         Change the sample information of an opened codec device
+ *                The codec and power amplifier stay enabled, only the data interface and codec clocks are reconfigured
+ * @param         codec: Codec device handle
+ * @param         fs: Audio sample information
+ * @return        ESP_CODEC_DEV_OK: Set success
+ *                ESP_CODEC_DEV_INVALID_ARG: Invalid arguments
+ *                ESP_CODEC_DEV_NOT_SUPPORT: Codec not support the sample information
+ *                ESP_CODEC_DEV_WRONG_STATE: Driver not open yet
+ */
+int esp_codec_dev_set_fs(esp_codec_dev_handle_t codec, esp_codec_dev_sample_info_t *fs);
+
 /**
  * @brief         Read data from codec
  * @param         codec: Codec device handle
@@ -90,7 +90,17 @@
  * - LV_OS_WINDOWS
  * - LV_OS_MQX
  * - LV_OS_CUSTOM */
+/* Set LV_HELPER_MULTI_CORE to 1 to render with two software draw units on both cores,
+ * this enables the FreeRTOS OS layer. See lv_helper_lock() in LV_Helper.h */
+#ifndef LV_HELPER_MULTI_CORE
+#define LV_HELPER_MULTI_CORE    0
+#endif
+
+#if LV_HELPER_MULTI_CORE
+#define LV_USE_OS   LV_OS_FREERTOS
+#else
 #define LV_USE_OS   LV_OS_NONE
+#endif
 
 #if LV_USE_OS == LV_OS_CUSTOM
     #define LV_OS_CUSTOM_INCLUDE <stdint.h>
@@ -156,7 +166,11 @@
 	/* Set the number of draw unit.
      * > 1 requires an operating system enabled in `LV_USE_OS`
      * > 1 means multiple threads will render the screen in parallel */
+    #if LV_HELPER_MULTI_CORE
+    #define LV_DRAW_SW_DRAW_UNIT_CNT    2
+    #else
     #define LV_DRAW_SW_DRAW_UNIT_CNT    1
+    #endif
 
     /* Use Arm-2D to accelerate the sw render */
     #define LV_USE_DRAW_ARM2D_SYNC      0
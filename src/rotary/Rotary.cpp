@@ -5,8 +5,8 @@
  *
  */
 
-#include "Arduino.h"
 #include "Rotary.h"
+#include <string.h>
 
 /*
  * The below state table has, for each state (row), the new state
@@ -76,8 +76,28 @@ Rotary::Rotary(char _pin1, char _pin2) {
   state = R_START;
   // Don't invert read pin state by default
   inverter = 0;
+  memset(&delta, 0, sizeof(delta));
+  last_step_us = 0;
+  // No acceleration by default
+  accel_slow_us = 0;
+  accel_fast_us = 0;
+  accel_max = 1;
+  edge_cb = NULL;
+  edge_cb_user_data = NULL;
+#if defined(ARDUINO_ARCH_ESP32)
+  mux = portMUX_INITIALIZER_UNLOCKED;
+#endif
 }
 
+#if defined(ARDUINO_ARCH_ESP32)
+#define ROTARY_ENTER_CRITICAL()     portENTER_CRITICAL_SAFE(&mux)
+#define ROTARY_EXIT_CRITICAL()      portEXIT_CRITICAL_SAFE(&mux)
+#else
+#define ROTARY_ENTER_CRITICAL()
+#define ROTARY_EXIT_CRITICAL()
+#endif
+
+#ifdef ARDUINO
 void Rotary::begin(bool internalPullup, bool flipLogicForPulldown) {
 
   if (internalPullup){
@@ -100,3 +120,76 @@ unsigned char Rotary::process() {
   // Return emit bits, ie the generated event.
   return state & 0x30;
 }
+
+void ARDUINO_ISR_ATTR Rotary::isr(void *arg) {
+  Rotary *self = (Rotary *)arg;
+  unsigned char pinstate = ((self->inverter ^ digitalRead(self->pin2)) << 1) | (self->inverter ^ digitalRead(self->pin1));
+  if (self->feed(pinstate, micros()) && self->edge_cb) {
+    self->edge_cb(self->edge_cb_user_data);
+  }
+}
+
+void Rotary::beginInterrupt(RotaryEdgeCallback_t cb, void *user_data, bool internalPullup, bool flipLogicForPulldown) {
+  begin(internalPullup, flipLogicForPulldown);
+  edge_cb = cb;
+  edge_cb_user_data = user_data;
+  // Both contacts change once per quarter step, every transition goes through the table
+  attachInterruptArg(pin1, isr, this, CHANGE);
+  attachInterruptArg(pin2, isr, this, CHANGE);
+}
+
+void Rotary::end() {
+  detachInterrupt(pin1);
+  detachInterrupt(pin2);
+  edge_cb = NULL;
+}
+#endif
+
+unsigned char Rotary::feed(unsigned char pinstate, uint32_t timestamp_us) {
+  ROTARY_ENTER_CRITICAL();
+  state = ttable[state & 0xf][pinstate & 0x3];
+  unsigned char result = state & 0x30;
+  if (result) {
+    int16_t dir = result == DIR_CW ? 1 : -1;
+    if (delta.steps == 0) {
+      delta.first_us = timestamp_us;
+    }
+    delta.last_us = timestamp_us;
+    delta.steps += dir;
+    delta.accel_steps += dir * accelerate(timestamp_us);
+  }
+  ROTARY_EXIT_CRITICAL();
+  return result;
+}
+
+bool Rotary::read(RotaryDelta_t *out) {
+  ROTARY_ENTER_CRITICAL();
+  bool ret = delta.steps != 0;
+  if (out) {
+    *out = delta;
+  }
+  memset(&delta, 0, sizeof(delta));
+  ROTARY_EXIT_CRITICAL();
+  return ret;
+}
+
+void Rotary::setAcceleration(uint16_t slow_ms, uint16_t fast_ms, uint8_t max_multiplier) {
+  ROTARY_ENTER_CRITICAL();
+  accel_slow_us = slow_ms * 1000UL;
+  accel_fast_us = fast_ms < slow_ms ? fast_ms * 1000UL : accel_slow_us;
+  accel_max = max_multiplier ? max_multiplier : 1;
+  ROTARY_EXIT_CRITICAL();
+}
+
+int16_t Rotary::accelerate(uint32_t timestamp_us) {
+  uint32_t interval = timestamp_us - last_step_us;
+  last_step_us = timestamp_us;
+  if (accel_max <= 1 || interval >= accel_slow_us) {
+    return 1;
+  }
+  if (interval <= accel_fast_us) {
+    return accel_max;
+  }
+  // Linear between 1 at accel_slow_us and accel_max at accel_fast_us
+  return 1 + (int16_t)((accel_max - 1) * (accel_slow_us - interval) / (accel_slow_us - accel_fast_us));
+}
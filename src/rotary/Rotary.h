@@ -5,7 +5,11 @@
 #ifndef Rotary_h
 #define Rotary_h
 
+#include <stdint.h>
+#include <stddef.h>
+#ifdef ARDUINO
 #include "Arduino.h"
+#endif
 
 // Enable this to emit codes twice per step.
 // #define HALF_STEP
@@ -18,21 +22,66 @@
 // Counter-clockwise step.
 #define DIR_CCW 0x20
 
+// Steps accumulated since the last 'read'
+typedef struct {
+  int16_t steps;        // Raw steps, positive is clockwise
+  int16_t accel_steps;  // Steps scaled by the acceleration curve
+  uint32_t first_us;    // Timestamp of the first step
+  uint32_t last_us;     // Timestamp of the last step
+} RotaryDelta_t;
+
+// Called from the pin interrupt after each edge, keep it short
+typedef void (*RotaryEdgeCallback_t)(void *user_data);
+
 class Rotary
 {
   public:
     Rotary(char, char);
     unsigned char process();
     void begin(bool internalPullup=true, bool flipLogicForPulldown=false);
-  
+
+    // Decode on pin edges instead of calling 'process' periodically.
+    // 'cb' runs in interrupt context after every edge, e.g. to wake the reading task.
+    void beginInterrupt(RotaryEdgeCallback_t cb = NULL, void *user_data = NULL,
+                        bool internalPullup=true, bool flipLogicForPulldown=false);
+    void end();
+
+    // Run one A/B sample through the state table and accumulate the result.
+    // 'pinstate' is (B << 1) | A after inversion. Does not touch the hardware,
+    // so recorded edge sequences can be replayed on a host.
+    unsigned char feed(unsigned char pinstate, uint32_t timestamp_us);
+
+    // Take and clear the accumulated steps, returns false if there are none
+    bool read(RotaryDelta_t *delta);
+
+    // Steps closer than 'slow_ms' apart are multiplied, rising linearly up to
+    // 'max_multiplier' at 'fast_ms' apart or less. max_multiplier 1 disables it.
+    void setAcceleration(uint16_t slow_ms, uint16_t fast_ms, uint8_t max_multiplier);
+
     inline unsigned char pin_1() const { return pin1; }
     inline unsigned char pin_2() const { return pin2; }
   private:
+    int16_t accelerate(uint32_t timestamp_us);
+#ifdef ARDUINO
+    static void ARDUINO_ISR_ATTR isr(void *arg);
+#endif
+
     unsigned char state;
     unsigned char pin1;
     unsigned char pin2;
     unsigned char inverter;
+
+    RotaryDelta_t delta;
+    uint32_t last_step_us;
+    uint32_t accel_slow_us;
+    uint32_t accel_fast_us;
+    uint8_t accel_max;
+
+    RotaryEdgeCallback_t edge_cb;
+    void *edge_cb_user_data;
+#if defined(ARDUINO_ARCH_ESP32)
+    portMUX_TYPE mux;
+#endif
 };
 
 #endif
- 
@@ -0,0 +1,60 @@
+/**
+ * @file      host_test.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      Minimal checks and timing for the host tests, a test returns
+ *            host_test_result() from main().
+ */
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <chrono>
+
+static int host_test_failures = 0;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            host_test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) do { \
+        long long _a = (long long)(a), _b = (long long)(b); \
+        if (_a != _b) { \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s (%lld != %lld)\n", \
+                    __FILE__, __LINE__, #a, #b, _a, _b); \
+            host_test_failures++; \
+        } \
+    } while (0)
+
+static inline uint64_t host_test_now_ns()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// True if the benchmarks were asked for with --bench
+static inline bool host_test_bench(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline int host_test_result(const char *name)
+{
+    if (host_test_failures) {
+        printf("%s: %d check(s) failed\n", name, host_test_failures);
+        return 1;
+    }
+    printf("%s: passed\n", name);
+    return 0;
+}
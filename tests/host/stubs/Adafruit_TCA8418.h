@@ -0,0 +1,126 @@
+/**
+ * @file      Adafruit_TCA8418.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      A TCA8418 key event FIFO for the host tests. host_key() queues an event
+ *            as a key would and pulls INT low, clearing K_INT releases INT once the
+ *            FIFO is empty, otherwise the flag is raised again as on the chip.
+ */
+#pragma once
+
+#include "Arduino.h"
+#include "Wire.h"
+#include <deque>
+
+#define TCA8418_DEFAULT_ADDR            0x34
+#define TCA8418_REG_INT_STAT            0x02
+#define TCA8418_REG_GPIO_INT_STAT_1     0x11
+#define TCA8418_REG_GPIO_INT_STAT_2     0x12
+#define TCA8418_REG_GPIO_INT_STAT_3     0x13
+
+class Adafruit_TCA8418
+{
+public:
+    // Test side
+    int host_irq_pin = -1;          // INT of the chip, driven when set
+    size_t host_fifo_size = 10;     // Events the FIFO holds
+    uint32_t host_overflows = 0;    // Events lost because the FIFO was full
+
+    // Queues a key event, false if the FIFO was full
+    bool host_key(uint8_t raw)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_fifo.size() >= host_fifo_size) {
+            host_overflows++;
+            return false;
+        }
+        _fifo.push_back(raw);
+        _int_stat |= 0x01;
+        if (host_irq_pin >= 0) {
+            host_pin_write(host_irq_pin, LOW);
+        }
+        return true;
+    }
+
+    size_t host_pending()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _fifo.size();
+    }
+
+    // Driver side
+    bool begin(uint8_t address, TwoWire *wire)
+    {
+        return true;
+    }
+
+    bool matrix(uint8_t rows, uint8_t columns)
+    {
+        return true;
+    }
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _fifo.clear();
+        _int_stat = 0;
+        releaseIrq();
+    }
+
+    uint8_t available()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return (uint8_t)_fifo.size();
+    }
+
+    uint8_t getEvent()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_fifo.empty()) {
+            return 0;
+        }
+        uint8_t raw = _fifo.front();
+        _fifo.pop_front();
+        return raw;
+    }
+
+    uint8_t readRegister(uint8_t reg)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return reg == TCA8418_REG_INT_STAT ? _int_stat : 0;
+    }
+
+    void writeRegister(uint8_t reg, uint8_t value)
+    {
+        if (reg != TCA8418_REG_INT_STAT) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard(_lock);
+        _int_stat &= ~value;
+        if (!_fifo.empty()) {
+            _int_stat |= 0x01;
+        }
+        releaseIrq();
+    }
+
+    void enableInterrupts() {}
+    void disableInterrupts() {}
+    bool pinMode(uint8_t pin, uint8_t mode)
+    {
+        return true;
+    }
+
+private:
+    void releaseIrq()
+    {
+        if (host_irq_pin >= 0 && !_int_stat) {
+            host_pin_write(host_irq_pin, HIGH);
+        }
+    }
+
+    std::mutex _lock;
+    std::deque<uint8_t> _fifo;
+    uint8_t _int_stat = 0;
+};
@@ -0,0 +1,201 @@
+/**
+ * @file      Arduino.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The few Arduino and FreeRTOS names the host tests need. Time only moves
+ *            when a test calls host_time_advance_us(), so state machines replay exactly,
+ *            and pins only change through host_pin_write(), which runs their interrupt.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <assert.h>
+#include <atomic>
+#include <thread>
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/timers.h"
+#include "freertos/semphr.h"
+
+#ifndef _BV
+#define _BV(b)  (1UL << (b))
+#endif
+
+#define log_e(fmt, ...)     fprintf(stderr, "[E] " fmt "\n", ##__VA_ARGS__)
+#define log_w(fmt, ...)     fprintf(stderr, "[W] " fmt "\n", ##__VA_ARGS__)
+#define log_i(fmt, ...)     do {} while (0)
+#define log_d(fmt, ...)     do {} while (0)
+#define log_v(fmt, ...)     do {} while (0)
+
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+#define ESP_IDF_VERSION_VAL(major, minor, patch)    (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION                             ESP_IDF_VERSION_VAL(5, 1, 0)
+
+#define SDA                 8
+#define SCL                 9
+
+#define lowByte(w)          ((uint8_t)((w) & 0xff))
+#define highByte(w)         ((uint8_t)((w) >> 8))
+
+// Serial output is dropped
+struct HostSerial {
+    int printf(const char *fmt, ...)
+    {
+        return 0;
+    }
+    void print(const char *s) {}
+    void println(const char *s = "") {}
+};
+
+inline HostSerial Serial;
+
+inline uint64_t &host_time_us()
+{
+    static uint64_t now = 0;
+    return now;
+}
+
+inline void host_time_advance_us(uint64_t us)
+{
+    host_time_us() += us;
+}
+
+inline unsigned long micros()
+{
+    return (unsigned long)host_time_us();
+}
+
+inline unsigned long millis()
+{
+    return (unsigned long)(host_time_us() / 1000);
+}
+
+// Moves the clock and lets other threads run, waits in a loop still end
+inline void delay(uint32_t ms)
+{
+    host_time_advance_us((uint64_t)ms * 1000);
+    std::this_thread::yield();
+}
+
+typedef struct {
+    std::atomic_flag flag;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    {ATOMIC_FLAG_INIT}
+
+inline void portENTER_CRITICAL(portMUX_TYPE *mux)
+{
+    while (mux->flag.test_and_set(std::memory_order_acquire)) {
+    }
+}
+
+inline void portEXIT_CRITICAL(portMUX_TYPE *mux)
+{
+    mux->flag.clear(std::memory_order_release);
+}
+
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+
+#define LOW                 0x0
+#define HIGH                0x1
+#define INPUT               0x01
+#define OUTPUT              0x03
+#define INPUT_PULLUP        0x05
+#define OPEN_DRAIN          0x10
+#define RISING              0x01
+#define FALLING             0x02
+#define CHANGE              0x03
+#define ARDUINO_ISR_ATTR
+
+#define HOST_PIN_COUNT      64
+
+struct host_pin_t {
+    std::atomic<int> level;
+    void (*isr)(void *);
+    void *arg;
+    int mode;
+};
+
+inline host_pin_t *host_pins()
+{
+    static host_pin_t pins[HOST_PIN_COUNT];
+    return pins;
+}
+
+inline void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+inline int digitalRead(uint8_t pin)
+{
+    return host_pins()[pin].level;
+}
+
+// Output pins keep their level for the tests, no interrupt is run
+inline void digitalWrite(uint8_t pin, uint8_t level)
+{
+    host_pins()[pin].level = level;
+}
+
+typedef int gpio_num_t;
+
+inline esp_err_t gpio_set_level(gpio_num_t pin, uint32_t level)
+{
+    host_pins()[pin].level = level;
+    return ESP_OK;
+}
+
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode)
+{
+    host_pins()[pin].isr = isr;
+    host_pins()[pin].arg = arg;
+    host_pins()[pin].mode = mode;
+}
+
+inline void host_call_isr(void *arg)
+{
+    ((void (*)(void))arg)();
+}
+
+inline void attachInterrupt(uint8_t pin, void (*isr)(void), int mode)
+{
+    attachInterruptArg(pin, host_call_isr, (void *)isr, mode);
+}
+
+inline void detachInterrupt(uint8_t pin)
+{
+    host_pins()[pin].isr = NULL;
+}
+
+// Sets the level, an edge of the attached mode runs the interrupt
+inline void host_pin_write(uint8_t pin, int level)
+{
+    host_pin_t &p = host_pins()[pin];
+    if (p.level.exchange(level) == level) {
+        return;
+    }
+    if (p.isr && (p.mode == CHANGE || p.mode == (level ? RISING : FALLING))) {
+        p.isr(p.arg);
+    }
+}
+
+inline void ledcWrite(uint8_t pin, uint32_t duty) {}
+inline bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t resolution)
+{
+    return true;
+}
+inline bool ledcDetach(uint8_t pin)
+{
+    return true;
+}
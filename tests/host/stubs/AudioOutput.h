@@ -0,0 +1,96 @@
+/**
+ * @file      AudioOutput.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The part of the ESP8266Audio AudioOutput base class that esp_audio_output.h
+ *            uses, with the same members and the same per frame ConsumeSamples().
+ */
+#pragma once
+
+#include "Arduino.h"
+
+class AudioOutput
+{
+public:
+    AudioOutput() {}
+    virtual ~AudioOutput() {}
+    virtual bool SetRate(int hz)
+    {
+        hertz = hz;
+        return true;
+    }
+    virtual bool SetBitsPerSample(int bits)
+    {
+        bps = bits;
+        return true;
+    }
+    virtual bool SetChannels(int chan)
+    {
+        channels = chan;
+        return true;
+    }
+    virtual bool SetGain(float f)
+    {
+        if (f > 4.0) {
+            f = 4.0;
+        }
+        if (f < 0.0) {
+            f = 0.0;
+        }
+        gainF2P6 = (uint8_t)(f * (1 << 6));
+        return true;
+    }
+    virtual bool begin()
+    {
+        return false;
+    }
+    typedef enum { LEFTCHANNEL = 0, RIGHTCHANNEL = 1 } SampleIndex;
+    virtual bool ConsumeSample(int16_t sample[2]) = 0;
+    virtual uint16_t ConsumeSamples(int16_t *samples, uint16_t count)
+    {
+        for (uint16_t i = 0; i < count; i++) {
+            if (!ConsumeSample(samples)) {
+                return i;
+            }
+            samples += 2;
+        }
+        return count;
+    }
+    virtual bool stop()
+    {
+        return false;
+    }
+    virtual void flush()
+    {
+    }
+
+protected:
+    void MakeSampleStereo16(int16_t sample[2])
+    {
+        // Mono is in the left sample, 8 bit samples are unsigned in the low byte
+        if (bps == 8) {
+            sample[0] = ((sample[0] & 0xff) - 128) << 8;
+            sample[1] = ((sample[1] & 0xff) - 128) << 8;
+        }
+        if (channels == 1) {
+            sample[1] = sample[0];
+        }
+    }
+    int16_t Amplify(int16_t s)
+    {
+        int32_t v = (s * gainF2P6) >> 6;
+        if (v < -32767) {
+            return -32767;
+        } else if (v > 32767) {
+            return 32767;
+        }
+        return (int16_t)v;
+    }
+
+    uint16_t hertz;
+    uint8_t bps;
+    uint8_t channels;
+    uint8_t gainF2P6;
+};
@@ -0,0 +1,95 @@
+/**
+ * @file      SPI.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      SPIClass that records what goes on the bus. Writes are kept with the
+ *            transaction they belong to and the levels of the chip select and
+ *            data/command pins, back to back writes of the same kind are joined.
+ */
+#pragma once
+
+#include "Arduino.h"
+#include <vector>
+
+#define MSBFIRST            1
+#define SPI_MODE0           0
+
+class SPISettings
+{
+public:
+    SPISettings(uint32_t clock = 1000000, uint8_t bitOrder = MSBFIRST, uint8_t dataMode = SPI_MODE0) : clock(clock) {}
+    uint32_t clock;
+};
+
+struct host_spi_write_t {
+    uint32_t transaction;       // beginTransaction count when written, 0 outside of one
+    bool command;               // DC was low
+    bool selected;              // CS was low
+    std::vector<uint8_t> bytes;
+};
+
+class SPIClass
+{
+public:
+    int host_cs = -1;
+    int host_dc = -1;
+    uint32_t host_transactions = 0;
+    uint32_t host_nested = 0;           // beginTransaction inside a transaction
+    std::vector<host_spi_write_t> host_writes;
+
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {}
+    void beginTransaction(SPISettings settings)
+    {
+        if (_in_transaction) {
+            host_nested++;
+        }
+        _in_transaction = true;
+        host_transactions++;
+    }
+    void endTransaction()
+    {
+        _in_transaction = false;
+    }
+    void write(uint8_t data)
+    {
+        record(&data, 1, false);
+    }
+    void writeBytes(const uint8_t *data, uint32_t size)
+    {
+        record(data, size, false);
+    }
+    // Sends every 16 bit pixel high byte first
+    void writePixels(const void *data, uint32_t size)
+    {
+        record((const uint8_t *)data, size, true);
+    }
+    void host_clear()
+    {
+        host_transactions = 0;
+        host_nested = 0;
+        host_writes.clear();
+    }
+
+private:
+    bool _in_transaction = false;
+
+    void record(const uint8_t *data, uint32_t size, bool swap)
+    {
+        host_spi_write_t w;
+        w.transaction = _in_transaction ? host_transactions : 0;
+        w.command = host_dc >= 0 && digitalRead(host_dc) == LOW;
+        w.selected = host_cs >= 0 && digitalRead(host_cs) == LOW;
+        if (host_writes.empty() || host_writes.back().transaction != w.transaction ||
+                host_writes.back().command != w.command || host_writes.back().selected != w.selected) {
+            host_writes.push_back(w);
+        }
+        std::vector<uint8_t> &bytes = host_writes.back().bytes;
+        for (uint32_t i = 0; i < size; i++) {
+            bytes.push_back(swap ? data[i ^ 1] : data[i]);
+        }
+    }
+};
+
+inline SPIClass SPI;
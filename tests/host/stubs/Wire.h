@@ -0,0 +1,13 @@
+/**
+ * @file      Wire.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      TwoWire is only passed around by the headers the host tests include.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+class TwoWire {};
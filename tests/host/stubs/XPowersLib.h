@@ -0,0 +1,127 @@
+/**
+ * @file      XPowersLib.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      XPowersAXP2101 as a register map for the host tests. The interrupt bits and
+ *            register addresses are the ones of XPowersLib, the status registers are
+ *            write 1 to clear as on the chip.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+#define XPOWERS_AXP2101_INTEN1      (0x40)
+#define XPOWERS_AXP2101_INTSTS1     (0x48)
+
+typedef enum {
+    XPOWERS_AXP2101_BAT_NOR_UNDER_TEMP_IRQ  = _BV(0),
+    XPOWERS_AXP2101_BAT_NOR_OVER_TEMP_IRQ   = _BV(1),
+    XPOWERS_AXP2101_BAT_CHG_UNDER_TEMP_IRQ  = _BV(2),
+    XPOWERS_AXP2101_BAT_CHG_OVER_TEMP_IRQ   = _BV(3),
+    XPOWERS_AXP2101_GAUGE_NEW_SOC_IRQ       = _BV(4),
+    XPOWERS_AXP2101_WDT_TIMEOUT_IRQ         = _BV(5),
+    XPOWERS_AXP2101_WARNING_LEVEL1_IRQ      = _BV(6),
+    XPOWERS_AXP2101_WARNING_LEVEL2_IRQ      = _BV(7),
+    XPOWERS_AXP2101_PKEY_POSITIVE_IRQ       = _BV(8),
+    XPOWERS_AXP2101_PKEY_NEGATIVE_IRQ       = _BV(9),
+    XPOWERS_AXP2101_PKEY_LONG_IRQ           = _BV(10),
+    XPOWERS_AXP2101_PKEY_SHORT_IRQ          = _BV(11),
+    XPOWERS_AXP2101_BAT_REMOVE_IRQ          = _BV(12),
+    XPOWERS_AXP2101_BAT_INSERT_IRQ          = _BV(13),
+    XPOWERS_AXP2101_VBUS_REMOVE_IRQ         = _BV(14),
+    XPOWERS_AXP2101_VBUS_INSERT_IRQ         = _BV(15),
+    XPOWERS_AXP2101_BAT_OVER_VOL_IRQ        = _BV(16),
+    XPOWERS_AXP2101_CHAGER_TIMER_IRQ        = _BV(17),
+    XPOWERS_AXP2101_DIE_OVER_TEMP_IRQ       = _BV(18),
+    XPOWERS_AXP2101_BAT_CHG_START_IRQ       = _BV(19),
+    XPOWERS_AXP2101_BAT_CHG_DONE_IRQ        = _BV(20),
+    XPOWERS_AXP2101_BATFET_OVER_CURR_IRQ    = _BV(21),
+    XPOWERS_AXP2101_LDO_OVER_CURR_IRQ       = _BV(22),
+    XPOWERS_AXP2101_WDT_EXPIRE_IRQ          = _BV(23),
+} xpowers_axp2101_irq_t;
+
+typedef enum {
+    XPOWERS_AXP2101_CHG_CUR_0MA,
+    XPOWERS_AXP2101_CHG_CUR_1000MA = 16,
+} xpowers_axp2101_chg_curr_t;
+
+class XPowersAXP2101
+{
+public:
+    uint8_t regs[256] = {};
+    bool battery = true;
+    uint8_t charge_current = 0;
+    uint32_t raise_after_read = 0;  // Status bits the chip latches right after the next read
+    uint32_t reads = 0;
+    uint32_t writes = 0;
+
+    // Enable and status words, low byte first as in the three registers
+    void setIrq(uint32_t enable, uint32_t status)
+    {
+        for (int i = 0; i < 3; i++) {
+            regs[XPOWERS_AXP2101_INTEN1 + i] = (uint8_t)(enable >> (8 * i));
+            regs[XPOWERS_AXP2101_INTSTS1 + i] = (uint8_t)(status >> (8 * i));
+        }
+    }
+
+    uint32_t irqStatus()
+    {
+        return regs[XPOWERS_AXP2101_INTSTS1] | (regs[XPOWERS_AXP2101_INTSTS1 + 1] << 8) |
+               ((uint32_t)regs[XPOWERS_AXP2101_INTSTS1 + 2] << 16);
+    }
+
+    int readRegister(uint8_t reg, uint8_t *buf, uint8_t len)
+    {
+        reads++;
+        memcpy(buf, regs + reg, len);
+        if (raise_after_read) {
+            setIrq(0, irqStatus() | raise_after_read);
+            // setIrq() rewrote the enables, read them back from the copy
+            memcpy(regs + XPOWERS_AXP2101_INTEN1, buf + (XPOWERS_AXP2101_INTEN1 - reg), 3);
+            raise_after_read = 0;
+        }
+        return 0;
+    }
+
+    int writeRegister(uint8_t reg, uint8_t *buf, uint8_t len)
+    {
+        writes++;
+        for (uint8_t i = 0; i < len; i++) {
+            uint8_t r = reg + i;
+            if (r >= XPOWERS_AXP2101_INTSTS1 && r < XPOWERS_AXP2101_INTSTS1 + 3) {
+                regs[r] &= ~buf[i];
+            } else {
+                regs[r] = buf[i];
+            }
+        }
+        return 0;
+    }
+
+    bool isBatteryConnect()
+    {
+        return battery;
+    }
+
+    void setChargerConstantCurr(uint8_t val)
+    {
+        charge_current = val;
+    }
+
+    uint8_t getChargerConstantCurr()
+    {
+        return charge_current;
+    }
+
+    void enableBattDetection() {}
+    void disableBattDetection() {}
+    void enableVbusVoltageMeasure() {}
+    void disableVbusVoltageMeasure() {}
+    void enableBattVoltageMeasure() {}
+    void disableBattVoltageMeasure() {}
+    void enableSystemVoltageMeasure() {}
+    void disableSystemVoltageMeasure() {}
+    void enableTemperatureMeasure() {}
+    void disableTemperatureMeasure() {}
+};
@@ -0,0 +1,305 @@
+/**
+ * @file      spi_master.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      A mock of the ESP-IDF SPI master queue. Queued transactions are sent in
+ *            order by a bus thread that takes transfer_us of real time for each one
+ *            and calls post_cb from there like the interrupt would. Every transfer
+ *            is recorded with the chip select level, and the rules of the driver
+ *            that the display code relies on are counted as errors: polling while
+ *            queued transactions are pending, queueing more than queue_size results,
+ *            releasing the bus with transactions pending and a tx buffer that changes
+ *            while it is being sent.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Arduino.h"
+
+typedef enum {
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2,
+} spi_host_device_t;
+
+#define SPI_DMA_CH_AUTO                 3
+
+#define SPICOMMON_BUSFLAG_MASTER        (1 << 0)
+#define SPICOMMON_BUSFLAG_GPIO_PINS     (1 << 2)
+
+#define SPI_DEVICE_HALFDUPLEX           (1 << 4)
+
+#define SPI_TRANS_MODE_DIO              (1 << 0)
+#define SPI_TRANS_MODE_QIO              (1 << 1)
+#define SPI_TRANS_USE_RXDATA            (1 << 2)
+#define SPI_TRANS_USE_TXDATA            (1 << 3)
+#define SPI_TRANS_MODE_DIOQIO_ADDR      (1 << 4)
+#define SPI_TRANS_VARIABLE_CMD          (1 << 5)
+#define SPI_TRANS_VARIABLE_ADDR         (1 << 6)
+#define SPI_TRANS_VARIABLE_DUMMY        (1 << 7)
+#define SPI_TRANS_CS_KEEP_ACTIVE        (1 << 8)
+#define SPI_TRANS_MULTILINE_CMD         (1 << 9)
+#define SPI_TRANS_MULTILINE_ADDR        SPI_TRANS_MODE_DIOQIO_ADDR
+
+struct spi_transaction_t;
+typedef void (*transaction_cb_t)(spi_transaction_t *trans);
+
+typedef struct {
+    union {
+        int mosi_io_num;
+        int data0_io_num;
+    };
+    union {
+        int miso_io_num;
+        int data1_io_num;
+    };
+    int sclk_io_num;
+    union {
+        int quadwp_io_num;
+        int data2_io_num;
+    };
+    union {
+        int quadhd_io_num;
+        int data3_io_num;
+    };
+    int data4_io_num;
+    int data5_io_num;
+    int data6_io_num;
+    int data7_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+    int intr_flags;
+} spi_bus_config_t;
+
+typedef struct {
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+    uint8_t mode;
+    uint16_t duty_cycle_pos;
+    uint16_t cs_ena_pretrans;
+    uint8_t cs_ena_posttrans;
+    int clock_speed_hz;
+    int input_delay_ns;
+    int spics_io_num;
+    uint32_t flags;
+    int queue_size;
+    transaction_cb_t pre_cb;
+    transaction_cb_t post_cb;
+} spi_device_interface_config_t;
+
+struct spi_transaction_t {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    size_t length;              // Bits
+    size_t rxlength;
+    void *user;
+    union {
+        const void *tx_buffer;
+        uint8_t tx_data[4];
+    };
+    union {
+        void *rx_buffer;
+        uint8_t rx_data[4];
+    };
+};
+typedef struct spi_transaction_t spi_transaction_t;
+
+typedef struct {
+    struct spi_transaction_t base;
+    uint8_t command_bits;
+    uint8_t address_bits;
+    uint8_t dummy_bits;
+} spi_transaction_ext_t;
+
+struct host_spi_transfer_t {
+    uint32_t flags;
+    uint16_t cmd;
+    uint64_t addr;
+    bool queued;                // Sent by the bus thread, not polled
+    int cs;                     // Level of host_spi_cs_pin() while it was sent
+    std::vector<uint8_t> data;
+};
+
+struct spi_device_t {
+    spi_device_interface_config_t config;
+    std::mutex lock;
+    std::condition_variable cv;
+    std::deque<spi_transaction_t *> queue;      // Waiting for the bus
+    std::deque<spi_transaction_t *> done;       // Sent, result not fetched yet
+    bool stop = false;
+    bool acquired = false;
+    std::thread bus;
+    uint32_t transfer_us = 0;
+    // What the tests look at
+    std::vector<host_spi_transfer_t> transfers;
+    uint32_t max_pending = 0;
+    uint32_t errors = 0;
+};
+
+typedef spi_device_t *spi_device_handle_t;
+
+// The chip select the driver toggles itself, recorded with every transfer
+inline int &host_spi_cs_pin()
+{
+    static int pin = -1;
+    return pin;
+}
+
+inline spi_device_handle_t &host_spi_last_device()
+{
+    static spi_device_handle_t dev = NULL;
+    return dev;
+}
+
+inline host_spi_transfer_t host_spi_record(const spi_transaction_t *t, bool queued)
+{
+    host_spi_transfer_t r;
+    r.flags = t->flags;
+    r.cmd = t->cmd;
+    r.addr = t->addr;
+    r.queued = queued;
+    r.cs = host_spi_cs_pin() >= 0 ? digitalRead(host_spi_cs_pin()) : HIGH;
+    if (t->tx_buffer && t->length) {
+        const uint8_t *p = (const uint8_t *)t->tx_buffer;
+        r.data.assign(p, p + t->length / 8);
+    }
+    return r;
+}
+
+inline void host_spi_bus_thread(spi_device_t *dev)
+{
+    std::unique_lock<std::mutex> guard(dev->lock);
+    for (;;) {
+        dev->cv.wait(guard, [dev] { return dev->stop || !dev->queue.empty(); });
+        if (dev->queue.empty()) {
+            break;
+        }
+        spi_transaction_t *t = dev->queue.front();
+        guard.unlock();
+        host_spi_transfer_t r = host_spi_record(t, true);
+        if (dev->transfer_us) {
+            std::this_thread::sleep_for(std::chrono::microseconds(dev->transfer_us));
+        }
+        bool changed = host_spi_record(t, true).data != r.data;
+        guard.lock();
+        dev->errors += changed;
+        dev->transfers.push_back(std::move(r));
+        guard.unlock();
+        if (dev->config.post_cb) {
+            dev->config.post_cb(t);
+        }
+        guard.lock();
+        dev->queue.pop_front();
+        dev->done.push_back(t);
+        dev->cv.notify_all();
+    }
+}
+
+inline esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *config, int dma_chan)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t spi_bus_free(spi_host_device_t host)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *config,
+                                    spi_device_handle_t *handle)
+{
+    spi_device_t *dev = new spi_device_t;
+    dev->config = *config;
+    dev->bus = std::thread(host_spi_bus_thread, dev);
+    host_spi_last_device() = dev;
+    *handle = dev;
+    return ESP_OK;
+}
+
+inline esp_err_t spi_bus_remove_device(spi_device_handle_t dev)
+{
+    {
+        std::lock_guard<std::mutex> guard(dev->lock);
+        dev->stop = true;
+        dev->cv.notify_all();
+    }
+    dev->bus.join();
+    if (host_spi_last_device() == dev) {
+        host_spi_last_device() = NULL;
+    }
+    delete dev;
+    return ESP_OK;
+}
+
+inline esp_err_t spi_device_queue_trans(spi_device_handle_t dev, spi_transaction_t *t, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> guard(dev->lock);
+    auto pending = [dev] { return dev->queue.size() + dev->done.size(); };
+    if (pending() >= (size_t)dev->config.queue_size) {
+        // The driver would block here, forever if the caller is the one to fetch the
+        // results. Counted and queued anyway so the test finishes
+        dev->errors++;
+    }
+    dev->queue.push_back(t);
+    if (pending() > dev->max_pending) {
+        dev->max_pending = pending();
+    }
+    dev->cv.notify_all();
+    return ESP_OK;
+}
+
+inline esp_err_t spi_device_get_trans_result(spi_device_handle_t dev, spi_transaction_t **t, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> guard(dev->lock);
+    if (dev->queue.empty() && dev->done.empty()) {
+        // Nothing queued, the driver would wait forever
+        dev->errors++;
+        return ESP_ERR_TIMEOUT;
+    }
+    dev->cv.wait(guard, [dev] { return !dev->done.empty(); });
+    *t = dev->done.front();
+    dev->done.pop_front();
+    dev->cv.notify_all();
+    return ESP_OK;
+}
+
+inline esp_err_t spi_device_polling_transmit(spi_device_handle_t dev, spi_transaction_t *t)
+{
+    {
+        std::lock_guard<std::mutex> guard(dev->lock);
+        if (!dev->queue.empty() || !dev->done.empty()) {
+            dev->errors++;
+        }
+        dev->transfers.push_back(host_spi_record(t, false));
+    }
+    if (dev->config.post_cb) {
+        dev->config.post_cb(t);
+    }
+    return ESP_OK;
+}
+
+inline esp_err_t spi_device_acquire_bus(spi_device_handle_t dev, TickType_t wait)
+{
+    std::lock_guard<std::mutex> guard(dev->lock);
+    dev->errors += dev->acquired;
+    dev->acquired = true;
+    return ESP_OK;
+}
+
+inline void spi_device_release_bus(spi_device_handle_t dev)
+{
+    std::lock_guard<std::mutex> guard(dev->lock);
+    dev->errors += !dev->acquired || !dev->queue.empty() || !dev->done.empty();
+    dev->acquired = false;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file      esp_heap_caps.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      heap_caps_malloc on malloc, the largest block asked for is kept so a test
+ *            can check that a driver never allocates a frame sized buffer.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define MALLOC_CAP_DMA          (1 << 3)
+#define MALLOC_CAP_INTERNAL     (1 << 11)
+#define MALLOC_CAP_SPIRAM       (1 << 10)
+
+inline size_t &host_heap_caps_largest()
+{
+    static size_t largest = 0;
+    return largest;
+}
+
+inline void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    if (size > host_heap_caps_largest()) {
+        host_heap_caps_largest() = size;
+    }
+    return malloc(size);
+}
+
+inline void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
@@ -0,0 +1,53 @@
+/**
+ * @file      esp_lcd_panel_io.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The esp_lcd panel IO names the display drivers compile against, the
+ *            calls do nothing. The esp_lcd SPI driver itself is not tested on the host.
+ */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct host_lcd_panel_io *esp_lcd_panel_io_handle_t;
+typedef struct host_lcd_panel *esp_lcd_panel_handle_t;
+typedef intptr_t esp_lcd_spi_bus_handle_t;
+typedef bool (*esp_lcd_panel_io_color_trans_done_cb_t)(esp_lcd_panel_io_handle_t io, void *edata, void *user_ctx);
+
+typedef struct {
+    int cs_gpio_num;
+    int dc_gpio_num;
+    int spi_mode;
+    unsigned int pclk_hz;
+    size_t trans_queue_depth;
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+    void *user_ctx;
+    int lcd_cmd_bits;
+    int lcd_param_bits;
+} esp_lcd_panel_io_spi_config_t;
+
+inline esp_err_t esp_lcd_new_panel_io_spi(esp_lcd_spi_bus_handle_t bus, const esp_lcd_panel_io_spi_config_t *config,
+        esp_lcd_panel_io_handle_t *ret_io)
+{
+    *ret_io = NULL;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io)
+{
+    return ESP_OK;
+}
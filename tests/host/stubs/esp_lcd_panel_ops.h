@@ -0,0 +1,57 @@
+/**
+ * @file      esp_lcd_panel_ops.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The esp_lcd panel calls the display drivers compile against, they do nothing.
+ */
+#pragma once
+
+#include "esp_lcd_panel_io.h"
+
+inline esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t panel)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+        const void *color_data)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x, bool mirror_y)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_set_gap(esp_lcd_panel_handle_t panel, int x_gap, int y_gap)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_invert_color(esp_lcd_panel_handle_t panel, bool invert_color_data)
+{
+    return ESP_OK;
+}
+
+inline esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off)
+{
+    return ESP_OK;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file      esp_lcd_panel_vendor.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The esp_lcd panel configuration the display drivers compile against.
+ */
+#pragma once
+
+#include "esp_lcd_panel_io.h"
+
+typedef enum {
+    LCD_RGB_ELEMENT_ORDER_RGB,
+    LCD_RGB_ELEMENT_ORDER_BGR,
+} lcd_rgb_element_order_t;
+
+typedef enum {
+    LCD_RGB_DATA_ENDIAN_BIG,
+    LCD_RGB_DATA_ENDIAN_LITTLE,
+} lcd_rgb_data_endian_t;
+
+typedef struct {
+    int reset_gpio_num;
+    lcd_rgb_element_order_t color_space;
+    lcd_rgb_data_endian_t data_endian;
+    uint32_t bits_per_pixel;
+} esp_lcd_panel_dev_config_t;
+
+inline esp_err_t esp_lcd_new_panel_st7789(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *config,
+        esp_lcd_panel_handle_t *ret_panel)
+{
+    *ret_panel = NULL;
+    return ESP_OK;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file      esp_log.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The ESP-IDF log macros for the codec sources on the host, errors only.
+ *            Includes stdlib.h as the ESP-IDF headers do, esp_codec_dev.c relies on it.
+ */
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define ESP_LOGE(tag, format, ...)  fprintf(stderr, "%s: " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)
+#define ESP_LOGI(tag, format, ...)
+#define ESP_LOGD(tag, format, ...)
+#define ESP_LOGV(tag, format, ...)
@@ -0,0 +1,16 @@
+/**
+ * @file      esp_timer.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      esp_timer_get_time() on the manual clock of the host Arduino.h.
+ */
+#pragma once
+
+#include "Arduino.h"
+
+inline int64_t esp_timer_get_time()
+{
+    return (int64_t)host_time_us();
+}
@@ -0,0 +1,40 @@
+/**
+ * @file      event_groups.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      An event group is a plain bit mask on the host.
+ */
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef uint32_t EventBits_t;
+
+typedef struct host_event_group {
+    EventBits_t bits;
+} *EventGroupHandle_t;
+
+inline EventGroupHandle_t xEventGroupCreate()
+{
+    return new host_event_group {0};
+}
+
+inline void vEventGroupDelete(EventGroupHandle_t group)
+{
+    delete group;
+}
+
+inline EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    group->bits |= bits;
+    return group->bits;
+}
+
+inline EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    EventBits_t old = group->bits;
+    group->bits &= ~bits;
+    return old;
+}
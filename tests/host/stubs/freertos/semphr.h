@@ -0,0 +1,77 @@
+/**
+ * @file      semphr.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      Semaphores as a counter under a condition variable. A mutex is a binary
+ *            semaphore that starts given, there is no owner or priority inheritance.
+ *            A tick is one millisecond of real time like in task.h.
+ */
+#pragma once
+
+#include "FreeRTOS.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+struct host_semaphore {
+    std::mutex lock;
+    std::condition_variable cv;
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+typedef host_semaphore *SemaphoreHandle_t;
+typedef SemaphoreHandle_t xSemaphoreHandle;
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+    SemaphoreHandle_t sem = new host_semaphore;
+    sem->count = initial;
+    sem->max = max;
+    return sem;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary()
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    delete sem;
+}
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> guard(sem->lock);
+    if (ticks == portMAX_DELAY) {
+        sem->cv.wait(guard, [sem] { return sem->count != 0; });
+    } else if (!sem->cv.wait_for(guard, std::chrono::milliseconds(ticks), [sem] { return sem->count != 0; })) {
+        return pdFALSE;
+    }
+    sem->count--;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    std::lock_guard<std::mutex> guard(sem->lock);
+    if (sem->count == sem->max) {
+        return pdFALSE;
+    }
+    sem->count++;
+    sem->cv.notify_one();
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken)
+{
+    return xSemaphoreGive(sem);
+}
@@ -0,0 +1,91 @@
+/**
+ * @file      task.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      Tasks are detached std::threads and notifications a counting condition
+ *            variable, enough to run a producer task against a consumer on a host.
+ *            A tick is one millisecond of real time, the Arduino clock is not moved.
+ */
+#pragma once
+
+#include "FreeRTOS.h"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+typedef void (*TaskFunction_t)(void *arg);
+
+struct host_task {
+    std::mutex lock;
+    std::condition_variable cv;
+    uint32_t notify = 0;
+};
+
+typedef host_task *TaskHandle_t;
+
+inline TaskHandle_t &host_current_task()
+{
+    static thread_local TaskHandle_t task = NULL;
+    return task;
+}
+
+// The handle is not freed, a deleted task may still be notified by a late interrupt
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack, void *arg,
+                              UBaseType_t priority, TaskHandle_t *handle)
+{
+    TaskHandle_t task = new host_task;
+    if (handle) {
+        *handle = task;
+    }
+    std::thread([fn, arg, task]() {
+        host_current_task() = task;
+        fn(arg);
+    }).detach();
+    return pdPASS;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return host_current_task();
+}
+
+// The task function returns right after, which ends the thread
+inline void vTaskDelete(TaskHandle_t task)
+{
+}
+
+inline void vTaskDelay(TickType_t ticks)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+inline void xTaskNotifyGive(TaskHandle_t task)
+{
+    std::lock_guard<std::mutex> guard(task->lock);
+    task->notify++;
+    task->cv.notify_one();
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyGive(task);
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    TaskHandle_t task = host_current_task();
+    std::unique_lock<std::mutex> guard(task->lock);
+    if (ticks == portMAX_DELAY) {
+        task->cv.wait(guard, [task] { return task->notify != 0; });
+    } else {
+        task->cv.wait_for(guard, std::chrono::milliseconds(ticks), [task] { return task->notify != 0; });
+    }
+    uint32_t value = task->notify;
+    if (value) {
+        task->notify = clear ? 0 : value - 1;
+    }
+    return value;
+}
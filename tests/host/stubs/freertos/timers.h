@@ -0,0 +1,91 @@
+/**
+ * @file      timers.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      Software timers that only run when a test calls host_timer_run().
+ */
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef struct host_timer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+struct host_timer {
+    const char *name;
+    TickType_t period;
+    UBaseType_t auto_reload;
+    void *id;
+    TimerCallbackFunction_t cb;
+    bool active;
+    uint32_t starts;
+};
+
+// The timer created last, for tests of classes that keep their timer private
+inline TimerHandle_t &host_last_timer()
+{
+    static TimerHandle_t timer = NULL;
+    return timer;
+}
+
+inline TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t auto_reload, void *id,
+                                  TimerCallbackFunction_t cb)
+{
+    host_last_timer() = new host_timer {name, period, auto_reload, id, cb, false, 0};
+    return host_last_timer();
+}
+
+inline BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t wait)
+{
+    delete timer;
+    return pdPASS;
+}
+
+inline BaseType_t xTimerStart(TimerHandle_t timer, TickType_t wait)
+{
+    timer->active = true;
+    timer->starts++;
+    return pdPASS;
+}
+
+inline BaseType_t xTimerStartFromISR(TimerHandle_t timer, BaseType_t *woken)
+{
+    return xTimerStart(timer, 0);
+}
+
+inline BaseType_t xTimerStop(TimerHandle_t timer, TickType_t wait)
+{
+    timer->active = false;
+    return pdPASS;
+}
+
+inline BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t wait)
+{
+    timer->period = period;
+    return xTimerStart(timer, wait);
+}
+
+inline BaseType_t xTimerIsTimerActive(TimerHandle_t timer)
+{
+    return timer->active;
+}
+
+inline void *pvTimerGetTimerID(TimerHandle_t timer)
+{
+    return timer->id;
+}
+
+// Runs the callback once if the timer is active, a one shot timer stops
+inline bool host_timer_run(TimerHandle_t timer)
+{
+    if (!timer || !timer->active) {
+        return false;
+    }
+    if (!timer->auto_reload) {
+        timer->active = false;
+    }
+    timer->cb(timer);
+    return true;
+}
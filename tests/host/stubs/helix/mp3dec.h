@@ -0,0 +1,57 @@
+/**
+ * @file      mp3dec.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      Stand-in for the libhelix-mp3 header so the streaming player builds on the
+ *            host without the decoder. Every MP3 call fails, only WAV can be played.
+ */
+#pragma once
+
+#define MAINBUF_SIZE    1940
+#define MAX_NCHAN       2
+#define MAX_NGRAN       2
+#define MAX_NSAMP       576
+
+enum {
+    ERR_MP3_NONE = 0,
+    ERR_MP3_INDATA_UNDERFLOW = -1,
+    ERR_MP3_MAINDATA_UNDERFLOW = -2,
+    ERR_MP3_INVALID_FRAMEHEADER = -6,
+};
+
+typedef void *HMP3Decoder;
+
+typedef struct {
+    int bitrate;
+    int nChans;
+    int samprate;
+    int bitsPerSample;
+    int outputSamps;
+    int layer;
+    int version;
+} MP3FrameInfo;
+
+static inline HMP3Decoder MP3InitDecoder()
+{
+    return NULL;
+}
+
+static inline void MP3FreeDecoder(HMP3Decoder decoder)
+{
+}
+
+static inline int MP3FindSyncWord(unsigned char *buf, int len)
+{
+    return -1;
+}
+
+static inline int MP3Decode(HMP3Decoder decoder, unsigned char **inbuf, int *bytesLeft, short *outbuf, int useSize)
+{
+    return ERR_MP3_INVALID_FRAMEHEADER;
+}
+
+static inline void MP3GetLastFrameInfo(HMP3Decoder decoder, MP3FrameInfo *info)
+{
+}
@@ -0,0 +1,74 @@
+/**
+ * @file      lvgl.h
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The lvgl 9 area helpers for the host tests, same semantics as lv_area.c.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LVGL_VERSION_MAJOR  9
+
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} lv_area_t;
+
+static inline void lv_area_set(lv_area_t *area, int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    area->x1 = x1;
+    area->y1 = y1;
+    area->x2 = x2;
+    area->y2 = y2;
+}
+
+static inline int32_t lv_area_get_width(const lv_area_t *area)
+{
+    return area->x2 - area->x1 + 1;
+}
+
+static inline int32_t lv_area_get_height(const lv_area_t *area)
+{
+    return area->y2 - area->y1 + 1;
+}
+
+static inline uint32_t lv_area_get_size(const lv_area_t *area)
+{
+    return (uint32_t)lv_area_get_width(area) * (uint32_t)lv_area_get_height(area);
+}
+
+static inline void lv_area_join(lv_area_t *res, const lv_area_t *a1, const lv_area_t *a2)
+{
+    res->x1 = a1->x1 < a2->x1 ? a1->x1 : a2->x1;
+    res->y1 = a1->y1 < a2->y1 ? a1->y1 : a2->y1;
+    res->x2 = a1->x2 > a2->x2 ? a1->x2 : a2->x2;
+    res->y2 = a1->y2 > a2->y2 ? a1->y2 : a2->y2;
+}
+
+static inline bool lv_area_intersect(lv_area_t *res, const lv_area_t *a1, const lv_area_t *a2)
+{
+    res->x1 = a1->x1 > a2->x1 ? a1->x1 : a2->x1;
+    res->y1 = a1->y1 > a2->y1 ? a1->y1 : a2->y1;
+    res->x2 = a1->x2 < a2->x2 ? a1->x2 : a2->x2;
+    res->y2 = a1->y2 < a2->y2 ? a1->y2 : a2->y2;
+    return res->x1 <= res->x2 && res->y1 <= res->y2;
+}
+
+static inline bool lv_area_is_on(const lv_area_t *a1, const lv_area_t *a2)
+{
+    return a1->x1 <= a2->x2 && a1->x2 >= a2->x1 && a1->y1 <= a2->y2 && a1->y2 >= a2->y1;
+}
+
+// Only radius 0 is used by the library
+static inline bool lv_area_is_in(const lv_area_t *ain, const lv_area_t *aholder, int32_t radius)
+{
+    (void)radius;
+    return ain->x1 >= aholder->x1 && ain->y1 >= aholder->y1 &&
+           ain->x2 <= aholder->x2 && ain->y2 <= aholder->y2;
+}
@@ -0,0 +1,342 @@
+/**
+ * @file      test_audio_engine.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      EspAudioEngine over a codec device with a fake audio_codec_data_if_t that
+ *            loops the playback back into the capture. With --bench the cost of process().
+ */
+#include "host_test.h"
+#include <deque>
+#include <thread>
+#include <vector>
+#include "bsp_codec/esp_audio_engine.h"
+#include "bsp_codec/interface/audio_codec_data_if.h"
+#include "bsp_codec/interface/audio_codec_vol_if.h"
+
+#define TEST_RATE       16000
+#define TEST_PERIOD     64
+
+// What was written comes back on the next reads, like a cable from the speaker to the mic
+static std::deque<int16_t> wire;
+static bool fail_read;
+
+static int loop_open(const audio_codec_data_if_t *h, void *data_cfg, int cfg_size)
+{
+    return ESP_CODEC_DEV_OK;
+}
+
+static bool loop_is_open(const audio_codec_data_if_t *h)
+{
+    return true;
+}
+
+static int loop_enable(const audio_codec_data_if_t *h, esp_codec_dev_type_t dev_type, bool enable)
+{
+    return ESP_CODEC_DEV_OK;
+}
+
+static int loop_set_fmt(const audio_codec_data_if_t *h, esp_codec_dev_type_t dev_type, esp_codec_dev_sample_info_t *fs)
+{
+    return ESP_CODEC_DEV_OK;
+}
+
+static int loop_read(const audio_codec_data_if_t *h, uint8_t *data, int size)
+{
+    if (fail_read) {
+        return ESP_CODEC_DEV_READ_FAIL;
+    }
+    int16_t *s = (int16_t *)data;
+    for (int i = 0; i < size / 2; i++) {
+        if (wire.empty()) {
+            s[i] = 0;
+        } else {
+            s[i] = wire.front();
+            wire.pop_front();
+        }
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
+static int loop_write(const audio_codec_data_if_t *h, uint8_t *data, int size)
+{
+    int16_t *s = (int16_t *)data;
+    wire.insert(wire.end(), s, s + size / 2);
+    return ESP_CODEC_DEV_OK;
+}
+
+static int loop_close(const audio_codec_data_if_t *h)
+{
+    return ESP_CODEC_DEV_OK;
+}
+
+static const audio_codec_data_if_t loop_if = {
+    loop_open, loop_is_open, loop_enable, loop_set_fmt, loop_read, loop_write, loop_close
+};
+
+// Unity gain, replaces the software volume and its fade in so the loop is bit exact
+static int unity_open(const audio_codec_vol_if_t *h, esp_codec_dev_sample_info_t *fs, int fade_time)
+{
+    return ESP_CODEC_DEV_OK;
+}
+
+static int unity_set_vol(const audio_codec_vol_if_t *h, float db_value)
+{
+    return ESP_CODEC_DEV_OK;
+}
+
+static int unity_process(const audio_codec_vol_if_t *h, uint8_t *in, int len, uint8_t *out, int out_len)
+{
+    if (in != out) {
+        memmove(out, in, len);
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
+static int unity_close(const audio_codec_vol_if_t *h)
+{
+    return ESP_CODEC_DEV_OK;
+}
+
+static const audio_codec_vol_if_t unity_vol = {unity_open, unity_set_vol, unity_process, unity_close};
+
+static esp_codec_dev_handle_t open_engine(EspAudioEngine &engine, uint8_t channels)
+{
+    wire.clear();
+    fail_read = false;
+    esp_codec_dev_cfg_t cfg = {};
+    cfg.dev_type = ESP_CODEC_DEV_TYPE_IN_OUT;
+    cfg.data_if = &loop_if;
+    esp_codec_dev_handle_t dev = esp_codec_dev_new(&cfg);
+    EspAudioEngineConfig_t config = {TEST_RATE, channels, TEST_PERIOD, 5};
+    CHECK(engine.begin(dev, config));
+    CHECK_EQ(esp_codec_dev_set_vol_handler(dev, &unity_vol), ESP_CODEC_DEV_OK);
+    return dev;
+}
+
+static void close_engine(EspAudioEngine &engine, esp_codec_dev_handle_t dev)
+{
+    engine.end();
+    esp_codec_dev_delete(dev);
+}
+
+static std::vector<int16_t> captured;
+
+static void capture_cb(const int16_t *frames, size_t count, void *user_data)
+{
+    uint8_t channels = *(uint8_t *)user_data;
+    captured.insert(captured.end(), frames, frames + count * channels);
+}
+
+// A ramp, 'count' frames of the next values on every channel
+struct ramp_source {
+    uint8_t channels;
+    int16_t next;
+    size_t limit;           // Frames per call, a short period below the request
+};
+
+static size_t ramp_cb(int16_t *frames, size_t count, void *user_data)
+{
+    ramp_source *r = (ramp_source *)user_data;
+    if (r->limit && count > r->limit) {
+        count = r->limit;
+    }
+    for (size_t i = 0; i < count; i++) {
+        for (uint8_t c = 0; c < r->channels; c++) {
+            *frames++ = r->next;
+        }
+        r->next++;
+    }
+    return count;
+}
+
+static void test_loopback(uint8_t channels)
+{
+    EspAudioEngine engine;
+    esp_codec_dev_handle_t dev = open_engine(engine, channels);
+    captured.clear();
+    ramp_source ramp = {channels, 1, 0};
+    CHECK(engine.subscribe(capture_cb, &channels));
+    engine.setPlaybackSource(ramp_cb, &ramp);
+    const int periods = 40;
+    for (int i = 0; i < periods; i++) {
+        CHECK(engine.process());
+    }
+    // The primed periods come back as silence, then the ramp in order
+    const size_t prime = CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS * TEST_PERIOD;
+    CHECK_EQ(captured.size(), periods * TEST_PERIOD * channels);
+    int bad = 0;
+    for (size_t i = 0; i < captured.size(); i++) {
+        size_t frame = i / channels;
+        int16_t expect = frame < prime ? 0 : (int16_t)(frame - prime + 1);
+        bad += captured[i] != expect;
+    }
+    CHECK_EQ(bad, 0);
+
+    EspAudioEngineStats_t stats;
+    engine.getStats(&stats);
+    CHECK_EQ(stats.periods, periods);
+    CHECK_EQ(stats.period_frames, TEST_PERIOD);
+    CHECK_EQ(stats.period_us, TEST_PERIOD * 1000000 / TEST_RATE);
+    CHECK_EQ(stats.capture_latency_us, stats.period_us);
+    CHECK_EQ(stats.playback_latency_us, stats.period_us * (1 + CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS));
+    CHECK_EQ(stats.short_periods, 0);
+    CHECK_EQ(stats.io_errors, 0);
+    close_engine(engine, dev);
+}
+
+static void test_short_and_idle()
+{
+    uint8_t channels = 1;
+    EspAudioEngine engine;
+    esp_codec_dev_handle_t dev = open_engine(engine, channels);
+    captured.clear();
+    ramp_source ramp = {channels, 1, TEST_PERIOD / 4};
+    engine.subscribe(capture_cb, &channels);
+    engine.setPlaybackSource(ramp_cb, &ramp);
+    engine.process();
+    engine.process();
+    // The rest of a short period is silence
+    size_t base = TEST_PERIOD;
+    CHECK_EQ(captured[base], 1);
+    CHECK_EQ(captured[base + TEST_PERIOD / 4 - 1], TEST_PERIOD / 4);
+    CHECK_EQ(captured[base + TEST_PERIOD / 4], 0);
+    // No source plays silence and an idle source is not short
+    engine.setPlaybackSource(NULL, NULL);
+    engine.process();
+    EspAudioEngineStats_t stats;
+    engine.getStats(&stats);
+    CHECK_EQ(stats.short_periods, 2);
+    close_engine(engine, dev);
+}
+
+static void test_read_error()
+{
+    uint8_t channels = 1;
+    EspAudioEngine engine;
+    esp_codec_dev_handle_t dev = open_engine(engine, channels);
+    captured.clear();
+    engine.subscribe(capture_cb, &channels);
+    wire.assign(TEST_PERIOD * 2, 1000);
+    fail_read = true;
+    CHECK(!engine.process());
+    // The subscribers get silence for the failed period
+    CHECK_EQ(captured.size(), TEST_PERIOD);
+    CHECK_EQ(captured[0], 0);
+    fail_read = false;
+    CHECK(engine.process());
+    EspAudioEngineStats_t stats;
+    engine.getStats(&stats);
+    CHECK_EQ(stats.io_errors, 1);
+    CHECK_EQ(stats.periods, 2);
+    close_engine(engine, dev);
+}
+
+static EspAudioEngine *self_engine;
+static uint32_t self_calls;
+
+static void unsubscribe_self_cb(const int16_t *frames, size_t count, void *user_data)
+{
+    self_calls++;
+    self_engine->unsubscribe(unsubscribe_self_cb, user_data);
+}
+
+static void test_subscribers()
+{
+    uint8_t channels = 1;
+    EspAudioEngine engine;
+    esp_codec_dev_handle_t dev = open_engine(engine, channels);
+    self_engine = &engine;
+    self_calls = 0;
+    captured.clear();
+    CHECK(engine.subscribe(unsubscribe_self_cb, NULL));
+    CHECK(engine.subscribe(capture_cb, &channels));
+    for (int i = 2; i < CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS; i++) {
+        CHECK(engine.subscribe(capture_cb, NULL));
+    }
+    CHECK(!engine.subscribe(capture_cb, NULL));
+    for (int i = 2; i < CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS; i++) {
+        engine.unsubscribe(capture_cb, NULL);
+    }
+    engine.process();
+    engine.process();
+    CHECK_EQ(self_calls, 1);
+    CHECK_EQ(captured.size(), 2 * TEST_PERIOD);
+    close_engine(engine, dev);
+}
+
+static void slow_cb(const int16_t *frames, size_t count, void *user_data)
+{
+    uint32_t *sleep_us = (uint32_t *)user_data;
+    if (*sleep_us) {
+        std::this_thread::sleep_for(std::chrono::microseconds(*sleep_us));
+        *sleep_us = 0;
+    }
+}
+
+// The fake device does not block, so every period but the slow one returns at once
+static void test_late_period()
+{
+    uint8_t channels = 1;
+    EspAudioEngine engine;
+    esp_codec_dev_handle_t dev = open_engine(engine, channels);
+    uint32_t period_us = TEST_PERIOD * 1000000 / TEST_RATE;
+    uint32_t sleep_us = period_us * (CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS + 2);
+    engine.subscribe(slow_cb, &sleep_us);
+    engine.process();
+    engine.process();
+    EspAudioEngineStats_t stats;
+    engine.getStats(&stats);
+    CHECK_EQ(stats.late_periods, 1);
+    CHECK(stats.late_max_us >= period_us * (CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS + 1));
+    CHECK(stats.work_max_us >= period_us * (CONFIG_ESP_AUDIO_ENGINE_PRIME_PERIODS + 2));
+    close_engine(engine, dev);
+}
+
+static void count_cb(const int16_t *frames, size_t count, void *user_data)
+{
+    *(uint32_t *)user_data += frames[0];
+}
+
+static void bench()
+{
+    printf("process(), fake device, ns per period\n");
+    printf("channels,period_frames,subscribers,ns\n");
+    for (uint8_t channels = 1; channels <= 2; channels++) {
+        EspAudioEngine engine;
+        esp_codec_dev_handle_t dev = open_engine(engine, channels);
+        ramp_source ramp = {channels, 1, 0};
+        uint32_t sum = 0;
+        engine.setPlaybackSource(ramp_cb, &ramp);
+        for (int subscribers = 0; subscribers <= CONFIG_ESP_AUDIO_ENGINE_SUBSCRIBERS; subscribers++) {
+            if (subscribers) {
+                engine.subscribe(count_cb, &sum);
+            }
+            const int rounds = 100000;
+            uint64_t start = host_test_now_ns();
+            for (int i = 0; i < rounds; i++) {
+                engine.process();
+            }
+            double ns = (double)(host_test_now_ns() - start) / rounds;
+            printf("%u,%u,%d,%.1f\n", channels, TEST_PERIOD, subscribers, ns);
+            // Everything written was read back, keep the wire short
+            wire.clear();
+        }
+        close_engine(engine, dev);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    test_loopback(1);
+    test_loopback(2);
+    test_short_and_idle();
+    test_read_error();
+    test_subscribers();
+    test_late_period();
+    if (host_test_bench(argc, argv)) {
+        bench();
+    }
+    return host_test_result("audio_engine");
+}
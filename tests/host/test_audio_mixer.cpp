@@ -0,0 +1,299 @@
+/**
+ * @file      test_audio_mixer.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      EspAudioMixer saturation, rate and channel conversion, streams and handles.
+ *            With --bench the cost per output frame of the direct and the resampling path.
+ */
+#include "host_test.h"
+#include <math.h>
+#include <vector>
+#include "bsp_codec/esp_audio_mixer.h"
+
+static bool equal_run(const int16_t *a, const int16_t *b, size_t n)
+{
+    return memcmp(a, b, n * sizeof(int16_t)) == 0;
+}
+
+static void test_direct_clip()
+{
+    EspAudioMixer m;
+    CHECK(m.begin(16000, 2));
+    std::vector<int16_t> pcm(1000 * 2);
+    for (size_t i = 0; i < pcm.size(); i++) {
+        pcm[i] = (int16_t)(i * 7 - 5000);
+    }
+    EspAudioClip_t clip = {pcm.data(), 1000, 16000, 2};
+    int16_t out[512 * 2];
+    // Nothing playing, nothing written
+    CHECK_EQ(m.mix(out, 512), 0);
+    int h = m.play(&clip);
+    CHECK(h >= 0);
+    CHECK_EQ(m.mix(out, 512), 512);
+    CHECK(equal_run(out, pcm.data(), 1024));
+    // The clip ends inside this pass, the rest is silence
+    CHECK_EQ(m.mix(out, 512), 512);
+    CHECK(equal_run(out, pcm.data() + 1024, 976));
+    bool silent = true;
+    for (int i = 976; i < 1024; i++) {
+        silent &= out[i] == 0;
+    }
+    CHECK(silent);
+    CHECK(!m.isPlaying(h));
+    CHECK_EQ(m.mix(out, 512), 0);
+}
+
+static void test_saturation()
+{
+    EspAudioMixer m;
+    m.begin(16000, 2);
+    std::vector<int16_t> loud(256 * 2, 30000), quiet(256 * 2, -30000);
+    EspAudioClip_t up = {loud.data(), 256, 16000, 2};
+    EspAudioClip_t down = {quiet.data(), 256, 16000, 2};
+    int16_t out[256 * 2];
+    m.play(&up);
+    m.play(&up);
+    m.mix(out, 256);
+    CHECK_EQ(out[0], INT16_MAX);
+    CHECK_EQ(out[511], INT16_MAX);
+    m.play(&down);
+    m.play(&down, 2.0f);
+    m.mix(out, 256);
+    CHECK_EQ(out[0], INT16_MIN);
+    EspAudioMixerStats_t stats;
+    m.getStats(&stats);
+    CHECK_EQ(stats.clipped, 1024);
+    // A gain above 2.0 is limited, 2 * 30000 still fits the 32 bit sum of four voices
+    m.play(&up, 10.0f);
+    m.play(&up, 10.0f);
+    m.play(&up, 10.0f);
+    m.play(&up, 10.0f);
+    m.mix(out, 256);
+    CHECK_EQ(out[0], INT16_MAX);
+    // Opposite voices cancel before the clamp
+    m.play(&up);
+    m.play(&down);
+    m.mix(out, 256);
+    CHECK_EQ(out[0], 0);
+}
+
+// 8 kHz mono to 16 kHz stereo, every second frame is the midpoint of two source frames
+static void test_upsample()
+{
+    EspAudioMixer m;
+    m.begin(16000, 2);
+    std::vector<int16_t> mono(100);
+    for (int i = 0; i < 100; i++) {
+        mono[i] = i * 100;
+    }
+    EspAudioClip_t clip = {mono.data(), 100, 8000, 1};
+    int16_t out[512 * 2];
+    m.play(&clip);
+    CHECK_EQ(m.mix(out, 512), 512);
+    bool ok = true;
+    for (int i = 0; i < 198; i++) {
+        int16_t expect = (int16_t)(i * 50);
+        ok &= out[2 * i] == expect && out[2 * i + 1] == expect;
+    }
+    CHECK(ok);
+    CHECK_EQ(out[2 * 198], 9900);
+    CHECK_EQ(out[2 * 200], 0);
+}
+
+// A sine resampled from several rates against the sine computed at the output rate
+static void test_resample_sine()
+{
+    static const uint32_t rates[] = {8000, 11025, 22050, 32000, 44100};
+    const uint32_t out_rate = 16000;
+    const double freq = 440.0;
+    for (uint32_t rate : rates) {
+        EspAudioMixer m;
+        m.begin(out_rate, 1);
+        uint32_t frames = rate / 4;
+        std::vector<int16_t> pcm(frames);
+        for (uint32_t i = 0; i < frames; i++) {
+            pcm[i] = (int16_t)lrint(16000.0 * sin(2 * M_PI * freq * i / rate));
+        }
+        EspAudioClip_t clip = {pcm.data(), frames, rate, 1};
+        m.play(&clip);
+        std::vector<int16_t> out(out_rate / 8);
+        CHECK_EQ(m.mix(out.data(), out.size()), out.size());
+        // Linear interpolation is off by at most A * (pi * f / rate)^2 / 2. The Q16 step is
+        // truncated, the position falls behind by less than 1/65536 frame per output frame
+        double x = M_PI * freq / rate;
+        double drift = out.size() / 65536.0;
+        int bound = (int)(16000.0 * x * x / 2 + 16000.0 * 2 * x * drift) + 4;
+        int max_err = 0;
+        for (size_t i = 0; i < out.size(); i++) {
+            int expect = (int)lrint(16000.0 * sin(2 * M_PI * freq * i / out_rate));
+            int err = abs(out[i] - expect);
+            if (err > max_err) {
+                max_err = err;
+            }
+        }
+        if (max_err > bound) {
+            printf("rate %u max error %d, bound %d\n", rate, max_err, bound);
+        }
+        CHECK(max_err <= bound);
+    }
+}
+
+static void test_stale_handle()
+{
+    EspAudioMixer m;
+    m.begin(16000, 1);
+    std::vector<int16_t> pcm(100, 1000);
+    EspAudioClip_t clip = {pcm.data(), 100, 16000, 1};
+    int16_t out[256];
+    int h1 = m.play(&clip);
+    m.mix(out, 256);
+    CHECK(!m.isPlaying(h1));
+    // The new voice takes the same slot, the old handle must not stop it
+    int h2 = m.play(&clip);
+    CHECK(h2 != h1);
+    m.stop(h1);
+    m.setGain(h1, 0.0f);
+    CHECK(m.isPlaying(h2));
+    m.mix(out, 1);
+    CHECK_EQ(out[0], 1000);
+    int handles[CONFIG_ESP_AUDIO_MIXER_VOICES];
+    for (int i = 1; i < CONFIG_ESP_AUDIO_MIXER_VOICES; i++) {
+        handles[i] = m.play(&clip);
+        CHECK(handles[i] >= 0);
+    }
+    CHECK_EQ(m.play(&clip), -1);
+    m.stopAll();
+    CHECK(!m.isActive());
+}
+
+// 32 kHz stereo to 16 kHz mono at half gain, fed in pieces, then closed
+static void test_stream()
+{
+    EspAudioMixer m;
+    m.begin(16000, 1);
+    int st = m.openStream(32000, 2, 0.5f);
+    CHECK(st >= 0);
+    std::vector<int16_t> pcm(5000 * 2);
+    for (int i = 0; i < 5000; i++) {
+        pcm[2 * i] = 1000;
+        pcm[2 * i + 1] = 3000;
+    }
+    int16_t out[256];
+    // Without waiting only the free space is taken
+    CHECK_EQ(m.writeStream(st, pcm.data(), 5000, 0), CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES);
+    CHECK_EQ(m.mix(out, 256), 256);
+    CHECK_EQ(out[0], 1000);
+    CHECK_EQ(out[255], 1000);
+    // Two source frames per output frame were given back
+    CHECK_EQ(m.writeStream(st, pcm.data(), 5000, 0), 512);
+    for (int k = 0; k < 20; k++) {
+        CHECK_EQ(m.mix(out, 256), 256);
+    }
+    EspAudioMixerStats_t stats;
+    m.getStats(&stats);
+    // Counted once per stall
+    CHECK_EQ(stats.underruns, 1);
+    CHECK(m.isPlaying(st));
+    m.closeStream(st);
+    m.mix(out, 256);
+    CHECK(!m.isPlaying(st));
+    // Writing to a closed stream does nothing
+    CHECK_EQ(m.writeStream(st, pcm.data(), 10, 0), 0);
+}
+
+// A step of more than one frame must never give back more frames than were written
+static void test_stream_never_overfills()
+{
+    EspAudioMixer m;
+    m.begin(16000, 1);
+    int st = m.openStream(44100, 2);
+    std::vector<int16_t> pcm(8000 * 2, 100);
+    int16_t out[256];
+    int overfills = 0;
+    for (int k = 1; k < 500; k++) {
+        m.writeStream(st, pcm.data(), k % 7 + 1, 0);
+        m.mix(out, 256);
+        if (m.writeStream(st, pcm.data(), 8000, 0) > CONFIG_ESP_AUDIO_MIXER_STREAM_FRAMES) {
+            overfills++;
+        }
+        for (int j = 0; j < 40; j++) {
+            m.mix(out, 256);
+        }
+    }
+    CHECK_EQ(overfills, 0);
+}
+
+// Output follows a format change of the mixer while a clip plays
+static void test_set_format()
+{
+    EspAudioMixer m;
+    m.begin(16000, 2);
+    std::vector<int16_t> pcm(2000);
+    for (int i = 0; i < 2000; i++) {
+        pcm[i] = i;
+    }
+    EspAudioClip_t clip = {pcm.data(), 2000, 16000, 1};
+    int16_t out[64 * 2];
+    int h = m.play(&clip);
+    m.mix(out, 64);
+    CHECK_EQ(out[2 * 63], 63);
+    CHECK_EQ(out[2 * 63 + 1], 63);
+    CHECK(m.setFormat(8000, 1));
+    CHECK(!m.setFormat(8000, 3));
+    m.mix(out, 64);
+    // Two source frames per output frame from here
+    CHECK_EQ(out[0], 64);
+    CHECK_EQ(out[1], 66);
+    CHECK(m.isPlaying(h));
+}
+
+static void bench()
+{
+    const uint32_t rate = 44100;
+    EspAudioMixer m;
+    m.begin(rate, 2);
+    std::vector<int16_t> pcm(rate * 2);
+    for (size_t i = 0; i < pcm.size(); i++) {
+        pcm[i] = (int16_t)(8000 * sin(i * 0.01));
+    }
+    EspAudioClip_t direct = {pcm.data(), rate, rate, 2};
+    EspAudioClip_t resample = {pcm.data(), rate, rate / 2, 1};
+    static const char *names[] = {"direct_44k1_stereo", "resample_22k05_mono"};
+    EspAudioClip_t *clips[] = {&direct, &resample};
+    printf("mix() of 256 frames to 44.1 kHz stereo, looping clips at gain 0.25\n");
+    printf("path,voices,ns_per_frame,ns_per_frame_voice\n");
+    for (int c = 0; c < 2; c++) {
+        for (int voices = 1; voices <= CONFIG_ESP_AUDIO_MIXER_VOICES; voices++) {
+            m.stopAll();
+            for (int k = 0; k < voices; k++) {
+                m.play(clips[c], 0.25f, true);
+            }
+            int16_t out[256 * 2];
+            const int rounds = 20000;
+            uint64_t start = host_test_now_ns();
+            for (int i = 0; i < rounds; i++) {
+                m.mix(out, 256);
+            }
+            double ns = (double)(host_test_now_ns() - start) / (rounds * 256.0);
+            printf("%s,%d,%.2f,%.2f\n", names[c], voices, ns, ns / voices);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    test_direct_clip();
+    test_saturation();
+    test_upsample();
+    test_resample_sine();
+    test_stale_handle();
+    test_stream();
+    test_stream_never_overfills();
+    test_set_format();
+    if (host_test_bench(argc, argv)) {
+        bench();
+    }
+    return host_test_result("audio_mixer");
+}
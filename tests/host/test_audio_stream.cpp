@@ -0,0 +1,241 @@
+/**
+ * @file      test_audio_stream.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The streaming player of the factory example on the host, WAV only, the MP3
+ *            path needs libhelix-mp3 which is not part of this tree. Every frame of the
+ *            test file holds its own index, so the output shows exactly what was played.
+ */
+#include "host_test.h"
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "audio_stream.h"
+
+// PCM bytes the player writes per WAV block, see audio_stream.cpp
+#define TEST_WAV_BLOCK      2048
+
+static std::vector<uint8_t> make_wav(uint32_t rate, uint8_t bits, uint8_t channels, uint32_t frames)
+{
+    uint16_t align = channels * (bits / 8);
+    uint32_t data = frames * align;
+    std::vector<uint8_t> wav(44 + data);
+    uint8_t *h = wav.data();
+    uint32_t v;
+    uint16_t s;
+    memcpy(h, "RIFF", 4);
+    v = 36 + data;
+    memcpy(h + 4, &v, 4);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    v = 16;
+    memcpy(h + 16, &v, 4);
+    s = 1;
+    memcpy(h + 20, &s, 2);
+    s = channels;
+    memcpy(h + 22, &s, 2);
+    memcpy(h + 24, &rate, 4);
+    v = rate * align;
+    memcpy(h + 28, &v, 4);
+    memcpy(h + 32, &align, 2);
+    s = bits;
+    memcpy(h + 34, &s, 2);
+    memcpy(h + 36, "data", 4);
+    memcpy(h + 40, &data, 4);
+    // The frame index, little endian over all bytes of the frame
+    for (uint32_t i = 0; i < frames; i++) {
+        uint8_t *f = h + 44 + i * align;
+        for (uint16_t b = 0; b < align; b++) {
+            f[b] = b < 4 ? (uint8_t)(i >> (8 * b)) : 0;
+        }
+    }
+    return wav;
+}
+
+struct mem_source {
+    const std::vector<uint8_t> *data;
+    uint32_t pos;
+};
+
+static size_t mem_read(void *ctx, uint8_t *dst, size_t len)
+{
+    mem_source *m = (mem_source *)ctx;
+    size_t left = m->data->size() - m->pos;
+    if (len > left) {
+        len = left;
+    }
+    memcpy(dst, m->data->data() + m->pos, len);
+    m->pos += len;
+    return len;
+}
+
+static bool mem_seek(void *ctx, uint32_t pos)
+{
+    mem_source *m = (mem_source *)ctx;
+    if (pos > m->data->size()) {
+        return false;
+    }
+    m->pos = pos;
+    return true;
+}
+
+struct capture_sink {
+    uint16_t align;
+    uint32_t rate;
+    bool misaligned;
+    std::vector<uint32_t> frames;
+};
+
+static bool capture_open(void *ctx, uint32_t rate, uint8_t bits, uint8_t channels)
+{
+    capture_sink *c = (capture_sink *)ctx;
+    c->rate = rate;
+    c->align = channels * (bits / 8);
+    return true;
+}
+
+static bool capture_write(void *ctx, const uint8_t *pcm, size_t bytes)
+{
+    capture_sink *c = (capture_sink *)ctx;
+    if (bytes % c->align) {
+        c->misaligned = true;
+    }
+    for (size_t off = 0; off + c->align <= bytes; off += c->align) {
+        uint32_t index = 0;
+        for (uint16_t b = 0; b < c->align && b < 4; b++) {
+            index |= (uint32_t)pcm[off + b] << (8 * b);
+        }
+        c->frames.push_back(index);
+    }
+    return true;
+}
+
+struct seek_control {
+    AudioStreamPlayer *player;
+    capture_sink *sink;
+    uint32_t at_frame;      // Seek once this many frames were written
+    uint32_t to_ms;
+    uint32_t requested_at;  // Frames written when the seek was requested, 0 before
+};
+
+static bool seek_control_cb(void *ctx)
+{
+    seek_control *s = (seek_control *)ctx;
+    if (!s->requested_at && s->sink->frames.size() >= s->at_frame) {
+        s->requested_at = s->sink->frames.size();
+        s->player->seek(s->to_ms);
+    }
+    return true;
+}
+
+static void test_play(uint8_t bits, uint8_t channels)
+{
+    const uint32_t frames = 20000;
+    std::vector<uint8_t> wav = make_wav(8000, bits, channels, frames);
+    mem_source src = {&wav, 0};
+    capture_sink cap = {};
+    audio_stream_source_t source = {mem_read, mem_seek, NULL, NULL, &src};
+    audio_stream_sink_t sink = {capture_open, capture_write, NULL, &cap};
+    AudioStreamPlayer player;
+    CHECK(player.play(source, sink, AUDIO_STREAM_WAV));
+    CHECK(!cap.misaligned);
+    CHECK_EQ(cap.rate, 8000);
+    CHECK_EQ(cap.frames.size(), frames);
+    bool in_order = true;
+    for (uint32_t i = 0; i < cap.frames.size(); i++) {
+        in_order &= cap.frames[i] == i;
+    }
+    CHECK(in_order);
+    audio_stream_stats_t stats;
+    player.getStats(&stats);
+    CHECK_EQ(stats.underruns, 0);
+    CHECK_EQ(stats.decode_errors, 0);
+}
+
+// Plays from the start, seeks once 'at_frame' frames were written and checks that at
+// most one block of the old position follows the request and then the new position
+// plays in order to the end
+static void test_seek(uint8_t bits, uint8_t channels, uint32_t frames, uint32_t at_frame, uint32_t to_ms)
+{
+    const uint32_t rate = 8000;
+    std::vector<uint8_t> wav = make_wav(rate, bits, channels, frames);
+    mem_source src = {&wav, 0};
+    capture_sink cap = {};
+    audio_stream_source_t source = {mem_read, mem_seek, NULL, NULL, &src};
+    audio_stream_sink_t sink = {capture_open, capture_write, NULL, &cap};
+    AudioStreamPlayer player;
+    seek_control ctl = {&player, &cap, at_frame, to_ms, 0};
+    CHECK(player.play(source, sink, AUDIO_STREAM_WAV, seek_control_cb, &ctl));
+    CHECK(!cap.misaligned);
+    CHECK(ctl.requested_at > 0);
+
+    // Old position in order up to the jump
+    uint32_t jump = 0;
+    while (jump < cap.frames.size() && cap.frames[jump] == jump) {
+        jump++;
+    }
+    uint32_t target = (uint32_t)((uint64_t)to_ms * rate / 1000);
+    uint32_t block_frames = TEST_WAV_BLOCK / cap.align;
+    CHECK(jump >= ctl.requested_at);
+    CHECK(jump - ctl.requested_at <= block_frames);
+    CHECK_EQ(cap.frames.size() - jump, frames - target);
+    bool in_order = true;
+    for (uint32_t i = jump; i < cap.frames.size(); i++) {
+        in_order &= cap.frames[i] == target + (i - jump);
+    }
+    CHECK(in_order);
+    audio_stream_stats_t stats;
+    player.getStats(&stats);
+    CHECK_EQ(stats.seeks, 1);
+}
+
+static void test_decode_file()
+{
+    const uint32_t frames = 30000;
+    std::vector<uint8_t> wav = make_wav(16000, 16, 2, frames);
+    char in_path[] = "/tmp/lilygo_stream_inXXXXXX";
+    int fd = mkstemp(in_path);
+    CHECK(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    FILE *fp = fdopen(fd, "wb");
+    fwrite(wav.data(), 1, wav.size(), fp);
+    fclose(fp);
+    // The format is taken from the extension
+    std::string in_wav = std::string(in_path) + ".wav";
+    rename(in_path, in_wav.c_str());
+    std::string out_wav = std::string(in_path) + "_out.wav";
+
+    audio_stream_stats_t stats;
+    CHECK(audio_stream_decode_file(in_wav.c_str(), out_wav.c_str(), &stats));
+    fp = fopen(out_wav.c_str(), "rb");
+    CHECK(fp != NULL);
+    if (fp) {
+        std::vector<uint8_t> out(wav.size() + 1);
+        size_t len = fread(out.data(), 1, out.size(), fp);
+        fclose(fp);
+        CHECK_EQ(len, wav.size());
+        CHECK(memcmp(out.data(), wav.data(), wav.size()) == 0);
+    }
+    CHECK(stats.slices > 0);
+    remove(in_wav.c_str());
+    remove(out_wav.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    test_play(16, 2);
+    test_play(24, 1);
+    test_play(16, 1);
+    // Mid file, the ring is full of the old position
+    test_seek(16, 2, 40000, 4000, 500);
+    test_seek(24, 1, 40000, 4000, 3000);
+    // Near the end the ring is almost dry, the refill after the seek takes the last old
+    // bytes and the first new ones in one copy
+    test_seek(16, 2, 20000, 19200, 100);
+    test_seek(24, 1, 20000, 18700, 100);
+    test_decode_file();
+    return host_test_result("audio_stream");
+}
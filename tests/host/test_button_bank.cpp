@@ -0,0 +1,251 @@
+/**
+ * @file      test_button_bank.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      ButtonBank state machines replayed from synthetic edge traces with the
+ *            default timing (50 ms debounce, 250 ms long press, 400 ms between clicks),
+ *            and the interrupt to timer path over stub pins and a stub timer.
+ */
+#include "host_test.h"
+#include <vector>
+#include "ButtonBank.h"
+
+struct edge_t {
+    uint32_t time_ms;
+    uint8_t index;
+    bool pressed;
+};
+
+struct event_t {
+    uint8_t id;
+    ButtonEvent_t event;
+    uint32_t time_ms;       // Tick that produced it
+};
+
+// Feeds the edges in time order and ticks every CONFIG_BUTTON_TICK_MS until end_ms,
+// as the timer would while a button is active
+static std::vector<event_t> replay(ButtonBank &bank, const std::vector<edge_t> &edges, uint32_t end_ms)
+{
+    std::vector<event_t> out;
+    size_t next = 0;
+    for (uint32_t now = 0; now <= end_ms; now += CONFIG_BUTTON_TICK_MS) {
+        while (next < edges.size() && edges[next].time_ms <= now) {
+            bank.feed(edges[next].index, edges[next].pressed, edges[next].time_ms);
+            next++;
+        }
+        bank.tick(now);
+        ButtonEventParam_t e;
+        while (bank.popEvent(&e)) {
+            out.push_back({e.id, (ButtonEvent_t)e.event, now});
+        }
+    }
+    return out;
+}
+
+static bool same_events(const std::vector<event_t> &got, const std::vector<ButtonEvent_t> &expect, uint8_t id = 0)
+{
+    bool ok = got.size() == expect.size();
+    for (size_t i = 0; ok && i < got.size(); i++) {
+        ok = got[i].event == expect[i] && got[i].id == id;
+    }
+    if (!ok) {
+        fprintf(stderr, "  got:");
+        for (const event_t &e : got) {
+            fprintf(stderr, " %u:%d@%u", e.id, e.event, e.time_ms);
+        }
+        fprintf(stderr, "\n");
+    }
+    return ok;
+}
+
+static std::vector<event_t> replay_one(const std::vector<edge_t> &edges, uint32_t end_ms)
+{
+    ButtonBank bank;
+    bank.reset(1);
+    return replay(bank, edges, end_ms);
+}
+
+static void test_click()
+{
+    std::vector<event_t> ev = replay_one({{100, 0, true}, {200, 0, false}}, 1000);
+    CHECK(same_events(ev, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_CLICK}));
+    // Reported once no second press can follow
+    CHECK(ev.size() == 3 && ev[2].time_ms >= 600 && ev[2].time_ms < 600 + CONFIG_BUTTON_TICK_MS);
+}
+
+static void test_double_triple()
+{
+    std::vector<event_t> ev = replay_one({{100, 0, true}, {180, 0, false}, {300, 0, true}, {380, 0, false}}, 1000);
+    CHECK(same_events(ev, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_PRESSED,
+                           BUTTON_EVENT_RELEASED, BUTTON_EVENT_DOUBLE_CLICK
+                          }));
+    // Nothing longer than a triple click exists, it is sent on the release
+    ev = replay_one({{100, 0, true}, {180, 0, false}, {300, 0, true}, {380, 0, false},
+        {500, 0, true}, {580, 0, false}
+    }, 1200);
+    CHECK(same_events(ev, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_PRESSED,
+                           BUTTON_EVENT_RELEASED, BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED,
+                           BUTTON_EVENT_TRIPLE_CLICK
+                          }));
+    CHECK(ev.size() == 7 && ev[6].time_ms == 580);
+}
+
+static void test_long_press()
+{
+    std::vector<event_t> ev = replay_one({{100, 0, true}, {700, 0, false}}, 1500);
+    CHECK(same_events(ev, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_LONG_PRESSED, BUTTON_EVENT_RELEASED}));
+    CHECK(ev.size() == 3 && ev[1].time_ms >= 350 && ev[1].time_ms < 350 + CONFIG_BUTTON_TICK_MS);
+    // A long press ends a click sequence
+    ev = replay_one({{100, 0, true}, {180, 0, false}, {300, 0, true}, {800, 0, false}}, 1500);
+    CHECK(same_events(ev, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_PRESSED,
+                           BUTTON_EVENT_LONG_PRESSED, BUTTON_EVENT_RELEASED
+                          }));
+}
+
+static void test_bounce()
+{
+    std::vector<event_t> ev = replay_one({
+        {100, 0, true}, {102, 0, false}, {104, 0, true}, {107, 0, false}, {109, 0, true},
+        {200, 0, false}, {201, 0, true}, {203, 0, false},
+    }, 1000);
+    CHECK(same_events(ev, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_CLICK}));
+    // The press keeps the time of its first edge
+    CHECK(ev.size() == 3 && ev[2].time_ms >= 600 && ev[2].time_ms < 600 + CONFIG_BUTTON_TICK_MS);
+}
+
+// A tap shorter than the debounce time is a click, not lost
+static void test_short_tap()
+{
+    std::vector<event_t> ev = replay_one({{100, 0, true}, {120, 0, false}}, 1000);
+    CHECK(same_events(ev, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_CLICK}));
+    CHECK(ev.size() == 3 && ev[1].time_ms == 150);
+}
+
+// The timer did not run between two taps far apart, they are still two clicks
+static void test_late_timer()
+{
+    ButtonBank bank;
+    bank.reset(1);
+    bank.feed(0, true, 100);
+    bank.feed(0, false, 180);
+    bank.feed(0, true, 2000);
+    bank.feed(0, false, 2080);
+    bank.tick(2500);
+    std::vector<event_t> ev;
+    ButtonEventParam_t e;
+    while (bank.popEvent(&e)) {
+        ev.push_back({e.id, (ButtonEvent_t)e.event, 0});
+    }
+    CHECK(same_events(ev, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_CLICK,
+                           BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_CLICK
+                          }));
+}
+
+static void test_two_buttons()
+{
+    ButtonBank bank;
+    bank.reset(2);
+    std::vector<event_t> ev = replay(bank, {
+        {100, 0, true}, {150, 1, true}, {180, 0, false}, {300, 0, true}, {380, 0, false}, {900, 1, false},
+    }, 1500);
+    std::vector<event_t> b0, b1;
+    for (const event_t &e : ev) {
+        (e.id ? b1 : b0).push_back(e);
+    }
+    CHECK(same_events(b0, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_PRESSED,
+                           BUTTON_EVENT_RELEASED, BUTTON_EVENT_DOUBLE_CLICK
+                          }, 0));
+    CHECK(same_events(b1, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_LONG_PRESSED, BUTTON_EVENT_RELEASED}, 1));
+}
+
+static void test_event_overflow()
+{
+    ButtonBank bank;
+    bank.reset(1);
+    // Three events per triple click sequence step, nobody dispatching
+    uint32_t t = 100;
+    for (int i = 0; i < 9; i++) {
+        bank.feed(0, true, t);
+        bank.feed(0, false, t + 60);
+        t += 120;
+    }
+    CHECK_EQ(bank.getDroppedEvents(), 9 * 2 + 3 - CONFIG_BUTTON_EVENT_QUEUE_SIZE);
+    ButtonEventParam_t e;
+    uint32_t count = 0;
+    while (bank.popEvent(&e)) {
+        count++;
+    }
+    CHECK_EQ(count, CONFIG_BUTTON_EVENT_QUEUE_SIZE);
+}
+
+// Pin interrupts queue the edges, the timer runs while a button is active and stops after
+static void test_interrupt_path()
+{
+    const uint8_t pins[] = {5, 6};
+    host_pin_write(5, HIGH);
+    // Held at begin, only its release is reported
+    host_pin_write(6, LOW);
+    EventGroupHandle_t group = xEventGroupCreate();
+    ButtonBank bank;
+    CHECK(bank.begin(pins, 2, group, _BV(3)));
+    TimerHandle_t timer = host_last_timer();
+    CHECK(timer != NULL);
+    CHECK(!timer->active);
+
+    auto run_for = [&](uint32_t ms) {
+        for (uint32_t t = 0; t < ms; t += CONFIG_BUTTON_TICK_MS) {
+            host_time_advance_us(CONFIG_BUTTON_TICK_MS * 1000);
+            host_timer_run(timer);
+        }
+    };
+
+    host_time_advance_us(1000000);
+    host_pin_write(5, LOW);
+    CHECK(timer->active);
+    run_for(80);
+    host_pin_write(5, HIGH);
+    host_pin_write(6, HIGH);
+    run_for(600);
+    CHECK(!timer->active);
+    CHECK(group->bits & _BV(3));
+
+    std::vector<event_t> ev;
+    ButtonEventParam_t e;
+    while (bank.popEvent(&e)) {
+        ev.push_back({e.id, (ButtonEvent_t)e.event, 0});
+    }
+    std::vector<event_t> b0, b1;
+    for (const event_t &x : ev) {
+        (x.id ? b1 : b0).push_back(x);
+    }
+    CHECK(same_events(b0, {BUTTON_EVENT_PRESSED, BUTTON_EVENT_RELEASED, BUTTON_EVENT_CLICK}, 0));
+    CHECK(same_events(b1, {BUTTON_EVENT_RELEASED}, 1));
+
+    // Started again by the next edge
+    uint32_t starts = timer->starts;
+    host_pin_write(5, LOW);
+    CHECK(timer->active);
+    CHECK_EQ(timer->starts, starts + 1);
+    bank.end();
+    CHECK(!timer->active);
+    // Detached, a change does nothing
+    host_pin_write(5, HIGH);
+    CHECK(!timer->active);
+    vEventGroupDelete(group);
+}
+
+int main(int argc, char **argv)
+{
+    test_click();
+    test_double_triple();
+    test_long_press();
+    test_bounce();
+    test_short_tap();
+    test_late_timer();
+    test_two_buttons();
+    test_event_overflow();
+    test_interrupt_path();
+    return host_test_result("button_bank");
+}
@@ -0,0 +1,203 @@
+/**
+ * @file      test_codec_output.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      EspCodecOutput and the ESP8266Audio adapter over a fake EspCodec. The test
+ *            defines the EspCodec methods the output calls, so the real headers are used.
+ */
+#include "host_test.h"
+#include <vector>
+#include "bsp_codec/esp_audio_output.h"
+
+// What the fake codec was given, one entry per write
+static std::vector<std::vector<int16_t>> codec_writes;
+static uint32_t codec_write_calls;
+static uint32_t codec_fail_from;   // Fail the writes from this call on, 1 based, 0 never
+static uint32_t codec_fail_to;
+
+EspCodec::EspCodec(uint8_t i2s_channel)
+{
+}
+
+EspCodec::~EspCodec()
+{
+}
+
+int EspCodec::open(uint8_t bits_per_sample, uint8_t channel, uint32_t sample_rate)
+{
+    return bits_per_sample == 16 && channel == 2 ? 0 : -1;
+}
+
+int EspCodec::setFormat(uint8_t bits_per_sample, uint8_t channel, uint32_t sample_rate)
+{
+    return 0;
+}
+
+void EspCodec::close()
+{
+}
+
+int EspCodec::write(uint8_t *buffer, size_t size)
+{
+    codec_write_calls++;
+    if (codec_fail_from && codec_write_calls >= codec_fail_from && codec_write_calls <= codec_fail_to) {
+        return -1;
+    }
+    const int16_t *s = (const int16_t *)buffer;
+    codec_writes.emplace_back(s, s + size / sizeof(int16_t));
+    return (int)size;
+}
+
+static void reset_codec()
+{
+    codec_writes.clear();
+    codec_write_calls = 0;
+    codec_fail_from = codec_fail_to = 0;
+}
+
+// All written samples in order
+static std::vector<int16_t> written()
+{
+    std::vector<int16_t> all;
+    for (auto &w : codec_writes) {
+        all.insert(all.end(), w.begin(), w.end());
+    }
+    return all;
+}
+
+static std::vector<int16_t> make_frames(size_t count, int16_t first)
+{
+    std::vector<int16_t> frames(count * 2);
+    for (size_t i = 0; i < count; i++) {
+        frames[2 * i] = (int16_t)(first + i);
+        frames[2 * i + 1] = (int16_t)(-first - (int16_t)i);
+    }
+    return frames;
+}
+
+// 'count' is in stereo frames, the codec must get all of them and not 'count' bytes
+static void test_consume_samples_count()
+{
+    reset_codec();
+    EspCodec codec;
+    EspAudioOutput out(codec);
+    CHECK(out.begin());
+    std::vector<int16_t> frames = make_frames(1000, 1);
+    CHECK_EQ(out.ConsumeSamples(frames.data(), 1000), 1000);
+    out.flush();
+    std::vector<int16_t> all = written();
+    CHECK_EQ(all.size(), frames.size());
+    CHECK(all == frames);
+    // Whole blocks, the rest at the flush
+    CHECK_EQ(codec_writes.size(), (1000 + CONFIG_ESP_CODEC_OUTPUT_FRAMES - 1) / CONFIG_ESP_CODEC_OUTPUT_FRAMES);
+    CHECK_EQ(codec_writes[0].size(), CONFIG_ESP_CODEC_OUTPUT_FRAMES * 2);
+    EspCodecOutputStats_t stats;
+    out.getStats(&stats);
+    CHECK_EQ(stats.frames, 1000);
+    out.stop();
+}
+
+// With a gain the base class converts frame by frame, the count is the same
+static void test_consume_samples_gain()
+{
+    reset_codec();
+    EspCodec codec;
+    EspAudioOutput out(codec);
+    out.SetGain(0.5);
+    out.begin();
+    std::vector<int16_t> frames = make_frames(300, 100);
+    CHECK_EQ(out.ConsumeSamples(frames.data(), 300), 300);
+    out.flush();
+    std::vector<int16_t> all = written();
+    CHECK_EQ(all.size(), 600);
+    CHECK_EQ(all[0], 50);
+    CHECK_EQ(all[1], -50);
+    CHECK_EQ(all[598], (100 + 299) / 2);
+    out.stop();
+}
+
+static void test_mono_sample()
+{
+    reset_codec();
+    EspCodec codec;
+    EspAudioOutput out(codec);
+    out.SetChannels(1);
+    out.begin();
+    int16_t sample[2] = {1234, 0};
+    CHECK(out.ConsumeSample(sample));
+    out.flush();
+    std::vector<int16_t> all = written();
+    CHECK_EQ(all.size(), 2);
+    CHECK_EQ(all[0], 1234);
+    CHECK_EQ(all[1], 1234);
+    out.stop();
+}
+
+// A failed write drops its block, the frame that completed it was still taken
+static void test_write_frame_error()
+{
+    reset_codec();
+    EspCodec codec;
+    EspCodecOutput out(codec);
+    out.begin(16000);
+    codec_fail_from = codec_fail_to = 1;
+    std::vector<int16_t> frames = make_frames(2 * CONFIG_ESP_CODEC_OUTPUT_FRAMES, 0);
+    bool all_taken = true;
+    for (size_t i = 0; i < 2 * CONFIG_ESP_CODEC_OUTPUT_FRAMES; i++) {
+        all_taken &= out.writeFrame(&frames[2 * i]);
+    }
+    CHECK(all_taken);
+    // No frame was repeated, the second block follows
+    std::vector<int16_t> expect(frames.begin() + CONFIG_ESP_CODEC_OUTPUT_FRAMES * 2, frames.end());
+    CHECK(written() == expect);
+    EspCodecOutputStats_t stats;
+    out.getStats(&stats);
+    CHECK_EQ(stats.write_errors, 1);
+    CHECK_EQ(stats.dropped, CONFIG_ESP_CODEC_OUTPUT_FRAMES);
+    CHECK_EQ(stats.frames, CONFIG_ESP_CODEC_OUTPUT_FRAMES);
+    // Not started
+    out.end();
+    CHECK(!out.writeFrame(&frames[0]));
+}
+
+// write() counts only what was written or is still staged
+static void test_write_error()
+{
+    const size_t block = CONFIG_ESP_CODEC_OUTPUT_FRAMES;
+    reset_codec();
+    EspCodec codec;
+    EspCodecOutput out(codec);
+    out.begin(16000);
+    std::vector<int16_t> frames = make_frames(3 * block, 0);
+    // The second block fails, the first is written and the third is not reached
+    codec_fail_from = codec_fail_to = 2;
+    CHECK_EQ(out.write(frames.data(), 3 * block), block);
+    // The caller gives the rest again
+    CHECK_EQ(out.write(frames.data() + block * 2, 2 * block), 2 * block);
+    CHECK(written() == frames);
+
+    // A block that starts with frames of an earlier call, only this call's frames are counted
+    reset_codec();
+    for (size_t i = 0; i < 100; i++) {
+        out.writeFrame(&frames[2 * i]);
+    }
+    codec_fail_from = codec_fail_to = 1;
+    CHECK_EQ(out.write(frames.data() + 200, block), 0);
+    CHECK_EQ(out.write(frames.data() + 200, block), block);
+    out.flush();
+    std::vector<int16_t> expect(frames.begin() + 200, frames.begin() + 200 + block * 2);
+    CHECK(written() == expect);
+    out.end();
+}
+
+int main(int argc, char **argv)
+{
+    test_consume_samples_count();
+    test_consume_samples_gain();
+    test_mono_sample();
+    test_write_frame_error();
+    test_write_error();
+    return host_test_result("codec_output");
+}
@@ -0,0 +1,223 @@
+/**
+ * @file      test_disp_qspi.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      LilyGoDispQSPI pushColors on the mock SPI master queue. The asynchronous
+ *            flush must return while chunks are still on the bus, keep no more than
+ *            the device queue size in flight, hold CS low until the last chunk and
+ *            complete once in the flush task. The bytes on the bus are the same for
+ *            the polling, DMA and asynchronous paths. The screen is cleared at init
+ *            from one small buffer instead of a frame sized one.
+ */
+#include "host_test.h"
+#include <atomic>
+#include <vector>
+#include "LilyGoDispInterface.h"
+
+#define TEST_CS             10
+#define TEST_WIDTH          480
+#define TEST_HEIGHT         640
+// Chunk size of the driver in pixels
+#define TEST_CHUNK          16384
+
+static const disp_cmd_t init_cmd[] = {
+    {0x11, {0x00}, 0x80},
+    {0x3A, {0x55}, 0x01},
+    {0x29, {0x00}, 0x00},
+};
+
+static std::atomic<uint32_t> done_calls;
+static std::atomic<bool> done_in_task;
+
+static void flush_done(void *user_data, uint32_t done_us)
+{
+    done_in_task = xTaskGetCurrentTaskHandle() != NULL;
+    done_calls++;
+}
+
+static spi_device_handle_t begin(LilyGoDispQSPI &disp)
+{
+    host_spi_cs_pin() = TEST_CS;
+    CHECK(disp.init(-1, TEST_CS, -1, 1, 2, 3, 4, 5));
+    spi_device_handle_t dev = host_spi_last_device();
+    dev->transfers.clear();
+    // Long enough that the caller gets well ahead of the bus
+    dev->transfer_us = 100;
+    done_calls = 0;
+    done_in_task = false;
+    return dev;
+}
+
+static std::vector<uint16_t> make_pixels(uint32_t len, uint32_t seed)
+{
+    std::vector<uint16_t> pixels(len);
+    for (uint32_t i = 0; i < len; i++) {
+        pixels[i] = (uint16_t)(i * 0x9E37 + seed);
+    }
+    return pixels;
+}
+
+// The pixel bytes of the queued or polled RAMWR transfers from 'first' on, in bus order
+static std::vector<uint8_t> pixel_bytes(spi_device_handle_t dev, size_t first)
+{
+    std::vector<uint8_t> out;
+    for (size_t i = first; i < dev->transfers.size(); i++) {
+        const host_spi_transfer_t &t = dev->transfers[i];
+        if (t.cmd == 0x02) {
+            continue;
+        }
+        out.insert(out.end(), t.data.begin(), t.data.end());
+    }
+    return out;
+}
+
+static std::vector<uint8_t> big_endian(const std::vector<uint16_t> &pixels)
+{
+    std::vector<uint8_t> out;
+    for (uint16_t p : pixels) {
+        out.push_back(p >> 8);
+        out.push_back(p & 0xFF);
+    }
+    return out;
+}
+
+// The address window goes out as three polled commands, the pixels follow in chunks
+static bool check_frame(spi_device_handle_t dev, size_t first, uint32_t len, bool queued)
+{
+    uint32_t chunks = (len + TEST_CHUNK - 1) / TEST_CHUNK;
+    bool ok = dev->transfers.size() >= first + 3 + chunks;
+    for (uint32_t i = 0; ok && i < 3; i++) {
+        const host_spi_transfer_t &t = dev->transfers[first + i];
+        ok = !t.queued && t.cmd == 0x02 && t.addr == (uint64_t)(i == 0 ? 0x2A : i == 1 ? 0x2B : 0x2C) << 8;
+    }
+    for (uint32_t i = 0; ok && i < chunks; i++) {
+        const host_spi_transfer_t &t = dev->transfers[first + 3 + i];
+        uint32_t px = i + 1 < chunks ? TEST_CHUNK : len - i * TEST_CHUNK;
+        ok = t.queued == queued && t.cs == LOW && t.data.size() == px * 2;
+        // Only the first chunk carries the write command, the rest continue it
+        if (i == 0) {
+            ok = ok && t.cmd == 0x32 && t.addr == 0x002C00 && !(t.flags & SPI_TRANS_VARIABLE_CMD);
+        } else {
+            ok = ok && (t.flags & SPI_TRANS_VARIABLE_CMD) && (t.flags & SPI_TRANS_VARIABLE_ADDR);
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "  frame at %zu: %zu transfers\n", first, dev->transfers.size());
+    }
+    return ok;
+}
+
+static void test_async_flush()
+{
+    LilyGoDispQSPI disp(init_cmd, 3, TEST_WIDTH, TEST_HEIGHT);
+    spi_device_handle_t dev = begin(disp);
+    disp.enableDMA(true);
+    disp.enableAsyncFlush(true);
+    disp.enableSwapBytes(true);
+    disp.setFlushDoneCallback(flush_done, NULL);
+
+    // More chunks than the device queue holds
+    const uint32_t len = TEST_WIDTH * TEST_HEIGHT;
+    static_assert((TEST_WIDTH * TEST_HEIGHT + TEST_CHUNK - 1) / TEST_CHUNK > CONFIG_QSPI_TRANS_QUEUE_SIZE, "chunks");
+    std::vector<uint16_t> pixels = make_pixels(len, 1);
+    std::vector<uint8_t> expect = big_endian(pixels);
+    disp.pushColors(0, 0, TEST_WIDTH, TEST_HEIGHT, pixels.data());
+    // Returned with the last chunks still queued
+    CHECK_EQ(done_calls, 0);
+    CHECK_EQ(digitalRead(TEST_CS), LOW);
+
+    disp.waitFlushDone();
+    CHECK_EQ(done_calls, 1);
+    CHECK(done_in_task);
+    CHECK_EQ(digitalRead(TEST_CS), HIGH);
+    CHECK(!dev->acquired);
+    CHECK_EQ(dev->errors, 0);
+    CHECK(dev->max_pending <= CONFIG_QSPI_TRANS_QUEUE_SIZE);
+    CHECK(check_frame(dev, 0, len, true));
+    CHECK(pixel_bytes(dev, 0) == expect);
+
+    // The next frame waits for the previous one before it polls the address window
+    dev->transfers.clear();
+    std::vector<uint16_t> a = make_pixels(len, 2);
+    std::vector<uint16_t> b = make_pixels(TEST_WIDTH * 40, 3);
+    std::vector<uint8_t> expect_ab = big_endian(a);
+    std::vector<uint8_t> expect_b = big_endian(b);
+    expect_ab.insert(expect_ab.end(), expect_b.begin(), expect_b.end());
+    disp.pushColors(0, 0, TEST_WIDTH, TEST_HEIGHT, a.data());
+    disp.pushColors(0, 100, TEST_WIDTH, 40, b.data());
+    disp.waitFlushDone();
+    CHECK_EQ(done_calls, 3);
+    CHECK_EQ(dev->errors, 0);
+    CHECK(check_frame(dev, 0, len, true));
+    CHECK(check_frame(dev, 3 + (len + TEST_CHUNK - 1) / TEST_CHUNK, TEST_WIDTH * 40, true));
+    CHECK(pixel_bytes(dev, 0) == expect_ab);
+    disp.end();
+}
+
+// init clears the whole screen with fillRect, the line buffer is sent again and again
+static void test_init_clear()
+{
+    host_heap_caps_largest() = 0;
+    host_spi_cs_pin() = TEST_CS;
+    LilyGoDispQSPI disp(init_cmd, 3, TEST_WIDTH, TEST_HEIGHT);
+    CHECK(disp.init(-1, TEST_CS, -1, 1, 2, 3, 4, 5));
+    spi_device_handle_t dev = host_spi_last_device();
+    CHECK(host_heap_caps_largest() <= CONFIG_DISP_FILL_BUF_PIXELS * sizeof(uint16_t));
+    // Two rounds of the init list and MADCTL come first
+    const size_t first = 2 * 3 + 1;
+    const uint32_t len = TEST_WIDTH * TEST_HEIGHT;
+    std::vector<uint8_t> bytes = pixel_bytes(dev, first);
+    CHECK_EQ(bytes.size(), len * 2);
+    bool zero = true;
+    for (uint8_t b : bytes) {
+        zero &= b == 0;
+    }
+    CHECK(zero);
+    CHECK_EQ(dev->transfers.size(), first + 3 + (len + CONFIG_DISP_FILL_BUF_PIXELS - 1) / CONFIG_DISP_FILL_BUF_PIXELS);
+    CHECK_EQ(dev->errors, 0);
+    CHECK_EQ(digitalRead(TEST_CS), HIGH);
+
+    // A color goes out high byte first
+    dev->transfers.clear();
+    disp.fillRect(10, 20, 30, 40, 0xF81F);
+    bytes = pixel_bytes(dev, 0);
+    CHECK_EQ(bytes.size(), 30 * 40 * 2);
+    bool color = true;
+    for (size_t i = 0; i < bytes.size(); i += 2) {
+        color &= bytes[i] == 0xF8 && bytes[i + 1] == 0x1F;
+    }
+    CHECK(color);
+    disp.end();
+}
+
+// Polling and blocking DMA send the same bytes and return with everything sent
+static void test_sync_paths(bool dma)
+{
+    LilyGoDispQSPI disp(init_cmd, 3, TEST_WIDTH, TEST_HEIGHT);
+    spi_device_handle_t dev = begin(disp);
+    disp.enableDMA(dma);
+    disp.enableSwapBytes(true);
+    disp.setFlushDoneCallback(flush_done, NULL);
+    const uint32_t len = TEST_WIDTH * 100 + 7;
+    std::vector<uint16_t> pixels = make_pixels(len, 4);
+    std::vector<uint8_t> expect = big_endian(pixels);
+    disp.pushColors(0, 0, len, 1, pixels.data());
+    CHECK_EQ(digitalRead(TEST_CS), HIGH);
+    CHECK(!dev->acquired);
+    CHECK_EQ(dev->errors, 0);
+    CHECK_EQ(done_calls, 0);
+    CHECK(check_frame(dev, 0, len, dma));
+    CHECK(pixel_bytes(dev, 0) == expect);
+    disp.end();
+}
+
+int main(int argc, char **argv)
+{
+    test_init_clear();
+    test_async_flush();
+    test_sync_paths(true);
+    test_sync_paths(false);
+    return host_test_result("disp_qspi");
+}
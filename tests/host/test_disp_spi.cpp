@@ -0,0 +1,218 @@
+/**
+ * @file      test_disp_spi.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      LilyGoDispArduinoSPI against a recording SPIClass: the init table goes
+ *            out in one transaction per delay, every command with its parameters
+ *            under CS with DC low only for the command byte, and pixels are pushed
+ *            in chunks with the bus lock given back between them. The screen is
+ *            cleared at init by repeating one small buffer.
+ */
+#include "host_test.h"
+#include <vector>
+#include "LilyGoDispInterface.h"
+
+#define TEST_CS         10
+#define TEST_DC         11
+#define TEST_WIDTH      222
+#define TEST_HEIGHT     480
+
+// The ST7796 table of the T-LoRa-Pager, 0x80 in len asks for a delay after the command
+static const CommandTable_t init_list[] = {
+    {0x01, {0x00}, 0x80},
+    {0x11, {0x00}, 0x80},
+    {0xF0, {0xC3}, 0x01},
+    {0xF0, {0xC3}, 0x01},
+    {0xF0, {0x96}, 0x01},
+    {0x36, {0x48}, 0x01},
+    {0x3A, {0x55}, 0x01},
+    {0xB4, {0x01}, 0x01},
+    {0xB6, {0x80, 0x02, 0x3B}, 0x03},
+    {0xE8, {0x40, 0x8A, 0x00, 0x00, 0x29, 0x19, 0xA5, 0x33}, 0x08},
+    {0xC1, {0x06}, 0x01},
+    {0xC2, {0xA7}, 0x01},
+    {0xC5, {0x18}, 0x81},
+    {0xE0, {0xF0, 0x09, 0x0b, 0x06, 0x04, 0x15, 0x2F, 0x54, 0x42, 0x3C, 0x17, 0x14, 0x18, 0x1B}, 0x0F},
+    {0xE1, {0xE0, 0x09, 0x0b, 0x06, 0x04, 0x03, 0x2B, 0x43, 0x42, 0x3B, 0x16, 0x14, 0x17, 0x1B}, 0x8F},
+    {0xF0, {0x3c}, 0x01},
+    {0xF0, {0x69}, 0x81},
+    {0x21, {0x00}, 0x01},
+    {0x29, {0x00}, 0x01},
+};
+#define INIT_LIST_LEN   (sizeof(init_list) / sizeof(init_list[0]))
+// Commands with a delay split the table
+#define INIT_TRANSACTIONS   6
+
+static const DispRotationConfig_t rotation_config[4] = {
+    {0xE8, TEST_HEIGHT, TEST_WIDTH, 0, 49},
+    {0x48, TEST_WIDTH, TEST_HEIGHT, 49, 0},
+    {0x28, TEST_HEIGHT, TEST_WIDTH, 0, 49},
+    {0x88, TEST_WIDTH, TEST_HEIGHT, 49, 0},
+};
+
+struct command_t {
+    uint32_t transaction;
+    uint8_t cmd;
+    std::vector<uint8_t> params;
+};
+
+// Splits the recorded writes into commands, the data written after a command are its parameters
+static std::vector<command_t> decode(const std::vector<host_spi_write_t> &writes)
+{
+    std::vector<command_t> out;
+    for (const host_spi_write_t &w : writes) {
+        if (w.command) {
+            for (uint8_t b : w.bytes) {
+                out.push_back({w.transaction, b, {}});
+            }
+        } else if (!out.empty()) {
+            out.back().params.insert(out.back().params.end(), w.bytes.begin(), w.bytes.end());
+        }
+    }
+    return out;
+}
+
+// Every byte under CS inside a transaction
+static bool all_framed(const std::vector<host_spi_write_t> &writes)
+{
+    for (const host_spi_write_t &w : writes) {
+        if (!w.selected || w.transaction == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void begin(LilyGoDispArduinoSPI &disp)
+{
+    SPI.host_cs = TEST_CS;
+    SPI.host_dc = TEST_DC;
+    SPI.host_clear();
+    CHECK(disp.init(1, 2, 3, TEST_CS, -1, TEST_DC, -1, 40, SPI));
+}
+
+static void test_init_table()
+{
+    LilyGoDispArduinoSPI disp(TEST_WIDTH, TEST_HEIGHT, init_list, INIT_LIST_LEN, rotation_config);
+    begin(disp);
+    CHECK(all_framed(SPI.host_writes));
+    CHECK_EQ(SPI.host_nested, 0);
+    std::vector<command_t> cmds = decode(SPI.host_writes);
+    CHECK(cmds.size() > INIT_LIST_LEN);
+    bool same = cmds.size() > INIT_LIST_LEN;
+    for (size_t i = 0; same && i < INIT_LIST_LEN; i++) {
+        size_t len = init_list[i].len & 0x1F;
+        same = cmds[i].cmd == init_list[i].cmd &&
+               cmds[i].params == std::vector<uint8_t>(init_list[i].data, init_list[i].data + len);
+    }
+    CHECK(same);
+    if (cmds.size() > INIT_LIST_LEN) {
+        // One transaction per run of commands up to a delay, not one per command or byte
+        CHECK_EQ(cmds[INIT_LIST_LEN - 1].transaction, INIT_TRANSACTIONS);
+        // The delayed command closes its transaction
+        CHECK_EQ(cmds[0].transaction, 1);
+        CHECK_EQ(cmds[1].transaction, 2);
+        CHECK_EQ(cmds[2].transaction, 3);
+        CHECK_EQ(cmds[12].transaction, 3);
+        CHECK_EQ(cmds[13].transaction, 4);
+        // Rotation 0 follows
+        CHECK_EQ(cmds[INIT_LIST_LEN].cmd, 0x36);
+        CHECK(cmds[INIT_LIST_LEN].params == std::vector<uint8_t>({rotation_config[0].madCmd}));
+    }
+}
+
+static std::vector<uint8_t> window(uint16_t xs, uint16_t ys, uint16_t xe, uint16_t ye)
+{
+    return {uint8_t(xs >> 8), uint8_t(xs), uint8_t(xe >> 8), uint8_t(xe), uint8_t(ys >> 8), uint8_t(ys), uint8_t(ye >> 8), uint8_t(ye)};
+}
+
+static void test_push_chunks(bool swap)
+{
+    LilyGoDispArduinoSPI disp(TEST_WIDTH, TEST_HEIGHT, init_list, INIT_LIST_LEN, rotation_config);
+    begin(disp);
+    disp.setPushChunkSize(1001);
+    disp.enableSwapBytes(swap);
+    SpiBusHoldStats_t before, after;
+    disp.getBusHoldStats(SPI_BUS_OWNER_DISPLAY, &before);
+
+    const uint16_t x = 5, y = 7, w = 20, h = 30;
+    std::vector<uint16_t> pixels(w * h);
+    for (uint32_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = (uint16_t)(i * 0x0101 + 0x1234);
+    }
+    std::vector<uint16_t> original = pixels;
+    SPI.host_clear();
+    disp.pushColors(x, y, w, h, pixels.data());
+
+    CHECK(all_framed(SPI.host_writes));
+    CHECK_EQ(SPI.host_nested, 0);
+    // 1200 bytes in chunks of 1000, the odd byte of the chunk size is dropped
+    CHECK_EQ(SPI.host_transactions, 2);
+    disp.getBusHoldStats(SPI_BUS_OWNER_DISPLAY, &after);
+    CHECK_EQ(after.locks - before.locks, 2);
+
+    std::vector<command_t> cmds = decode(SPI.host_writes);
+    CHECK_EQ(cmds.size(), 3);
+    if (cmds.size() == 3) {
+        const DispRotationConfig_t &r = rotation_config[0];
+        std::vector<uint8_t> win = window(x + r.offset_x, y + r.offset_y, x + w - 1 + r.offset_x, y + h - 1 + r.offset_y);
+        CHECK(cmds[0].cmd == 0x2A && cmds[0].params == std::vector<uint8_t>(win.begin(), win.begin() + 4));
+        CHECK(cmds[1].cmd == 0x2B && cmds[1].params == std::vector<uint8_t>(win.begin() + 4, win.end()));
+        CHECK_EQ(cmds[2].cmd, 0x2C);
+        CHECK_EQ(cmds[2].transaction, 1);
+        // The pixels follow RAMWR across the chunks, high byte first when swapping
+        std::vector<uint8_t> expect;
+        for (uint16_t p : original) {
+            expect.push_back(swap ? p >> 8 : p & 0xFF);
+            expect.push_back(swap ? p & 0xFF : p >> 8);
+        }
+        CHECK(cmds[2].params == expect);
+    }
+    // The chunk boundary is a transaction boundary
+    CHECK(SPI.host_writes.size() >= 2 && SPI.host_writes.back().transaction == 2 &&
+          SPI.host_writes.back().bytes.size() == 200);
+    // The swap is done on the wire, the caller's buffer is left alone
+    CHECK(pixels == original);
+}
+
+// init ends with fillRect over the screen, one transaction per push chunk
+static void test_init_clear()
+{
+    LilyGoDispArduinoSPI disp(TEST_WIDTH, TEST_HEIGHT, init_list, INIT_LIST_LEN, rotation_config);
+    begin(disp);
+    std::vector<command_t> cmds = decode(SPI.host_writes);
+    CHECK(cmds.size() > 0 && cmds.back().cmd == 0x2C);
+    const size_t bytes = TEST_HEIGHT * TEST_WIDTH * sizeof(uint16_t);
+    if (cmds.size() > 0) {
+        const std::vector<uint8_t> &p = cmds.back().params;
+        CHECK_EQ(p.size(), bytes);
+        bool zero = true;
+        for (uint8_t b : p) {
+            zero &= b == 0;
+        }
+        CHECK(zero);
+        uint32_t chunks = (bytes + CONFIG_ARDUINO_SPI_PUSH_CHUNK_SIZE - 1) / CONFIG_ARDUINO_SPI_PUSH_CHUNK_SIZE;
+        CHECK_EQ(SPI.host_transactions - cmds.back().transaction + 1, chunks);
+    }
+
+    SPI.host_clear();
+    disp.fillRect(3, 4, 5, 6, 0xF81F);
+    cmds = decode(SPI.host_writes);
+    CHECK(cmds.size() == 3 && cmds[2].params.size() == 5 * 6 * 2);
+    bool color = cmds.size() == 3;
+    for (size_t i = 0; color && i < cmds[2].params.size(); i += 2) {
+        color = cmds[2].params[i] == 0xF8 && cmds[2].params[i + 1] == 0x1F;
+    }
+    CHECK(color);
+}
+
+int main(int argc, char **argv)
+{
+    test_init_table();
+    test_init_clear();
+    test_push_chunks(false);
+    test_push_chunks(true);
+    return host_test_result("disp_spi");
+}
@@ -0,0 +1,130 @@
+/**
+ * @file      test_disp_swap.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The RGB565 byte swap of the display drivers at every length and word
+ *            alignment, and with --bench its cost against the generic C path of
+ *            lv_draw_sw_rgb565_swap that disp_flush used before. Both cost about the
+ *            same per pixel, the drivers gain by swapping the next chunk while the
+ *            previous one is on the bus, not from a faster loop.
+ */
+#include "host_test.h"
+#include <vector>
+#include "LilyGoDispSwap.h"
+
+// lv_draw_sw_rgb565_swap of lvgl 9.2 without an assembly LV_DRAW_SW_RGB565_SWAP
+static void lv_rgb565_swap_ref(void *buf, uint32_t buf_size_px)
+{
+    uint32_t u32_cnt = buf_size_px / 2;
+    uint16_t *buf16 = (uint16_t *)buf;
+    uint32_t *buf32 = (uint32_t *)buf;
+
+    while (u32_cnt >= 8) {
+        for (int i = 0; i < 8; i++) {
+            buf32[i] = ((buf32[i] & 0xff00ff00) >> 8) | ((buf32[i] & 0x00ff00ff) << 8);
+        }
+        buf32 += 8;
+        u32_cnt -= 8;
+    }
+    while (u32_cnt) {
+        *buf32 = ((*buf32 & 0xff00ff00) >> 8) | ((*buf32 & 0x00ff00ff) << 8);
+        buf32++;
+        u32_cnt--;
+    }
+    if (buf_size_px & 0x1) {
+        uint32_t e = buf_size_px - 1;
+        buf16[e] = ((buf16[e] & 0xff00) >> 8) | ((buf16[e] & 0x00ff) << 8);
+    }
+}
+
+static uint16_t pixel(uint32_t i)
+{
+    return (uint16_t)(i * 0x9E37 + 0x1234);
+}
+
+// Every pixel in the range swapped, the guard pixels around it untouched
+static void test_lengths()
+{
+    // 32 bit aligned storage, offset 1 starts the range on a half word
+    std::vector<uint32_t> store(64);
+    uint16_t *base = (uint16_t *)store.data();
+    bool ok = true;
+    for (uint32_t offset = 0; offset < 2; offset++) {
+        for (uint32_t len = 0; len <= 100; len++) {
+            for (uint32_t i = 0; i < 128; i++) {
+                base[i] = pixel(i);
+            }
+            disp_swap_rgb565(base + 1 + offset, len);
+            for (uint32_t i = 0; i < 128; i++) {
+                bool inside = i >= 1 + offset && i < 1 + offset + len;
+                uint16_t expect = inside ? (uint16_t)((pixel(i) >> 8) | (pixel(i) << 8)) : pixel(i);
+                if (base[i] != expect) {
+                    fprintf(stderr, "  offset %u len %u pixel %u: %04x != %04x\n", offset, len, i, base[i], expect);
+                    ok = false;
+                }
+            }
+        }
+    }
+    CHECK(ok);
+}
+
+// Swapping twice gives the original pixels back
+static void test_round_trip()
+{
+    std::vector<uint16_t> buf(480 * 37);
+    for (uint32_t i = 0; i < buf.size(); i++) {
+        buf[i] = pixel(i);
+    }
+    disp_swap_rgb565(buf.data(), buf.size());
+    CHECK_EQ(buf[5], (uint16_t)((pixel(5) >> 8) | (pixel(5) << 8)));
+    disp_swap_rgb565(buf.data(), buf.size());
+    bool same = true;
+    for (uint32_t i = 0; i < buf.size(); i++) {
+        same &= buf[i] == pixel(i);
+    }
+    CHECK(same);
+}
+
+static volatile uint32_t bench_sink;
+
+template <typename F>
+static double bench_swap(F swap, uint16_t *p, uint32_t len, uint32_t rounds)
+{
+    uint64_t start = host_test_now_ns();
+    for (uint32_t i = 0; i < rounds; i++) {
+        swap(p, len);
+    }
+    bench_sink += p[len / 2];
+    return (double)(host_test_now_ns() - start) / rounds;
+}
+
+static void bench()
+{
+    // One SEND_BUF_SIZE chunk of the QSPI driver, a 24 line band and a small area
+    const uint32_t lengths[] = {16384, 480 * 24, 64 * 16};
+    std::vector<uint32_t> store(16384 / 2 + 1);
+    uint16_t *buf = (uint16_t *)store.data();
+    printf("RGB565 swap, ns per call\n");
+    printf("pixels,lv_draw_sw_rgb565_swap_ns,disp_swap_rgb565_ns\n");
+    for (uint32_t len : lengths) {
+        uint32_t rounds = 200000000 / len;
+        for (uint32_t i = 0; i < len; i++) {
+            buf[i] = pixel(i);
+        }
+        double lv_ns = bench_swap(lv_rgb565_swap_ref, buf, len, rounds);
+        double disp_ns = bench_swap(disp_swap_rgb565, buf, len, rounds);
+        printf("%u,%.1f,%.1f\n", len, lv_ns, disp_ns);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    test_lengths();
+    test_round_trip();
+    if (host_test_bench(argc, argv)) {
+        bench();
+    }
+    return host_test_result("disp_swap");
+}
@@ -0,0 +1,273 @@
+/**
+ * @file      test_event_manage.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      LilyGoEventManage dispatch rules, and with --bench the cost of sendEvent
+ *            against the former vector registry with many registered callbacks.
+ */
+#include "host_test.h"
+#include <vector>
+#include "LilyGoEventManage.h"
+
+static LilyGoEventManage *manage;
+static uint32_t calls[8];
+static DeviceEvent_t last_event;
+
+static void cb0(DeviceEvent_t event, void *params, void *user_data)
+{
+    calls[0]++;
+    last_event = event;
+}
+
+static void cb1(DeviceEvent_t event, void *params, void *user_data)
+{
+    calls[1]++;
+}
+
+static void cb2(DeviceEvent_t event, void *params, void *user_data)
+{
+    calls[2]++;
+}
+
+// Removes cb1 and cb2, adds cb1 again
+static void cb_remover(DeviceEvent_t event, void *params, void *user_data)
+{
+    calls[3]++;
+    manage->removeEvent(cb1, POWER_EVENT);
+    manage->removeEvent(cb2, POWER_EVENT);
+    manage->onEvent(cb1, POWER_EVENT, NULL);
+}
+
+static void cb_self_remove(DeviceEvent_t event, void *params, void *user_data)
+{
+    calls[4]++;
+    manage->removeEvent(cb_self_remove, POWER_EVENT);
+}
+
+static void cb_adder(DeviceEvent_t event, void *params, void *user_data)
+{
+    calls[5]++;
+    manage->onEvent(cb2, POWER_EVENT, NULL);
+}
+
+// Removes cb1 and sends the event again while the first dispatch still runs
+static void cb_nested(DeviceEvent_t event, void *params, void *user_data)
+{
+    calls[6]++;
+    if (calls[6] == 1) {
+        manage->removeEvent(cb1, POWER_EVENT);
+        manage->sendEvent(POWER_EVENT);
+    }
+}
+
+static void reset_calls()
+{
+    memset(calls, 0, sizeof(calls));
+}
+
+static void test_buckets()
+{
+    LilyGoEventManage m;
+    reset_calls();
+    m.onEvent(cb0, POWER_EVENT, NULL);
+    m.onEvent(cb1, SENSOR_EVENT, NULL);
+    m.onEvent(cb2, NULL, ALL_EVENT_MAX);
+    m.sendEvent(SENSOR_EVENT);
+    CHECK_EQ(calls[0], 0);
+    CHECK_EQ(calls[1], 1);
+    CHECK_EQ(calls[2], 1);
+    m.sendEvent(POWER_EVENT);
+    CHECK_EQ(calls[0], 1);
+    CHECK_EQ(last_event, POWER_EVENT);
+    CHECK_EQ(calls[2], 2);
+    // ALL_EVENT_MAX is not an event that can be sent
+    m.sendEvent(ALL_EVENT_MAX);
+    CHECK_EQ(calls[2], 2);
+}
+
+static void test_duplicate_and_full()
+{
+    LilyGoEventManage m;
+    m.onEvent(cb0, POWER_EVENT, NULL);
+    m.onEvent(cb0, POWER_EVENT, NULL);
+    CHECK_EQ(m.findEvent(cb0, POWER_EVENT), 0);
+    CHECK_EQ(m.findEvent(cb1, POWER_EVENT), CONFIG_EVENT_CALLBACKS_PER_TYPE);
+    // The same callback may be registered for another event
+    m.onEvent(cb0, SENSOR_EVENT, NULL);
+    CHECK_EQ(m.findEvent(cb0, SENSOR_EVENT), 0);
+    m.removeEvent(cb0, POWER_EVENT);
+    CHECK_EQ(m.findEvent(cb0, POWER_EVENT), CONFIG_EVENT_CALLBACKS_PER_TYPE);
+    CHECK_EQ(m.findEvent(cb0, SENSOR_EVENT), 0);
+}
+
+static void test_remove_during_dispatch()
+{
+    LilyGoEventManage m;
+    manage = &m;
+    reset_calls();
+    m.onEvent(cb_remover, POWER_EVENT, NULL);
+    m.onEvent(cb1, POWER_EVENT, NULL);
+    m.onEvent(cb2, POWER_EVENT, NULL);
+    m.sendEvent(POWER_EVENT);
+    // cb1 was removed and added again before its turn, the new registration waits
+    // for the next event, cb2 is gone
+    CHECK_EQ(calls[3], 1);
+    CHECK_EQ(calls[1], 0);
+    CHECK_EQ(calls[2], 0);
+    // Compacted after the dispatch
+    CHECK_EQ(m.findEvent(cb1, POWER_EVENT), 1);
+    CHECK_EQ(m.findEvent(cb2, POWER_EVENT), CONFIG_EVENT_CALLBACKS_PER_TYPE);
+    m.removeEvent(cb_remover, POWER_EVENT);
+    m.sendEvent(POWER_EVENT);
+    CHECK_EQ(calls[1], 1);
+    CHECK_EQ(m.findEvent(cb1, POWER_EVENT), 0);
+}
+
+static void test_self_remove_and_add()
+{
+    LilyGoEventManage m;
+    manage = &m;
+    reset_calls();
+    m.onEvent(cb_self_remove, POWER_EVENT, NULL);
+    m.onEvent(cb_adder, POWER_EVENT, NULL);
+    m.sendEvent(POWER_EVENT);
+    CHECK_EQ(calls[4], 1);
+    CHECK_EQ(calls[5], 1);
+    // Added during the dispatch, only called from the next event on
+    CHECK_EQ(calls[2], 0);
+    m.sendEvent(POWER_EVENT);
+    CHECK_EQ(calls[4], 1);
+    CHECK_EQ(calls[5], 2);
+    CHECK_EQ(calls[2], 1);
+}
+
+static void test_nested_dispatch()
+{
+    LilyGoEventManage m;
+    manage = &m;
+    reset_calls();
+    m.onEvent(cb_nested, POWER_EVENT, NULL);
+    m.onEvent(cb1, POWER_EVENT, NULL);
+    m.onEvent(cb2, POWER_EVENT, NULL);
+    // The nested dispatch sees the removed slot before it is compacted
+    m.sendEvent(POWER_EVENT);
+    CHECK_EQ(calls[6], 2);
+    CHECK_EQ(calls[1], 0);
+    CHECK_EQ(calls[2], 2);
+    CHECK_EQ(m.findEvent(cb2, POWER_EVENT), 1);
+}
+
+static void test_fill_after_removal()
+{
+    static DeviceEventCb_t fill[] = {
+        [](DeviceEvent_t, void *, void *) {}, [](DeviceEvent_t, void *, void *) {},
+        [](DeviceEvent_t, void *, void *) {}, [](DeviceEvent_t, void *, void *) {},
+        [](DeviceEvent_t, void *, void *) {}, [](DeviceEvent_t, void *, void *) {},
+        [](DeviceEvent_t, void *, void *) {}, [](DeviceEvent_t, void *, void *) {},
+    };
+    static_assert(sizeof(fill) / sizeof(fill[0]) == CONFIG_EVENT_CALLBACKS_PER_TYPE, "one per slot");
+    LilyGoEventManage m;
+    for (auto cb : fill) {
+        m.onEvent(cb, BUTTON_EVENT, NULL);
+    }
+    m.onEvent(cb0, BUTTON_EVENT, NULL);
+    CHECK_EQ(m.findEvent(cb0, BUTTON_EVENT), CONFIG_EVENT_CALLBACKS_PER_TYPE);
+    m.removeEvent(fill[3], BUTTON_EVENT);
+    m.onEvent(cb0, BUTTON_EVENT, NULL);
+    CHECK_EQ(m.findEvent(cb0, BUTTON_EVENT), CONFIG_EVENT_CALLBACKS_PER_TYPE - 1);
+    CHECK_EQ(m.findEvent(fill[4], BUTTON_EVENT), 3);
+}
+
+// The registry before the buckets, kept to compare the dispatch cost
+class VectorEventManage
+{
+    std::vector < DeviceEventCbList_t > cbEventList;
+public:
+    void onEvent(DeviceEventCb_t cbEvent, DeviceEvent_t event, void *user_data)
+    {
+        DeviceEventCbList_t newEventHandler;
+        newEventHandler.cb = cbEvent;
+        newEventHandler.user_data = user_data;
+        newEventHandler.event = event;
+        cbEventList.push_back(newEventHandler);
+    }
+    void sendEvent(DeviceEvent_t event, void *params = NULL)
+    {
+        for (uint32_t i = 0; i < cbEventList.size(); i++) {
+            DeviceEventCbList_t entry = cbEventList[i];
+            if (entry.cb && entry.event == event || entry.event == ALL_EVENT_MAX) {
+                entry.cb(event, params, entry.user_data);
+            }
+        }
+    }
+};
+
+static volatile uint32_t bench_sink;
+
+static void bench_cb(DeviceEvent_t event, void *params, void *user_data)
+{
+    bench_sink += (uintptr_t)user_data;
+}
+
+template <typename T>
+static void bench_register(T &m, uint32_t per_type)
+{
+    // Distinct callbacks so the bucketed registry accepts them
+    static DeviceEventCb_t cbs[] = {
+        [](DeviceEvent_t e, void *p, void *u) { bench_cb(e, p, u); },
+        [](DeviceEvent_t e, void *p, void *u) { bench_cb(e, p, u); },
+        [](DeviceEvent_t e, void *p, void *u) { bench_cb(e, p, u); },
+        [](DeviceEvent_t e, void *p, void *u) { bench_cb(e, p, u); },
+        [](DeviceEvent_t e, void *p, void *u) { bench_cb(e, p, u); },
+        [](DeviceEvent_t e, void *p, void *u) { bench_cb(e, p, u); },
+        [](DeviceEvent_t e, void *p, void *u) { bench_cb(e, p, u); },
+        [](DeviceEvent_t e, void *p, void *u) { bench_cb(e, p, u); },
+    };
+    for (uint32_t e = POWER_EVENT; e < ALL_EVENT_MAX; e++) {
+        for (uint32_t i = 0; i < per_type; i++) {
+            m.onEvent(cbs[i], (DeviceEvent_t)e, (void *)(uintptr_t)1);
+        }
+    }
+}
+
+template <typename T>
+static double bench_dispatch(T &m, uint32_t rounds)
+{
+    uint64_t start = host_test_now_ns();
+    for (uint32_t i = 0; i < rounds; i++) {
+        m.sendEvent(SENSOR_EVENT);
+    }
+    return (double)(host_test_now_ns() - start) / rounds;
+}
+
+static void bench()
+{
+    const uint32_t rounds = 2000000;
+    printf("sendEvent(SENSOR_EVENT), callbacks per event type, ns per event\n");
+    printf("per_type,registered,vector_ns,bucket_ns\n");
+    for (uint32_t per_type = 1; per_type <= CONFIG_EVENT_CALLBACKS_PER_TYPE; per_type *= 2) {
+        VectorEventManage v;
+        LilyGoEventManage b;
+        bench_register(v, per_type);
+        bench_register(b, per_type);
+        double v_ns = bench_dispatch(v, rounds);
+        double b_ns = bench_dispatch(b, rounds);
+        printf("%u,%u,%.1f,%.1f\n", per_type, per_type * (ALL_EVENT_MAX - POWER_EVENT), v_ns, b_ns);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    test_buckets();
+    test_duplicate_and_full();
+    test_remove_during_dispatch();
+    test_self_remove_and_add();
+    test_nested_dispatch();
+    test_fill_after_removal();
+    if (host_test_bench(argc, argv)) {
+        bench();
+    }
+    return host_test_result("event_manage");
+}
@@ -0,0 +1,386 @@
+/**
+ * @file      test_flush_merge.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The flush merge cost model, and with --bench a replay of invalidation traces
+ *            through a model of the lvgl 9.2 invalidate, join and partial render steps,
+ *            with and without merging. --bench FILE replays a recorded trace instead of
+ *            the built in ones: one "x1 y1 x2 y2" area per line as lv_inv_area got it,
+ *            an empty line ends a refresh.
+ */
+#include "host_test.h"
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include "LV_FlushMerge.h"
+
+// T-LoRa-Pager panel and the default partial draw buffer of LV_Helper_v9.cpp
+#define SIM_WIDTH           480
+#define SIM_HEIGHT          222
+#define SIM_BUF_LINES       (SIM_HEIGHT / 6)
+#define SIM_COST_PX         256
+// LV_INV_BUF_SIZE
+#define SIM_INV_BUF_SIZE    32
+// CASET, RASET and RAMWR with their parameters
+#define SIM_WINDOW_BYTES    11
+
+typedef std::vector<lv_area_t> sim_frame_t;
+typedef std::vector<sim_frame_t> sim_trace_t;
+
+struct lv_sim {
+    bool merge;
+    bool check;                     // Record the rendered pixels for sim_covers()
+    lv_area_t inv_areas[SIM_INV_BUF_SIZE];
+    uint8_t inv_area_joined[SIM_INV_BUF_SIZE];
+    uint32_t inv_p;
+    lv_flush_merge_stats_t stats;
+    uint64_t flushes;
+    uint64_t px;
+    std::vector<uint8_t> drawn;     // Pixels rendered in the current refresh
+};
+
+// The rounder of the boards with aligned areas
+static void sim_round(lv_area_t *area)
+{
+    if (!(area->x2 & 1))
+        area->x2++;
+    if (area->y1 & 1)
+        area->y1--;
+    if (!(area->y2 & 1))
+        area->y2++;
+}
+
+// lv_inv_area
+static void sim_invalidate(lv_sim &s, const lv_area_t &in)
+{
+    lv_area_t scr, area;
+    lv_area_set(&scr, 0, 0, SIM_WIDTH - 1, SIM_HEIGHT - 1);
+    if (!lv_area_intersect(&area, &in, &scr)) {
+        return;
+    }
+    // LV_EVENT_INVALIDATE_AREA, the rounder then the merge as registered
+    sim_round(&area);
+    if (s.merge) {
+        lv_flush_merge_area(&area, s.inv_areas, s.inv_p, SIM_COST_PX, SIM_WIDTH * SIM_BUF_LINES, &s.stats);
+    }
+    for (uint32_t i = 0; i < s.inv_p; i++) {
+        if (lv_area_is_in(&area, &s.inv_areas[i], 0)) {
+            return;
+        }
+    }
+    if (s.inv_p >= SIM_INV_BUF_SIZE) {
+        s.inv_p = 0;
+        area = scr;
+    }
+    s.inv_areas[s.inv_p] = area;
+    s.inv_area_joined[s.inv_p] = 0;
+    s.inv_p++;
+}
+
+// lv_refr_join_area, then every area left rendered in bands of the draw buffer
+static void sim_refresh(lv_sim &s)
+{
+    for (uint32_t in = 0; in < s.inv_p; in++) {
+        if (s.inv_area_joined[in]) {
+            continue;
+        }
+        for (uint32_t from = 0; from < s.inv_p; from++) {
+            if (s.inv_area_joined[from] || in == from) {
+                continue;
+            }
+            if (!lv_area_is_on(&s.inv_areas[in], &s.inv_areas[from])) {
+                continue;
+            }
+            lv_area_t join;
+            lv_area_join(&join, &s.inv_areas[in], &s.inv_areas[from]);
+            if (lv_area_get_size(&join) < lv_area_get_size(&s.inv_areas[in]) + lv_area_get_size(&s.inv_areas[from])) {
+                s.inv_areas[in] = join;
+                s.inv_area_joined[from] = 1;
+            }
+        }
+    }
+    if (s.check) {
+        s.drawn.assign(SIM_WIDTH * SIM_HEIGHT, 0);
+    }
+    for (uint32_t i = 0; i < s.inv_p; i++) {
+        if (s.inv_area_joined[i]) {
+            continue;
+        }
+        const lv_area_t *a = &s.inv_areas[i];
+        uint32_t rows = (SIM_WIDTH * SIM_BUF_LINES) / lv_area_get_width(a);
+        s.flushes += (lv_area_get_height(a) + rows - 1) / rows;
+        s.px += lv_area_get_size(a);
+        for (int32_t y = a->y1; s.check && y <= a->y2; y++) {
+            memset(&s.drawn[y * SIM_WIDTH + a->x1], 1, lv_area_get_width(a));
+        }
+    }
+    s.inv_p = 0;
+}
+
+static bool sim_covers(const lv_sim &s, const sim_frame_t &frame)
+{
+    for (const lv_area_t &a : frame) {
+        for (int32_t y = a.y1 < 0 ? 0 : a.y1; y <= a.y2 && y < SIM_HEIGHT; y++) {
+            for (int32_t x = a.x1 < 0 ? 0 : a.x1; x <= a.x2 && x < SIM_WIDTH; x++) {
+                if (!s.drawn[y * SIM_WIDTH + x]) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Replays the trace, false if a refresh left an invalidated pixel unrendered
+static bool sim_replay(lv_sim &s, const sim_trace_t &trace)
+{
+    bool covered = true;
+    for (const sim_frame_t &frame : trace) {
+        for (const lv_area_t &a : frame) {
+            sim_invalidate(s, a);
+        }
+        sim_refresh(s);
+        covered &= !s.check || sim_covers(s, frame);
+    }
+    return covered;
+}
+
+static lv_area_t area_of(int32_t x1, int32_t y1, int32_t x2, int32_t y2)
+{
+    lv_area_t a;
+    lv_area_set(&a, x1, y1, x2, y2);
+    return a;
+}
+
+// The factory monitor page: value labels in two columns, a chart drawing one new
+// point per refresh and a spinner
+static sim_trace_t trace_monitor(uint32_t frames)
+{
+    sim_trace_t trace;
+    for (uint32_t f = 0; f < frames; f++) {
+        sim_frame_t frame;
+        for (int32_t row = 0; row < 8; row++) {
+            frame.push_back(area_of(90, 20 + row * 18, 90 + 40 + (f + row) % 20, 20 + row * 18 + 15));
+            frame.push_back(area_of(330, 20 + row * 18, 330 + 50, 20 + row * 18 + 15));
+        }
+        int32_t x = 20 + (f * 3) % 400;
+        int32_t y = 170 + (int32_t)((f * 7) % 40);
+        frame.push_back(area_of(x, y - 6, x + 3, y + 6));
+        frame.push_back(area_of(x + 4, 165, x + 7, 215));
+        int32_t a = f % 8;
+        frame.push_back(area_of(440 + (a & 3) * 6, 180 + (a >> 2) * 12, 440 + (a & 3) * 6 + 11, 180 + (a >> 2) * 12 + 11));
+        trace.push_back(frame);
+    }
+    return trace;
+}
+
+// Typing into a text area: the new glyph, the cursor and the character counter
+static sim_trace_t trace_typing(uint32_t frames)
+{
+    sim_trace_t trace;
+    for (uint32_t f = 0; f < frames; f++) {
+        sim_frame_t frame;
+        int32_t col = f % 50;
+        int32_t line = (f / 50) % 6;
+        frame.push_back(area_of(10 + col * 9, 30 + line * 20, 10 + col * 9 + 8, 30 + line * 20 + 17));
+        frame.push_back(area_of(10 + col * 9 + 9, 30 + line * 20, 10 + col * 9 + 10, 30 + line * 20 + 17));
+        frame.push_back(area_of(10 + col * 9 - 1, 30 + line * 20, 10 + col * 9, 30 + line * 20 + 17));
+        frame.push_back(area_of(420, 200, 470, 215));
+        trace.push_back(frame);
+    }
+    return trace;
+}
+
+// A list scrolling, every refresh invalidates the whole list body and the scrollbar
+static sim_trace_t trace_scroll(uint32_t frames)
+{
+    sim_trace_t trace;
+    for (uint32_t f = 0; f < frames; f++) {
+        sim_frame_t frame;
+        frame.push_back(area_of(0, 24, 469, 221));
+        int32_t y = 24 + (f * 5) % 150;
+        frame.push_back(area_of(472, y, 477, y + 40));
+        frame.push_back(area_of(0, 0, 479, 23));
+        trace.push_back(frame);
+    }
+    return trace;
+}
+
+static void test_adjacent()
+{
+    lv_area_t queued[] = {area_of(0, 0, 59, 15)};
+    lv_area_t area = area_of(0, 16, 59, 31);
+    lv_flush_merge_stats_t stats = {};
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 1, SIM_COST_PX, 0, &stats), 1);
+    CHECK_EQ(area.y1, 0);
+    CHECK_EQ(area.y2, 31);
+    CHECK_EQ(stats.areas, 1);
+    CHECK_EQ(stats.merged, 1);
+    CHECK_EQ(stats.extra_px, 0);
+}
+
+static void test_cost()
+{
+    // A 2 line gap over 16 columns adds 32 pixels
+    lv_area_t queued[] = {area_of(0, 0, 15, 15)};
+    lv_area_t area = area_of(0, 18, 15, 33);
+    lv_flush_merge_stats_t stats = {};
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 1, SIM_COST_PX, 0, &stats), 1);
+    CHECK_EQ(stats.extra_px, 32);
+    CHECK_EQ(lv_area_get_size(&area), 16 * 34);
+    // Too expensive at a lower cost
+    area = area_of(0, 18, 15, 33);
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 1, 31, 0, NULL), 0);
+    CHECK_EQ(area.y1, 18);
+    // Far apart
+    area = area_of(200, 100, 215, 115);
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 1, SIM_COST_PX, 0, NULL), 0);
+}
+
+// The grown area reaches a queued area it could not merge with before
+static void test_chain()
+{
+    lv_area_t queued[] = {area_of(40, 0, 55, 15), area_of(0, 0, 15, 15), area_of(300, 0, 315, 15)};
+    lv_area_t area = area_of(16, 0, 39, 15);
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 3, SIM_COST_PX, 0, NULL), 2);
+    CHECK_EQ(area.x1, 0);
+    CHECK_EQ(area.x2, 55);
+}
+
+static void test_buffer_limit()
+{
+    // 1400 pixels, 1500 together
+    lv_area_t queued[] = {area_of(0, 0, 99, 6)};
+    lv_area_t area = area_of(0, 8, 99, 14);
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 1, SIM_COST_PX, 1500, NULL), 1);
+    area = area_of(0, 8, 99, 14);
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 1, SIM_COST_PX, 1450, NULL), 0);
+    // Areas not fitting the buffer anyway are still merged
+    area = area_of(0, 8, 99, 14);
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 1, SIM_COST_PX, 1000, NULL), 1);
+}
+
+static void test_contained()
+{
+    // Inside a queued area, lvgl drops the grown area as a duplicate
+    lv_area_t queued[] = {area_of(0, 0, 99, 99)};
+    lv_area_t area = area_of(10, 10, 19, 19);
+    lv_flush_merge_stats_t stats = {};
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 1, SIM_COST_PX, 0, &stats), 1);
+    CHECK_EQ(lv_area_get_size(&area), 100 * 100);
+    CHECK_EQ(stats.extra_px, 0);
+    // Covering a queued area, left to the lvgl join
+    area = area_of(0, 0, 199, 199);
+    CHECK_EQ(lv_flush_merge_area(&area, queued, 1, SIM_COST_PX, 0, NULL), 0);
+    CHECK_EQ(area.x2, 199);
+}
+
+// Through the lvgl model every invalidated pixel is still rendered, with fewer flushes
+static void test_replay()
+{
+    const sim_trace_t traces[] = {trace_monitor(200), trace_typing(200), trace_scroll(50)};
+    for (const sim_trace_t &trace : traces) {
+        lv_sim plain = {};
+        lv_sim merged = {};
+        plain.check = true;
+        merged.check = true;
+        merged.merge = true;
+        CHECK(sim_replay(plain, trace));
+        CHECK(sim_replay(merged, trace));
+        CHECK(merged.flushes <= plain.flushes);
+    }
+    lv_sim plain = {};
+    lv_sim merged = {};
+    merged.merge = true;
+    sim_replay(plain, traces[0]);
+    sim_replay(merged, traces[0]);
+    CHECK(merged.flushes < plain.flushes);
+}
+
+static bool load_trace(const char *path, sim_trace_t &trace)
+{
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return false;
+    }
+    char line[128];
+    sim_frame_t frame;
+    while (fgets(line, sizeof(line), fp)) {
+        lv_area_t a;
+        if (sscanf(line, "%d %d %d %d", &a.x1, &a.y1, &a.x2, &a.y2) == 4) {
+            frame.push_back(a);
+        } else if (!frame.empty()) {
+            trace.push_back(frame);
+            frame.clear();
+        }
+    }
+    if (!frame.empty()) {
+        trace.push_back(frame);
+    }
+    fclose(fp);
+    return true;
+}
+
+static void bench_trace(const char *name, const sim_trace_t &trace)
+{
+    lv_sim plain = {};
+    lv_sim merged = {};
+    merged.merge = true;
+    uint64_t start = host_test_now_ns();
+    sim_replay(plain, trace);
+    uint64_t plain_ns = host_test_now_ns() - start;
+    start = host_test_now_ns();
+    sim_replay(merged, trace);
+    uint64_t merged_ns = host_test_now_ns() - start;
+    // Pixel data plus the address window commands of every flush
+    uint64_t plain_bytes = plain.px * 2 + plain.flushes * SIM_WINDOW_BYTES;
+    uint64_t merged_bytes = merged.px * 2 + merged.flushes * SIM_WINDOW_BYTES;
+    uint32_t areas = merged.stats.areas ? merged.stats.areas : 1;
+    printf("%s,%zu,%u,%llu,%llu,%lld,%llu,%llu,%lld,%.0f\n", name, trace.size(), merged.stats.areas,
+           (unsigned long long)plain.flushes, (unsigned long long)merged.flushes,
+           (long long)plain.flushes - (long long)merged.flushes,
+           (unsigned long long)plain_bytes, (unsigned long long)merged_bytes,
+           (long long)plain_bytes - (long long)merged_bytes,
+           ((double)merged_ns - (double)plain_ns) / areas);
+}
+
+static void bench(int argc, char **argv)
+{
+    printf("Invalidation replay, %dx%d, %d line draw buffer, merge cost %d px\n",
+           SIM_WIDTH, SIM_HEIGHT, SIM_BUF_LINES, SIM_COST_PX);
+    // A flush costs CONFIG_LV_FLUSH_MERGE_COST_PX pixels of bus time, so a merge may send
+    // more bytes and still save time, bytes_saved is then negative
+    printf("trace,refreshes,areas,lvgl_flushes,merged_flushes,flushes_saved,"
+           "lvgl_bytes,merged_bytes,bytes_saved,merge_ns_per_area\n");
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--bench") == 0) {
+            continue;
+        }
+        sim_trace_t trace;
+        if (load_trace(argv[i], trace)) {
+            bench_trace(argv[i], trace);
+        } else {
+            printf("%s: cannot open\n", argv[i]);
+        }
+        return;
+    }
+    bench_trace("monitor", trace_monitor(2000));
+    bench_trace("typing", trace_typing(2000));
+    bench_trace("scroll", trace_scroll(500));
+}
+
+int main(int argc, char **argv)
+{
+    test_adjacent();
+    test_cost();
+    test_chain();
+    test_buffer_limit();
+    test_contained();
+    test_replay();
+    if (host_test_bench(argc, argv)) {
+        bench(argc, argv);
+    }
+    return host_test_result("flush_merge");
+}
@@ -0,0 +1,149 @@
+/**
+ * @file      test_keyboard.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The keyboard event queue between the FIFO drain and getKey, polled and
+ *            with the interrupt task running on its own thread against a consumer
+ *            thread. The raw callback reports every event in queue order.
+ */
+#include "host_test.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "LilyGoKeyboard.h"
+
+static const LilyGoKeyboardConfigure_t config = {4, 10};
+static TwoWire wire;
+static std::vector<uint8_t> received;
+static std::atomic<uint32_t> consumed;
+
+static void raw_cb(bool pressed, uint8_t raw)
+{
+    received.push_back(raw | (pressed ? 0x80 : 0));
+    consumed++;
+}
+
+static void reset_received()
+{
+    received.clear();
+    consumed = 0;
+}
+
+// Never 0 (no event) nor KB_RAW_REPEAT
+static uint8_t raw_of(uint32_t i)
+{
+    return 1 + (i % 126);
+}
+
+// Without an interrupt pin getKey drains the FIFO at most every 100 ms
+static void poll(LilyGoKeyboard &kb)
+{
+    host_time_advance_us(200000);
+    kb.getKey(NULL);
+}
+
+static void test_polled_order()
+{
+    LilyGoKeyboard kb;
+    CHECK(kb.begin(config, wire, 0));
+    kb.setRawCallback(raw_cb);
+    reset_received();
+    for (uint32_t i = 0; i < 5; i++) {
+        kb.host_key(raw_of(i) | 0x80);
+    }
+    poll(kb);
+    CHECK_EQ(received.size(), 5);
+    for (uint32_t i = 0; i < received.size(); i++) {
+        CHECK_EQ(received[i], raw_of(i) | 0x80);
+    }
+    CHECK_EQ(kb.getDroppedEvents(), 0);
+}
+
+// A drain larger than the queue keeps the oldest events and counts the rest
+static void test_overflow()
+{
+    LilyGoKeyboard kb;
+    kb.host_fifo_size = 2 * CONFIG_KEYBOARD_EVENT_QUEUE_SIZE;
+    CHECK(kb.begin(config, wire, 0));
+    kb.setRawCallback(raw_cb);
+    reset_received();
+    const uint32_t burst = CONFIG_KEYBOARD_EVENT_QUEUE_SIZE + 16;
+    for (uint32_t i = 0; i < burst; i++) {
+        kb.host_key(raw_of(i));
+    }
+    poll(kb);
+    CHECK_EQ(kb.getDroppedEvents(), 16);
+    CHECK_EQ(received.size(), CONFIG_KEYBOARD_EVENT_QUEUE_SIZE);
+    bool in_order = true;
+    for (uint32_t i = 0; i < received.size(); i++) {
+        in_order &= received[i] == raw_of(i);
+    }
+    CHECK(in_order);
+    // Usable again after the wrap
+    reset_received();
+    for (uint32_t i = 0; i < 3; i++) {
+        kb.host_key(raw_of(100 + i));
+    }
+    poll(kb);
+    CHECK_EQ(received.size(), 3);
+    CHECK(received.size() == 3 && received[2] == raw_of(102));
+}
+
+// The interrupt task produces on its thread while another thread calls getKey. The
+// keys stay within the queue size of the consumer and are retried while the chip FIFO
+// is full, so nothing may be lost, duplicated or reordered across many ring wraps
+static void test_threads()
+{
+    const uint8_t irq = 7;
+    const uint32_t total = 5000;
+    LilyGoKeyboard kb;
+    kb.host_irq_pin = irq;
+    host_pin_write(irq, HIGH);
+    CHECK(kb.begin(config, wire, irq));
+    kb.setRawCallback(raw_cb);
+    reset_received();
+
+    std::thread consumer([&kb, total]() {
+        while (consumed < total) {
+            if (kb.getKey(NULL) < 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    uint64_t deadline = host_test_now_ns() + 20000000000ULL;
+    for (uint32_t i = 0; i < total && host_test_now_ns() < deadline;) {
+        if (i - consumed >= CONFIG_KEYBOARD_EVENT_QUEUE_SIZE - 16 || !kb.host_key(raw_of(i))) {
+            std::this_thread::yield();
+            continue;
+        }
+        i++;
+    }
+    while (consumed < total && host_test_now_ns() < deadline) {
+        std::this_thread::yield();
+    }
+    CHECK_EQ(consumed, total);
+    if (consumed < total) {
+        // Let the consumer finish so the test can report
+        consumed = total;
+    }
+    consumer.join();
+    kb.end();
+
+    CHECK_EQ(kb.getDroppedEvents(), 0);
+    CHECK_EQ(received.size(), total);
+    bool in_order = received.size() == total;
+    for (uint32_t i = 0; in_order && i < total; i++) {
+        in_order = received[i] == raw_of(i);
+    }
+    CHECK(in_order);
+}
+
+int main(int argc, char **argv)
+{
+    test_polled_order();
+    test_overflow();
+    test_threads();
+    return host_test_result("keyboard");
+}
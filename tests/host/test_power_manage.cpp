@@ -0,0 +1,169 @@
+/**
+ * @file      test_power_manage.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      PMU interrupt decoding, and readPowerEvent() replayed over a fake AXP2101
+ *            register map.
+ */
+#include "host_test.h"
+#include "LilyGoPowerManage.h"
+
+static const struct {
+    uint32_t irq;
+    PMUEventType_t event;
+} mapped[] = {
+    {XPOWERS_AXP2101_WARNING_LEVEL2_IRQ,    PMU_EVENT_LOW_VOLTAGE_LEVEL2},
+    {XPOWERS_AXP2101_WARNING_LEVEL1_IRQ,    PMU_EVENT_LOW_VOLTAGE_LEVEL1},
+    {XPOWERS_AXP2101_BAT_CHG_OVER_TEMP_IRQ, PMU_EVENT_CHARGE_HIGH_TEMP},
+    {XPOWERS_AXP2101_VBUS_INSERT_IRQ,       PMU_EVENT_USBC_INSERT},
+    {XPOWERS_AXP2101_VBUS_REMOVE_IRQ,       PMU_EVENT_USBC_REMOVE},
+    {XPOWERS_AXP2101_BAT_INSERT_IRQ,        PMU_EVENT_BATTERY_INSERT},
+    {XPOWERS_AXP2101_BAT_REMOVE_IRQ,        PMU_EVENT_BATTERY_REMOVE},
+    {XPOWERS_AXP2101_PKEY_SHORT_IRQ,        PMU_EVENT_KEY_CLICKED},
+    {XPOWERS_AXP2101_PKEY_LONG_IRQ,         PMU_EVENT_KEY_LONG_PRESSED},
+    {XPOWERS_AXP2101_BATFET_OVER_CURR_IRQ,  PMU_EVENT_BAT_FET_OVER_CURRENT},
+    {XPOWERS_AXP2101_BAT_CHG_DONE_IRQ,      PMU_EVENT_CHARGE_FINISH},
+    {XPOWERS_AXP2101_BAT_CHG_START_IRQ,     PMU_EVENT_CHARGE_STARTED},
+    {XPOWERS_AXP2101_CHAGER_TIMER_IRQ,      PMU_EVENT_CHARGE_TIMEOUT},
+    {XPOWERS_AXP2101_BAT_OVER_VOL_IRQ,      PMU_EVENT_BATTERY_OVER_VOLTAGE},
+};
+
+#define MAPPED_COUNT    (sizeof(mapped) / sizeof(mapped[0]))
+
+static void test_single_bits()
+{
+    uint32_t all = 0;
+    for (uint32_t i = 0; i < MAPPED_COUNT; i++) {
+        PMUEventType_t last = PMU_EVENT_NONE;
+        CHECK_EQ(LilyGoPowerManage::decodeIrqStatus(mapped[i].irq, true, &last), _BV(mapped[i].event));
+        CHECK_EQ(last, mapped[i].event);
+        all |= mapped[i].irq;
+    }
+    // Every other status bit has no event
+    for (uint32_t bit = 0; bit < 24; bit++) {
+        if (!(all & _BV(bit))) {
+            PMUEventType_t last = PMU_EVENT_KEY_CLICKED;
+            CHECK_EQ(LilyGoPowerManage::decodeIrqStatus(_BV(bit), true, &last), 0);
+            CHECK_EQ(last, PMU_EVENT_NONE);
+        }
+    }
+}
+
+static void test_batch()
+{
+    uint32_t status = 0, expect = 0;
+    for (uint32_t i = 0; i < MAPPED_COUNT; i++) {
+        status |= mapped[i].irq;
+        expect |= _BV(mapped[i].event);
+    }
+    PMUEventType_t last;
+    CHECK_EQ(LilyGoPowerManage::decodeIrqStatus(status | 0xFF000000, true, &last), expect);
+    // The last one in the former check order
+    CHECK_EQ(last, PMU_EVENT_BATTERY_OVER_VOLTAGE);
+    // 'last' is optional
+    CHECK_EQ(LilyGoPowerManage::decodeIrqStatus(XPOWERS_AXP2101_PKEY_SHORT_IRQ, true, NULL), _BV(PMU_EVENT_KEY_CLICKED));
+}
+
+// A charger without a battery reports start and done on its own, they are not events
+static void test_no_battery()
+{
+    uint32_t status = XPOWERS_AXP2101_BAT_CHG_START_IRQ | XPOWERS_AXP2101_BAT_CHG_DONE_IRQ;
+    PMUEventType_t last;
+    CHECK_EQ(LilyGoPowerManage::decodeIrqStatus(status, false, &last), 0);
+    CHECK_EQ(last, PMU_EVENT_NONE);
+    CHECK_EQ(LilyGoPowerManage::decodeIrqStatus(status | XPOWERS_AXP2101_VBUS_INSERT_IRQ, false, &last),
+             _BV(PMU_EVENT_USBC_INSERT));
+    CHECK_EQ(LilyGoPowerManage::decodeIrqStatus(status, true, &last),
+             _BV(PMU_EVENT_CHARGE_STARTED) | _BV(PMU_EVENT_CHARGE_FINISH));
+}
+
+// One read and one write per interrupt, only enabled bits are events, all read bits cleared
+static void test_read_power_event()
+{
+    XPowersAXP2101 pmu;
+    LilyGoPowerManage manage(&pmu);
+    uint32_t enable = XPOWERS_AXP2101_VBUS_INSERT_IRQ | XPOWERS_AXP2101_PKEY_SHORT_IRQ |
+                      XPOWERS_AXP2101_BAT_CHG_START_IRQ;
+    // The status latches a disabled interrupt too
+    pmu.setIrq(enable, XPOWERS_AXP2101_VBUS_INSERT_IRQ | XPOWERS_AXP2101_PKEY_SHORT_IRQ |
+               XPOWERS_AXP2101_PKEY_LONG_IRQ);
+    host_time_advance_us(1500000);
+    PMUEventRecord_t record;
+    CHECK(manage.readPowerEvent(&record));
+    CHECK_EQ(pmu.reads, 1);
+    CHECK_EQ(pmu.writes, 1);
+    CHECK_EQ(record.irq_status, XPOWERS_AXP2101_VBUS_INSERT_IRQ | XPOWERS_AXP2101_PKEY_SHORT_IRQ);
+    CHECK_EQ(record.mask, _BV(PMU_EVENT_USBC_INSERT) | _BV(PMU_EVENT_KEY_CLICKED));
+    CHECK_EQ(record.type, PMU_EVENT_KEY_CLICKED);
+    CHECK_EQ(record.timestamp, 1500);
+    CHECK_EQ(pmu.irqStatus(), 0);
+
+    // Nothing enabled pending
+    pmu.setIrq(enable, XPOWERS_AXP2101_PKEY_LONG_IRQ);
+    CHECK(!manage.readPowerEvent(&record));
+    CHECK_EQ(record.mask, 0);
+    CHECK_EQ(record.type, PMU_EVENT_NONE);
+}
+
+// A bit latched between the read and the clear stays pending for the next interrupt
+static void test_raised_during_read()
+{
+    XPowersAXP2101 pmu;
+    LilyGoPowerManage manage(&pmu);
+    uint32_t enable = XPOWERS_AXP2101_PKEY_SHORT_IRQ | XPOWERS_AXP2101_BAT_CHG_DONE_IRQ;
+    pmu.setIrq(enable, XPOWERS_AXP2101_PKEY_SHORT_IRQ);
+    pmu.raise_after_read = XPOWERS_AXP2101_BAT_CHG_DONE_IRQ;
+    PMUEventRecord_t record;
+    CHECK(manage.readPowerEvent(&record));
+    CHECK_EQ(record.mask, _BV(PMU_EVENT_KEY_CLICKED));
+    CHECK_EQ(pmu.irqStatus(), XPOWERS_AXP2101_BAT_CHG_DONE_IRQ);
+    CHECK(manage.readPowerEvent(&record));
+    CHECK_EQ(record.mask, _BV(PMU_EVENT_CHARGE_FINISH));
+    CHECK_EQ(pmu.irqStatus(), 0);
+}
+
+// A plug in with a key press and the charger starting, then unplugged
+static void test_replay()
+{
+    static const struct {
+        uint32_t status;
+        bool battery;
+        uint32_t mask;
+        PMUEventType_t type;
+    } trace[] = {
+        {XPOWERS_AXP2101_VBUS_INSERT_IRQ, true, _BV(PMU_EVENT_USBC_INSERT), PMU_EVENT_USBC_INSERT},
+        {
+            XPOWERS_AXP2101_PKEY_SHORT_IRQ | XPOWERS_AXP2101_BAT_CHG_START_IRQ, true,
+            _BV(PMU_EVENT_KEY_CLICKED) | _BV(PMU_EVENT_CHARGE_STARTED), PMU_EVENT_CHARGE_STARTED
+        },
+        {XPOWERS_AXP2101_BAT_CHG_DONE_IRQ, false, 0, PMU_EVENT_NONE},
+        {
+            XPOWERS_AXP2101_VBUS_REMOVE_IRQ | XPOWERS_AXP2101_WARNING_LEVEL1_IRQ, true,
+            _BV(PMU_EVENT_USBC_REMOVE) | _BV(PMU_EVENT_LOW_VOLTAGE_LEVEL1), PMU_EVENT_USBC_REMOVE
+        },
+    };
+    XPowersAXP2101 pmu;
+    LilyGoPowerManage manage(&pmu);
+    for (auto &step : trace) {
+        pmu.setIrq(0xFFFFFF, step.status);
+        pmu.battery = step.battery;
+        PMUEventRecord_t record;
+        CHECK_EQ(manage.readPowerEvent(&record), step.mask != 0);
+        CHECK_EQ(record.mask, step.mask);
+        CHECK_EQ(record.type, step.type);
+        CHECK_EQ(pmu.irqStatus(), 0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    test_single_bits();
+    test_batch();
+    test_no_battery();
+    test_read_power_event();
+    test_raised_during_read();
+    test_replay();
+    return host_test_result("power_manage");
+}
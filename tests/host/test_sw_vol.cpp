@@ -0,0 +1,240 @@
+/**
+ * @file      test_sw_vol.cpp
+ * @author    Lewis He (lewishe@outlook.com)
+ * @license   MIT
+ * @copyright Copyright (c) 2025  ShenZhen XinYuan Electronic Technology Co., Ltd
+ * @date      2025-06-28
+ * @note      The software volume stage against the per frame implementation it replaced.
+ *            Up to 0 dB the output must be bit exact, above 0 dB it must be the saturated
+ *            product where the old code wrapped. With --bench both are timed.
+ */
+#include "host_test.h"
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "bsp_codec/audio_codec_sw_vol.h"
+
+#define REF_GAIN_0DB_SHIFT  15
+
+// The former _sw_vol_process() and _sw_vol_set(), with the gain kept as an int so the
+// ramps above 0 dB can be compared. 'saturate' clamps the product instead of wrapping.
+struct ref_vol {
+    int gain;
+    int cur;
+    int step;
+    int channel;
+    int rate;
+    int duration;
+    bool saturate;
+};
+
+static int16_t ref_sample(const ref_vol *v, int16_t in)
+{
+    if (!v->saturate) {
+        return (int16_t)((in * v->cur) >> REF_GAIN_0DB_SHIFT);
+    }
+    int64_t p = ((int64_t)in * v->cur) >> REF_GAIN_0DB_SHIFT;
+    return p > INT16_MAX ? INT16_MAX : (p < INT16_MIN ? INT16_MIN : (int16_t)p);
+}
+
+static void ref_set(ref_vol *v, float db_value)
+{
+    if (db_value <= -96.0) {
+        v->gain = 0;
+    } else {
+        v->gain = (int)(exp(db_value / 20 * log(10)) * (1 << REF_GAIN_0DB_SHIFT));
+    }
+    float step = (float)(v->gain - v->cur) * 1000 / v->duration / v->rate;
+    v->step = (int)step;
+    if (step == 0) {
+        v->cur = v->gain;
+    }
+}
+
+static void ref_process(ref_vol *v, const int16_t *in, int16_t *out, int frames)
+{
+    if (v->cur == v->gain) {
+        if (v->gain == 0) {
+            memset(out, 0, frames * v->channel * sizeof(int16_t));
+            return;
+        }
+        for (int i = 0; i < frames * v->channel; i++) {
+            out[i] = ref_sample(v, in[i]);
+        }
+        return;
+    }
+    for (int i = 0; i < frames; i++) {
+        for (int j = 0; j < v->channel; j++) {
+            *out++ = ref_sample(v, *in++);
+        }
+        if (v->step) {
+            v->cur += v->step;
+            if (v->step > 0) {
+                if (v->cur > v->gain) {
+                    v->cur = v->gain;
+                    v->step = 0;
+                }
+            } else {
+                if (v->cur < v->gain) {
+                    v->cur = v->gain;
+                    v->step = 0;
+                }
+            }
+        }
+    }
+}
+
+static const audio_codec_vol_if_t *open_vol(ref_vol *ref, int rate, int channel, int duration, bool saturate)
+{
+    const audio_codec_vol_if_t *vol = audio_codec_new_sw_vol();
+    esp_codec_dev_sample_info_t fs = {};
+    fs.bits_per_sample = 16;
+    fs.channel = channel;
+    fs.sample_rate = rate;
+    CHECK_EQ(vol->open(vol, &fs, duration), ESP_CODEC_DEV_OK);
+    *ref = {0, 0, 0, channel, rate, duration, saturate};
+    return vol;
+}
+
+static void fill_random(std::vector<int16_t> &buf)
+{
+    for (auto &s : buf) {
+        s = (int16_t)(rand() & 0xFFFF);
+    }
+}
+
+// Random fades and block sizes, gains drawn from [min_db, max_db]
+static void test_random(float min_db, float max_db, bool saturate, int trials)
+{
+    static const int rates[] = {8000, 16000, 44100, 48000};
+    int mismatches = 0;
+    for (int t = 0; t < trials; t++) {
+        ref_vol ref;
+        int channel = 1 + rand() % 4;
+        int rate = rates[rand() % 4];
+        int duration = 1 + rand() % 100;
+        const audio_codec_vol_if_t *vol = open_vol(&ref, rate, channel, duration, saturate);
+        for (int step = 0; step < 20; step++) {
+            if (rand() % 3 == 0) {
+                float db = rand() % 10 == 0 ? -100.0f : min_db + (max_db - min_db) * (rand() / (float)RAND_MAX);
+                vol->set_vol(vol, db);
+                ref_set(&ref, db);
+            }
+            int frames = rand() % 600;
+            std::vector<int16_t> in(frames * channel), expect(frames * channel), out(frames * channel);
+            fill_random(in);
+            ref_process(&ref, in.data(), expect.data(), frames);
+            int len = frames * channel * sizeof(int16_t);
+            if (rand() & 1) {
+                // In place
+                out = in;
+                vol->process(vol, (uint8_t *)out.data(), len, (uint8_t *)out.data(), len);
+            } else {
+                vol->process(vol, (uint8_t *)in.data(), len, (uint8_t *)out.data(), len);
+            }
+            mismatches += out != expect;
+        }
+        vol->close(vol);
+        free((void *)vol);
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+static void test_saturation()
+{
+    ref_vol ref;
+    const audio_codec_vol_if_t *vol = open_vol(&ref, 16000, 1, 50, true);
+    vol->close(vol);
+    // Not open, the gain is taken at once
+    vol->set_vol(vol, 12.0f);
+    esp_codec_dev_sample_info_t fs = {};
+    fs.bits_per_sample = 16;
+    fs.channel = 1;
+    fs.sample_rate = 16000;
+    vol->open(vol, &fs, 50);
+    int16_t pcm[6] = {INT16_MAX, INT16_MIN, 10000, -10000, 1000, -1000};
+    vol->process(vol, (uint8_t *)pcm, sizeof(pcm), (uint8_t *)pcm, sizeof(pcm));
+    CHECK_EQ(pcm[0], INT16_MAX);
+    CHECK_EQ(pcm[1], INT16_MIN);
+    CHECK_EQ(pcm[2], INT16_MAX);
+    CHECK_EQ(pcm[3], INT16_MIN);
+    // 3.98 times
+    CHECK(pcm[4] > 3900 && pcm[4] < 4000);
+    CHECK(pcm[5] < -3900 && pcm[5] > -4000);
+    free((void *)vol);
+}
+
+template <typename F>
+static double bench_ns_per_sample(F process, int samples, int rounds)
+{
+    uint64_t start = host_test_now_ns();
+    for (int r = 0; r < rounds; r++) {
+        process();
+    }
+    return (double)(host_test_now_ns() - start) / ((double)samples * rounds);
+}
+
+static void bench()
+{
+    const int frames = 512;
+    const int channel = 2;
+    const int rounds = 20000;
+    std::vector<int16_t> in(frames * channel), out(frames * channel);
+    fill_random(in);
+    printf("%d stereo frames per call, ns per sample\n", frames);
+    printf("case,old_ns,new_ns\n");
+    static const struct {
+        const char *name;
+        float db;
+        bool fade;
+    } cases[] = {
+        {"-6dB", -6.0f, false},
+        {"0dB", 0.0f, false},
+        {"+6dB", 6.0f, false},
+        {"fade", -6.0f, true},
+    };
+    for (auto &c : cases) {
+        ref_vol ref;
+        // A 20 ms fade is longer than one call, a fade case ramps on every sample
+        const audio_codec_vol_if_t *vol = open_vol(&ref, 48000, channel, 20, c.db > 0);
+        vol->set_vol(vol, c.db);
+        ref_set(&ref, c.db);
+        if (!c.fade) {
+            // Settle on the gain
+            while (ref.cur != ref.gain) {
+                ref_process(&ref, in.data(), out.data(), frames);
+                vol->process(vol, (uint8_t *)in.data(), frames * channel * 2, (uint8_t *)out.data(), frames * channel * 2);
+            }
+        }
+        int call = 0;
+        double old_ns = bench_ns_per_sample([&]() {
+            if (c.fade) {
+                ref_set(&ref, ++call & 1 ? -20.0f : c.db);
+            }
+            ref_process(&ref, in.data(), out.data(), frames);
+        }, frames * channel, rounds);
+        call = 0;
+        double new_ns = bench_ns_per_sample([&]() {
+            if (c.fade) {
+                vol->set_vol(vol, ++call & 1 ? -20.0f : c.db);
+            }
+            vol->process(vol, (uint8_t *)in.data(), frames * channel * 2, (uint8_t *)out.data(), frames * channel * 2);
+        }, frames * channel, rounds);
+        printf("%s,%.3f,%.3f\n", c.name, old_ns, new_ns);
+        free((void *)vol);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    srand(1);
+    // Up to 0 dB the old arithmetic can not overflow, the output must match bit for bit
+    test_random(-60.0f, 0.0f, false, 300);
+    // Above 0 dB the old code wrapped, compare against the saturated product
+    test_random(-20.0f, 12.0f, true, 300);
+    test_saturation();
+    if (host_test_bench(argc, argv)) {
+        bench();
+    }
+    return host_test_result("sw_vol");
+}